@@ -15,16 +15,42 @@ command -v rsgain   >/dev/null 2>&1 || { echo "rsgain not found";   exit 1; }
 dir="${1:?Usage: $0 /path/to/album_dir loudness}"
 lvl="${2:?Usage: $0 /path/to/album_dir loudness}"
 
+# Config (LOUDNESS_CACHE_ENABLED) and the loudness scan cache; boosting
+# still works without them, it just rescans every time
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    load_config 2>/dev/null || true
+    source "$SCRIPT_DIR/musiclib_utils_tag_functions.sh" 2>/dev/null || true
+fi
+declare -F loudness_cached >/dev/null || loudness_cached() { return 1; }
+declare -F loudness_record >/dev/null || loudness_record() { return 0; }
+
+# Every MP3 of the album, including disc subfolders
+mapfile -d '' files < <(find "$dir" -type f -name '*.mp3' -print0 | sort -z)
+if [ ${#files[@]} -eq 0 ]; then
+    echo "No MP3 files found in $dir"
+    exit 1
+fi
+
+# Boosted to this level before and untouched since: the tags already hold
+# the gains this run would compute
+if loudness_cached "custom:-${lvl}" "${files[@]}"; then
+    echo "$dir is already at target loudness -${lvl} LUFS (unchanged since last boost), skipped."
+    exit 0
+fi
+
 # 1) Remove existing ReplayGain-related fields via kid3-cli
 kid3-cli -c "set REPLAYGAIN_TRACK_GAIN ''" \
          -c "set REPLAYGAIN_TRACK_PEAK ''" \
          -c "set REPLAYGAIN_ALBUM_GAIN ''" \
          -c "set REPLAYGAIN_ALBUM_PEAK ''" \
-         "$dir"/*.mp3
+         "${files[@]}"
 
 echo "Removed existing ReplayGain settings from tags."
 echo "Boosting $dir to target loudness -${lvl} LUFS..."
 
 # 2) Re-scan and tag with rsgain at the requested loudness
-rsgain custom -a -s i -l "-${lvl}" -c a -t -S -m 8 \
-  $(find "$dir" -type f -name '*.mp3')
+rsgain custom -a -s i -l "-${lvl}" -c a -t -S -m 8 "${files[@]}"
+rc=$?
+[ $rc -eq 0 ] && loudness_record "custom:-${lvl}" "${files[@]}"
+exit $rc
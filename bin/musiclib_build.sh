@@ -39,6 +39,7 @@ SORT_COLUMN=""
 OUTPUT_FILE="$MUSICDB"
 TEMP_OUTPUT=""
 DRY_RUN=false
+DIFF_DETAIL=""
 SHOW_PROGRESS=true
 RESTORE_LASTPLAYED=false
 
@@ -63,7 +64,13 @@ Arguments:
 
 Options:
   -h, --help        Display this help
-  -d, --dry-run     Preview mode - show what would be processed without changes
+  -d, --dry-run     Preview mode - read every file as a real build would and
+                    report the difference to the existing database (rows
+                    added, removed and changed per column, LastTimePlayed
+                    values that would be lost) without changing anything
+  --diff-detail FILE
+                    With --dry-run: also write one JSON line per
+                    added, removed or changed row to FILE
   -o FILE           Output file path (default: $OUTPUT_FILE)
   -m DEPTH          Minimum subdirectory depth from root (default: 1)
   --no-header       Suppress database header in output
@@ -77,11 +84,19 @@ Options:
                     via kid3-cli.  Use when rebuilding an existing library so
                     play history is preserved.  Adds one kid3-cli call per
                     file; omit for faster builds on new libraries.
+  --shard NAME      Build one library shard from LIBRARY_SHARDS: scans the
+                    shard's root and writes the shard's DSV under its own lock
+  --all-shards      Build every shard in LIBRARY_SHARDS in parallel, one
+                    build process per shard
 
 Examples:
   # Preview what would be rebuilt
   musiclib-cli build /mnt/music --dry-run
 
+  # Same, with per-row detail; list rows that would lose play history
+  musiclib-cli build --dry-run --diff-detail /tmp/build.ndjson
+  jq -c 'select(.changes.LastTimePlayed)' /tmp/build.ndjson
+
   # Rebuild entire database (new library — no play history)
   musiclib-cli build /mnt/music
 
@@ -94,6 +109,9 @@ Examples:
   # Custom output location
   musiclib-cli build /mnt/music -o ~/music_backup.dsv
 
+  # Rebuild every library shard at once, keeping play history
+  musiclib-cli build --all-shards --restore-lastplayed
+
 Exit Codes:
   0 - Success
   1 - Dry-run complete (informational) or user error (invalid arguments)
@@ -116,6 +134,10 @@ EOF
 MUSIC_DIR=""
 TEST_MODE=false
 CREATE_BACKUP=false
+OUTPUT_SET=false
+SHARD_NAME=""
+ALL_SHARDS=false
+ORIG_ARGS=("$@")
 
 while [ $# -gt 0 ]; do
     case "$1" in
@@ -127,12 +149,21 @@ while [ $# -gt 0 ]; do
             DRY_RUN=true
             shift
             ;;
+        --diff-detail)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option --diff-detail requires an argument" "option" "--diff-detail"
+                exit 1
+            fi
+            DIFF_DETAIL="$2"
+            shift 2
+            ;;
         -o|--output)
             if [ -z "${2:-}" ]; then
                 error_exit 1 "Option -o/--output requires an argument" "option" "-o"
                 exit 1
             fi
             OUTPUT_FILE="$2"
+            OUTPUT_SET=true
             shift 2
             ;;
         -m|--min-depth)
@@ -166,6 +197,7 @@ while [ $# -gt 0 ]; do
         -t|--test)
             TEST_MODE=true
             OUTPUT_FILE="/tmp/musiclib_test_$(date +%Y%m%d_%H%M%S).dsv"
+            OUTPUT_SET=true
             shift
             ;;
         --no-progress)
@@ -176,6 +208,18 @@ while [ $# -gt 0 ]; do
             RESTORE_LASTPLAYED=true
             shift
             ;;
+        --shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option --shard requires an argument" "option" "--shard"
+                exit 1
+            fi
+            SHARD_NAME="$2"
+            shift 2
+            ;;
+        --all-shards)
+            ALL_SHARDS=true
+            shift
+            ;;
         -*)
             show_usage
             error_exit 1 "Unknown option" "option" "$1"
@@ -194,6 +238,68 @@ while [ $# -gt 0 ]; do
     esac
 done
 
+# A dry run exits 1; the CLI only treats that as success when --dry-run
+# was given, so the detail file must not switch the mode on by itself
+if [ -n "$DIFF_DETAIL" ] && [ "$DRY_RUN" != true ]; then
+    error_exit 1 "Option --diff-detail requires --dry-run" "option" "--diff-detail"
+    exit 1
+fi
+
+#############################################
+# Library Shards
+#############################################
+# --all-shards fans out one child build per shard.  Each child owns its
+# shard's DSV and lock (${dsv}.lock), so the builds never wait on each
+# other.  Child output is prefixed with the shard name; the exit code is
+# the worst child result.
+if [ "$ALL_SHARDS" = true ]; then
+    if [ -n "$MUSIC_DIR" ] || [ "$OUTPUT_SET" = true ] || [ -n "$SHARD_NAME" ]; then
+        error_exit 1 "--all-shards cannot be combined with MUSIC_DIR, -o, -t or --shard"
+        exit 1
+    fi
+
+    pass_args=()
+    for arg in "${ORIG_ARGS[@]}"; do
+        [ "$arg" = "--all-shards" ] || pass_args+=("$arg")
+    done
+
+    shard_pids=()
+    shard_names=()
+    while IFS=$'\t' read -r name root dsv; do
+        [ "$QUIET" = false ] && echo "Building shard '$name': $root -> $dsv"
+        (
+            bash "$SCRIPT_DIR/musiclib_build.sh" --shard "$name" --no-progress "${pass_args[@]}" \
+                | awk -v p="[$name] " '{ print p $0; fflush() }'
+        ) &
+        shard_pids+=("$!")
+        shard_names+=("$name")
+    done < <(list_library_shards)
+
+    overall_rc=0
+    for i in "${!shard_pids[@]}"; do
+        wait "${shard_pids[$i]}"
+        rc=$?
+        if [ "$rc" -gt 1 ]; then
+            echo "Shard '${shard_names[$i]}' failed (exit $rc)" >&2
+        fi
+        [ "$rc" -gt "$overall_rc" ] && overall_rc=$rc
+    done
+    exit "$overall_rc"
+fi
+
+# --shard: scan the shard's root and write its DSV.  MUSICDB follows the
+# shard so the lock and backup apply to that shard only.
+if [ -n "$SHARD_NAME" ]; then
+    if ! shard_info=$(get_library_shard "$SHARD_NAME"); then
+        error_exit 1 "Unknown library shard" "shard" "$SHARD_NAME"
+        exit 1
+    fi
+    IFS=$'\t' read -r shard_root shard_dsv <<< "$shard_info"
+    [ -z "$MUSIC_DIR" ] && MUSIC_DIR="$shard_root"
+    MUSICDB="$shard_dsv"
+    [ "$OUTPUT_SET" = false ] && OUTPUT_FILE="$shard_dsv"
+fi
+
 # Use default if not specified
 if [ -z "$MUSIC_DIR" ]; then
     MUSIC_DIR="$MUSIC_ROOT_DIR"
@@ -282,6 +388,125 @@ query_exiftool_daemon() {
     ET_COMMENT_C2=$(printf '%s'     "$raw" | grep -m1 '^Comment[[:space:]-].*:[[:space:]]*(Songs-DB_Custom2)' | sed 's/^[^:]*:[[:space:]]*//')
 }
 
+#############################################
+# Dry-Run Diff Report
+# Hash-joins the would-be database against the
+# existing one by SongPath: one pass over each
+# file, old rows held in memory.
+#############################################
+# Usage: dry_run_diff_report <existing_dsv> <new_dsv> [detail_ndjson]
+# Columns are matched by header name; a file without a header is read in
+# DEFAULT_HEADER order.  ID and IDAlbum are regenerated by every build, so
+# they are reported as renumbered rather than changed.
+dry_run_diff_report() {
+    local old_dsv="$1" new_dsv="$2" detail="${3:-}"
+    local old_input="$old_dsv"
+
+    [ -f "$old_dsv" ] || old_input=/dev/null
+    [ -n "$detail" ] && : > "$detail"
+
+    awk -F'^' -v detail="$detail" -v defhdr="$DEFAULT_HEADER" '
+        function jstr(s,    n, parts, i) {
+            # Backslashes by split/join: gsub replacement escaping differs
+            # between awk implementations
+            n = split(s, parts, /\\/)
+            s = parts[1]
+            for (i = 2; i <= n; i++) s = s "\\\\" parts[i]
+            gsub(/"/, "\\\"", s)
+            gsub(/\t/, "\\t", s); gsub(/\r/, "\\r", s)
+            return "\"" s "\""
+        }
+        function emit(line) { if (detail != "") print line > detail }
+        function played(v) { return v != "" && v + 0 > 0 }
+        function header(line, names, idx,    n, f, i) {
+            n = split(line, f, "^")
+            for (i = 1; i <= n; i++)
+                if (f[i] != "") { names[i] = f[i]; idx[f[i]] = i }
+            return n
+        }
+        BEGIN {
+            header(defhdr, dnames, didx)
+            ncmp = split("Artist^Album^AlbumArtist^SongTitle^Genre^SongLength^Rating^Custom2^GroupDesc^LastTimePlayed", cmp, "^")
+        }
+        # Pass 1: existing database
+        FILENAME == ARGV[1] {
+            if (FNR == 1 && $1 == "ID") { header($0, onames, oidx); ohdr = 1; next }
+            if (!ohdr) { for (k in didx) oidx[k] = didx[k]; ohdr = 1 }
+            path = $(oidx["SongPath"])
+            if (path == "") next
+            if (path in old) {
+                # Duplicate rows for one file collapse to one in a rebuild
+                dups++
+                emit("{\"op\":\"removed\",\"reason\":\"duplicate\",\"id\":" jstr($(oidx["ID"])) ",\"path\":" jstr(path) "}")
+                next
+            }
+            old[path] = $0
+            nold++
+            next
+        }
+        # Pass 2: would-be database
+        FNR == 1 && $1 == "ID" { header($0, nnames, nidx); nhdr = 1; next }
+        {
+            if (!nhdr) { for (k in didx) nidx[k] = didx[k]; nhdr = 1 }
+            path = $(nidx["SongPath"])
+            if (path == "") next
+            nnew++
+            if (!(path in old)) {
+                added++
+                emit("{\"op\":\"added\",\"id\":" jstr($(nidx["ID"])) ",\"path\":" jstr(path) "}")
+                next
+            }
+            n = split(old[path], o, "^")
+            delete old[path]
+            if (o[oidx["ID"]] != $(nidx["ID"])) renumbered++
+
+            changes = ""
+            for (c = 1; c <= ncmp; c++) {
+                col = cmp[c]
+                if (!(col in oidx) || !(col in nidx)) continue
+                ov = o[oidx[col]]; nv = $(nidx[col])
+                if (ov == nv) continue
+                if (col == "LastTimePlayed" && ov + 0 == nv + 0) continue
+                colchg[col]++
+                changes = changes (changes == "" ? "" : ",") jstr(col) ":[" jstr(ov) "," jstr(nv) "]"
+            }
+            if ("LastTimePlayed" in oidx && "LastTimePlayed" in nidx \
+                    && played(o[oidx["LastTimePlayed"]]) && !played($(nidx["LastTimePlayed"])))
+                lost++
+            if (changes == "") { same++; next }
+            changed++
+            emit("{\"op\":\"changed\",\"id_old\":" jstr(o[oidx["ID"]]) ",\"id_new\":" jstr($(nidx["ID"])) \
+                 ",\"path\":" jstr(path) ",\"changes\":{" changes "}}")
+        }
+        END {
+            for (path in old) {
+                split(old[path], o, "^")
+                removed++
+                lp = ("LastTimePlayed" in oidx) ? o[oidx["LastTimePlayed"]] : ""
+                if (played(lp)) removed_played++
+                emit("{\"op\":\"removed\",\"id\":" jstr(o[oidx["ID"]]) ",\"path\":" jstr(path) \
+                     ",\"lastplayed\":" jstr(lp) "}")
+            }
+            printf "Existing rows:          %d\n", nold + dups
+            printf "Would-be rows:          %d\n", nnew
+            printf "  Unchanged:            %d\n", same
+            printf "  Changed:              %d\n", changed
+            printf "  Added:                %d\n", added
+            printf "  Removed:              %d\n", removed + dups
+            if (dups) printf "    (duplicates:         %d)\n", dups
+            printf "  IDs renumbered:       %d\n", renumbered
+            if (changed) {
+                print "Column changes:"
+                for (c = 1; c <= ncmp; c++)
+                    if (colchg[cmp[c]]) printf "  %-22s%d\n", cmp[c] ":", colchg[cmp[c]]
+            }
+            print "LastTimePlayed:"
+            printf "  Lost (played -> 0):   %d\n", lost
+            printf "  Removed with history: %d\n", removed_played
+        }
+    ' "$old_input" "$new_dsv"
+}
+
 start_exiftool_daemon
 
 #############################################
@@ -328,6 +553,14 @@ if [ $SCAN_EXIT_CODE -ne 0 ]; then
     exit 2
 fi
 
+# Visit files in disk order (SCAN_ORDER) so tag reads sweep the disk once
+# instead of seeking back and forth between album directories
+ORDERED_SCAN=$(mktemp)
+CLEANUP_FILES="$CLEANUP_FILES $ORDERED_SCAN"
+if disk_order_list < "$SCAN_FILE" > "$ORDERED_SCAN" 2>>"$ERROR_LOG" && [ -s "$ORDERED_SCAN" ]; then
+    mv "$ORDERED_SCAN" "$SCAN_FILE"
+fi
+
 # Count total files
 TOTAL_FILES=$(wc -l < "$SCAN_FILE")
 TOTAL_FILES=${TOTAL_FILES##* }   # strip any leading whitespace from wc
@@ -340,101 +573,49 @@ if [ "$TOTAL_FILES" -eq 0 ]; then
     exit 2
 fi
 
-#############################################
-# DRY RUN MODE - Preview Only
-#############################################
-if [ "$DRY_RUN" = true ]; then
-    [ "$QUIET" = false ] && echo "Preview: Analyzing files without making changes..."
-    [ "$QUIET" = false ] && echo ""
-    
-    declare -A ALBUM_PREVIEW=()
-    PREVIEW_COUNT=0
-    MISSING_TAGS_COUNT=0
-    SAMPLE_FILES=()
-    
-    # Process files for preview
-    while IFS= read -r filepath; do
-        [ -z "$filepath" ] && continue
-        
-        PREVIEW_COUNT=$((PREVIEW_COUNT + 1))
-        
-        # Extract basic metadata for preview via daemon (1 round-trip)
-        query_exiftool_daemon "$filepath"
-        ARTIST="$ET_ARTIST"
-        ALBUM="$ET_ALBUM"
-        TITLE="$ET_TITLE"
-        
-        # Track files with missing critical tags
-        if [ -z "$ARTIST" ] || [ -z "$TITLE" ]; then
-            MISSING_TAGS_COUNT=$((MISSING_TAGS_COUNT + 1))
-            if [ ${#SAMPLE_FILES[@]} -lt 3 ]; then
-                SAMPLE_FILES+=("$filepath")
-            fi
-        fi
-        
-        # Collect unique albums
-        if [ -n "$ALBUM" ]; then
-            ALBUM_PREVIEW["$ALBUM"]=1
-        fi
-        
-        # Show progress every 100 files
-        if [ "$QUIET" = false ] && [ "$SHOW_PROGRESS" = true ] && [ $((PREVIEW_COUNT % 100)) -eq 0 ]; then
-            echo "  Analyzed $PREVIEW_COUNT of $TOTAL_FILES files..."
-        fi
-    done < "$SCAN_FILE"
+# Read-ahead: while the exiftool daemon works through one batch of
+# SCAN_PREFETCH_BATCH files, the tag headers of the next batch are pulled
+# into the page cache by concurrent reads, so the daemon rarely waits on
+# the disk.  The background readers must not hold the daemon's pipes (7/8).
+PREFETCH_BATCH="${SCAN_PREFETCH_BATCH:-256}"
+[[ "$PREFETCH_BATCH" =~ ^[1-9][0-9]*$ ]] || PREFETCH_BATCH=256
+
+prefetch_scan_batch() {
+    local first=$(( $1 * PREFETCH_BATCH + 1 ))
+    [ "$first" -gt "$TOTAL_FILES" ] && return 0
+    ( sed -n "${first},$((first + PREFETCH_BATCH - 1))p" "$SCAN_FILE" | prefetch_file_list ) 7<&- 8>&- &
+}
 
-    [ "$QUIET" = false ] && echo ""
-    echo "=== Dry Run Summary ==="
-    echo "Total files found: $TOTAL_FILES"
-    echo "Files that would be processed: $TOTAL_FILES"
-    echo "Estimated unique albums: ${#ALBUM_PREVIEW[@]}"
-    
-    if [ $MISSING_TAGS_COUNT -gt 0 ]; then
-        echo ""
-        echo "WARNING: $MISSING_TAGS_COUNT files missing Artist or Title tags"
-        if [ ${#SAMPLE_FILES[@]} -gt 0 ]; then
-            echo "Sample files with missing tags:"
-            for sample in "${SAMPLE_FILES[@]}"; do
-                echo "  - $(basename "$sample")"
-            done
-        fi
-    fi
-    
-    echo ""
-    echo "Database changes:"
-    if [ "$TEST_MODE" = true ]; then
-        echo "  - Would create: $OUTPUT_FILE (test mode)"
-    else
-        if [ -f "$OUTPUT_FILE" ]; then
-            CURRENT_ENTRIES=$(grep -v "^ID" "$OUTPUT_FILE" 2>/dev/null | wc -l || echo 0)
-            echo "  - Would replace: $OUTPUT_FILE"
-            echo "  - Current entries: $CURRENT_ENTRIES"
-            echo "  - New entries: $TOTAL_FILES"
-            [ "$CREATE_BACKUP" = true ] && echo "  - Would backup existing database"
-        else
-            echo "  - Would create: $OUTPUT_FILE"
-            echo "  - New entries: $TOTAL_FILES"
-        fi
+# Call once per file with its 1-based position in SCAN_FILE
+prefetch_ahead() {
+    if [ $(( ($1 - 1) % PREFETCH_BATCH )) -eq 0 ]; then
+        prefetch_scan_batch $(( ($1 - 1) / PREFETCH_BATCH + 1 ))
     fi
-    echo ""
-    echo "No changes were made (dry-run mode)"
-    echo "Run without --dry-run to apply changes"
-    
-    exit 1  # Exit 1 for dry-run complete (informational, not an error)
-fi
+}
+
+prefetch_scan_batch 0
+SCAN_POSITION=0
 
 #############################################
 # NORMAL MODE - Process Files
 #############################################
-[ "$QUIET" = false ] && echo "Processing files..."
+if [ "$DRY_RUN" = true ]; then
+    [ "$QUIET" = false ] && echo "Analyzing files (nothing will be written)..."
+else
+    [ "$QUIET" = false ] && echo "Processing files..."
+fi
 
 CURRENT_ID=1
 declare -A ALBUM_ID_MAP=()
 NEXT_ALBUM_ID=1
 PROCESSING_ERRORS=0
 
-# Determine working file: test mode writes directly, production uses temp file
-if [ "$TEST_MODE" = true ]; then
+# Determine working file: dry run builds a throwaway copy for the diff
+# report, test mode writes directly, production uses temp file
+if [ "$DRY_RUN" = true ]; then
+    WORKING_FILE=$(mktemp)
+    CLEANUP_FILES="$CLEANUP_FILES $WORKING_FILE"
+elif [ "$TEST_MODE" = true ]; then
     WORKING_FILE="$OUTPUT_FILE"
     [ "$QUIET" = false ] && echo "TEST MODE: Writing directly to $OUTPUT_FILE"
 else
@@ -447,8 +628,9 @@ else
     [ "$QUIET" = false ] && echo "Building database in temporary file..."
 fi
 
-# Write header if not suppressed
-if [ "$NO_HEADER" = false ]; then
+# Write header if not suppressed (always in a dry run: the diff report
+# matches columns by name)
+if [ "$NO_HEADER" = false ] || [ "$DRY_RUN" = true ]; then
     if ! echo "$DEFAULT_HEADER" > "$WORKING_FILE" 2>/dev/null; then
         error_exit 2 "Failed to write database header" "file" "$WORKING_FILE"
         exit 2
@@ -457,6 +639,8 @@ fi
 
 # Process all found files
 while IFS= read -r filepath; do
+    SCAN_POSITION=$((SCAN_POSITION + 1))
+    prefetch_ahead "$SCAN_POSITION"
     [ -z "$filepath" ] && continue
     
     # Extract all metadata in a single daemon round-trip (stay_open mode)
@@ -582,6 +766,26 @@ if [ $PROCESSING_ERRORS -gt 0 ]; then
     echo "Warning: $PROCESSING_ERRORS files had processing errors" >&2
 fi
 
+#############################################
+# DRY RUN - Diff Report
+#############################################
+if [ "$DRY_RUN" = true ]; then
+    [ "$QUIET" = false ] && echo ""
+    echo "=== Dry Run: Changes to $OUTPUT_FILE (matched by SongPath) ==="
+    [ -f "$OUTPUT_FILE" ] || echo "(database does not exist yet; every row would be added)"
+    dry_run_diff_report "$OUTPUT_FILE" "$WORKING_FILE" "$DIFF_DETAIL"
+    echo "Unique albums:          $((NEXT_ALBUM_ID - 1))"
+    [ -n "$DIFF_DETAIL" ] && echo "Per-row detail (NDJSON): $DIFF_DETAIL"
+    if [ "$RESTORE_LASTPLAYED" = false ] && [ -f "$OUTPUT_FILE" ]; then
+        echo ""
+        echo "Note: without --restore-lastplayed every LastTimePlayed is reset to 0"
+    fi
+    echo ""
+    echo "No changes were made (dry-run mode)"
+    echo "Run without --dry-run to apply changes"
+    exit 1  # Exit 1 for dry-run complete (informational, not an error)
+fi
+
 [ "$QUIET" = false ] && echo ""
 [ "$QUIET" = false ] && echo "=== Rebuild Complete ==="
 [ "$QUIET" = false ] && echo "Total tracks processed: $TOTAL_PROCESSED"
@@ -600,8 +804,8 @@ else
 
     # Function to perform the atomic move
     perform_database_replacement() {
-        mv "$WORKING_FILE" "$OUTPUT_FILE"
-        return $?
+        mv "$WORKING_FILE" "$OUTPUT_FILE" || return $?
+        publish_change "$OUTPUT_FILE" reload "" ""
     }
 
     # Use with_db_lock to ensure exclusive access during replacement
@@ -627,6 +831,20 @@ else
             "$SCRIPT_DIR/musiclib_baloo_sync.sh" || true
         fi
     fi
+
+    # Record inode, size and payload hash of every file so a later
+    # "musiclib-cli reconcile" can follow files that get moved.  Non-fatal.
+    [ "$QUIET" = false ] && echo ""
+    [ "$QUIET" = false ] && echo "Recording file identities..."
+    file_ids_update "$OUTPUT_FILE" || true
+
+    # Bring the lyrics/comment text index up to date.  Only files whose
+    # mtime changed are re-read.  Non-fatal.
+    if [ "${TEXT_INDEX_ENABLED:-false}" = true ] && [ -f "$SCRIPT_DIR/musiclib_textindex.sh" ]; then
+        [ "$QUIET" = false ] && echo ""
+        [ "$QUIET" = false ] && echo "Updating lyrics/comment text index..."
+        "$SCRIPT_DIR/musiclib_textindex.sh" -d "$OUTPUT_FILE" -q || true
+    fi
 fi
 
 exit 0
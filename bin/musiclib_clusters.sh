@@ -0,0 +1,483 @@
+#!/bin/bash
+#
+# musiclib_clusters.sh - Propose clusters of near-duplicate artist/genre names
+# Usage: musiclib_clusters.sh artists|genres [options]
+#        musiclib_clusters.sh apply MAPPING [options]
+#
+#   artists        Cluster distinct Artist and AlbumArtist values
+#   genres         Cluster distinct Genre values
+#   apply MAPPING  Write a reviewed artist mapping to Custom2
+#
+# Names are first normalised (case, a leading "The" or trailing ", The",
+# "&" vs "and", punctuation, whitespace); names with the same normalised
+# key always cluster.  The remaining keys are compared through an inverted
+# index of character trigrams: only keys that share a trigram outside the
+# most common ones are scored, so the work grows with the number of names
+# rather than its square.  Pairs whose trigram Jaccard similarity reaches
+# the threshold are joined (union-find).
+#
+# The mapping is TSV ("cluster<TAB>canonical<TAB>variant<TAB>tracks") with
+# the most used spelling as canonical.  Edit or delete lines, then apply it:
+# each track whose effective artist (AlbumArtist, or Artist when empty) is
+# a variant and whose Custom2 is empty gets Custom2 = canonical, so smart
+# playlists treat the variants as one artist.  The whole database is
+# rewritten once, under the lock, and published as a reload.  The new value
+# is then written to each file's Songs-DB_Custom2 tag, as a Custom2 edit
+# does, so it survives a rebuild: one kid3-cli run per canonical name.
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard, unreadable mapping)
+#   2 - System error (config failure, database not found, lock timeout,
+#       kid3-cli missing for apply)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_clusters.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_clusters.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli clusters artists|genres [options]
+       musiclib-cli clusters apply MAPPING [options]
+
+Propose clusters of near-duplicate artist or genre names ("The Beatles",
+"Beatles, The", "beatles") as a reviewable mapping, and apply a reviewed
+artist mapping to the Custom2 field.
+
+Options:
+  --threshold T   Trigram similarity needed to join two names, 0-1
+                  (default: 0.6)
+  -o FILE         Write the mapping to FILE instead of stdout
+  --dry-run       apply: report what would change without writing
+  -d FILE         Database to use (default: every library shard)
+  --shard NAME    Use the named library shard only
+  -h, --help      Display this help
+
+Mapping format (TSV, lines starting with # are ignored):
+  cluster   canonical   variant   tracks
+
+Examples:
+  musiclib-cli clusters artists -o ~/artists.tsv
+  musiclib-cli clusters apply ~/artists.tsv --dry-run
+  musiclib-cli clusters genres --threshold 0.5
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+SUBCOMMAND=""
+MAPPING=""
+THRESHOLD="0.6"
+OUTPUT_FILE=""
+DRY_RUN=false
+TARGET_DB=""
+TARGET_SHARD=""
+LOCK_TIMEOUT=10
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        --threshold|-o|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --threshold) THRESHOLD="$2" ;;
+                -o)          OUTPUT_FILE="$2" ;;
+                -d)          TARGET_DB="$2" ;;
+                --shard)     TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --dry-run)
+            DRY_RUN=true
+            shift
+            ;;
+        -*)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+        *)
+            if [ -z "$SUBCOMMAND" ]; then
+                SUBCOMMAND="$1"
+            elif [ "$SUBCOMMAND" = "apply" ] && [ -z "$MAPPING" ]; then
+                MAPPING="$1"
+            else
+                error_exit 1 "Unexpected argument" "argument" "$1"
+                exit 1
+            fi
+            shift
+            ;;
+    esac
+done
+
+case "$SUBCOMMAND" in
+    artists) COLUMNS_WANTED="Artist AlbumArtist" ;;
+    genres)  COLUMNS_WANTED="Genre" ;;
+    apply)
+        if [ -z "$MAPPING" ]; then
+            error_exit 1 "apply requires a mapping file"
+            exit 1
+        fi
+        if [ ! -r "$MAPPING" ]; then
+            error_exit 1 "Mapping file not readable" "mapping" "$MAPPING"
+            exit 1
+        fi
+        # Genre is read from tags, so only artist mappings are applied
+        if head -n 1 "$MAPPING" | grep -q '^# musiclib clusters: genres'; then
+            error_exit 1 "Genre mappings cannot be applied (Custom2 holds artists)" "mapping" "$MAPPING"
+            exit 1
+        fi
+        # Custom2 also lives in the file tags; a database-only change would
+        # be lost on the next rebuild
+        if [ "$DRY_RUN" = false ] && ! check_required_tools kid3-cli; then
+            error_exit 2 "Required tools not available" "missing" "kid3-cli"
+            exit 2
+        fi
+        ;;
+    "")
+        show_usage >&2
+        error_exit 1 "No subcommand given (artists, genres or apply)"
+        exit 1
+        ;;
+    *)
+        error_exit 1 "Unknown subcommand (must be artists, genres or apply)" "subcommand" "$SUBCOMMAND"
+        exit 1
+        ;;
+esac
+
+if ! [[ "$THRESHOLD" =~ ^(0(\.[0-9]+)?|1(\.0+)?)$ ]]; then
+    error_exit 1 "--threshold must be between 0 and 1" "threshold" "$THRESHOLD"
+    exit 1
+fi
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+for db in "${TARGETS[@]}"; do
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+done
+
+#############################################
+# Clustering
+#############################################
+# Distinct values of the wanted columns with their track counts, as
+# "count<TAB>value", summed over every target shard.
+distinct_values() {
+    local db
+    for db in "${TARGETS[@]}"; do
+        awk -F'^' -v want="$COLUMNS_WANTED" '
+            NR == 1 {
+                n = split(want, w, " ")
+                for (i = 1; i <= NF; i++)
+                    for (j = 1; j <= n; j++)
+                        if ($i == w[j]) cols[++nc] = i
+                next
+            }
+            {
+                # A track counts once per distinct value (Artist and
+                # AlbumArtist are usually the same string)
+                delete seen
+                for (c = 1; c <= nc; c++) {
+                    v = $(cols[c])
+                    if (v != "" && !(v in seen)) { seen[v] = 1; count[v]++ }
+                }
+            }
+            END { for (v in count) printf "%d\t%s\n", count[v], v }
+        ' "$db"
+    done | awk -F'\t' '{ count[$2] += $1 } END { for (v in count) printf "%d\t%s\n", count[v], v }'
+}
+
+# Reads "count<TAB>value" lines, prints the mapping for every cluster with
+# more than one spelling.
+cluster_values() {
+    awk -F'\t' -v thr="$THRESHOLD" -v maxdf=200 '
+        function norm(s) {
+            s = tolower(s)
+            gsub(/&/, " and ", s)
+            gsub(/[[:punct:][:space:]]+/, " ", s)
+            gsub(/^ +| +$/, "", s)
+            sub(/ the$/, "", s)
+            sub(/^the /, "", s)
+            return s == "" ? tolower($2) : s
+        }
+        function find(x) {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]]
+                x = parent[x]
+            }
+            return x
+        }
+        {
+            value[++nv] = $2
+            tracks[nv] = $1
+            k = norm($2)
+            if (!(k in keyid)) {
+                keyid[k] = ++nk
+                key[nk] = k
+                parent[nk] = nk
+            }
+            vkey[nv] = keyid[k]
+        }
+        END {
+            # Trigram sets and postings.  Keys are padded so that short names
+            # and word starts get trigrams of their own.
+            for (i = 1; i <= nk; i++) {
+                s = "  " key[i] " "
+                delete seen
+                grams[i] = ""
+                size[i] = 0
+                for (p = 1; p <= length(s) - 2; p++) {
+                    t = substr(s, p, 3)
+                    if (t in seen) continue
+                    seen[t] = 1
+                    grams[i] = grams[i] " " t
+                    size[i]++
+                    df[t]++
+                    post[t] = post[t] " " i
+                }
+            }
+
+            # Candidates share at least one trigram that is not in more than
+            # maxdf keys; those are scored exactly.
+            for (i = 1; i <= nk; i++) {
+                ng = split(substr(grams[i], 2), gi, " ")
+                delete mine
+                delete cand
+                for (g = 1; g <= ng; g++) mine[gi[g]] = 1
+                for (g = 1; g <= ng; g++) {
+                    if (df[gi[g]] > maxdf) continue
+                    np = split(post[gi[g]], pl, " ")
+                    for (q = 1; q <= np; q++)
+                        if (pl[q] + 0 > i) cand[pl[q] + 0] = 1
+                }
+                for (j in cand) {
+                    if (find(i) == find(j + 0)) continue
+                    nj = split(substr(grams[j], 2), gj, " ")
+                    shared = 0
+                    for (g = 1; g <= nj; g++) if (gj[g] in mine) shared++
+                    if (shared / (size[i] + nj - shared) >= thr)
+                        parent[find(j + 0)] = find(i)
+                }
+            }
+
+            # Group spellings by cluster root; canonical is the spelling with
+            # the most tracks (then the alphabetically first).
+            for (v = 1; v <= nv; v++) {
+                r = find(vkey[v])
+                members[r] = members[r] " " v
+                nmem[r]++
+                b = best[r]
+                if (b == "" || tracks[v] > tracks[b] || (tracks[v] == tracks[b] && value[v] < value[b]))
+                    best[r] = v
+            }
+            for (r in members) {
+                if (nmem[r] < 2) continue
+                n = split(substr(members[r], 2), m, " ")
+                for (q = 1; q <= n; q++)
+                    printf "%s\t%s\t%d\n", value[best[r]], value[m[q]], tracks[m[q]]
+            }
+        }
+    ' | sort -t $'\t' -k1,1 -k3,3nr -k2,2 |
+        awk -F'\t' -v OFS='\t' '$1 != last { cluster++; last = $1 } { print cluster, $0 }'
+}
+
+propose() {
+    local mapping
+    mapping=$(distinct_values | cluster_values) || {
+        error_exit 2 "Clustering failed" "subcommand" "$SUBCOMMAND"
+        return 2
+    }
+    {
+        echo "# musiclib clusters: $SUBCOMMAND (threshold $THRESHOLD)"
+        echo "# Review, delete unwanted lines, then: musiclib-cli clusters apply FILE"
+        printf '# cluster\tcanonical\tvariant\ttracks\n'
+        if [ -n "$mapping" ]; then printf '%s\n' "$mapping"; fi
+    } > "${OUTPUT_FILE:-/dev/stdout}" || {
+        error_exit 2 "Cannot write mapping" "path" "$OUTPUT_FILE"
+        return 2
+    }
+    if [ -n "$OUTPUT_FILE" ]; then
+        echo "Wrote $(printf '%s' "$mapping" | cut -f1 | sort -u | grep -c .) clusters to $OUTPUT_FILE"
+    fi
+}
+
+#############################################
+# Apply
+#############################################
+# Rewrites $1 with Custom2 set from the mapping; prints the number of rows
+# that changed and lists them as "canonical<TAB>path" in $out.tags.  Rows
+# whose Custom2 is already set are left alone.
+apply_mapping_to() {
+    local db="$1" out="$2"
+    awk -F'^' -v OFS='^' -v mapping="$MAPPING" -v tags="$out.tags" '
+        BEGIN {
+            while ((getline line < mapping) > 0) {
+                if (line ~ /^#/ || line == "") continue
+                split(line, f, "\t")
+                if (f[2] != "" && f[3] != "" && f[2] != f[3]) canon[f[3]] = f[2]
+            }
+            close(mapping)
+        }
+        NR == 1 {
+            for (i = 1; i <= NF; i++) {
+                if ($i == "Artist") ac = i
+                else if ($i == "AlbumArtist") aac = i
+                else if ($i == "Custom2") cc = i
+                else if ($i == "SongPath") pc = i
+            }
+            if (!cc || !ac || !pc) { print "missing columns" > "/dev/stderr"; exit 2 }
+            print
+            next
+        }
+        {
+            base = (aac && $aac != "") ? $aac : $ac
+            if ($cc == "" && (base in canon)) {
+                $cc = canon[base]
+                printf "%s\t%s\n", $cc, $pc > tags
+                updated++
+            }
+            print
+        }
+        END { print updated + 0 > "/dev/stderr" }
+    ' "$db" 2> "$out.count" > "$out" || { rm -f "$out.count" "$out.tags"; return 2; }
+    cat "$out.count"
+    rm -f "$out.count"
+}
+
+# Appends the rows it changed to $TAG_LIST once the database is replaced.
+apply_locked() {
+    local tmp="${MUSICDB}.tmp" updated
+    updated=$(apply_mapping_to "$MUSICDB" "$tmp") || { rm -f "$tmp"; return 2; }
+    if [ "$DRY_RUN" = true ] || [ "$updated" -eq 0 ]; then
+        rm -f "$tmp" "$tmp.tags"
+        echo "$updated"
+        return 0
+    fi
+    backup_database "$MUSICDB" > /dev/null || { rm -f "$tmp" "$tmp.tags"; return 2; }
+    if ! mv "$tmp" "$MUSICDB" 2>/dev/null; then
+        rm -f "$tmp" "$tmp.tags"
+        return 2
+    fi
+    publish_change "$MUSICDB" reload "" ""
+    cat "$tmp.tags" >> "$TAG_LIST"
+    rm -f "$tmp.tags"
+    echo "$updated"
+}
+
+# Writes Songs-DB_Custom2 = $1 to the files that follow in one kid3-cli
+# run; only if that run fails is each file retried on its own.  Prints the
+# number of files whose tag could not be written.
+tag_custom2_batch() {
+    local cmd f failed=0
+    cmd="set Songs-DB_Custom2 \"$(printf '%s' "$1" | sed 's/["\\]/\\&/g')\""
+    shift
+    if ! kid3-cli -c "$cmd" "$@" 2>/dev/null; then
+        for f in "$@"; do
+            kid3-cli -c "$cmd" "$f" 2>/dev/null || failed=$((failed + 1))
+        done
+    fi
+    echo "$failed"
+}
+
+# Tags every file listed in $1 ("canonical<TAB>path"), one kid3-cli run per
+# canonical name (split every TAG_BATCH_MAX files).  Prints the number of
+# files left untagged.
+TAG_BATCH_MAX=200
+
+write_custom2_tags() {
+    local list="$1" canon path prev="" failed=0
+    local -a files=()
+
+    while IFS=$'\t' read -r canon path; do
+        if [ ! -f "$path" ]; then
+            failed=$((failed + 1))
+            continue
+        fi
+        if [ ${#files[@]} -gt 0 ] &&
+           { [ "$canon" != "$prev" ] || [ ${#files[@]} -ge "$TAG_BATCH_MAX" ]; }; then
+            failed=$((failed + $(tag_custom2_batch "$prev" "${files[@]}")))
+            files=()
+        fi
+        prev="$canon"
+        files+=("$path")
+    done < <(LC_ALL=C sort -s -t$'\t' -k1,1 "$list")
+    if [ ${#files[@]} -gt 0 ]; then
+        failed=$((failed + $(tag_custom2_batch "$prev" "${files[@]}")))
+    fi
+    echo "$failed"
+}
+
+apply() {
+    local db updated total=0 rc=0 failed
+    TAG_LIST=$(mktemp) || return 2
+    for db in "${TARGETS[@]}"; do
+        MUSICDB="$db"
+        updated=$(with_db_lock "$LOCK_TIMEOUT" apply_locked)
+        rc=$?
+        if [ "$rc" -eq 1 ]; then
+            error_exit 2 "Database lock timeout" "database" "$db" "timeout" "${LOCK_TIMEOUT}s"
+            break
+        elif [ "$rc" -ne 0 ]; then
+            error_exit 2 "Failed to apply mapping" "database" "$db" "mapping" "$MAPPING"
+            break
+        fi
+        total=$((total + updated))
+    done
+
+    if [ "$DRY_RUN" = true ]; then
+        rm -f "$TAG_LIST"
+        [ "$rc" -eq 0 ] || return 2
+        echo "Would set Custom2 on $total tracks"
+        return 0
+    fi
+
+    # Tags are written outside the lock, as musiclib_edit_field.sh does, and
+    # also for the databases already rewritten when a later one failed
+    failed=$(write_custom2_tags "$TAG_LIST")
+    rm -f "$TAG_LIST"
+    [ "$rc" -eq 0 ] || return 2
+    echo "Set Custom2 on $total tracks"
+    if [ "$failed" -gt 0 ]; then
+        echo "Warning: Songs-DB_Custom2 tag not written to $failed files — database updated" >&2
+    fi
+    log_message "Applied artist clusters from $MAPPING: Custom2 set on $total tracks ($failed tag writes failed)" > /dev/null
+}
+
+#############################################
+# Main
+#############################################
+if [ "$SUBCOMMAND" = "apply" ]; then
+    apply || exit 2
+else
+    propose || exit 2
+fi
+exit 0
@@ -101,6 +101,164 @@ validate_database() {
     return 0
 }
 
+#############################################
+# LIBRARY SHARDS
+#############################################
+# A library may be split into several shards, each with its own music root,
+# its own DSV and therefore its own lock file (${dsv}.lock).  Shards are
+# declared in musiclib.conf:
+#
+#   LIBRARY_SHARDS="main:/mnt/music:/path/main.dsv;lossless:/mnt/archive:/path/lossless.dsv"
+#
+# When LIBRARY_SHARDS is empty the library is a single implicit shard named
+# "main" made of MUSIC_ROOT_DIR and MUSICDB, so every helper below is safe to
+# call unconditionally.
+
+# Print one "name<TAB>root<TAB>dsv" line per configured shard.
+# Usage: list_library_shards
+list_library_shards() {
+    if [ -z "${LIBRARY_SHARDS:-}" ]; then
+        printf 'main\t%s\t%s\n' "${MUSIC_ROOT_DIR:-/mnt/music}" "$MUSICDB"
+        return 0
+    fi
+
+    local entries entry name root dsv
+    IFS=';' read -r -a entries <<< "$LIBRARY_SHARDS"
+    for entry in "${entries[@]}"; do
+        # Trim surrounding whitespace so the list may be written one per line
+        entry="${entry#"${entry%%[![:space:]]*}"}"
+        entry="${entry%"${entry##*[![:space:]]}"}"
+        [ -z "$entry" ] && continue
+        IFS=':' read -r name root dsv <<< "$entry"
+        if [ -z "$name" ] || [ -z "$root" ] || [ -z "$dsv" ]; then
+            echo "Warning: Ignoring malformed LIBRARY_SHARDS entry: $entry" >&2
+            continue
+        fi
+        printf '%s\t%s\t%s\n' "$name" "${root%/}" "$dsv"
+    done
+}
+
+# Resolve the DSV that owns a file path (longest matching shard root).
+# Falls back to MUSICDB when no shard root contains the path.
+# Usage: shard_db_for_path <filepath>
+# Example: MUSICDB=$(shard_db_for_path "$FILEPATH")
+shard_db_for_path() {
+    printf '%s\n' "$1" | shard_db_for_paths
+}
+
+# Batch form of shard_db_for_path: read one path per line on stdin and
+# print the owning DSV of each, in order.  The shard list is read once,
+# so this is the one to use for lists of files.
+# Usage: shard_db_for_paths < paths
+shard_db_for_paths() {
+    local -a roots=() dsvs=()
+    local name root dsv path i best_dsv best_len
+
+    while IFS=$'\t' read -r name root dsv; do
+        roots+=("$root")
+        dsvs+=("$dsv")
+    done < <(list_library_shards)
+
+    while IFS= read -r path || [ -n "$path" ]; do
+        best_dsv="$MUSICDB"
+        best_len=0
+        for i in "${!roots[@]}"; do
+            case "$path" in
+                "${roots[$i]}"/*)
+                    if [ "${#roots[$i]}" -gt "$best_len" ]; then
+                        best_len=${#roots[$i]}
+                        best_dsv="${dsvs[$i]}"
+                    fi
+                    ;;
+            esac
+        done
+        printf '%s\n' "$best_dsv"
+    done
+}
+
+# Resolve a shard name to "root<TAB>dsv".
+# Usage: get_library_shard <name>
+# Returns 1 if no shard has that name.
+get_library_shard() {
+    local want="$1"
+    local name root dsv
+
+    while IFS=$'\t' read -r name root dsv; do
+        if [ "$name" = "$want" ]; then
+            printf '%s\t%s\n' "$root" "$dsv"
+            return 0
+        fi
+    done < <(list_library_shards)
+    return 1
+}
+
+# Set TARGETS to the databases a command works on: the DSV of shard
+# <shard> if one is named, else <file> if given, else every shard's DSV
+# (just MUSICDB when LIBRARY_SHARDS is unset).  These are the -d FILE and
+# --shard NAME options of the scripts that default to the whole library.
+# Usage: resolve_target_dbs <file> <shard>
+# Returns 1 after reporting an unknown shard with error_exit.
+resolve_target_dbs() {
+    local file="$1" shard="$2" entry _name _root dsv
+    TARGETS=()
+    if [ -n "$shard" ]; then
+        if ! entry=$(get_library_shard "$shard"); then
+            error_exit 1 "Unknown library shard" "shard" "$shard"
+            return 1
+        fi
+        file="${entry#*$'\t'}"
+    fi
+    if [ -n "$file" ]; then
+        TARGETS=("$file")
+        return 0
+    fi
+    while IFS=$'\t' read -r _name _root dsv; do
+        TARGETS+=("$dsv")
+    done < <(list_library_shards)
+}
+
+# Write every shard into one read-only DSV snapshot for readers that
+# need the whole library (smart playlists, queries).  The header comes
+# from the first shard; each shard body is read by its own background
+# job so shards on separate disks are read concurrently.
+# No lock is taken: writers replace shards by tmp+mv, so each read sees
+# a complete file.
+# Usage: merge_library_shards <output_file>
+# Returns 1 if no shard DSV could be read.
+merge_library_shards() {
+    local out="$1"
+    local name root dsv header="" i=0 pids=() parts=()
+
+    while IFS=$'\t' read -r name root dsv; do
+        [ -f "$dsv" ] || continue
+        [ -z "$header" ] && header=$(head -n 1 "$dsv")
+        parts+=("${out}.part${i}")
+        tail -n +2 "$dsv" > "${out}.part${i}" &
+        pids+=("$!")
+        i=$((i + 1))
+    done < <(list_library_shards)
+
+    if [ -z "$header" ]; then
+        return 1
+    fi
+
+    local rc=0 pid
+    for pid in "${pids[@]}"; do
+        wait "$pid" || rc=1
+    done
+    if [ "$rc" -eq 0 ]; then
+        { printf '%s\n' "$header"; cat "${parts[@]}"; } > "$out" || rc=1
+    fi
+    rm -f "${parts[@]}"
+    return "$rc"
+}
+
+# Count configured shards (1 when LIBRARY_SHARDS is unset).
+# Usage: library_shard_count
+library_shard_count() {
+    list_library_shards | wc -l
+}
+
 #############################################
 # DATABASE UPDATE OPERATIONS
 #############################################
@@ -142,6 +300,8 @@ update_lastplayed() {
     fi
 
     mv "$db_file.tmp" "$db_file"
+    publish_change "$db_file" update "${row_data%%^*}" "$filepath" \
+        LastTimePlayed "$old_value" "$sql_time"
 
 # Update tag using kid3-cli with repair on failure
     if ! $KID3_CMD -c "set Songs-DB_Custom1 $sql_time" "$filepath" 2>/dev/null; then
@@ -233,6 +393,10 @@ delete_record_by_path() {
         fi
 
         mv "${db_file}.tmp" "$db_file"
+        local deleted_id
+        while read -r deleted_id; do
+            publish_change "$db_file" delete "$deleted_id" "$filepath"
+        done < <(printf '%s\n' "$matches" | cut -d: -f2- | cut -d'^' -f1)
         log_message "Deleted $match_count DB records for $filepath (rows: $row_numbers)"
         return 0
     fi
@@ -249,6 +413,7 @@ delete_record_by_path() {
     fi
 
     mv "${db_file}.tmp" "$db_file"
+    publish_change "$db_file" delete "$(printf '%s\n' "$matches" | cut -d: -f2- | cut -d'^' -f1)" "$filepath"
     log_message "Deleted DB record for $filepath (row $target_row)"
     return 0
 }
@@ -304,32 +469,834 @@ delete_record_by_id_and_path() {
     fi
 
     mv "${db_file}.tmp" "$db_file"
+    publish_change "$db_file" delete "$record_id" "$filepath"
     log_message "Deleted DB record ID=$record_id for $(basename "$filepath")"
     return 0
 }
 
+# Remove many records in one pass over the database.
+# Usage: delete_records_batch "$MUSICDB" <list_file>
+# Behavior:
+#   - Each line of list_file is "ID<TAB>SongPath" and names one row; as in
+#     delete_record_by_id_and_path, both fields must match.
+#   - The DSV is rewritten once (tmp + mv) without every matched row, and is
+#     left untouched when nothing matched.
+#   - Prints "removed<TAB>ID<TAB>PATH" or "not-found<TAB>ID<TAB>PATH" for
+#     every list line, in list order.
+#   - Publishes one delete event per removed row; batches larger than
+#     BATCH_DELETE_MAX_EVENTS publish a single reload instead.
+#   - Returns 0 (even if some rows were not found), 1 on I/O error.
+#   - Caller is responsible for acquiring the database lock (with_db_lock).
+BATCH_DELETE_MAX_EVENTS=100
+
+delete_records_batch() {
+    local db_file="$1"
+    local list="$2"
+
+    if [ ! -f "$db_file" ]; then
+        echo "Error: Database not found: $db_file" >&2
+        return 1
+    fi
+
+    local pathcol
+    pathcol=$(get_column_index "$db_file" "SongPath") || return 1
+
+    local results
+    results=$(awk -F'^' -v list="$list" -v pcol="$pathcol" -v out="${db_file}.tmp" '
+        BEGIN {
+            while ((getline line < list) > 0) {
+                t = index(line, "\t")
+                if (t == 0) continue
+                key = substr(line, 1, t - 1) SUBSEP substr(line, t + 1)
+                order[++n] = key
+                want[key] = 1
+            }
+        }
+        NR > 1 && (($1 SUBSEP $pcol) in want) { found[$1 SUBSEP $pcol] = 1; removed++; next }
+        { print > out }
+        END {
+            for (i = 1; i <= n; i++) {
+                split(order[i], k, SUBSEP)
+                print ((order[i] in found) ? "removed" : "not-found") "\t" k[1] "\t" k[2]
+            }
+            exit (removed > 0 ? 0 : 3)
+        }
+    ' "$db_file")
+    local rc=$?
+
+    if [ "$rc" -eq 3 ]; then
+        rm -f "${db_file}.tmp"
+        printf '%s\n' "$results"
+        return 0
+    fi
+    if [ "$rc" -ne 0 ]; then
+        echo "Error: Failed to write temporary database while deleting records" >&2
+        rm -f "${db_file}.tmp"
+        return 1
+    fi
+
+    mv "${db_file}.tmp" "$db_file" || { rm -f "${db_file}.tmp"; return 1; }
+
+    local count status id path
+    count=$(printf '%s\n' "$results" | grep -c '^removed')
+    if [ "$count" -gt "$BATCH_DELETE_MAX_EVENTS" ]; then
+        publish_change "$db_file" reload "" ""
+    else
+        while IFS=$'\t' read -r status id path; do
+            [ "$status" = removed ] && publish_change "$db_file" delete "$id" "$path"
+        done <<< "$results"
+    fi
+    # stdout carries the result lines, so the log echo goes to stderr
+    log_message "Deleted $count DB records in one batch from $db_file" >&2
+    printf '%s\n' "$results"
+    return 0
+}
+
+#############################################
+# CHANGE FEED
+#############################################
+#
+# Every write to a DSV appends one event to "<dsv>.changes" (NDJSON) and
+# broadcasts it as a D-Bus signal, so consumers can apply the delta instead
+# of reparsing the whole file:
+#
+#   {"seq":42,"time":"2026-10-18T14:03:11","op":"update","id":"1234",
+#    "path":"/mnt/music/a/b.mp3","changes":{"GroupDesc":["3","4"],"Rating":["128","196"]}}
+#
+#   op      update | insert | delete | reload
+#   seq     per-DSV sequence number, +1 per event
+#   changes column -> [old, new]; an insert lists every column with old ""
+#
+# "reload" is published by bulk writers (build, merge, restore, new-tracks)
+# and means "reparse the file".  A consumer that sees a sequence number
+# other than last+1 reads the missed events back from the journal; if they
+# have already been trimmed it reloads.  The journal keeps the newest
+# CHANGE_FEED_MAX_EVENTS events.
+#
+# D-Bus: signal org.musiclib.ChangeFeed.Changed(s dsv, t seq, s event) on
+# object /org/musiclib/ChangeFeed, session bus.  Publishing never fails the
+# write: a missing bus or dbus-send only costs subscribers the live signal,
+# and a journal lock that cannot be taken leaves "<dsv>.changes.gap", which
+# the next publisher turns into a "reload" ahead of its own event.
+
+# Escape a string for a JSON string literal (without the quotes).
+_json_str() {
+    local s="$1"
+    s="${s//\\/\\\\}"
+    s="${s//\"/\\\"}"
+    s="${s//$'\t'/\\t}"
+    s="${s//$'\r'/\\r}"
+    s="${s//$'\n'/\\n}"
+    printf '%s' "$s"
+}
+
+# Publish a change event for a DSV.  Call after the tmp+mv, while still
+# holding the database lock, so events are ordered like the writes.
+# Usage: publish_change <db_file> <op> <id> <path> [<column> <old> <new>]...
+publish_change() {
+    local db_file="$1" op="$2" id="$3" path="$4"
+    shift 4
+
+    local changes="" sep=""
+    while [ $# -ge 3 ]; do
+        changes+="${sep}\"$(_json_str "$1")\":[\"$(_json_str "$2")\",\"$(_json_str "$3")\"]"
+        sep=","
+        shift 3
+    done
+
+    local journal="${db_file}.changes"
+    local event
+    event=$(
+        exec {feed_fd}>"${journal}.lock" 2>/dev/null || exit 1
+        flock -x -w 5 "$feed_fd" || exit 1
+
+        last=$(tail -n 1 "$journal" 2>/dev/null | sed -n 's/^{"seq":\([0-9]*\),.*/\1/p')
+        seq=$(( ${last:-0} + 1 ))
+
+        # An earlier write could not get the journal lock and published
+        # nothing: tell consumers to reparse before this event
+        if [ -e "${journal}.gap" ]; then
+            printf '{"seq":%d,"time":"%s","op":"reload","id":"","path":"","changes":{}}\n' \
+                "$seq" "$(date '+%Y-%m-%dT%H:%M:%S')" >> "$journal" || exit 1
+            rm -f "${journal}.gap"
+            seq=$((seq + 1))
+        fi
+
+        line=$(printf '{"seq":%d,"time":"%s","op":"%s","id":"%s","path":"%s","changes":{%s}}' \
+            "$seq" "$(date '+%Y-%m-%dT%H:%M:%S')" "$op" "$(_json_str "$id")" \
+            "$(_json_str "$path")" "$changes")
+        printf '%s\n' "$line" >> "$journal" || exit 1
+
+        # Keep the journal bounded; trimmed history turns into a reload for
+        # consumers that fall that far behind.
+        max="${CHANGE_FEED_MAX_EVENTS:-10000}"
+        if [ "$seq" -gt "$max" ] && [ $((seq % 100)) -eq 0 ] &&
+           [ "$(wc -l < "$journal")" -gt "$max" ]; then
+            tail -n $((max / 2)) "$journal" > "${journal}.tmp" && mv "${journal}.tmp" "$journal"
+        fi
+
+        printf '%s\t%s' "$seq" "$line"
+    ) || {
+        # The write itself has happened.  Leave a marker so the next
+        # publisher emits a reload; until then the journal is older than
+        # the DSV, which readers already treat as unpublished.
+        : > "${journal}.gap" 2>/dev/null
+        echo "Warning: change feed for $db_file is busy; queued a reload" >&2
+        return 0
+    }
+
+    if command -v dbus-send >/dev/null 2>&1; then
+        dbus-send --session --type=signal /org/musiclib/ChangeFeed \
+            org.musiclib.ChangeFeed.Changed \
+            string:"$db_file" uint64:"${event%%$'\t'*}" string:"${event#*$'\t'}" \
+            >/dev/null 2>&1 &
+    fi
+    return 0
+}
+
+# Publish an insert event for a new DSV row.
+# Usage: publish_row_insert <db_file> <dsv_line>
+publish_row_insert() {
+    local db_file="$1" line="$2"
+    local -a cols vals args=()
+    IFS='^' read -r -a cols <<< "$(head -n 1 "$db_file")"
+    IFS='^' read -r -a vals <<< "$line"
+
+    local i pathcol=-1
+    for i in "${!cols[@]}"; do
+        [ -z "${cols[$i]}" ] && continue
+        [ "${cols[$i]}" = "SongPath" ] && pathcol=$i
+        args+=("${cols[$i]}" "" "${vals[$i]:-}")
+    done
+    local path=""
+    [ "$pathcol" -ge 0 ] && path="${vals[$pathcol]:-}"
+
+    publish_change "$db_file" insert "${vals[0]:-}" "$path" "${args[@]}"
+}
+
+#############################################
+# PLAYED INDEX
+#############################################
+#
+# "<dsv>.lpidx" lists every row ordered by (GroupDesc, LastTimePlayed) as
+# fixed-width records, so recency queries need no sort of the whole DSV:
+#
+#   G^SSSSSSS.ssssss^OOOOOOOOOOOO\n     (30 bytes)
+#
+#   G  star rating 0-5   S  LastTimePlayed serial (0 = never played)
+#   O  byte offset of the row in the DSV
+#
+# The index is rebuilt (one sort) on first use after the DSV changes; every
+# query after that is one awk pass over the index plus one pass over the
+# DSV prefix holding the returned rows.
+
+# Print the index path for a DSV, rebuilding the index if it is stale.
+# Usage: lp_index_ensure <db_file>
+lp_index_ensure() {
+    local db_file="$1"
+    local idx="${db_file}.lpidx"
+
+    if [ ! -f "$idx" ] || [ "$db_file" -nt "$idx" ]; then
+        # Byte offsets: awk must count bytes, not characters
+        LC_ALL=C awk -F'^' '
+            NR == 1 {
+                for (i = 1; i <= NF; i++) {
+                    if ($i == "GroupDesc") gcol = i
+                    if ($i == "LastTimePlayed") tcol = i
+                }
+                off = length($0) + 1
+                next
+            }
+            {
+                g = $gcol + 0; if (g < 0 || g > 5) g = 0
+                t = $tcol + 0; if (t < 0) t = 0
+                printf "%d^%014.6f^%012d\n", g, t, off
+                off += length($0) + 1
+            }
+        ' "$db_file" | LC_ALL=C sort > "${idx}.tmp.$$" &&
+            mv "${idx}.tmp.$$" "$idx" || { rm -f "${idx}.tmp.$$"; return 1; }
+    fi
+    printf '%s\n' "$idx"
+}
+
+# Format a serial (or "max") as the 14-character index key field.
+_lp_serial_key() {
+    if [ "$1" = "max" ]; then
+        printf '9999999.999999'
+    else
+        LC_ALL=C awk -v s="$1" 'BEGIN { printf "%014.6f", s }'
+    fi
+}
+
+# Print index records ("G^SERIAL^OFFSET") played in [from, to), for one
+# rating or all (stars = -1).  mode "oldest" returns the first <limit> in
+# ascending order, "newest" the last <limit> in descending order; limit 0
+# means no limit.  Never-played rows are only included when from is 0.
+# Usage: lp_index_range <idx> <stars> <from_serial> <to_serial|max> <oldest|newest> <limit>
+lp_index_range() {
+    local idx="$1" stars="$2" from="$3" to="$4" mode="$5" limit="$6"
+    local from_key to_key
+    from_key=$(_lp_serial_key "$from")
+    to_key=$(_lp_serial_key "$to")
+
+    # One pass over the sorted records.  Per rating group, "oldest" keeps
+    # the first <limit> matches and "newest" the last <limit> (ring buffer);
+    # the scan stops once it is past the highest group wanted.
+    LC_ALL=C awk -v stars="$stars" -v from="$from_key" -v to="$to_key" \
+                 -v open_end="$([ "$to" = "max" ] && echo 1 || echo 0)" \
+                 -v mode="$mode" -v limit="$limit" '
+        BEGIN { cur = -1 }
+        function flush(    i) {
+            if (mode == "newest" && limit > 0)
+                for (i = (n > limit) ? n - limit : 0; i < n; i++) print ring[i % limit]
+            n = 0
+        }
+        {
+            g = substr($0, 1, 1) + 0
+            if (stars >= 0 && g < stars) next
+            if (stars >= 0 && g > stars) exit
+            if (g != cur) { flush(); cur = g }
+            key = substr($0, 3, 14)
+            if (key < from || (!open_end && key >= to)) next
+            if (limit <= 0) { print; next }
+            if (mode == "newest") ring[n++ % limit] = $0
+            else if (n < limit) { print; n++ }
+        }
+        END { flush() }
+    ' "$idx" | if [ "$mode" = "newest" ]; then
+        LC_ALL=C sort -t'^' -k2,2r -k3,3r
+    else
+        LC_ALL=C sort -t'^' -k2,2 -k3,3
+    fi | if [ "$limit" -gt 0 ]; then head -n "$limit"; else cat; fi
+}
+
+# Print the DSV rows for index records read on stdin, in input order.  Each
+# line is "G^SERIAL^OFFSET^DSV"; every DSV is read once, up to its last
+# wanted offset.
+# Usage: ... | lp_rows_at
+lp_rows_at() {
+    LC_ALL=C awk '
+        {
+            rest = $0
+            for (i = 0; i < 2; i++) rest = substr(rest, index(rest, "^") + 1)
+            off = substr(rest, 1, index(rest, "^") - 1) + 0
+            db = substr(rest, index(rest, "^") + 1)
+            order[NR] = db SUBSEP off
+            want[db SUBSEP off] = 1
+            if (!(db in last)) dbs[++ndb] = db
+            if (!(db in last) || off > last[db]) last[db] = off
+        }
+        END {
+            for (d = 1; d <= ndb; d++) {
+                db = dbs[d]; pos = 0
+                while (pos <= last[db] && (getline line < db) > 0) {
+                    if ((db SUBSEP pos) in want) row[db SUBSEP pos] = line
+                    pos += length(line) + 1
+                }
+                close(db)
+            }
+            for (i = 1; i <= NR; i++)
+                if (order[i] in row) print row[order[i]]
+        }
+    '
+}
+
+#############################################
+# AGGREGATE TABLES
+#############################################
+#
+# "<dsv>.albums" and "<dsv>.artists" hold one row per album (IDAlbum) and
+# per artist (Custom2, or AlbumArtist when Custom2 is empty — the smart
+# playlist's rule), so album and artist views need not scan the DSV:
+#
+#   IDAlbum^Album^Artist^Tracks^SongLength^Stars0^...^Stars5^MeanStars^MinLastPlayed^MaxLastPlayed^PathPrefix
+#   Artist^Albums^Tracks^SongLength^Stars0^...^Stars5^MeanStars^MinLastPlayed^MaxLastPlayed^PathPrefix
+#
+# An album's Artist is its most frequent track artist.  SongLength is the
+# total in ms, StarsN the number of tracks rated N, MeanStars the mean over
+# rated tracks (0 if none), Min/MaxLastPlayed range over played tracks (0 if
+# none), PathPrefix the longest directory prefix shared by the tracks.
+#
+# Like the played index, both tables are rebuilt together (one awk pass) on
+# first use after the DSV changes.  The GUI keeps the same tables in memory
+# and adjusts them per row from the change feed (see LibraryAggregates).
+
+AGG_ALBUMS_HEADER="IDAlbum^Album^Artist^Tracks^SongLength^Stars0^Stars1^Stars2^Stars3^Stars4^Stars5^MeanStars^MinLastPlayed^MaxLastPlayed^PathPrefix"
+AGG_ARTISTS_HEADER="Artist^Albums^Tracks^SongLength^Stars0^Stars1^Stars2^Stars3^Stars4^Stars5^MeanStars^MinLastPlayed^MaxLastPlayed^PathPrefix"
+
+# awk functions shared by the builder and the shard merge: the common
+# directory prefix of two paths, and the MeanStars column from Stars1-5.
+AGG_AWK_FUNCS='
+function agg_prefix(a, b,    n) {
+    n = (length(a) < length(b)) ? length(a) : length(b)
+    while (n > 0 && substr(a, 1, n) != substr(b, 1, n)) n--
+    a = substr(a, 1, n)
+    sub(/[^\/]*$/, "", a)
+    return a
+}
+function agg_mean(s1, s2, s3, s4, s5,    rated) {
+    rated = s1 + s2 + s3 + s4 + s5
+    return rated ? sprintf("%.2f", (s1 + 2 * s2 + 3 * s3 + 4 * s4 + 5 * s5) / rated) : "0"
+}'
+
+# Print the path of an aggregate table for a DSV, rebuilding both tables if
+# they are stale.
+# Usage: agg_table_ensure <db_file> <albums|artists>
+agg_table_ensure() {
+    local db_file="$1" kind="$2"
+    local albums="${db_file}.albums" artists="${db_file}.artists"
+
+    case "$kind" in
+        albums|artists) ;;
+        *) return 1 ;;
+    esac
+
+    if [ ! -f "$albums" ] || [ ! -f "$artists" ] \
+            || [ "$db_file" -nt "$albums" ] || [ "$db_file" -nt "$artists" ]; then
+        LC_ALL=C awk -F'^' -v albums="${albums}.tmp.$$" -v artists="${artists}.tmp.$$" \
+                -v album_header="$AGG_ALBUMS_HEADER" -v artist_header="$AGG_ARTISTS_HEADER" \
+                "$AGG_AWK_FUNCS"'
+            NR == 1 {
+                for (i = 1; i <= NF; i++) col[$i] = i
+                next
+            }
+            {
+                id = $col["IDAlbum"]
+                a = (col["Custom2"] && $col["Custom2"] != "") ? $col["Custom2"] : $col["AlbumArtist"]
+                g = $col["GroupDesc"] + 0; if (g < 0 || g > 5) g = 0
+                t = $col["LastTimePlayed"] + 0
+                len = $col["SongLength"] + 0
+                dir = $col["SongPath"]; sub(/[^\/]*$/, "", dir)
+
+                if (!(id in tracks)) { order[++nalb] = id; title[id] = $col["Album"] }
+                tracks[id]++; length_ms[id] += len; stars[id, g]++
+                by[id, a]++
+                if (by[id, a] > best[id] || (by[id, a] == best[id] && a < artist_of[id])) {
+                    best[id] = by[id, a]; artist_of[id] = a
+                }
+                if (t > 0) {
+                    if (!(id in tmin) || t < tmin[id]) tmin[id] = t
+                    if (t > tmax[id]) tmax[id] = t
+                }
+                if (tracks[id] == 1) prefix[id] = dir
+                else prefix[id] = agg_prefix(prefix[id], dir)
+
+                if (!(a in atracks)) aorder[++nart] = a
+                atracks[a]++; alength[a] += len; astars[a, g]++
+                if (!((a, id) in on_album)) { on_album[a, id] = 1; aalbums[a]++ }
+                if (t > 0) {
+                    if (!(a in atmin) || t < atmin[a]) atmin[a] = t
+                    if (t > atmax[a]) atmax[a] = t
+                }
+                if (atracks[a] == 1) aprefix[a] = dir
+                else aprefix[a] = agg_prefix(aprefix[a], dir)
+            }
+            END {
+                print album_header > albums
+                for (i = 1; i <= nalb; i++) {
+                    id = order[i]
+                    line = id "^" title[id] "^" artist_of[id] "^" tracks[id] "^" length_ms[id]
+                    for (g = 0; g <= 5; g++) line = line "^" (stars[id, g] + 0)
+                    line = line "^" agg_mean(stars[id, 1], stars[id, 2], stars[id, 3], stars[id, 4], stars[id, 5])
+                    print line "^" (tmin[id] + 0) "^" (tmax[id] + 0) "^" prefix[id] > albums
+                }
+                print artist_header > artists
+                for (i = 1; i <= nart; i++) {
+                    a = aorder[i]
+                    line = a "^" aalbums[a] "^" atracks[a] "^" alength[a]
+                    for (g = 0; g <= 5; g++) line = line "^" (astars[a, g] + 0)
+                    line = line "^" agg_mean(astars[a, 1], astars[a, 2], astars[a, 3], astars[a, 4], astars[a, 5])
+                    print line "^" (atmin[a] + 0) "^" (atmax[a] + 0) "^" aprefix[a] > artists
+                }
+            }
+        ' "$db_file" &&
+            mv "${albums}.tmp.$$" "$albums" && mv "${artists}.tmp.$$" "$artists" ||
+            { rm -f "${albums}.tmp.$$" "${artists}.tmp.$$"; return 1; }
+    fi
+
+    if [ "$kind" = "albums" ]; then
+        printf '%s\n' "$albums"
+    else
+        printf '%s\n' "$artists"
+    fi
+}
+
+# Merge artist tables of several shards into one (header included): counts
+# are summed, the play range widened and the path prefix shortened.
+# Albums never span shards, so the Albums column is summed too.
+# Usage: agg_artists_merge <table>...
+agg_artists_merge() {
+    LC_ALL=C awk -F'^' -v header="$AGG_ARTISTS_HEADER" "$AGG_AWK_FUNCS"'
+        FNR == 1 { next }
+        {
+            a = $1
+            if (!(a in seen)) { seen[a] = 1; order[++n] = a; prefix[a] = $14 }
+            else prefix[a] = agg_prefix(prefix[a], $14)
+            for (i = 2; i <= 10; i++) sum[a, i] += $i
+            if ($12 > 0 && (!(a in tmin) || $12 < tmin[a])) tmin[a] = $12
+            if ($13 > tmax[a]) tmax[a] = $13
+        }
+        END {
+            print header
+            for (k = 1; k <= n; k++) {
+                a = order[k]
+                line = a
+                for (i = 2; i <= 10; i++) line = line "^" (sum[a, i] + 0)
+                line = line "^" agg_mean(sum[a, 6], sum[a, 7], sum[a, 8], sum[a, 9], sum[a, 10])
+                print line "^" (tmin[a] + 0) "^" (tmax[a] + 0) "^" prefix[a]
+            }
+        }
+    ' "$@"
+}
+
+#############################################
+# SIDECAR UPDATES
+#############################################
+#
+# Per-file sidecars (text index, fingerprints, file identities) are kept
+# next to a DSV and brought up to date incrementally: only files whose
+# stat identity changed are read again, by parallel workers.
+
+# Print "PATH<TAB>stat fields" for every DSV row whose file exists, sorted
+# by path.  <format> is a stat -c format starting with %n<TAB>.
+# Usage: sidecar_stat_current <db_file> <format>
+sidecar_stat_current() {
+    local db_file="$1" format="$2" pathcol
+    pathcol=$(get_column_index "$db_file" "SongPath") || return 2
+    tail -n +2 "$db_file" | cut -d'^' -f"$pathcol" | LC_ALL=C sort -u | tr '\n' '\0' |
+        xargs -0 -r stat -c "$format" 2>/dev/null | LC_ALL=C sort -t $'\t' -k1,1
+    return 0    # stat fails for the missing files, which are meant to drop out
+}
+
+# Split the files of <current> (from sidecar_stat_current) against a
+# sidecar whose lines start with the same fields: sidecar lines whose file
+# is unchanged go to <kept>, the paths to compute again to <todo>.  A
+# missing sidecar keeps nothing.
+# Usage: sidecar_split <sidecar> <current> <kept> <todo>
+sidecar_split() {
+    local sidecar="$1" current="$2" kept="$3" todo="$4"
+    : > "$kept"
+    : > "$todo"
+    if [ ! -f "$sidecar" ]; then
+        cut -f1 "$current" > "$todo"
+        return
+    fi
+    LC_ALL=C awk -F'\t' -v kept="$kept" -v todo="$todo" '
+        FILENAME == ARGV[1] { line[$1] = $0; next }
+        ($1 in line) && (line[$1] == $0 || index(line[$1], $0 "\t") == 1) { print line[$1] > kept; next }
+        { print $1 > todo }
+    ' "$sidecar" "$current"
+}
+
+# Run a bash <script> over the NUL-separated paths on stdin, <batch> paths
+# per invocation and <jobs> invocations at a time, and print what the
+# batches wrote once all have finished.  The script gets [args...] then
+# the batch as "$@"; each batch writes its own part file under <work_dir>,
+# so output lines never interleave.
+# Usage: parallel_parts <work_dir> <jobs> <batch> <script> [args...]
+parallel_parts() {
+    local work_dir="$1" jobs="$2" batch="$3" script="$4" parts
+    shift 4
+    parts=$(mktemp -d "$work_dir/parts.XXXXXX") || return 2
+    xargs -0 -r -n "$batch" -P "$jobs" bash -c 'exec > "$0/part.$$" || exit 0
+'"$script"'
+exit 0' "$parts" "$@"
+    cat "$parts"/part.* 2>/dev/null
+    rm -rf "$parts"
+}
+
+#############################################
+# TEXT INDEX
+#############################################
+#
+# Optional full-text index over lyrics and comment tags, written next to the
+# DSV by musiclib_textindex.sh.  Each update is a new generation directory
+# "<dsv>.txtindex.gN" holding both files:
+#
+#   docs     PATH<TAB>MTIME<TAB> normalised text      sorted by path;
+#                                                     line N = doc N
+#   terms    TERM<TAB>N N N ...                       sorted by term
+#
+# The symlink "<dsv>.txtindex" names the current generation and is replaced
+# by rename, so docs and terms always change together: a reader resolves
+# the link once and reads both files from that directory.  The previous
+# generation is kept for readers still using it.
+#
+# Normalised text is ASCII-lowercased, with curly apostrophes folded and
+# every run of other ASCII characters (punctuation, whitespace) turned into
+# one space, padded with a space at each end so a phrase matches as
+# " words ".  Terms are the words longer than one byte.  The GUI's
+# TextIndex applies the same rules; keep the two in step.
+
+# awk function: tnorm(s) returns the normalised form of s.  Run the awk
+# program under LC_ALL=C so bytes, not characters, are compared.
+TEXT_INDEX_AWK_NORM='
+function tnorm(s) {
+    gsub(/\342\200[\230\231]/, "'"'"'", s)
+    gsub(/[^A-Za-z0-9\200-\377]+/, " ", s)
+    s = tolower(s)
+    sub(/^ */, " ", s)
+    sub(/ *$/, " ", s)
+    return s
+}'
+
+# Print the current generation directory of a DSV's text index.
+# Usage: text_index_dir <db_file>
+# Returns 1 if the DSV has no text index.
+text_index_dir() {
+    local gen
+    gen=$(readlink "${1}.txtindex" 2>/dev/null) || return 1
+    [ -f "$(dirname "$1")/$gen/docs" ] && [ -f "$(dirname "$1")/$gen/terms" ] || return 1
+    printf '%s/%s\n' "$(dirname "$1")" "$gen"
+}
+
+# Print the paths of tracks whose lyrics or comments contain the phrase.
+# Posting lists narrow the candidates (binary search with look(1) when it
+# is installed); the phrase itself is then checked in those documents only.
+# Usage: text_index_search <db_file> <phrase>
+# Returns: 0 on success, 1 if the phrase has no indexable word, 2 if the
+#          database has no text index
+text_index_search() {
+    local db_file="$1" phrase="$2"
+    local dir docs terms q term
+
+    dir=$(text_index_dir "$db_file") || return 2
+    docs="$dir/docs" terms="$dir/terms"
+
+    # Line 1: the normalised phrase; then its distinct indexable words
+    local -a words=()
+    {
+        IFS= read -r q
+        while IFS= read -r term; do words+=("$term"); done
+    } < <(printf '%s\n' "$phrase" | LC_ALL=C awk "$TEXT_INDEX_AWK_NORM"'
+        {
+            q = tnorm($0)
+            print q
+            n = split(q, w, " ")
+            for (i = 1; i <= n; i++)
+                if (length(w[i]) > 1 && !(w[i] in seen)) { seen[w[i]] = 1; print w[i] }
+        }')
+    [ "${#words[@]}" -gt 0 ] || return 1
+
+    for term in "${words[@]}"; do
+        if command -v look >/dev/null 2>&1; then
+            LC_ALL=C look "$term"$'\t' "$terms"
+        else
+            LC_ALL=C awk -F'\t' -v t="$term" '$1 == t { print; exit } $1 > t { exit }' "$terms"
+        fi
+    done | LC_ALL=C awk -F'\t' -v q="$q" -v nterms="${#words[@]}" '
+        # Intersect the posting lists, then check the phrase in each candidate
+        FNR == NR {
+            n = split($2, ids, " ")
+            for (i = 1; i <= n; i++)
+                if (++hits[ids[i]] == nterms) { want[ids[i]] = 1; if (ids[i] + 0 > max) max = ids[i] + 0 }
+            next
+        }
+        FNR > max { exit }
+        (FNR in want) && index($3, q) { print $1 }
+    ' - "$docs"
+}
+
+#############################################
+# FILE IDENTITIES
+#############################################
+#
+# "<dsv>.fileids" remembers what each DSV path looked like when it was last
+# seen on disk, so a file that has since been moved or renamed can be found
+# again (musiclib_reconcile.sh):
+#
+#   PATH<TAB>DEV:INODE<TAB>SIZE<TAB>MTIME<TAB>HASH
+#
+# HASH is a 16-hex-digit SHA-256 prefix of 64 KiB read from the middle of
+# the file: audio payload, which tag edits and copies leave alone.  Records
+# whose file has gone missing are kept for as long as the row is in the DSV.
+
+FILE_ID_BLOCK=65536
+
+# Refresh the identity records of a DSV.  Only files whose inode, size or
+# mtime changed are hashed again, by <jobs> parallel workers.
+# Usage: file_ids_update <db_file> [jobs]
+file_ids_update() {
+    local db_file="$1" jobs="${2:-$(nproc 2>/dev/null || echo 2)}"
+    local ids="${db_file}.fileids"
+    local pathcol work rc=0
+
+    pathcol=$(get_column_index "$db_file" "SongPath") || return 2
+    work=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_fileids.XXXXXX") || return 2
+
+    tail -n +2 "$db_file" | cut -d'^' -f"$pathcol" | LC_ALL=C sort -u > "$work/paths"
+    tr '\n' '\0' < "$work/paths" | xargs -0 -r stat -c $'%n\t%d:%i\t%s\t%Y' 2>/dev/null \
+        > "$work/stat"
+    [ -f "$ids" ] || : > "$ids"
+
+    # Unchanged files and missing-but-still-listed paths keep their record
+    LC_ALL=C awk -F'\t' -v keep="$work/keep" -v todo="$work/todo" '
+        FILENAME == ARGV[1] { old[$1] = $0; key[$1] = $2 "\t" $3 "\t" $4; next }
+        FILENAME == ARGV[2] {
+            seen[$1] = 1
+            if (($1 in key) && key[$1] == $2 "\t" $3 "\t" $4) print old[$1] > keep
+            else print $0 > todo
+            next
+        }
+        !($0 in seen) && ($0 in old) { print old[$0] > keep }
+    ' "$ids" "$work/stat" "$work/paths"
+    touch "$work/keep" "$work/todo"
+
+    cut -f1 "$work/todo" | tr '\n' '\0' |
+        parallel_parts "$work" "$jobs" 64 '
+            block="$1"; shift
+            for f; do
+                size=$(stat -c %s "$f" 2>/dev/null) || continue
+                skip=$(( size / 2 / block ))
+                h=$(dd if="$f" bs="$block" skip="$skip" count=1 2>/dev/null | sha256sum)
+                printf "%s\t%s\n" "$f" "${h:0:16}"
+            done
+        ' "$FILE_ID_BLOCK" |
+        LC_ALL=C awk -F'\t' -v OFS='\t' '
+            FNR == NR { hash[$1] = $2; next }
+            ($1 in hash) { print $0, hash[$1] }
+        ' - "$work/todo" |
+        LC_ALL=C sort -t $'\t' -k1,1 - "$work/keep" > "${ids}.tmp.$$" &&
+        mv "${ids}.tmp.$$" "$ids" || { rm -f "${ids}.tmp.$$"; rc=2; }
+
+    rm -rf "$work"
+    return "$rc"
+}
+
 #############################################
 # BACKUP FUNCTIONS
 #############################################
 
-# Create backup of database
+# Create backup of database.
+# Stores a deduplicated snapshot in the backup store (see SNAPSHOT BACKUPS
+# below).  If the store cannot be written, falls back to a plain timestamped
+# copy next to the DSV so callers always get a restorable backup.
 backup_database() {
     local db_file="$1"
+
+    if [ ! -f "$db_file" ]; then
+        return 1
+    fi
+
+    local result
+    if result=$(db_snapshot_create "$db_file"); then
+        echo "Backup created: snapshot ${result%%$'\t'*}"
+        db_snapshot_prune > /dev/null 2>&1 || true
+        return 0
+    fi
+
     local backup_dir=$(dirname "$db_file")
     local timestamp=$(date '+%Y%m%d_%H%M%S')
-    local backup_file="${backup_dir}/musiclib.dsv.backup.${timestamp}"
+    # Name after the DSV itself so shards sharing a directory keep
+    # separate backup sets
+    local db_name=$(basename "$db_file")
+    local backup_file="${backup_dir}/${db_name}.backup.${timestamp}"
 
-    if [ -f "$db_file" ]; then
-        cp "$db_file" "$backup_file"
-        echo "Backup created: $backup_file"
+    cp "$db_file" "$backup_file" || return 1
+    echo "Backup created: $backup_file"
 
-        # Keep only last 5 backups
-        ls -t "${backup_dir}"/musiclib.dsv.backup.* 2>/dev/null | tail -n +6 | xargs rm -f 2>/dev/null || true
+    # Keep only last 5 fallback copies
+    ls -t "${backup_dir}/${db_name}".backup.* 2>/dev/null | tail -n +6 | xargs rm -f 2>/dev/null || true
 
-        return 0
+    return 0
+}
+
+#############################################
+# TAG BACKUP INDEX
+#############################################
+#
+# Every backup made by backup_file() is recorded in
+# "<backup_dir>/backup_index.tsv", one line per backup:
+#
+#   BACKUP_NAME<TAB>ORIGINAL_PATH<TAB>RUN<TAB>SIZE<TAB>PAYLOAD
+#
+# RUN is TAG_BACKUP_RUN when the calling script set one (each tagclean or
+# tagrebuild run has its own), else empty.  PAYLOAD is mp3_payload_hash() of
+# the backup: tag tools never touch the audio, so a restore can check that a
+# backup still belongs to the file it is about to overwrite.  Lines whose
+# backup was removed are dropped by tag_backup_index_compact().
+
+TAG_BACKUP_INDEX_NAME="backup_index.tsv"
+
+# Print a short hash of an MP3's audio payload: the bytes between a leading
+# ID3v2 tag and trailing APEv2 / ID3v1 tags.  Tag edits leave it unchanged.
+# Usage: mp3_payload_hash <file>
+mp3_payload_hash() {
+    local f="$1"
+    local size start=0 end flags
+    local -a h a
+
+    size=$(stat -c %s "$f" 2>/dev/null) || return 1
+
+    # ID3v2: "ID3" v v flags + 4-byte syncsafe size (+10 when a footer is present)
+    read -r -a h <<< "$(od -An -tu1 -N10 "$f")"
+    if [ "${h[0]:-0}" -eq 73 ] && [ "${h[1]:-0}" -eq 68 ] && [ "${h[2]:-0}" -eq 51 ] &&
+       [ "${#h[@]}" -eq 10 ]; then
+        start=$(( 10 + (h[6] << 21 | h[7] << 14 | h[8] << 7 | h[9]) ))
+        (( h[5] & 16 )) && start=$((start + 10))
     fi
 
-    return 1
+    end=$size
+    if [ "$end" -ge 128 ] && [ "$(tail -c 128 "$f" | head -c 3)" = "TAG" ]; then
+        end=$((end - 128))
+    fi
+    # APEv2 footer: "APETAGEX", version, size (items + footer), count, flags
+    if [ "$end" -ge 32 ] &&
+       [ "$(tail -c +$((end - 31)) "$f" | head -c 8)" = "APETAGEX" ]; then
+        read -r -a a <<< "$(tail -c +$((end - 31 + 12)) "$f" | head -c 12 | od -An -tu1)"
+        end=$(( end - (a[0] | a[1] << 8 | a[2] << 16 | a[3] << 24) ))
+        flags=$(( a[8] | a[9] << 8 | a[10] << 16 | a[11] << 24 ))
+        (( flags & 0x80000000 )) && end=$((end - 32))
+    fi
+
+    [ "$end" -gt "$start" ] || { start=0; end=$size; }
+    tail -c +$((start + 1)) "$f" | head -c $((end - start)) | sha256sum | cut -c1-16
+}
+
+# Append a line to the tag backup index of backup_dir.
+# Usage: tag_backup_index_add <backup_dir> <backup_file> <original_path>
+tag_backup_index_add() {
+    local backup_dir="$1" backup="$2" original="$3"
+    local index="$backup_dir/$TAG_BACKUP_INDEX_NAME"
+    local payload size
+
+    case "$original" in
+        /*) ;;
+        *) original="$(cd "$(dirname "$original")" 2>/dev/null && pwd)/$(basename "$original")" ;;
+    esac
+    size=$(stat -c %s "$backup" 2>/dev/null)
+    payload=$(mp3_payload_hash "$backup" 2>/dev/null)
+
+    (
+        exec {idx_fd}>"${index}.lock" || exit 1
+        flock -x -w 10 "$idx_fd" || exit 1
+        printf '%s\t%s\t%s\t%s\t%s\n' "$(basename "$backup")" "$original" \
+            "${TAG_BACKUP_RUN:-}" "${size:-}" "${payload:-}" >> "$index"
+    ) 2>/dev/null || true
+}
+
+# Bring the index in line with the directory: drop lines of deleted backups
+# and add (path-less) lines for backups made before the index existed.
+# Usage: tag_backup_index_compact <backup_dir>
+tag_backup_index_compact() {
+    local backup_dir="$1"
+    local index="$backup_dir/$TAG_BACKUP_INDEX_NAME"
+
+    [ -d "$backup_dir" ] || return 0
+    (
+        exec {idx_fd}>"${index}.lock" || exit 1
+        flock -x -w 10 "$idx_fd" || exit 1
+        touch "$index" || exit 1
+        find "$backup_dir" -maxdepth 1 -type f -name '*.backup.*' -printf '%f\n' 2>/dev/null |
+            LC_ALL=C sort > "${index}.present.$$"
+        LC_ALL=C awk -F'\t' '
+            FNR == NR { present[$0] = 1; next }
+            ($1 in present) { print; indexed[$1] = 1 }
+            END { for (name in present) if (!(name in indexed)) print name "\t\t\t\t" }
+        ' "${index}.present.$$" "$index" > "${index}.tmp.$$" &&
+            mv "${index}.tmp.$$" "$index"
+        rm -f "${index}.present.$$" "${index}.tmp.$$"
+    ) 2>/dev/null
 }
 
 # Create backup of any file with timestamp
@@ -351,6 +1318,14 @@ backup_file() {
         mkdir -p "$backup_dir" || return 1
     fi
 
+    # Files with the same name in different albums can be backed up within
+    # the same second; never overwrite another file's backup
+    local n=1
+    while [ -e "$backup_file" ]; do
+        n=$((n + 1))
+        backup_file="$backup_dir/${basename}.backup.${timestamp}.${n}"
+    done
+
     cp "$filepath" "$backup_file" || return 1
 
     # Verify backup
@@ -360,6 +1335,7 @@ backup_file() {
         return 1
     fi
 
+    tag_backup_index_add "$backup_dir" "$backup_file" "$filepath"
     echo "$backup_file"
     return 0
 }
@@ -386,6 +1362,325 @@ remove_backup() {
     fi
 }
 
+#############################################
+# SNAPSHOT BACKUPS
+#############################################
+#
+# Point-in-time DSV backups are stored as content-defined chunks:
+#
+#   $DB_BACKUP_DIR/chunks/<2 hex>/<sha256>.zst   (or .gz without zstd)
+#   $DB_BACKUP_DIR/snapshots/<dsv name>-<key>/<YYYYmmdd_HHMMSS>.snap
+#
+# <key> is the first 16 hex digits of the SHA-1 of the DSV's absolute path
+# (as for the library snapshot in $XDG_RUNTIME_DIR), so two shards that
+# share a file name in different directories keep separate histories.
+#
+# A snapshot file is a few key=value header lines followed by the ordered
+# list of chunk hashes.  Chunk boundaries are chosen from the content of
+# the line that ends each chunk (not from byte offsets), so editing a few
+# rows only changes the chunks around those rows and every other chunk is
+# shared with earlier snapshots.  The store is shared by all shards.
+
+DB_CHUNK_MIN_BYTES=4096
+DB_CHUNK_MAX_BYTES=65536
+DB_CHUNK_MASK=64
+
+# Print the backup store directory.
+db_backup_store_dir() {
+    echo "${DB_BACKUP_DIR:-$(get_data_dir)/data/db_backups}"
+}
+
+# Print the stored path of a chunk, or return 1 if it is missing.
+# Usage: db_chunk_path <store> <sha256>
+db_chunk_path() {
+    local base="$1/chunks/${2:0:2}/$2"
+    if [ -f "${base}.zst" ]; then
+        echo "${base}.zst"
+    elif [ -f "${base}.gz" ]; then
+        echo "${base}.gz"
+    else
+        return 1
+    fi
+}
+
+# Print the snapshot set directory of a DSV.
+# Usage: _db_snapshot_set_dir <store> <db_file>
+_db_snapshot_set_dir() {
+    local key
+    key=$(realpath -m -- "$2" | sha1sum | cut -c1-16)
+    echo "$1/snapshots/$(basename "$2")-${key}"
+}
+
+# Move the snapshots of <db_file> out of a set written when sets were keyed
+# by file name alone.  Each snapshot's db= header says which DSV it is of,
+# so a set shared by same-named shards is split correctly.
+# Usage: _db_snapshot_adopt_legacy <store> <db_file> <set_dir>  (store lock held)
+_db_snapshot_adopt_legacy() {
+    local legacy="$1/snapshots/$(basename "$2")"
+    [ -d "$legacy" ] || return 0
+
+    local abs f recorded
+    abs=$(realpath -m -- "$2")
+    for f in "$legacy"/*.snap; do
+        [ -f "$f" ] || continue
+        recorded=$(sed -n 's/^db=//p;/^[0-9a-f]\{64\}$/q' "$f")
+        [ -n "$recorded" ] && [ "$(realpath -m -- "$recorded")" = "$abs" ] || continue
+        mkdir -p "$3" && mv "$f" "$3/" || return 2
+    done
+    rmdir "$legacy" 2>/dev/null || true
+}
+
+# Print the snapshot set directory of a DSV, adopting any snapshots of it
+# still in a legacy (file-name keyed) set.
+# Usage: db_snapshot_set_dir <db_file>
+db_snapshot_set_dir() {
+    local store dir
+    store=$(db_backup_store_dir)
+    dir=$(_db_snapshot_set_dir "$store" "$1")
+    if [ -d "$store/snapshots/$(basename "$1")" ]; then
+        _db_store_locked "$store" _db_snapshot_adopt_legacy "$store" "$1" "$dir" || true
+    fi
+    echo "$dir"
+}
+
+# Run a command holding the store lock, so pruning never deletes chunks
+# that a concurrent snapshot has written but not yet referenced.
+# Usage: _db_store_locked <store> command [args...]
+_db_store_locked() {
+    local store="$1"
+    shift
+    mkdir -p "$store" 2>/dev/null || return 2
+    (
+        exec {lock_fd}>"$store/.lock" || exit 2
+        flock -x -w "${LOCK_TIMEOUT:-10}" "$lock_fd" || exit 1
+        "$@"
+    )
+}
+
+# Split a DSV into numbered chunk files (000000, 000001, ...) in <dir>.
+# Usage: db_split_chunks <db_file> <dir>
+db_split_chunks() {
+    LC_ALL=C awk -v dir="$2" -v minb="$DB_CHUNK_MIN_BYTES" \
+        -v maxb="$DB_CHUNK_MAX_BYTES" -v mask="$DB_CHUNK_MASK" '
+        BEGIN {
+            for (i = 1; i < 256; i++) ord[sprintf("%c", i)] = i
+            n = 0; size = 0
+            file = sprintf("%s/%06d", dir, n)
+        }
+        {
+            print > file
+            size += length($0) + 1
+            # Hash the start of the row (ID, artist, album), which rating
+            # and play-count edits never touch
+            h = 0; m = length($0); if (m > 32) m = 32
+            for (i = 1; i <= m; i++) h = (h * 31 + ord[substr($0, i, 1)]) % 1000003
+            if ((size >= minb && h % mask == 0) || size >= maxb) {
+                close(file)
+                n++; size = 0
+                file = sprintf("%s/%06d", dir, n)
+            }
+        }
+    ' "$1"
+}
+
+# Store a snapshot of a DSV.  Only chunks not already in the store are
+# written.  If the content equals the latest snapshot nothing is written.
+# Usage: db_snapshot_create <db_file>
+# Prints: id<TAB>created|unchanged<TAB>size<TAB>chunks<TAB>new_chunks<TAB>new_bytes
+db_snapshot_create() {
+    local db_file="$1"
+    local store
+    store=$(db_backup_store_dir)
+
+    [ -f "$db_file" ] || return 1
+    _db_store_locked "$store" _db_snapshot_create_locked "$db_file" "$store"
+}
+
+_db_snapshot_create_locked() {
+    local db_file="$1" store="$2"
+    local snap_dir
+    snap_dir=$(_db_snapshot_set_dir "$store" "$db_file")
+    _db_snapshot_adopt_legacy "$store" "$db_file" "$snap_dir" || return 2
+    local work
+    work=$(mktemp -d) || return 2
+
+    if ! db_split_chunks "$db_file" "$work"; then
+        rm -rf "$work"
+        return 2
+    fi
+
+    local sums sha size
+    sums=$(cd "$work" && sha256sum [0-9]*) || { rm -rf "$work"; return 2; }
+    sha=$(cat "$work"/[0-9]* | sha256sum | cut -d' ' -f1)
+    size=$(cat "$work"/[0-9]* | wc -c)
+
+    mkdir -p "$snap_dir" || { rm -rf "$work"; return 2; }
+
+    local latest
+    latest=$(ls "$snap_dir"/*.snap 2>/dev/null | tail -n 1)
+    if [ -n "$latest" ] && grep -qx "sha256=$sha" "$latest"; then
+        rm -rf "$work"
+        printf '%s\tunchanged\t%s\t%s\t0\t0\n' "$(basename "$latest" .snap)" \
+            "$size" "$(grep -c '^[0-9a-f]\{64\}$' "$latest")"
+        return 0
+    fi
+
+    local compress=(gzip -q -9) ext="gz"
+    if command -v zstd >/dev/null 2>&1; then
+        compress=(zstd -q -19)
+        ext="zst"
+    fi
+
+    local hash part dest nchunks=0 new_chunks=0 new_bytes=0
+    while read -r hash part; do
+        nchunks=$((nchunks + 1))
+        db_chunk_path "$store" "$hash" > /dev/null && continue
+        dest="$store/chunks/${hash:0:2}/${hash}.${ext}"
+        mkdir -p "${dest%/*}" &&
+            "${compress[@]}" -c "$work/$part" > "${dest}.tmp" &&
+            mv "${dest}.tmp" "$dest" || { rm -f "${dest}.tmp"; rm -rf "$work"; return 2; }
+        new_chunks=$((new_chunks + 1))
+        new_bytes=$((new_bytes + $(wc -c < "$dest")))
+    done <<< "$sums"
+
+    local id snap n=2
+    id=$(date '+%Y%m%d_%H%M%S')
+    snap="$snap_dir/${id}.snap"
+    while [ -e "$snap" ]; do
+        snap="$snap_dir/${id}_${n}.snap"
+        n=$((n + 1))
+    done
+
+    {
+        echo "# musiclib snapshot v1"
+        echo "db=$(realpath -m -- "$db_file")"
+        echo "created=$(date '+%Y-%m-%dT%H:%M:%S')"
+        echo "size=$size"
+        echo "sha256=$sha"
+        echo "chunks=$nchunks"
+        cut -d' ' -f1 <<< "$sums"
+    } > "${snap}.tmp" && mv "${snap}.tmp" "$snap" || { rm -f "${snap}.tmp"; rm -rf "$work"; return 2; }
+
+    rm -rf "$work"
+    printf '%s\tcreated\t%s\t%s\t%s\t%s\n' "$(basename "$snap" .snap)" \
+        "$size" "$nchunks" "$new_chunks" "$new_bytes"
+}
+
+# List snapshots of a DSV, oldest first.
+# Usage: db_snapshot_list <db_file>
+# Prints: id<TAB>created<TAB>size<TAB>chunks
+db_snapshot_list() {
+    local snap_dir
+    snap_dir=$(db_snapshot_set_dir "$1")
+    ls "$snap_dir"/*.snap > /dev/null 2>&1 || return 0
+
+    awk -F'=' '
+        FNR == 1 && NR > 1 { print row }
+        FNR == 1 { id = FILENAME; sub(/.*\//, "", id); sub(/\.snap$/, "", id); row = "" }
+        $1 == "created" { created = $2 }
+        $1 == "size"    { size = $2 }
+        $1 == "chunks"  { row = id "\t" created "\t" size "\t" $2 }
+        END { if (NR > 0) print row }
+    ' "$snap_dir"/*.snap
+}
+
+# Resolve a snapshot id ("latest" for the newest) to its snapshot file.
+# Usage: db_snapshot_file <db_file> <id|latest>
+db_snapshot_file() {
+    local snap_dir
+    snap_dir=$(db_snapshot_set_dir "$1")
+
+    if [ "$2" = "latest" ]; then
+        ls "$snap_dir"/*.snap 2>/dev/null | tail -n 1 | grep . || return 1
+    elif [ -f "$snap_dir/$2.snap" ]; then
+        echo "$snap_dir/$2.snap"
+    else
+        return 1
+    fi
+}
+
+# Reassemble a snapshot into <output>, verifying its checksum.  The output
+# is written to a temp file and moved into place only once verified.
+# Usage: db_snapshot_restore <snapshot_file> <output>
+# Returns: 0 success, 1 missing chunk or checksum mismatch, 2 I/O error
+db_snapshot_restore() {
+    local snap="$1" out="$2"
+    local store
+    store=$(db_backup_store_dir)
+
+    local hash path paths=()
+    while read -r hash; do
+        if ! path=$(db_chunk_path "$store" "$hash"); then
+            echo "Error: Snapshot chunk missing from store: $hash" >&2
+            return 1
+        fi
+        paths+=("$path")
+    done < <(grep '^[0-9a-f]\{64\}$' "$snap")
+
+    local tmp="${out}.restore.tmp"
+    : > "$tmp" || return 2
+    for path in "${paths[@]}"; do
+        case "$path" in
+            *.zst) zstd -q -d -c "$path" ;;
+            *)     gzip -d -c "$path" ;;
+        esac
+    done > "$tmp" || { rm -f "$tmp"; return 2; }
+
+    local want got
+    want=$(sed -n 's/^sha256=//p' "$snap")
+    got=$(sha256sum "$tmp" | cut -d' ' -f1)
+    if [ "$want" != "$got" ]; then
+        echo "Error: Restored data does not match snapshot checksum: $snap" >&2
+        rm -f "$tmp"
+        return 1
+    fi
+
+    mv "$tmp" "$out" || { rm -f "$tmp"; return 2; }
+}
+
+# Apply retention to every snapshot set, then delete chunks no snapshot
+# references.  Snapshots younger than DB_BACKUP_KEEP_ALL_HOURS are all
+# kept; older ones are thinned to the newest per day and dropped after
+# DB_BACKUP_RETENTION_DAYS.  The newest snapshot of each set is always kept.
+# Usage: db_snapshot_prune
+# Prints: removed_snapshots<TAB>removed_chunks
+db_snapshot_prune() {
+    local store
+    store=$(db_backup_store_dir)
+    [ -d "$store/snapshots" ] || { printf '0\t0\n'; return 0; }
+    _db_store_locked "$store" _db_snapshot_prune_locked "$store"
+}
+
+_db_snapshot_prune_locked() {
+    local store="$1"
+    local recent_cut oldest_cut
+    recent_cut=$(date -d "-${DB_BACKUP_KEEP_ALL_HOURS:-48} hours" '+%Y%m%d_%H%M%S')
+    oldest_cut=$(date -d "-${DB_BACKUP_RETENTION_DAYS:-365} days" '+%Y%m%d_%H%M%S')
+
+    local set_dir removed=0 n
+    for set_dir in "$store"/snapshots/*/; do
+        [ -d "$set_dir" ] || continue
+        n=$(ls "$set_dir" | grep '\.snap$' | sort -r | awk -v recent="$recent_cut" -v oldest="$oldest_cut" '
+            NR == 1 { next }
+            $0 >= recent { next }
+            $0 < oldest { print; next }
+            { day = substr($0, 1, 8); if (day in seen) print; else seen[day] = 1 }
+        ' | while read -r f; do rm -f "$set_dir$f" && echo; done | wc -l)
+        removed=$((removed + n))
+    done
+
+    local live
+    live=$(mktemp) || return 2
+    cat "$store"/snapshots/*/*.snap 2>/dev/null | grep '^[0-9a-f]\{64\}$' | sort -u > "$live"
+    n=$(find "$store/chunks" -type f \( -name '*.zst' -o -name '*.gz' \) 2>/dev/null |
+        awk 'NR == FNR { live[$0]; next }
+             { h = $0; sub(/.*\//, "", h); sub(/\.(zst|gz)$/, "", h); if (!(h in live)) print }' "$live" - |
+        while read -r f; do rm -f "$f" && echo; done | wc -l)
+    rm -f "$live"
+
+    printf '%s\t%s\n' "$removed" "$n"
+}
+
 #############################################
 # DATABASE LOCKING
 #############################################
@@ -451,9 +1746,8 @@ with_db_lock() {
     (
         # Subshell isolates trap — caller's traps are unaffected
         trap 'release_db_lock 2>/dev/null' EXIT
-        if ! acquire_db_lock "$timeout"; then
-        exit $? # Propagates 1 (timeout) or 2 (error)
-        fi
+        # Propagates 1 (timeout) or 2 (error); "if ! ..." would leave $? at 0
+        acquire_db_lock "$timeout" || exit $?
         "$@"
         # Exit code of callback propagates naturally
     )
@@ -470,8 +1764,9 @@ with_db_lock_scope() {
     local _wdls_prev_trap _wdls_rc
     _wdls_prev_trap=$(trap -p EXIT 2>/dev/null || true)
     trap 'release_db_lock 2>/dev/null' EXIT
-    if ! acquire_db_lock "$_wdls_timeout"; then
-        _wdls_rc=$?
+    _wdls_rc=0
+    acquire_db_lock "$_wdls_timeout" || _wdls_rc=$?
+    if [ "$_wdls_rc" -ne 0 ]; then
         if [ -n "$_wdls_prev_trap" ]; then eval "$_wdls_prev_trap"; else trap - EXIT; fi
         return "$_wdls_rc"
     fi
@@ -0,0 +1,266 @@
+#!/bin/bash
+#
+# musiclib_db_backup.sh - Point-in-time DSV snapshots (backup, restore, list)
+# Usage: musiclib_db_backup.sh backup|restore|list [options]
+#
+# Snapshots are kept in a deduplicated, compressed chunk store (see the
+# SNAPSHOT BACKUPS section of musiclib_db.sh), so frequent backups of a
+# large DSV only cost the chunks that actually changed.
+#
+#   backup                Snapshot the database (every shard when
+#                         LIBRARY_SHARDS is set), then apply retention
+#   restore <ID|latest>   Restore a snapshot over the database, or to -o FILE
+#   list                  List snapshots
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown snapshot, corrupt snapshot)
+#   2 - System error (config failure, I/O error, lock timeout)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_db_backup.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_db_backup.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+LOCK_TIMEOUT="${LOCK_TIMEOUT:-10}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli db backup [options]
+       musiclib-cli db restore <ID|latest> [options]
+       musiclib-cli db list [options]
+
+Deduplicated point-in-time snapshots of the database.
+
+Subcommands:
+  backup              Take a snapshot (all shards unless -d/--shard is given)
+  restore ID|latest   Restore a snapshot.  The current database is
+                      snapshotted first, so a restore can be undone.
+  list                List snapshots, oldest first
+
+Options:
+  -d FILE             Database to operate on (default: $MUSICDB)
+  --shard NAME        Operate on the named library shard
+  -o FILE             restore: write to FILE instead of replacing the database
+  -h, --help          Display this help
+
+Store:      $(db_backup_store_dir)
+Retention:  every snapshot for ${DB_BACKUP_KEEP_ALL_HOURS:-48} hours, then one per day
+            for ${DB_BACKUP_RETENTION_DAYS:-365} days (DB_BACKUP_KEEP_ALL_HOURS,
+            DB_BACKUP_RETENTION_DAYS)
+
+Examples:
+  musiclib-cli db backup
+  musiclib-cli db list
+  musiclib-cli db restore 20261018_140000 -o /tmp/musiclib-old.dsv
+  musiclib-cli db restore latest
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+SUBCOMMAND=""
+SNAPSHOT_ID=""
+TARGET_DB=""
+TARGET_SHARD=""
+OUTPUT_FILE=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        -d|-o|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                -d) TARGET_DB="$2" ;;
+                -o) OUTPUT_FILE="$2" ;;
+                --shard) TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        -*)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+        *)
+            if [ -z "$SUBCOMMAND" ]; then
+                SUBCOMMAND="$1"
+            elif [ "$SUBCOMMAND" = "restore" ] && [ -z "$SNAPSHOT_ID" ]; then
+                SNAPSHOT_ID="$1"
+            else
+                error_exit 1 "Unexpected argument" "argument" "$1"
+                exit 1
+            fi
+            shift
+            ;;
+    esac
+done
+
+case "$SUBCOMMAND" in
+    backup|list) ;;
+    restore)
+        if [ -z "$SNAPSHOT_ID" ]; then
+            error_exit 1 "restore requires a snapshot ID (or 'latest')"
+            exit 1
+        fi
+        ;;
+    "")
+        show_usage >&2
+        error_exit 1 "No subcommand given (backup, restore or list)"
+        exit 1
+        ;;
+    *)
+        error_exit 1 "Unknown subcommand (must be backup, restore or list)" "subcommand" "$SUBCOMMAND"
+        exit 1
+        ;;
+esac
+
+# Databases to operate on: an explicit target, otherwise every shard
+# (just MUSICDB when LIBRARY_SHARDS is unset)
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+#############################################
+# backup
+#############################################
+do_backup() {
+    local db result id state size chunks new_chunks new_bytes sep="" rc=0
+    local total_new=0
+    printf '{"status": "ok", "snapshots": ['
+    for db in "${TARGETS[@]}"; do
+        if [ ! -f "$db" ]; then
+            echo "Warning: Database not found, skipped: $db" >&2
+            continue
+        fi
+        if ! result=$(db_snapshot_create "$db"); then
+            echo "Error: Snapshot failed: $db" >&2
+            rc=2
+            continue
+        fi
+        IFS=$'\t' read -r id state size chunks new_chunks new_bytes <<< "$result"
+        printf '%s{"database": "%s", "id": "%s", "state": "%s", "size": %d, "chunks": %d, "new_chunks": %d, "new_bytes": %d}' \
+            "$sep" "$db" "$id" "$state" "$size" "$chunks" "$new_chunks" "$new_bytes"
+        sep=", "
+        total_new=$((total_new + new_bytes))
+    done
+
+    local pruned removed_snaps removed_chunks
+    pruned=$(db_snapshot_prune) || pruned=$'0\t0'
+    IFS=$'\t' read -r removed_snaps removed_chunks <<< "$pruned"
+    printf '], "new_bytes": %d, "pruned_snapshots": %d, "pruned_chunks": %d}\n' \
+        "$total_new" "$removed_snaps" "$removed_chunks"
+
+    log_message "DB backup: ${#TARGETS[@]} database(s), ${total_new} new bytes, pruned ${removed_snaps} snapshot(s)" > /dev/null
+    return "$rc"
+}
+
+#############################################
+# list
+#############################################
+do_list() {
+    local db id created size chunks sep=""
+    local store store_bytes
+    store=$(db_backup_store_dir)
+    store_bytes=$(du -sb "$store/chunks" 2>/dev/null | cut -f1)
+
+    printf '{"status": "ok", "store": "%s", "store_bytes": %d, "snapshots": [' "$store" "${store_bytes:-0}"
+    for db in "${TARGETS[@]}"; do
+        while IFS=$'\t' read -r id created size chunks; do
+            printf '%s{"database": "%s", "id": "%s", "created": "%s", "size": %d, "chunks": %d}' \
+                "$sep" "$db" "$id" "$created" "$size" "$chunks"
+            sep=", "
+        done < <(db_snapshot_list "$db")
+    done
+    printf ']}\n'
+}
+
+#############################################
+# restore
+#############################################
+# Runs under the database lock (via with_db_lock_scope) when replacing the
+# live database.  Sets LOCKED and PREVIOUS_ID in the caller's scope.
+install_snapshot() {
+    local snap="$1"
+    local current
+    LOCKED=true
+    if [ -f "$MUSICDB" ]; then
+        current=$(db_snapshot_create "$MUSICDB") || return 2
+        PREVIOUS_ID="${current%%$'\t'*}"
+    fi
+    db_snapshot_restore "$snap" "$MUSICDB" || return $?
+    publish_change "$MUSICDB" reload "" ""
+}
+
+do_restore() {
+    if [ "${#TARGETS[@]}" -ne 1 ]; then
+        error_exit 1 "Library is sharded; choose the shard to restore with --shard NAME or -d FILE"
+        return 1
+    fi
+    MUSICDB="${TARGETS[0]}"
+
+    local snap
+    if ! snap=$(db_snapshot_file "$MUSICDB" "$SNAPSHOT_ID"); then
+        error_exit 1 "Snapshot not found" "database" "$MUSICDB" "snapshot" "$SNAPSHOT_ID"
+        return 1
+    fi
+    local id
+    id=$(basename "$snap" .snap)
+
+    PREVIOUS_ID=""
+    LOCKED=false
+    local rc=0 dest
+    if [ -n "$OUTPUT_FILE" ]; then
+        dest="$OUTPUT_FILE"
+        db_snapshot_restore "$snap" "$dest" || rc=$?
+    else
+        dest="$MUSICDB"
+        with_db_lock_scope "$LOCK_TIMEOUT" install_snapshot "$snap" || rc=$?
+        if [ "$rc" -ne 0 ] && [ "$LOCKED" = false ]; then
+            error_exit 2 "Database is locked" "database" "$MUSICDB" "timeout" "$LOCK_TIMEOUT"
+            return 2
+        fi
+    fi
+
+    if [ "$rc" -ne 0 ]; then
+        error_exit "$rc" "Restore failed" "database" "$MUSICDB" "snapshot" "$id"
+        return "$rc"
+    fi
+
+    log_message "DB restore: $MUSICDB snapshot $id -> $dest" > /dev/null
+    printf '{"status": "ok", "database": "%s", "snapshot": "%s", "output": "%s", "previous_snapshot": "%s"}\n' \
+        "$MUSICDB" "$id" "$dest" "$PREVIOUS_ID"
+}
+
+#############################################
+# Main
+#############################################
+case "$SUBCOMMAND" in
+    backup)  do_backup ;;
+    list)    do_list ;;
+    restore) do_restore ;;
+esac
+exit $?
@@ -0,0 +1,154 @@
+#!/bin/bash
+#
+# musiclib_db_changes.sh - Read the database change feed
+# Usage: musiclib_db_changes.sh [--since SEQ] [--follow] [-d FILE]
+#
+# Prints the change events (NDJSON, one per line) that writers append to
+# "<dsv>.changes" — see the CHANGE FEED section of musiclib_db.sh for the
+# event format.  Consumers remember the last "seq" they applied and resume
+# with --since.  If the events after SEQ are no longer in the journal (it is
+# trimmed to CHANGE_FEED_MAX_EVENTS) or the journal was reset, a single
+# synthetic {"seq":N,"op":"reload",...} event is printed instead, meaning
+# "reparse the DSV, then continue from N".
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments)
+#   2 - System error (config failure)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_db_changes.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_db_changes.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli db changes [--since SEQ] [--follow] [-d FILE]
+
+Print database change events (one JSON object per line).
+
+Options:
+  --since SEQ     Only events after sequence number SEQ (default: 0, all
+                  events still in the journal)
+  --follow        Keep running and print new events as they are written
+  -d FILE         Database whose feed to read (default: $MUSICDB)
+  --shard NAME    Read the feed of the named library shard
+  -h, --help      Display this help
+
+Live events are also broadcast on the session bus as
+org.musiclib.ChangeFeed.Changed(s dsv, t seq, s event) on /org/musiclib/ChangeFeed.
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+SINCE=0
+FOLLOW=false
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        --since|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --since) SINCE="$2" ;;
+                -d)      MUSICDB="$2" ;;
+                --shard)
+                    if ! shard=$(get_library_shard "$2"); then
+                        error_exit 1 "Unknown library shard" "shard" "$2"
+                        exit 1
+                    fi
+                    MUSICDB="${shard#*$'\t'}"
+                    ;;
+            esac
+            shift 2
+            ;;
+        --follow)
+            FOLLOW=true
+            shift
+            ;;
+        *)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+    esac
+done
+
+if ! [[ "$SINCE" =~ ^[0-9]+$ ]]; then
+    error_exit 1 "--since must be a non-negative integer" "since" "$SINCE"
+    exit 1
+fi
+
+JOURNAL="${MUSICDB}.changes"
+
+#############################################
+# Main
+#############################################
+[ -f "$JOURNAL" ] || : > "$JOURNAL" 2>/dev/null
+
+# A journal that restarted below SINCE (deleted, or a restored database)
+# cannot be replayed from SINCE
+LAST=$(tail -n 1 "$JOURNAL" 2>/dev/null | sed -n 's/^{"seq":\([0-9]*\),.*/\1/p')
+LAST="${LAST:-0}"
+if [ "$LAST" -lt "$SINCE" ]; then
+    printf '{"seq":%d,"op":"reload","id":"","path":"","changes":{}}\n' "$LAST"
+    SINCE="$LAST"
+fi
+
+# Replay events after SINCE; if the first one is not SINCE+1 the events in
+# between were trimmed, so emit a reload positioned just before it.
+# mawk reads a pipe in large blocks unless told to work line by line, which
+# would hold --follow output back indefinitely
+AWK_LINE_MODE=()
+awk -W version 2>/dev/null | grep -q '^mawk' && AWK_LINE_MODE=(-W interactive)
+
+replay() {
+    awk "${AWK_LINE_MODE[@]}" -v since="$SINCE" '
+        {
+            if (!match($0, /^\{"seq":[0-9]+/)) next
+            seq = substr($0, 8, RLENGTH - 7) + 0
+            if (seq <= since) next
+            if (seq != since + 1)
+                printf "{\"seq\":%d,\"op\":\"reload\",\"id\":\"\",\"path\":\"\",\"changes\":{}}\n", seq - 1
+            since = seq
+            print
+            fflush()
+        }
+    '
+}
+
+if [ "$FOLLOW" = true ]; then
+    # Journal trimming replaces the file; -F follows the new one.  --pid
+    # ends tail when this script is killed, so no reader is left behind.
+    tail -n +1 -F --pid=$$ "$JOURNAL" 2>/dev/null | replay
+else
+    replay < "$JOURNAL"
+fi
+exit 0
@@ -0,0 +1,419 @@
+#!/bin/bash
+#
+# musiclib_db_merge.sh - Merge play history and ratings from another MusicLib DSV
+# Usage: musiclib_db_merge.sh <other.dsv> [options]
+#
+# Reconciles two copies of the library database (e.g. desktop and laptop).
+# Rows are aligned by SongPath — or by the path relative to each side's
+# music root with --relative — using a sorted merge join:
+#
+#   1. Both DSVs are decorated with their join key and sorted with sort(1)
+#      (external merge sort, bounded memory).
+#   2. One awk pass walks both sorted streams in lockstep, writes the merged
+#      rows and a change report.
+#   3. The merged rows are sorted back into ID order and the header is
+#      restored.
+#
+# Only the local database's rows are written; rows that exist only in the
+# other DSV are listed in the report (their files may not exist locally).
+#
+# Merge rules for a matched row:
+#   LastTimePlayed   the larger (more recent) value wins
+#   Rating/GroupDesc equal values are kept; if one side is unrated (0) the
+#                    rated side wins; otherwise --rating decides:
+#                      played  side with the more recent LastTimePlayed
+#                              (default; ties keep local)
+#                      local   always keep the local rating
+#                      other   always take the other rating
+#   Custom2          filled from the other side only when local is empty
+#
+# Report format (tab-separated, one line per event):
+#   UPDATE     <path> <field> <old> <new>
+#   CONFLICT   <path> Rating  <local> <other> <resolution>
+#   OTHER_ONLY <path>
+#   DUPLICATE  <path>                       (extra rows for one key in other)
+#
+# File tags are not touched.  After --apply, rating changes can be written
+# back to tags with `musiclib-cli tagrebuild`.
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, other DSV missing or invalid)
+#   2 - System error (config failure, DB not found, I/O error, lock timeout)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_db_merge.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_db_merge.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+MUSIC_ROOT_DIR="${MUSIC_ROOT_DIR:-/mnt/music}"
+LOCK_TIMEOUT="${LOCK_TIMEOUT:-10}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli db merge <other.dsv> [options]
+
+Merge LastTimePlayed, ratings and Custom2 from another MusicLib database
+into this one.  Rows are matched by SongPath with a sorted merge join.
+
+Options:
+  -d FILE           Local database (default: $MUSICDB)
+  -o FILE           Write the merged database here
+                    (default: <local>.merged next to the local database)
+  -r FILE           Write the change report here (default: <output>.report)
+  --apply           Replace the local database with the merged result
+                    (backup first, under the database lock)
+  --relative        Match on the path relative to each side's music root
+  --local-root DIR  Music root of the local database (default: $MUSIC_ROOT_DIR)
+  --other-root DIR  Music root of the other database (default: same as local)
+  --rating RULE     Rating conflict rule: played (default), local, other
+  -h, --help        Display this help
+
+Examples:
+  # Preview: write merged copy and report, leave the database alone
+  musiclib-cli db merge ~/laptop-musiclib.dsv
+
+  # Laptop mounts the collection elsewhere; merge and apply
+  musiclib-cli db merge ~/laptop-musiclib.dsv --relative --other-root /media/music --apply
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+OTHER_DB=""
+OUTPUT_FILE=""
+REPORT_FILE=""
+APPLY=false
+RELATIVE=false
+LOCAL_ROOT="$MUSIC_ROOT_DIR"
+OTHER_ROOT=""
+RATING_RULE="played"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        -d|-o|-r|--local-root|--other-root|--rating)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                -d)           MUSICDB="$2" ;;
+                -o)           OUTPUT_FILE="$2" ;;
+                -r)           REPORT_FILE="$2" ;;
+                --local-root) LOCAL_ROOT="$2" ;;
+                --other-root) OTHER_ROOT="$2" ;;
+                --rating)     RATING_RULE="$2" ;;
+            esac
+            shift 2
+            ;;
+        --apply)
+            APPLY=true
+            shift
+            ;;
+        --relative)
+            RELATIVE=true
+            shift
+            ;;
+        -*)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+        *)
+            if [ -n "$OTHER_DB" ]; then
+                error_exit 1 "Only one database to merge may be given" "provided" "$*"
+                exit 1
+            fi
+            OTHER_DB="$1"
+            shift
+            ;;
+    esac
+done
+
+if [ -z "$OTHER_DB" ]; then
+    show_usage >&2
+    error_exit 1 "No database to merge given"
+    exit 1
+fi
+
+case "$RATING_RULE" in
+    played|local|other) ;;
+    *)
+        error_exit 1 "Invalid rating rule (must be played, local or other)" "rating" "$RATING_RULE"
+        exit 1
+        ;;
+esac
+
+OTHER_ROOT="${OTHER_ROOT:-$LOCAL_ROOT}"
+OUTPUT_FILE="${OUTPUT_FILE:-${MUSICDB}.merged}"
+REPORT_FILE="${REPORT_FILE:-${OUTPUT_FILE}.report}"
+
+#############################################
+# Validation
+#############################################
+if ! validate_database "$MUSICDB" 2>/dev/null; then
+    error_exit 2 "Database not found or invalid" "database" "$MUSICDB"
+    exit 2
+fi
+if ! validate_database "$OTHER_DB" 2>/dev/null; then
+    error_exit 1 "Database to merge not found or invalid" "database" "$OTHER_DB"
+    exit 1
+fi
+if [ "$(realpath "$MUSICDB")" = "$(realpath "$OTHER_DB")" ]; then
+    error_exit 1 "Cannot merge a database with itself" "database" "$MUSICDB"
+    exit 1
+fi
+
+# Column positions, resolved independently — the two files may come from
+# different schema versions.
+resolve_merge_columns() {
+    local db="$1" prefix="$2" col idx
+    for col in ID SongPath Rating GroupDesc LastTimePlayed; do
+        if ! idx=$(get_column_index "$db" "$col" 2>/dev/null); then
+            error_exit 1 "Column '$col' not found in database header" "database" "$db"
+            return 1
+        fi
+        printf -v "${prefix}_${col}" '%s' "$idx"
+    done
+    idx=$(get_column_index "$db" "Custom2" 2>/dev/null) || idx=0
+    printf -v "${prefix}_Custom2" '%s' "$idx"
+}
+resolve_merge_columns "$MUSICDB" L || exit 1
+resolve_merge_columns "$OTHER_DB" O || exit 1
+
+#############################################
+# Temp Files
+#############################################
+MERGE_TMP=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_merge.XXXXXX") || {
+    error_exit 2 "Cannot create temp directory"
+    exit 2
+}
+cleanup() { rm -rf "$MERGE_TMP" 2>/dev/null || true; }
+trap cleanup EXIT
+
+# Byte-order collation for sort(1) and awk string comparison, so both agree
+# on key order regardless of the user's locale.
+export LC_ALL=C
+
+#############################################
+# Merge
+#############################################
+
+# Print "<key>\t<row>" for every data row, sorted by key.
+# Usage: decorate_sorted <db> <pathcol> <root>
+decorate_sorted() {
+    local db="$1" pcol="$2" root="${3%/}"
+    awk -F'^' -v pcol="$pcol" -v root="$root/" -v rel="$RELATIVE" '
+        NR == 1 { next }
+        {
+            key = $pcol
+            if (rel == "true" && substr(key, 1, length(root)) == root)
+                key = substr(key, length(root) + 1)
+            print key "\t" $0
+        }
+    ' "$db" | sort -s -t $'\t' -k1,1 -S 25% -T "$MERGE_TMP"
+}
+
+# Write the merged DSV to $1 and the report to $REPORT_FILE.
+# Prints the summary counters on stdout as "name=value" lines.
+run_merge() {
+    local out="$1"
+
+    decorate_sorted "$MUSICDB" "$L_SongPath" "$LOCAL_ROOT" > "$MERGE_TMP/local.sorted" || return 2
+    decorate_sorted "$OTHER_DB" "$O_SongPath" "$OTHER_ROOT" > "$MERGE_TMP/other.sorted" || return 2
+
+    # The join emits "<ID>\t<row>" so the result can be put back into the
+    # local database's original ID order.
+    awk -F'\t' \
+        -v ofile="$MERGE_TMP/other.sorted" \
+        -v report="$REPORT_FILE" \
+        -v rule="$RATING_RULE" \
+        -v lid="$L_ID" -v lrat="$L_Rating" -v lgd="$L_GroupDesc" \
+        -v lltp="$L_LastTimePlayed" -v lc2="$L_Custom2" \
+        -v orat="$O_Rating" -v ogd="$O_GroupDesc" \
+        -v oltp="$O_LastTimePlayed" -v oc2="$O_Custom2" \
+        '
+        function next_other(    tab) {
+            if ((getline oline < ofile) > 0) {
+                tab = index(oline, "\t")
+                okey = substr(oline, 1, tab - 1)
+                split(substr(oline, tab + 1), of, "^")
+            } else {
+                oeof = 1
+                okey = ""
+            }
+        }
+        # Step past other rows whose key sorts before k, reporting those
+        # that never matched a local row
+        function drain_other_before(k) {
+            while (!oeof && (k == "" || okey < k)) {
+                if (omatched) {
+                    omatched = 0
+                } else if (okey == last_matched) {
+                    print "DUPLICATE\t" okey > report
+                    duplicates++
+                } else {
+                    print "OTHER_ONLY\t" okey > report
+                    other_only++
+                }
+                next_other()
+            }
+        }
+        function set_field(col, val, name,    old) {
+            old = lf[col]
+            if (old == val) return
+            lf[col] = val
+            print "UPDATE\t" key "\t" name "\t" old "\t" val > report
+            changed = 1
+        }
+        BEGIN { oeof = 0; omatched = 0; last_matched = "\001"; next_other() }
+        {
+            tab = index($0, "\t")
+            key = substr($0, 1, tab - 1)
+            row = substr($0, tab + 1)
+
+            drain_other_before(key)
+
+            if (oeof || okey != key) {
+                local_only++
+                print row_id(row) "\t" row
+                next
+            }
+
+            # Matched: merge other into a copy of the local fields
+            matched++
+            n = split(row, lf, "^")
+            changed = 0
+
+            l_ltp = lf[lltp] + 0; o_ltp = of[oltp] + 0
+            if (o_ltp > l_ltp) {
+                set_field(lltp, of[oltp], "LastTimePlayed")
+                ltp_updates++
+            }
+
+            l_gd = lf[lgd] + 0; o_gd = of[ogd] + 0
+            if ((lf[lrat] + 0) != (of[orat] + 0) || l_gd != o_gd) {
+                take = ""
+                if (l_gd == 0 && (lf[lrat] + 0) == 0)       take = "other"
+                else if (o_gd == 0 && (of[orat] + 0) == 0)  take = "local"
+                else {
+                    if (rule == "played")     take = (o_ltp > l_ltp) ? "other" : "local"
+                    else                      take = rule
+                    print "CONFLICT\t" key "\tRating\t" lf[lrat] "/" lf[lgd] "\t" of[orat] "/" of[ogd] "\t" take > report
+                    conflicts++
+                }
+                if (take == "other") {
+                    set_field(lrat, of[orat], "Rating")
+                    set_field(lgd, of[ogd], "GroupDesc")
+                    rating_updates++
+                }
+            }
+
+            if (lc2 > 0 && oc2 > 0 && lf[lc2] == "" && of[oc2] != "") {
+                set_field(lc2, of[oc2], "Custom2")
+                custom2_updates++
+            }
+
+            if (changed) {
+                updated++
+                out = lf[1]
+                for (i = 2; i <= n; i++) out = out "^" lf[i]
+                row = out
+            }
+            print row_id(row) "\t" row
+            last_matched = key
+            omatched = 1
+        }
+        function row_id(r,    f) {
+            split(r, f, "^")
+            return f[lid]
+        }
+        END {
+            drain_other_before("")
+            close(report)
+            printf "matched=%d\nupdated=%d\nlastplayed_updates=%d\nrating_updates=%d\n", matched, updated, ltp_updates, rating_updates > "/dev/stderr"
+            printf "custom2_updates=%d\nconflicts=%d\nlocal_only=%d\nother_only=%d\nduplicates=%d\n", custom2_updates, conflicts, local_only, other_only, duplicates > "/dev/stderr"
+        }
+        ' "$MERGE_TMP/local.sorted" 2> "$MERGE_TMP/summary" > "$MERGE_TMP/merged.keyed" || return 2
+
+    {
+        head -n 1 "$MUSICDB"
+        sort -t $'\t' -k1,1n -S 25% -T "$MERGE_TMP" "$MERGE_TMP/merged.keyed" | cut -f2-
+    } > "$out" || return 2
+
+    cat "$MERGE_TMP/summary"
+}
+
+# --apply: merge and replace under the lock, so no rating or scrobble
+# written while the merge runs is lost.
+apply_merge() {
+    local tmp="${MUSICDB}.tmp"
+    run_merge "$tmp" > "$MERGE_TMP/counters" || { rm -f "$tmp"; return 2; }
+    backup_database "$MUSICDB" > /dev/null || { rm -f "$tmp"; return 2; }
+    if ! mv "$tmp" "$MUSICDB" 2>/dev/null; then
+        rm -f "$tmp"
+        return 2
+    fi
+    publish_change "$MUSICDB" reload "" ""
+    cp "$MUSICDB" "$OUTPUT_FILE" 2>/dev/null || true
+}
+
+mkdir -p "$(dirname "$OUTPUT_FILE")" "$(dirname "$REPORT_FILE")" 2>/dev/null
+: > "$REPORT_FILE" || {
+    error_exit 2 "Cannot write report file" "path" "$REPORT_FILE"
+    exit 2
+}
+
+if [ "$APPLY" = true ]; then
+    with_db_lock "$LOCK_TIMEOUT" apply_merge
+    rc=$?
+    if [ "$rc" -eq 1 ]; then
+        error_exit 2 "Database lock timeout" "database" "$MUSICDB" "timeout" "${LOCK_TIMEOUT}s"
+        exit 2
+    elif [ "$rc" -ne 0 ]; then
+        error_exit 2 "Merge failed" "database" "$MUSICDB" "other" "$OTHER_DB"
+        exit 2
+    fi
+else
+    if ! run_merge "$OUTPUT_FILE" > "$MERGE_TMP/counters"; then
+        error_exit 2 "Merge failed" "database" "$MUSICDB" "other" "$OTHER_DB"
+        exit 2
+    fi
+fi
+
+#############################################
+# Summary
+#############################################
+# shellcheck disable=SC1091
+source "$MERGE_TMP/counters"
+
+log_message "DB merge from $OTHER_DB: matched=$matched updated=$updated conflicts=$conflicts applied=$APPLY" >/dev/null
+
+printf '{"status": "ok", "applied": %s, "matched": %d, "updated": %d, "lastplayed_updates": %d, "rating_updates": %d, "custom2_updates": %d, "conflicts": %d, "local_only": %d, "other_only": %d, "duplicates": %d, "output": "%s", "report": "%s"}\n' \
+    "$APPLY" "$matched" "$updated" "$lastplayed_updates" "$rating_updates" \
+    "$custom2_updates" "$conflicts" "$local_only" "$other_only" "$duplicates" \
+    "$OUTPUT_FILE" "$REPORT_FILE"
+exit 0
@@ -1,9 +1,11 @@
 #!/bin/bash
 #
 # musiclib_edit_field.sh - Edit a single metadata field in a database record
-# Usage: musiclib_edit_field.sh <record_id> <field_name> <new_value>
+# Usage: musiclib_edit_field.sh <record_id> <field_name> <new_value> [song_path]
 #
 # Updates the named field for the record with the given ID in the DSV database.
+# Record IDs are only unique within one DSV; when LIBRARY_SHARDS is configured,
+# pass the record's SongPath so the edit goes to the shard that owns it.
 # For most fields only the DSV record is changed.
 # Exception — Custom2: the Songs-DB_Custom2 tag is also written to the audio
 # file via kid3-cli so the value survives a full database rebuild.
@@ -45,7 +47,7 @@ MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
 #############################################
 
 if [ $# -lt 3 ]; then
-    echo "Usage: $0 <record_id> <field_name> <new_value>"
+    echo "Usage: $0 <record_id> <field_name> <new_value> [song_path]"
     echo ""
     echo "Supported field names: Artist, Album, AlbumArtist, SongTitle, Genre, Custom2"
     exit 1
@@ -54,6 +56,11 @@ fi
 RECORD_ID="$1"
 FIELD_NAME="$2"
 NEW_VALUE="$3"
+SONG_PATH="${4:-}"
+
+if [ -n "$SONG_PATH" ]; then
+    MUSICDB=$(shard_db_for_path "$SONG_PATH")
+fi
 
 if [ -z "$RECORD_ID" ]; then
     error_exit 1 "Record ID cannot be empty"
@@ -101,6 +108,11 @@ do_edit() {
         return 1
     fi
 
+    # Old value and path, for the change feed
+    local pathcol old_row
+    pathcol=$(get_column_index "$MUSICDB" "SongPath") || return 2
+    old_row=$(awk -F'^' -v id="$RECORD_ID" 'NR > 1 && $1 == id { print; exit }' "$MUSICDB")
+
     # Update the field — match by ID in column 1, leave header (NR==1) untouched
     if ! awk -F'^' -v OFS='^' \
         -v record_id="$RECORD_ID" \
@@ -119,6 +131,8 @@ do_edit() {
         return 2
     fi
 
+    publish_change "$MUSICDB" update "$RECORD_ID" "$(cut -f"$pathcol" -d'^' <<< "$old_row")" \
+        "$FIELD_NAME" "$(cut -f"$colnum" -d'^' <<< "$old_row")" "$NEW_VALUE"
     return 0
 }
 
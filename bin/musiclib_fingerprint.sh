@@ -0,0 +1,500 @@
+#!/bin/bash
+#
+# musiclib_fingerprint.sh - Acoustic fingerprints for finding transcodes
+# Usage: musiclib_fingerprint.sh build [options]
+#        musiclib_fingerprint.sh match [FILE...] [options]
+#
+#   build          Fingerprint new and changed tracks into <dsv>.fingerprints
+#   match          List groups of tracks that are the same recording
+#   match FILE...  List the library tracks that are the same recording as
+#                  FILE (e.g. before importing it)
+#
+# Payload hashes (see FILE IDENTITIES in musiclib_db.sh) only recognise
+# byte-identical audio.  The same recording at another bitrate or from
+# another rip decodes to almost the same sound, which Chromaprint's
+# fingerprint captures: fpcalc -raw gives one 32-bit sub-fingerprint per
+# ~0.12 s of audio, and two encodings of one recording differ in only a
+# few percent of those bits.
+#
+# build runs fpcalc over the first FINGERPRINT_SECONDS of every track whose
+# device, inode, size or mtime changed since the last run, FINGERPRINT_JOBS
+# at a time.  The sidecar next to each shard DSV holds, sorted by path:
+#
+#   PATH<TAB>DEV:INODE<TAB>SIZE<TAB>MTIME<TAB>DURATION<TAB>FINGERPRINT
+#
+# FINGERPRINT is the sub-fingerprints as little-endian uint32, base64
+# encoded (empty if the file could not be decoded).
+#
+# match finds candidates without comparing all pairs.  Each track's sketch
+# is the sub-fingerprints whose hash falls in a fixed 1/8 of the hash
+# space; every sketch value is a bucket, and only tracks sharing a bucket
+# (skipping buckets held by more than 50 tracks, e.g. silence) of similar
+# duration are compared.  A candidate pair is aligned on the offset its
+# shared values agree on and scored as 1 - bit error rate; pairs at or
+# above --threshold are joined with union-find.
+#
+# Output: TSV, one line per track of every group with more than one track:
+#   group<TAB>similarity<TAB>ID<TAB>Artist<TAB>SongTitle<TAB>size<TAB>path
+# The largest file of a group comes first; similarity is to that file.
+# Files given to match that are not in the database have ID "-".
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard, file not found)
+#   2 - System error (config failure, database not found, fpcalc or
+#       python3 missing, sidecar write failure)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_fingerprint.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_fingerprint.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli fingerprint build [options]
+       musiclib-cli fingerprint match [FILE...] [options]
+
+Find tracks that are the same recording in another encoding (transcodes,
+other bitrates, other rips) by their acoustic fingerprint.
+
+Subcommands:
+  build           Fingerprint new and changed tracks (incremental)
+  match           List groups of tracks that are the same recording
+  match FILE...   List library tracks that are the same recording as FILE
+
+Options:
+  --threshold T   Similarity (1 - bit error rate) needed to group two
+                  tracks, 0-1 (default: 0.8)
+  --rebuild       build: fingerprint every track again
+  -j JOBS         Parallel fpcalc processes (default: FINGERPRINT_JOBS,
+                  else the number of CPUs)
+  -o FILE         match: write the groups to FILE instead of stdout
+  -d FILE         Database to use (default: every library shard)
+  --shard NAME    Use the named library shard only
+  -q              build: no progress output
+  -h, --help      Display this help
+
+Output format (TSV, lines starting with # are comments):
+  group   similarity   ID   artist   title   size   path
+
+Examples:
+  musiclib-cli fingerprint build -j 8
+  musiclib-cli fingerprint match -o ~/duplicates.tsv
+  musiclib-cli fingerprint match ~/Downloads/track.mp3
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+SUBCOMMAND=""
+QUERY_FILES=()
+THRESHOLD="0.8"
+REBUILD=false
+QUIET=false
+JOBS="${FINGERPRINT_JOBS:-}"
+OUTPUT_FILE=""
+TARGET_DB=""
+TARGET_SHARD=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        --threshold|-j|-o|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --threshold) THRESHOLD="$2" ;;
+                -j)          JOBS="$2" ;;
+                -o)          OUTPUT_FILE="$2" ;;
+                -d)          TARGET_DB="$2" ;;
+                --shard)     TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --rebuild)
+            REBUILD=true
+            shift
+            ;;
+        -q)
+            QUIET=true
+            shift
+            ;;
+        -*)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+        *)
+            if [ -z "$SUBCOMMAND" ]; then
+                SUBCOMMAND="$1"
+            elif [ "$SUBCOMMAND" = "match" ]; then
+                QUERY_FILES+=("$1")
+            else
+                error_exit 1 "Unexpected argument" "argument" "$1"
+                exit 1
+            fi
+            shift
+            ;;
+    esac
+done
+
+case "$SUBCOMMAND" in
+    build|match) ;;
+    "")
+        show_usage >&2
+        error_exit 1 "No subcommand given (build or match)"
+        exit 1
+        ;;
+    *)
+        error_exit 1 "Unknown subcommand (must be build or match)" "subcommand" "$SUBCOMMAND"
+        exit 1
+        ;;
+esac
+
+if ! [[ "$THRESHOLD" =~ ^(0(\.[0-9]+)?|1(\.0+)?)$ ]]; then
+    error_exit 1 "--threshold must be between 0 and 1" "threshold" "$THRESHOLD"
+    exit 1
+fi
+
+JOBS="${JOBS:-$(nproc 2>/dev/null || echo 2)}"
+if ! [[ "$JOBS" =~ ^[1-9][0-9]*$ ]]; then
+    error_exit 1 "-j must be a positive integer" "jobs" "$JOBS"
+    exit 1
+fi
+
+FP_SECONDS="${FINGERPRINT_SECONDS:-60}"
+if ! [[ "$FP_SECONDS" =~ ^[1-9][0-9]*$ ]]; then
+    FP_SECONDS=60
+fi
+
+for f in ${QUERY_FILES[@]+"${QUERY_FILES[@]}"}; do
+    if [ ! -f "$f" ]; then
+        error_exit 1 "File not found" "filepath" "$f"
+        exit 1
+    fi
+done
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+if ! command -v fpcalc >/dev/null 2>&1 || ! command -v python3 >/dev/null 2>&1; then
+    error_exit 2 "fpcalc (Chromaprint) and python3 are required for fingerprints" "tools" "fpcalc python3"
+    exit 2
+fi
+
+for db in "${TARGETS[@]}"; do
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+done
+
+#############################################
+# Fingerprinting
+#############################################
+# Files per worker invocation: amortises bash start-up, small enough to
+# keep every job busy
+BATCH_SIZE=16
+
+WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_fingerprint.XXXXXX") || {
+    error_exit 2 "Cannot create work directory"
+    exit 2
+}
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# PATH<TAB>DURATION<TAB>sub-fingerprints (comma-separated) -> the same with
+# the sub-fingerprints packed as base64 little-endian uint32
+FP_PACK_PY='
+import base64, struct, sys
+with open(sys.argv[1], encoding="utf-8", errors="surrogateescape") as src:
+    out = sys.stdout
+    for line in src:
+        f = line.rstrip("\n").split("\t")
+        if len(f) != 3:
+            continue
+        vals = [int(v) & 0xFFFFFFFF for v in f[2].split(",") if v.lstrip("-").isdigit()]
+        fp = base64.b64encode(struct.pack("<%dI" % len(vals), *vals)).decode() if vals else ""
+        out.write("%s\t%s\t%s\n" % (f[0], f[1], fp))
+'
+
+# Fingerprint the files named on stdin (NUL-separated) with JOBS parallel
+# workers; print "PATH<TAB>DURATION<TAB>FINGERPRINT" for each.
+fingerprint_files() {
+    parallel_parts "$WORK_DIR" "$JOBS" "$BATCH_SIZE" '
+        secs="$1"
+        shift
+        for f; do
+            out=$(fpcalc -raw -length "$secs" "$f" 2>/dev/null) || out=""
+            dur=$(sed -n "s/^DURATION=//p" <<< "$out")
+            fp=$(sed -n "s/^FINGERPRINT=//p" <<< "$out")
+            printf "%s\t%s\t%s\n" "$f" "${dur:-0}" "$fp"
+        done
+    ' "$FP_SECONDS" > "$WORK_DIR/raw" || : > "$WORK_DIR/raw"
+    LC_ALL=C python3 -c "$FP_PACK_PY" "$WORK_DIR/raw"
+}
+
+# Bring <db>.fingerprints up to date.  Only files whose identity changed
+# are decoded; rows no longer in the DSV are dropped.
+update_fingerprints() {
+    local db="$1"
+    local sidecar="${db}.fingerprints"
+    local kept_count todo_count old_count
+
+    # PATH<TAB>DEV:INODE<TAB>SIZE<TAB>MTIME for every row whose file exists
+    sidecar_stat_current "$db" $'%n\t%d:%i\t%s\t%Y' > "$WORK_DIR/current" || return 2
+
+    if [ "$REBUILD" = true ] || [ ! -f "$sidecar" ]; then
+        sidecar_split "" "$WORK_DIR/current" "$WORK_DIR/kept" "$WORK_DIR/todo"
+        old_count=-1
+    else
+        sidecar_split "$sidecar" "$WORK_DIR/current" "$WORK_DIR/kept" "$WORK_DIR/todo"
+        old_count=$(wc -l < "$sidecar")
+    fi
+    kept_count=$(wc -l < "$WORK_DIR/kept")
+    todo_count=$(wc -l < "$WORK_DIR/todo")
+
+    if [ "$todo_count" -eq 0 ] && [ "$kept_count" -eq "$old_count" ]; then
+        [ "$QUIET" = true ] || echo "$db: fingerprints up to date ($kept_count tracks)"
+        return 0
+    fi
+
+    [ "$QUIET" = true ] || [ "$todo_count" -eq 0 ] ||
+        echo "$db: fingerprinting $todo_count tracks ($JOBS jobs)..."
+    tr '\n' '\0' < "$WORK_DIR/todo" | fingerprint_files |
+        LC_ALL=C awk -F'\t' -v OFS='\t' '
+            FNR == NR { id[$1] = $2 "\t" $3 "\t" $4; next }
+            ($1 in id) && !($1 in done) { done[$1] = 1; print $1, id[$1], $2, $3 }
+        ' "$WORK_DIR/current" - > "$WORK_DIR/new" || return 2
+
+    LC_ALL=C sort -t $'\t' -k1,1 "$WORK_DIR/kept" "$WORK_DIR/new" > "$sidecar.tmp.$$" &&
+        mv "$sidecar.tmp.$$" "$sidecar" || { rm -f "$sidecar.tmp.$$"; return 2; }
+
+    [ "$QUIET" = true ] ||
+        echo "$db: fingerprints updated ($todo_count computed, $(wc -l < "$sidecar") tracks)"
+    log_message "Fingerprints updated for $db: $todo_count files decoded" > /dev/null
+}
+
+# Update every target shard; a shard whose update is already running is
+# left to that run
+build_all() {
+    local db lock rc=0
+    for db in "${TARGETS[@]}"; do
+        exec {lock}> "${db}.fingerprints.lock" || { rc=2; continue; }
+        if ! flock -n "$lock"; then
+            [ "$QUIET" = true ] || echo "$db: fingerprint update already running"
+            exec {lock}>&-
+            continue
+        fi
+        if ! update_fingerprints "$db"; then
+            error_exit 2 "Failed to update fingerprints" "database" "$db"
+            rc=2
+        fi
+        exec {lock}>&-
+    done
+    return "$rc"
+}
+
+#############################################
+# Matching
+#############################################
+# argv: threshold, query sidecar ("" for none), then DSV paths.  Reads
+# each DSV and its .fingerprints sidecar; prints the groups.
+FP_MATCH_PY='
+import base64, os, struct, sys
+from collections import defaultdict
+
+threshold = float(sys.argv[1])
+query_sidecar = sys.argv[2]
+dsvs = sys.argv[3:]
+
+SAMPLE = 8          # 1 in SAMPLE sub-fingerprints goes into the sketch
+MAX_BUCKET = 50     # buckets held by more tracks are not informative
+MAX_LENGTH_DIFF = 10  # seconds
+
+def mix(v):
+    # Cheap integer hash, so the sample does not depend on the raw bits
+    v = (v * 0x9E3779B1) & 0xFFFFFFFF
+    return v ^ (v >> 15)
+
+paths, durations, prints, rows = [], [], [], {}
+index = {}
+query = set()
+
+def load(sidecar, is_query):
+    try:
+        src = open(sidecar, encoding="utf-8", errors="surrogateescape")
+    except OSError:
+        return
+    with src:
+        for line in src:
+            f = line.rstrip("\n").split("\t")
+            if len(f) != 6 or not f[5]:
+                continue
+            if f[0] in index:
+                # A library file given to match: match it in place
+                if is_query:
+                    query.add(index[f[0]])
+                continue
+            raw = base64.b64decode(f[5])
+            if is_query:
+                query.add(len(paths))
+            index[f[0]] = len(paths)
+            paths.append(f[0])
+            durations.append(int(f[4] or 0))
+            prints.append(struct.unpack("<%dI" % (len(raw) // 4), raw))
+
+for dsv in dsvs:
+    with open(dsv, encoding="utf-8", errors="surrogateescape") as src:
+        header = src.readline().rstrip("\n").split("^")
+        col = {name: i for i, name in enumerate(header)}
+        need = [col.get(n) for n in ("ID", "Artist", "SongTitle", "SongPath")]
+        if None in need:
+            continue
+        for line in src:
+            f = line.rstrip("\n").split("^")
+            if len(f) > need[3]:
+                rows[f[need[3]]] = (f[need[0]], f[need[1]], f[need[2]])
+    load(dsv + ".fingerprints", False)
+if query_sidecar:
+    load(query_sidecar, True)
+
+# Sketches and buckets: value -> tracks, and per track value -> position
+sketch = []
+buckets = defaultdict(list)
+for t, fp in enumerate(prints):
+    s = {}
+    for pos, v in enumerate(fp):
+        if mix(v) % SAMPLE == 0 and v not in s:
+            s[v] = pos
+    sketch.append(s)
+    for v in s:
+        buckets[v].append(t)
+
+def similarity(a, b, offsets):
+    fa, fb = prints[a], prints[b]
+    best = 0.0
+    for off in offsets:
+        # fa[i] aligned with fb[i - off]
+        lo, hi = max(0, off), min(len(fa), len(fb) + off)
+        n = hi - lo
+        if n < 16:
+            continue
+        errors = sum(bin(fa[i] ^ fb[i - off]).count("1") for i in range(lo, hi))
+        best = max(best, 1.0 - errors / (32.0 * n))
+    return best
+
+parent = list(range(len(prints)))
+def find(x):
+    while parent[x] != x:
+        parent[x] = parent[parent[x]]
+        x = parent[x]
+    return x
+
+for a in range(len(prints)):
+    votes = defaultdict(lambda: defaultdict(int))
+    for v, pa in sketch[a].items():
+        tracks = buckets[v]
+        if len(tracks) > MAX_BUCKET:
+            continue
+        for b in tracks:
+            if b > a:
+                votes[b][pa - sketch[b][v]] += 1
+    for b, offs in votes.items():
+        if find(a) == find(b) or abs(durations[a] - durations[b]) > MAX_LENGTH_DIFF:
+            continue
+        off = max(offs, key=offs.get)
+        if similarity(a, b, (off - 1, off, off + 1)) >= threshold:
+            parent[find(b)] = find(a)
+
+groups = defaultdict(list)
+for t in range(len(prints)):
+    groups[find(t)].append(t)
+
+def size(t):
+    try:
+        return os.path.getsize(paths[t])
+    except OSError:
+        return 0
+
+out = sys.stdout
+n = 0
+for members in sorted(groups.values(), key=lambda m: min(paths[t] for t in m)):
+    if len(members) < 2 or (query and not query.intersection(members)):
+        continue
+    n += 1
+    members.sort(key=lambda t: (-size(t), paths[t]))
+    head = members[0]
+    for t in members:
+        sim = 1.0 if t == head else similarity(head, t, range(-8, 9))
+        # A library file given as a query keeps its row; outside files have none
+        row = rows.get(paths[t], ("-", "", ""))
+        out.write("%d\t%.3f\t%s\t%s\t%s\t%d\t%s\n" % (n, sim, row[0], row[1], row[2], size(t), paths[t]))
+'
+
+match_all() {
+    local query_sidecar="" groups
+    local -a dsvs=()
+
+    # Fingerprints are only as fresh as the last build; bring them up to
+    # date first (cheap when nothing changed)
+    QUIET=true build_all || return 2
+
+    for db in "${TARGETS[@]}"; do
+        dsvs+=("$db")
+    done
+
+    if [ ${#QUERY_FILES[@]} -gt 0 ]; then
+        query_sidecar="$WORK_DIR/query.fingerprints"
+        printf '%s\0' "${QUERY_FILES[@]}" | fingerprint_files |
+            awk -F'\t' -v OFS='\t' '{ print $1, "", "", "", $2, $3 }' > "$query_sidecar" || return 2
+    fi
+
+    groups=$(LC_ALL=C python3 -c "$FP_MATCH_PY" "$THRESHOLD" "$query_sidecar" "${dsvs[@]}") || {
+        error_exit 2 "Fingerprint matching failed"
+        return 2
+    }
+    {
+        echo "# musiclib fingerprint: same recording (threshold $THRESHOLD)"
+        printf '# group\tsimilarity\tID\tartist\ttitle\tsize\tpath\n'
+        if [ -n "$groups" ]; then printf '%s\n' "$groups"; fi
+    } > "${OUTPUT_FILE:-/dev/stdout}" || {
+        error_exit 2 "Cannot write groups" "path" "$OUTPUT_FILE"
+        return 2
+    }
+    if [ -n "$OUTPUT_FILE" ]; then
+        echo "Wrote $(printf '%s' "$groups" | cut -f1 | sort -u | grep -c .) groups to $OUTPUT_FILE"
+    fi
+}
+
+#############################################
+# Main
+#############################################
+case "$SUBCOMMAND" in
+    build) build_all ;;
+    match) match_all ;;
+esac
+exit $?
@@ -4,10 +4,10 @@
 #
 # Usage: musiclib-cli mobile upload <playlist.audpl> [device_id] [--non-interactive] [--end-time "MM/DD/YYYY HH:MM:SS"] [--end-track N]
 #        musiclib-cli mobile update-lastplayed <playlist_name> [--end-time "MM/DD/YYYY HH:MM:SS"] [--end-track N]
-#        musiclib-cli mobile retry <playlist_name>
+#        musiclib-cli mobile retry <playlist_name> | --all
 #        musiclib-cli mobile refresh-player-playlists
 #        musiclib-cli mobile status
-#        musiclib-cli mobile logs [filter]
+#        musiclib-cli mobile logs [errors|warnings|stats|today|YYYY-MM-DD]
 #        musiclib-cli mobile cleanup
 #        musiclib-cli mobile check-update <playlist_name>
 #
@@ -73,46 +73,185 @@ SKIP_ACCOUNTING=false
 END_TRACK=0          # 0 = no truncation; >0 = log only first N tracks of old playlist
 
 #############################################
-# Mobile-specific logging
+# Mobile operations store
 #############################################
+#
+# Every mobile operation is recorded in an append-only store instead of a
+# rotated flat log, so history is kept for as long as the library lives:
+#
+#   ops/YYYY-MM-DD.ops   every record of that day        (time partition)
+#   ops/<LEVEL>.idx      every ERROR, WARN or STATS record (type index)
+#
+# A record is one line, "YYYY-MM-DD HH:MM:SS^LEVEL^OPERATION^MESSAGE", and
+# is appended with single O_APPEND writes, so concurrent runs never take a
+# lock and logging never forks.  "logs today" reads one day file, "logs
+# errors" the tail of one index file, and "logs" only the newest day files,
+# whatever the size of the history.
+#
+# Outstanding recovery files are listed in $MOBILE_DIR/recovery.index
+# ("PLAYLIST^PENDING^FAILED^UPDATED", see mobile_recovery_update), which
+# status, "retry --all" and the GUI read instead of globbing and counting
+# the .pending_tracks and .failed files.
 MOBILE_LOG_DIR="${XDG_DATA_HOME:-$HOME/.local/share}/musiclib/logs/mobile"
-MOBILE_LOG_FILE="$MOBILE_LOG_DIR/mobile_operations.log"
+MOBILE_OPS_DIR="$MOBILE_LOG_DIR/ops"
+MOBILE_OPS_INDEXED=" ERROR WARN STATS "
+MOBILE_RECOVERY_INDEX="$MOBILE_DIR/recovery.index"
+
+# Import the flat logs of earlier versions (mobile_operations.log and its
+# rotated copies) the first time the store is opened.  They are left in
+# place; the store is built aside and moved in, so an interrupted import
+# is simply redone.
+mobile_ops_init() {
+    [ -d "$MOBILE_OPS_DIR" ] && return 0
+    mkdir -p "$MOBILE_LOG_DIR" || return 1
+
+    local legacy="$MOBILE_LOG_DIR/mobile_operations.log"
+    local work="$MOBILE_OPS_DIR.tmp.$$"
+    local -a sources=()
+    local f
+    for f in "$legacy".*; do
+        [ -f "$f" ] && sources+=("$f")
+    done
+    [ -f "$legacy" ] && sources+=("$legacy")
+
+    mkdir -p "$work" || return 1
+    if [ "${#sources[@]}" -gt 0 ]; then
+        awk -v dir="$work" -v indexed="$MOBILE_OPS_INDEXED" '
+            match($0, /^\[[0-9-]+ [0-9:]+\] \[[A-Z]+\] \[[^]]*\] /) {
+                head = substr($0, 1, RLENGTH - 1)
+                msg = substr($0, RLENGTH + 1)
+                n = split(head, f, /\] \[/)
+                ts = substr(f[1], 2); level = f[2]; op = substr(f[3], 1, length(f[3]) - 1)
+                rec = ts "^" level "^" op "^" msg
+                day = dir "/" substr(ts, 1, 10) ".ops"
+                if (day != last) { if (last != "") close(last); last = day }
+                print rec >> day
+                if (index(indexed, " " level " ")) print rec >> (dir "/" level ".idx")
+            }
+        ' "${sources[@]}"
+    fi
+    # -T: if a concurrent first run got there first, fail and use its
+    # store rather than moving ours inside it as a subdirectory
+    mv -T "$work" "$MOBILE_OPS_DIR" 2>/dev/null || rm -rf "$work"
+    [ -d "$MOBILE_OPS_DIR" ]
+}
 
-# Ensure log directory exists
-mkdir -p "$MOBILE_LOG_DIR"
+mobile_ops_init
 
 # Mobile logging function
 mobile_log() {
     local level="$1"
     local operation="$2"
-    local message="$3"
-    local timestamp=$(date '+%Y-%m-%d %H:%M:%S')
+    local message="${3//$'\n'/ }"
+    local timestamp record
+
+    printf -v timestamp '%(%Y-%m-%d %H:%M:%S)T' -1
+    record="$timestamp^$level^$operation^$message"
+    printf '%s\n' "$record" >> "$MOBILE_OPS_DIR/${timestamp:0:10}.ops"
+    case "$MOBILE_OPS_INDEXED" in
+        *" $level "*) printf '%s\n' "$record" >> "$MOBILE_OPS_DIR/$level.idx" ;;
+    esac
+
+    # Also write the main log and the event journal, keeping the level
+    local event_level
+    case "$level" in
+        ERROR) event_level=error ;;
+        WARN)  event_level=warn ;;
+        DEBUG) event_level=debug ;;
+        *)     event_level=info ;;
+    esac
+    log_message_as "$event_level" "mobile/${operation,,}" "[MOBILE] [$operation] $message"
+}
 
-    echo "[$timestamp] [$level] [$operation] $message" >> "$MOBILE_LOG_FILE"
+# Print store records (stdin) as "[TIME] [LEVEL] [OPERATION] message".
+mobile_ops_format() {
+    awk -F'^' '{
+        msg = $0
+        sub(/^[^^]*\^[^^]*\^[^^]*\^/, "", msg)
+        print "[" $1 "] [" $2 "] [" $3 "] " msg
+    }'
+}
 
-    # Also use main log_message if available
-    if command -v log_message >/dev/null 2>&1; then
-        log_message "[MOBILE] [$operation] $message"
-    fi
+# Print the last <count> records of the whole store, oldest first.  Only
+# the newest day files are read.
+# Usage: mobile_ops_tail <count>
+mobile_ops_tail() {
+    local count="$1" lines=0 i n
+    local -a days=() files=()
+    days=("$MOBILE_OPS_DIR"/????-??-??.ops)
+    [ -f "${days[0]}" ] || return 0
+    for (( i = ${#days[@]} - 1; i >= 0 && lines < count; i-- )); do
+        files=("${days[i]}" "${files[@]}")
+        n=$(wc -l < "${days[i]}")
+        lines=$((lines + n))
+    done
+    cat "${files[@]}" | tail -n "$count" | mobile_ops_format
+}
+
+# Print the last <count> records of one indexed level, oldest first.
+# Usage: mobile_ops_level <ERROR|WARN|STATS> <count>
+mobile_ops_level() {
+    local idx="$MOBILE_OPS_DIR/$1.idx"
+    [ -s "$idx" ] || return 1
+    tail -n "$2" "$idx" | mobile_ops_format
 }
 
-# Rotate mobile log if it exceeds 10MB
-rotate_mobile_log() {
-    if [ -f "$MOBILE_LOG_FILE" ]; then
-        local size=$(stat -c%s "$MOBILE_LOG_FILE" 2>/dev/null || echo 0)
-        if [ $size -gt 10485760 ]; then  # 10MB
-            local timestamp=$(date '+%Y%m%d_%H%M%S')
-            mv "$MOBILE_LOG_FILE" "${MOBILE_LOG_FILE}.${timestamp}"
-            mobile_log "INFO" "ROTATE" "Log rotated to mobile_operations.log.${timestamp}"
-
-            # Keep only last 5 rotated logs
-            ls -t "${MOBILE_LOG_FILE}".* 2>/dev/null | tail -n +6 | xargs rm -f 2>/dev/null || true
+# Print every record of one day.
+# Usage: mobile_ops_day <YYYY-MM-DD>
+mobile_ops_day() {
+    local day="$MOBILE_OPS_DIR/$1.ops"
+    [ -s "$day" ] || return 1
+    mobile_ops_format < "$day"
+}
+
+# Record the recovery state of a playlist after its .pending_tracks or
+# .failed file was written, rewritten or removed.  Playlists with nothing
+# left to retry are dropped from the index.
+# Usage: mobile_recovery_update <playlist_name>
+mobile_recovery_update() {
+    local playlist="$1" pending=0 failed=0 updated
+    [ -f "$MOBILE_DIR/${playlist}.pending_tracks" ] && pending=$(wc -l < "$MOBILE_DIR/${playlist}.pending_tracks")
+    [ -f "$MOBILE_DIR/${playlist}.failed" ] && failed=$(wc -l < "$MOBILE_DIR/${playlist}.failed")
+    printf -v updated '%(%Y-%m-%d %H:%M:%S)T' -1
+
+    mobile_recovery_index_ensure || return 1
+    {
+        awk -F'^' -v pl="$playlist" '$1 != pl' "$MOBILE_RECOVERY_INDEX"
+        if [ $((pending + failed)) -gt 0 ]; then
+            printf '%s^%d^%d^%s\n' "$playlist" "$pending" "$failed" "$updated"
         fi
-    fi
+    } > "$MOBILE_RECOVERY_INDEX.tmp.$$" &&
+        mv "$MOBILE_RECOVERY_INDEX.tmp.$$" "$MOBILE_RECOVERY_INDEX" ||
+        { rm -f "$MOBILE_RECOVERY_INDEX.tmp.$$"; return 1; }
 }
 
-# Rotate log at startup
-rotate_mobile_log
+# Create the recovery index from the recovery files on disk if it does not
+# exist yet (first run after upgrading, or after it was deleted).
+mobile_recovery_index_ensure() {
+    [ -f "$MOBILE_RECOVERY_INDEX" ] && return 0
+    [ -d "$MOBILE_DIR" ] || mkdir -p "$MOBILE_DIR" || return 1
+
+    local f name pending failed updated
+    local -A seen=()
+    {
+        for f in "$MOBILE_DIR"/*.pending_tracks "$MOBILE_DIR"/*.failed; do
+            [ -f "$f" ] || continue
+            name=$(basename "$f")
+            name="${name%.pending_tracks}"
+            name="${name%.failed}"
+            [ -n "${seen[$name]:-}" ] && continue
+            seen[$name]=1
+            pending=0
+            failed=0
+            [ -f "$MOBILE_DIR/${name}.pending_tracks" ] && pending=$(wc -l < "$MOBILE_DIR/${name}.pending_tracks")
+            [ -f "$MOBILE_DIR/${name}.failed" ] && failed=$(wc -l < "$MOBILE_DIR/${name}.failed")
+            updated=$(date -r "$f" '+%Y-%m-%d %H:%M:%S')
+            printf '%s^%d^%d^%s\n' "$name" "$pending" "$failed" "$updated"
+        done
+    } > "$MOBILE_RECOVERY_INDEX.tmp.$$" &&
+        mv "$MOBILE_RECOVERY_INDEX.tmp.$$" "$MOBILE_RECOVERY_INDEX" ||
+        { rm -f "$MOBILE_RECOVERY_INDEX.tmp.$$"; return 1; }
+}
 
 #############################################
 # Playlist sync functions
@@ -379,6 +518,8 @@ _do_process_track_loop() {
             continue
         fi
         mv "$MUSICDB.tmp" "$MUSICDB"
+        publish_change "$MUSICDB" update "${row_data%%^*}" "$filepath" \
+            LastTimePlayed "$current_lp" "$synthetic_sql"
 
         # Update tag using kid3-cli with repair on failure
         if ! $KID3_CMD -c "set Songs-DB_Custom1 $synthetic_sql" "$filepath" 2>/dev/null; then
@@ -580,6 +721,9 @@ process_previous_playlist() {
     else
         rm -f "$temp_failed"
     fi
+    if [ "$has_pending" = true ] || [ "$has_failed" = true ]; then
+        mobile_recovery_update "$prev_playlist"
+    fi
 
     # Summary line
     local summary="$updated updated"
@@ -760,6 +904,9 @@ _do_retry_loop() {
                 "$MUSICDB" > "$MUSICDB.tmp" 2>/dev/null; then
 
                 mv "$MUSICDB.tmp" "$MUSICDB"
+                row_data="${grepped_string#*:}"
+                publish_change "$MUSICDB" update "${row_data%%^*}" "$filepath" \
+                    LastTimePlayed "$(cut -f"$lpcolnum" -d'^' <<< "$row_data")" "$synthetic_sql"
 
                 # Attempt tag write
                 if $KID3_CMD -c "set Songs-DB_Custom1 $synthetic_sql" "$filepath" 2>/dev/null; then
@@ -801,6 +948,9 @@ _do_retry_loop() {
                 "$MUSICDB" > "$MUSICDB.tmp" 2>/dev/null; then
 
                 mv "$MUSICDB.tmp" "$MUSICDB"
+                row_data="${grepped_string#*:}"
+                publish_change "$MUSICDB" update "${row_data%%^*}" "$filepath" \
+                    LastTimePlayed "$(cut -f"$lpcolnum" -d'^' <<< "$row_data")" "$synthetic_sql"
 
                 if $KID3_CMD -c "set Songs-DB_Custom1 $synthetic_sql" "$filepath" 2>/dev/null; then
                     echo "ACCOUNTING: Retry success — $(basename "$filepath") -> $synthetic_human"
@@ -892,6 +1042,7 @@ retry_playlist() {
     else
         rm -f "$temp_still_failed" "$failed_file"
     fi
+    mobile_recovery_update "$playlist_name"
 
     # Summary
     echo ""
@@ -1087,15 +1238,16 @@ Commands:
   update-lastplayed <playlist_name>
       Manually trigger last-played time updates for a playlist.
 
-  retry <playlist_name>
-      Re-process tracks from .pending_tracks or .failed recovery files.
+  retry <playlist_name> | --all
+      Re-process tracks from .pending_tracks or .failed recovery files,
+      for one playlist or every playlist in the recovery index.
 
   status
       Show current mobile playlist tracking status.
 
   logs [filter]
       View mobile operations log.
-      Filters: errors, warnings, stats, today
+      Filters: errors, warnings, stats, today, or a date (YYYY-MM-DD)
 
   cleanup
       Remove orphaned metadata files from mobile directory.
@@ -1130,6 +1282,7 @@ Examples:
   musiclib_mobile.sh refresh-player-playlists
   musiclib_mobile.sh update-lastplayed workout
   musiclib_mobile.sh retry workout
+  musiclib_mobile.sh retry --all
   musiclib_mobile.sh status
   musiclib_mobile.sh logs errors
   musiclib_mobile.sh cleanup
@@ -1226,6 +1379,25 @@ case "$COMMAND" in
             error_exit 1 "Missing playlist name argument"
             exit 1
         fi
+        if [ "$2" = "--all" ]; then
+            # Every playlist in the recovery index, each in its own subshell
+            # because retry_playlist exits when it is done
+            if ! mobile_recovery_index_ensure; then
+                error_exit 2 "Cannot read recovery index" "index" "$MOBILE_RECOVERY_INDEX"
+                exit 2
+            fi
+            mapfile -t candidates < <(cut -d'^' -f1 "$MOBILE_RECOVERY_INDEX")
+            if [ "${#candidates[@]}" -eq 0 ]; then
+                echo "No recovery files (all accounting clean)"
+                exit 0
+            fi
+            retry_rc=0
+            for candidate in "${candidates[@]}"; do
+                echo "ACCOUNTING: Retrying $candidate"
+                ( retry_playlist "$candidate" ) || retry_rc=$?
+            done
+            exit "$retry_rc"
+        fi
         retry_playlist "$2"
         ;;
 
@@ -1246,19 +1418,19 @@ case "$COMMAND" in
                 echo "Tracks: $track_count"
             fi
 
-            # Show recovery files if any
+            # Show recovery files if any (from the recovery index)
             echo ""
             has_recovery=false
-            for playlist_dir_file in "$MOBILE_DIR"/*.pending_tracks "$MOBILE_DIR"/*.failed; do
-                if [ -f "$playlist_dir_file" ]; then
+            if mobile_recovery_index_ensure; then
+                while IFS='^' read -r pl_name pl_pending pl_failed _pl_updated; do
                     if [ "$has_recovery" = false ]; then
                         echo "Recovery files (require attention):"
                         has_recovery=true
                     fi
-                    local_count=$(wc -l < "$playlist_dir_file")
-                    echo "  $(basename "$playlist_dir_file"): $local_count tracks"
-                fi
-            done
+                    [ "$pl_pending" -gt 0 ] && echo "  ${pl_name}.pending_tracks: $pl_pending tracks"
+                    [ "$pl_failed" -gt 0 ] && echo "  ${pl_name}.failed: $pl_failed tracks"
+                done < "$MOBILE_RECOVERY_INDEX"
+            fi
             if [ "$has_recovery" = false ]; then
                 echo "No recovery files (all accounting clean)"
             fi
@@ -1275,17 +1447,17 @@ case "$COMMAND" in
             fi
 
             # Show log information
-            if [ -f "$MOBILE_LOG_FILE" ]; then
+            ops_days=("$MOBILE_OPS_DIR"/????-??-??.ops)
+            if [ -f "${ops_days[0]}" ]; then
                 echo ""
                 echo "Mobile operations log:"
-                echo "  Location: $MOBILE_LOG_FILE"
-                log_size=$(stat -c%s "$MOBILE_LOG_FILE" 2>/dev/null || echo 0)
-                log_size_kb=$((log_size / 1024))
-                echo "  Size: ${log_size_kb} KB"
+                echo "  Location: $MOBILE_OPS_DIR"
+                first_day=$(basename "${ops_days[0]}" .ops)
+                echo "  History: ${#ops_days[@]} days with operations since $first_day"
 
                 echo ""
                 echo "Recent operations (last 5):"
-                tail -5 "$MOBILE_LOG_FILE" | while read line; do
+                mobile_ops_tail 5 | while IFS= read -r line; do
                     echo "  $line"
                 done
             fi
@@ -1295,52 +1467,56 @@ case "$COMMAND" in
         ;;
 
     logs)
-        if [ ! -f "$MOBILE_LOG_FILE" ]; then
+        ops_days=("$MOBILE_OPS_DIR"/????-??-??.ops)
+        if [ ! -f "${ops_days[0]}" ]; then
             echo "No mobile operations log found"
-            echo "Location: $MOBILE_LOG_FILE"
+            echo "Location: $MOBILE_OPS_DIR"
             exit 0
         fi
 
         case "${2:-}" in
             "")
-                # Show last 50 lines
+                # Show last 50 records
                 echo "Recent mobile operations (last 50 lines):"
                 echo ""
-                tail -50 "$MOBILE_LOG_FILE"
+                mobile_ops_tail 50
                 ;;
             errors)
                 echo "Recent errors:"
                 echo ""
-                grep "\[ERROR\]" "$MOBILE_LOG_FILE" | tail -20
-                if [ ${PIPESTATUS[0]} -ne 0 ]; then
+                if ! mobile_ops_level ERROR 20; then
                     echo "No errors found in log"
                 fi
                 ;;
             warnings)
                 echo "Recent warnings:"
                 echo ""
-                grep "\[WARN\]" "$MOBILE_LOG_FILE" | tail -20
-                if [ ${PIPESTATUS[0]} -ne 0 ]; then
+                if ! mobile_ops_level WARN 20; then
                     echo "No warnings found in log"
                 fi
                 ;;
             stats)
                 echo "Recent statistics:"
                 echo ""
-                grep "\[STATS\]" "$MOBILE_LOG_FILE" | tail -10
-                if [ ${PIPESTATUS[0]} -ne 0 ]; then
+                if ! mobile_ops_level STATS 10; then
                     echo "No statistics found in log"
                 fi
                 ;;
             today)
-                today=$(date '+%Y-%m-%d')
+                printf -v today '%(%Y-%m-%d)T' -1
                 echo "Operations from today ($today):"
                 echo ""
-                grep "$today" "$MOBILE_LOG_FILE"
-                if [ $? -ne 0 ]; then
+                if ! mobile_ops_day "$today"; then
                     echo "No operations logged today"
                 fi
                 ;;
+            [0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9])
+                echo "Operations from $2:"
+                echo ""
+                if ! mobile_ops_day "$2"; then
+                    echo "No operations logged on $2"
+                fi
+                ;;
             *)
                 error_exit 1 "Unknown logs filter" "filter" "$2"
                 exit 1
@@ -1403,6 +1579,7 @@ case "$COMMAND" in
                             rm -f "$MOBILE_DIR/${local_pl_name}.failed"
                             removed=$((removed + 1))
                         fi
+                        mobile_recovery_update "$local_pl_name"
                     fi
                 fi
             fi
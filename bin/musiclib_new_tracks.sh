@@ -6,13 +6,16 @@
 #
 # This script processes files newly downloaded to $NEW_DOWNLOAD_DIR and imports them
 # to the music repository ($MUSIC_REPO) by:
-#   1. Extracting ZIP files (if present) - AUTOMATIC
+#   1. Extracting ZIP files (if present) - AUTOMATIC, one album per ZIP
 #   2. Normalizing MP3 filenames from ID3 tags
-#   3. Standardizing volume levels with rsgain
+#   3. Standardizing volume levels with rsgain (per album)
 #   4. Organizing files into artist/album folder structure
 #   5. Adding tracks to the musiclib.dsv database
 #
-# The script pauses after extraction to allow tag editing in kid3-qt.
+# Albums are processed in parallel (NEW_TRACKS_JOBS) and each is added to
+# the database as soon as it is ready.
+# Run from a terminal, the script pauses after extraction to allow tag
+# editing in kid3-qt.
 # IMPORTANT: Check the album tag - it determines the folder name in the repository.
 #
 # Exit codes:
@@ -88,13 +91,19 @@ DESCRIPTION:
   This script processes files newly downloaded to the configured download
   directory and imports them to the music repository by:
 
-    1. Extracting ZIP files automatically (if present)
+    1. Extracting ZIP files automatically (if present), one album per ZIP
     2. Normalizing MP3 filenames from ID3 tags
-    3. Standardizing volume levels with rsgain
+    3. Standardizing volume levels with rsgain, per album
     4. Organizing files into artist/album folder structure
     5. Adding tracks to the musiclib.dsv database
 
-  The script pauses after extraction to allow tag editing in kid3-qt.
+  Each ZIP (and the loose MP3s, together) is handled in its own folder
+  under <download dir>/musiclib_import/, NEW_TRACKS_JOBS albums at a time,
+  and added to the database as soon as it is done.  Folders left by an
+  interrupted run are resumed.
+
+  Run from a terminal, the script pauses after extraction to allow tag
+  editing in kid3-qt.
 
 IMPORTANT:
   Check the album tag before continuing – it determines the folder name in
@@ -113,6 +122,9 @@ CONFIGURATION:
     - NEW_DOWNLOAD_DIR (where new downloads are placed)
     - MUSICDB (path to music database file)
 
+  Optional variables:
+    - NEW_TRACKS_JOBS (albums processed at once; default: CPU count, max 4)
+
 REQUIRED TOOLS:
   - kid3-cli (tag editor)
   - exiftool (metadata extractor)
@@ -271,6 +283,7 @@ add_track_to_database() {
             rm -f "$MUSICDB.tmp"
             return 1
         fi
+        publish_row_insert "$MUSICDB" "$new_entry"
     }
 
     # Attempt to write with lock (5 second timeout)
@@ -318,231 +331,339 @@ add_track_to_database() {
 }
 
 #############################################
-# Main Processing Logic
+# Import Batches
 #############################################
 
-echo ""
-echo "=== MusicLib Track Import ==="
-echo "Processing directory: $DOWNLOAD_DIR"
-echo ""
+# Every ZIP is treated as one album and extracted into its own folder under
+# $IMPORT_ROOT; loose MP3s in the download directory form one more batch.
+# Up to IMPORT_JOBS batches run at once, each doing extraction, tag
+# normalization, renaming and rsgain for its own folder only.  Batches are
+# finished (moved into the repository and added to the database) in the
+# order they complete, so a large download takes about as long as its
+# slowest album instead of the sum of all of them.  Folders left behind by
+# an interrupted run are picked up again as batches.
 
-# Count files
-zip_files=("$DOWNLOAD_DIR"/*.zip)
-mp3_files=("$DOWNLOAD_DIR"/*.mp3)
-num_zip=${#zip_files[@]}
-num_mp3=${#mp3_files[@]}
+IMPORT_ROOT="$DOWNLOAD_DIR/musiclib_import"
+IMPORT_JOBS="${NEW_TRACKS_JOBS:-}"
+if ! [[ "$IMPORT_JOBS" =~ ^[1-9][0-9]*$ ]]; then
+    IMPORT_JOBS=$(nproc 2>/dev/null || echo 2)
+    (( IMPORT_JOBS > 4 )) && IMPORT_JOBS=4
+fi
 
-echo "Found: ${num_zip} ZIP file(s), ${num_mp3} MP3 file(s)"
-echo ""
+# rsgain threads per album, so the batches together use about one per CPU
+RSGAIN_THREADS=$(( $(nproc 2>/dev/null || echo 2) / IMPORT_JOBS ))
+(( RSGAIN_THREADS < 1 )) && RSGAIN_THREADS=1
 
-#############################################
-# CASE 1: Multiple ZIP files - Error
-#############################################
+declare -a BATCH_DIRS=()
+declare -a BATCH_ZIPS=()
+declare -a BATCH_RC=()
 
-if (( num_zip > 1 )); then
-    error_exit 1 "Multiple ZIP files found - can only process one at a time" \
-        "count" "$num_zip" "directory" "$DOWNLOAD_DIR"
-    echo "Error: Found ${num_zip} ZIP files in $DOWNLOAD_DIR"
-    echo "This script processes at most one zip at a time. Please leave at most one .zip file and try again."
-    exit 1
-fi
+# Normalize a name for use as a folder: lowercase, spaces to underscores,
+# only a-z0-9_- kept, runs of _ collapsed, leading/trailing _ trimmed
+normalize_folder_name() {
+    printf '%s' "$1" \
+        | tr '[:upper:]' '[:lower:]' \
+        | tr -s ' ' '_' \
+        | sed 's/[^a-z0-9_-]//g' \
+        | sed 's/_\+/_/g; s/^_//; s/_$//'
+}
 
-#############################################
-# CASE 2: No ZIP and No MP3 - Nothing to do
-#############################################
+# Register a batch folder and, for ZIP batches, the archive to extract into it
+add_batch() {
+    BATCH_DIRS+=("$1")
+    BATCH_ZIPS+=("${2:-}")
+    BATCH_RC+=(0)
+}
 
-if (( num_zip == 0 && num_mp3 == 0 )); then
-    echo "No .zip or .mp3 files found in $DOWNLOAD_DIR – nothing to do."
-    exit 0
-fi
+# Extract a ZIP into its batch folder and remove it on success.  The
+# .extracting marker keeps a half-extracted folder from being resumed; the
+# ZIP is still there and is extracted again instead.
+batch_extract() {
+    local dir="$1" zipfile="$2"
+
+    echo "Extracting $(basename "$zipfile") → $(basename "$dir")"
+    : > "$dir/.extracting"
+    if ! unzip -o -q "$zipfile" -d "$dir" 2>&1; then
+        echo "  Error: ZIP extraction failed: $zipfile"
+        rm -rf "$dir"
+        return 2
+    fi
+    rm -f "$dir/.extracting" "$zipfile"
+}
 
-#############################################
-# CASE 3: Exactly One ZIP - Extract Automatically
-#############################################
+# Normalize tags, set filenames from tags and standardize the volume of one
+# batch folder.  Returns 2 if a file cannot be renamed.
+batch_process() {
+    local dir="$1"
+    local -a files=("$dir"/*.mp3)
+    local f base norm_base newname normalized_count=0 normalize_failed=0
 
-if (( num_zip == 1 )); then
-    zipfile="${zip_files[0]}"
-    echo "Processing ZIP: $(basename "$zipfile")"
+    if [ ${#files[@]} -eq 0 ]; then
+        echo "No MP3 files found in $(basename "$dir")"
+        return 0
+    fi
 
-    # Rename: spaces → underscores
-    filename=$(basename "$zipfile")
-    newname="${filename// /_}"
+    echo "Normalizing ID3v2 tags in $(basename "$dir") (removing excluded frames)..."
+    for f in "${files[@]}"; do
+        if normalize_new_track_tags "$f"; then
+            ((normalized_count++))
+        else
+            ((normalize_failed++))
+            echo "  Warning: Tag normalization failed for $(basename "$f")"
+        fi
+    done
+    echo "Tag normalization complete: $normalized_count succeeded, $normalize_failed failed"
 
-    if [ "$filename" != "$newname" ]; then
-        echo "  → Replacing spaces: $newname"
-        if ! mv -i "$zipfile" "$DOWNLOAD_DIR/$newname" 2>/dev/null; then
-            error_exit 2 "Failed to rename ZIP file" "original" "$filename" "new" "$newname"
-            exit 2
+    # Uses Tag 2 (ID3v2), format: track_-_artist_-_title
+    echo "Setting filename from tags..."
+    ( cd "$dir" && "$KID3_CMD" -c "fromtag %{track.2}_-_%{artist}_-_%{title} 2" *.mp3 2>/dev/null ) || \
+        echo "  Warning: kid3-cli fromtag step had issues – continuing to normalization..."
+
+    # Aggressive filename normalization:
+    # - Lowercase
+    # - Replace anything not a-z0-9_- with single _
+    # - Collapse multiple _ → one _
+    # - Trim leading/trailing _
+    for f in "$dir"/*.mp3; do
+        base=$(basename "$f" .mp3)
+        norm_base=$(printf '%s\n' "$base" \
+            | tr 'A-Z' 'a-z' \
+            | sed 's/[^a-z0-9_-]/_/g' \
+            | sed 's/_\+/_/g; s/^_//; s/_$//')
+        newname="${norm_base}.mp3"
+        [ "$(basename "$f")" = "$newname" ] && continue
+        echo "  $(basename "$f") → $newname"
+        if ! mv -i -- "$f" "$dir/$newname" 2>/dev/null; then
+            echo "  Error: Failed to rename $(basename "$f") to $newname"
+            return 2
+        fi
+    done
+
+    # Per album, so album gain covers exactly this album's tracks.  The
+    # CPUs not taken by other batches scan this album's tracks in parallel;
+    # a resumed batch whose files were already scanned is skipped.
+    if command -v rsgain >/dev/null 2>&1; then
+        files=("$dir"/*.mp3)
+        if loudness_cached easy "${files[@]}"; then
+            echo "Volume level already standardized (unchanged since last scan)"
+        else
+            echo "Standardizing volume level..."
+            if rsgain easy -q -m "$RSGAIN_THREADS" "$dir" 2>/dev/null; then
+                loudness_record easy "${files[@]}"
+            else
+                echo "  Warning: rsgain had issues, continuing..."
+            fi
         fi
-        zipfile="$DOWNLOAD_DIR/$newname"
     fi
+    return 0
+}
 
-    # Rename: to lowercase
-    filename=$(basename "$zipfile")
-    lowercase="${filename,,}"
+# Background job for one batch: runs the stages selected by MODE
+# (extract, process or all) with output captured in <dir>.log, then
+# reports "<index> <exit code>" on the completion pipe
+batch_worker() {
+    local idx="$1" mode="$2" rc=0
+    local dir="${BATCH_DIRS[$idx]}" zipfile="${BATCH_ZIPS[$idx]}"
 
-    if [ "$filename" != "$lowercase" ]; then
-        echo "  → Lowercase: $lowercase"
-        if ! mv -i "$zipfile" "$DOWNLOAD_DIR/$lowercase" 2>/dev/null; then
-            error_exit 2 "Failed to lowercase ZIP filename" "original" "$filename" "new" "$lowercase"
-            exit 2
+    {
+        if [ "$mode" != process ] && [ -n "$zipfile" ]; then
+            batch_extract "$dir" "$zipfile" || rc=$?
         fi
-        zipfile="$DOWNLOAD_DIR/$lowercase"
-    fi
+        if [ $rc -eq 0 ] && [ "$mode" != extract ]; then
+            batch_process "$dir" || rc=$?
+        fi
+    } > "$dir.log" 2>&1 < /dev/null
 
-    # Extract
-    echo " Extracting..."
-    if ! unzip -o "$zipfile" -d "$DOWNLOAD_DIR" 2>&1 \
-       | { grep -v "^Archive:" | grep -v "^ inflating:"; } && (( PIPESTATUS[0] == 0 )); then
-        error_exit 2 "ZIP extraction failed" "file" "$zipfile"
-        exit 2
+    printf '%s %s\n' "$idx" "$rc" >&"$BATCH_DONE_FD"
+}
+
+# Run MODE for every batch that has not failed, IMPORT_JOBS at a time, and
+# call ON_DONE <index> <exit code> in the main shell as each one finishes
+run_batches() {
+    local mode="$1" on_done="$2"
+    local next=0 running=0 idx rc
+
+    while :; do
+        while (( running < IMPORT_JOBS && next < ${#BATCH_DIRS[@]} )); do
+            if [ "${BATCH_RC[$next]}" -eq 0 ]; then
+                batch_worker "$next" "$mode" &
+                ((running++))
+            fi
+            ((next++))
+        done
+        (( running > 0 )) || break
+
+        read -r idx rc <&"$BATCH_DONE_FD" || break
+        ((running--))
+        cat "${BATCH_DIRS[$idx]}.log" 2>/dev/null
+        rm -f "${BATCH_DIRS[$idx]}.log"
+        BATCH_RC[$idx]=$rc
+        "$on_done" "$idx" "$rc"
+    done
+    wait
+}
+
+# Record a failed batch; used on its own after the extract-only pass
+note_batch_result() {
+    local idx="$1" rc="$2"
+
+    if [ "$rc" -ne 0 ]; then
+        ((batches_failed++))
+        log_message "ERROR: Import batch failed: ${BATCH_ZIPS[$idx]:-${BATCH_DIRS[$idx]}}"
     fi
+}
 
-    # Cleanup
-    echo "  Removing original ZIP..."
-    rm -f "$zipfile"
+# Album folder name for a track, from its album tag (sets ALBUM_NORMALIZED)
+resolve_album_folder() {
+    local first_file="$1" album_raw
 
-    echo "ZIP processing complete."
+    # Try to read album tag (ID3v2 preferred)
+    album_raw=$("$KID3_CMD" -c 'get album' "$first_file" 2>/dev/null | head -n 1)
 
-    # Recount MP3 files after extraction
-    mp3_files=("$DOWNLOAD_DIR"/*.mp3)
-    num_mp3=${#mp3_files[@]}
-    echo "Found ${num_mp3} MP3 file(s) after extraction."
-fi
+    if [ -z "$album_raw" ] || [ "$album_raw" = "-" ]; then
+        # Fallback: try albumartist or just use a generic name
+        album_raw=$("$KID3_CMD" -c 'get albumartist' "$first_file" 2>/dev/null | head -n 1)
+        if [ -z "$album_raw" ] || [ "$album_raw" = "-" ]; then
+            ALBUM_NORMALIZED="unknown_album_$(date +%Y%m%d)"
+            echo "  Warning: No album tag found – using fallback: $ALBUM_NORMALIZED"
+        else
+            ALBUM_NORMALIZED="various"
+            echo "  Warning: No album tag, but albumartist found – using 'various'"
+        fi
+    else
+        ALBUM_NORMALIZED=$(normalize_folder_name "$album_raw")
 
-#############################################
-# Interactive Tag Editing Pause
-#############################################
+        if [ -z "$ALBUM_NORMALIZED" ]; then
+            ALBUM_NORMALIZED="untitled_album"
+            echo "  Warning: Album name normalized to empty – using 'untitled_album'"
+        fi
 
-echo ""
-echo "=== Need to tailor the tags in kid3-qt before continuing? Press Enter when ready to continue or Ctrl-C to abort ==="
-read -r || {
-    error_exit 1 "User cancelled operation"
-    exit 1
+        echo "  Detected album: $album_raw → normalized to: $ALBUM_NORMALIZED"
+    fi
 }
 
-#############################################
-# Tag Normalization
-#############################################
+# Move a finished batch into the repository and add its tracks to the
+# database.  Runs in the main shell while other batches keep working.
+finish_batch() {
+    local idx="$1" rc="$2"
+    local dir="${BATCH_DIRS[$idx]}" album_dir file result
 
-echo ""
-echo "Normalizing ID3v2 tags (removing excluded frames)..."
+    if [ "$rc" -ne 0 ]; then
+        note_batch_result "$idx" "$rc"
+        return
+    fi
 
-# Get list of MP3 files to normalize
-mp3_files_temp=("$DOWNLOAD_DIR"/*.mp3)
+    local -a batch_files=("$dir"/*.mp3)
+    if [ ${#batch_files[@]} -eq 0 ]; then
+        rmdir "$dir" 2>/dev/null || true
+        return
+    fi
 
-if [ ${#mp3_files_temp[@]} -gt 0 ]; then
-    normalized_count=0
-    normalize_failed=0
+    echo "Organizing ${#batch_files[@]} file(s) into artist/album structure..."
+    resolve_album_folder "${batch_files[0]}"
+    album_dir="$ARTIST_DIR/$ALBUM_NORMALIZED"
 
-    for file in "${mp3_files_temp[@]}"; do
+    if [ -d "$album_dir" ]; then
+        echo "  Album folder already exists: $album_dir"
+    else
+        echo "  Creating album folder: $album_dir"
+        if ! mkdir -p "$album_dir" 2>/dev/null; then
+            echo "  Error: Failed to create album directory: $album_dir"
+            note_batch_result "$idx" 2
+            return
+        fi
+    fi
+
+    echo "  Moving files to $album_dir ..."
+    if ! mv -i -t "$album_dir" "${batch_files[@]}" 2>&1; then
+        echo "  Error: Failed to move files to $album_dir"
+        note_batch_result "$idx" 2
+        return
+    fi
+    # Anything else that came with the download (covers, booklets) stays
+    rmdir "$dir" 2>/dev/null || true
+    album_dirs+=("$album_dir")
+
+    # Destination paths of exactly the moved files.  We must NOT glob
+    # "$album_dir"/*.mp3 here because that would also pick up any tracks
+    # that already existed in the folder, causing duplicate DB entries.
+    echo "Adding tracks from $ALBUM_NORMALIZED to music library database..."
+    for file in "${batch_files[@]}"; do
+        file="$album_dir/$(basename "$file")"
         [ -f "$file" ] || continue
 
-        if normalize_new_track_tags "$file"; then
-            ((normalized_count++))
-        else
-            ((normalize_failed++))
-            echo "  Warning: Tag normalization failed for $(basename "$file")"
-        fi
+        add_track_to_database "$file"
+        result=$?
+
+        case $result in
+            0)
+                ((added++))
+                ;;
+            3)
+                ((deferred++))
+                ;;
+            *)
+                ((failed++))
+                echo "  Failed to add: $(basename "$file")"
+                ;;
+        esac
     done
-
-    echo "Tag normalization complete: $normalized_count succeeded, $normalize_failed failed"
-else
-    echo "No MP3 files found to normalize"
-fi
+}
 
 #############################################
-# CASE 4: Process MP3 Files
+# Main Processing Logic
 #############################################
 
-# Recount to ensure we have current state
+echo ""
+echo "=== MusicLib Track Import ==="
+echo "Processing directory: $DOWNLOAD_DIR"
+echo ""
+
+# Count files
+zip_files=("$DOWNLOAD_DIR"/*.zip)
 mp3_files=("$DOWNLOAD_DIR"/*.mp3)
+num_zip=${#zip_files[@]}
 num_mp3=${#mp3_files[@]}
 
-if (( num_mp3 == 0 )); then
-    echo "No MP3 files found to process."
-    exit 0
-fi
+echo "Found: ${num_zip} ZIP file(s), ${num_mp3} MP3 file(s)"
 
-echo ""
-echo "Processing ${num_mp3} MP3 file(s) in $DOWNLOAD_DIR"
-if ! pushd "$DOWNLOAD_DIR" >/dev/null 2>&1; then
-    error_exit 2 "Cannot change to download directory" "directory" "$DOWNLOAD_DIR"
+if ! mkdir -p "$IMPORT_ROOT" 2>/dev/null; then
+    error_exit 2 "Cannot create import directory" "directory" "$IMPORT_ROOT"
     exit 2
 fi
 
-#############################################
-# Step 1: Set Filename from Tags
-#############################################
-
-# Uses Tag 2 (ID3v2), format: track_-_artist_-_title
-echo "Setting filename from tags..."
-"$KID3_CMD" -c "fromtag %{track.2}_-_%{artist}_-_%{title} 2" *.mp3 2>/dev/null || \
-    echo "  Warning: kid3-cli fromtag step had issues – continuing to normalization..."
-
-#############################################
-# Step 2: Aggressive Filename Normalization
-#############################################
-
-# - Lowercase
-# - Replace anything not a-z0-9_- with single _
-# - Collapse multiple _ → one _
-# - Trim leading/trailing _
-for f in *.mp3; do
-    [ -f "$f" ] || continue
-    base="${f%.mp3}"
-    norm_base=$(printf '%s\n' "$base" \
-        | tr 'A-Z' 'a-z' \
-        | sed 's/[^a-z0-9_-]/_/g' \
-        | sed 's/_\+/_/g; s/^_//; s/_$//')
-    newname="${norm_base}.mp3"
-    if [ "$f" = "$newname" ]; then
+# Folders left by an interrupted run
+for dir in "$IMPORT_ROOT"/*/; do
+    dir="${dir%/}"
+    if [ -e "$dir/.extracting" ]; then
+        rm -rf "$dir"
         continue
     fi
-    echo "  $f → $newname"
-    if ! mv -i -- "$f" "$newname" 2>/dev/null; then
-        error_exit 2 "Failed to rename file" "original" "$f" "new" "$newname"
-        popd >/dev/null
-        exit 2
+    leftover=("$dir"/*.mp3)
+    if [ ${#leftover[@]} -gt 0 ]; then
+        echo "Resuming: $(basename "$dir") (${#leftover[@]} MP3 file(s))"
+        add_batch "$dir"
     fi
 done
-echo "MP3 filename processing complete (${num_mp3} file(s))."
-popd >/dev/null
 
-#############################################
-# Volume Normalization (rsgain)
-#############################################
-
-echo ""
-echo "Standardizing volume level..."
-if ! command -v rsgain >/dev/null 2>&1; then
-    echo "Warning: rsgain not found – skipping volume standardization"
-else
-    rsgain easy -q "$DOWNLOAD_DIR" 2>/dev/null || echo "  Warning: rsgain had issues, continuing..."
+if (( num_zip == 0 && num_mp3 == 0 && ${#BATCH_DIRS[@]} == 0 )); then
+    echo "No .zip or .mp3 files found in $DOWNLOAD_DIR – nothing to do."
+    rmdir "$IMPORT_ROOT" 2>/dev/null || true
+    exit 0
 fi
-echo "Done"
+echo ""
 
 #############################################
 # Artist Folder Setup
 #############################################
 
-# Get final list of MP3 files to organize
-mp3_files=("$DOWNLOAD_DIR"/*.mp3)
-
-if [ ${#mp3_files[@]} -eq 0 ]; then
-    echo "No .mp3 files found in $DOWNLOAD_DIR – nothing to organize."
-    exit 0
-fi
-
-echo "Organizing ${#mp3_files[@]} file(s) into artist/album structure..."
-
 # Determine artist name
 if [ $# -ge 1 ] && [ "$1" != "--help" ] && [ "$1" != "-h" ] && [ "$1" != "help" ]; then
     artist_input="$1"
 else
     echo -n "Enter artist name for folder organization: "
     read -r artist_input
-    
+
     if [ -z "$artist_input" ]; then
         error_exit 1 "No artist name provided" "action" "user_input_required"
         exit 1
@@ -550,11 +671,7 @@ else
 fi
 
 # Normalize artist name for filesystem
-artist_normalized=$(printf '%s' "$artist_input" \
-    | tr '[:upper:]' '[:lower:]' \
-    | tr -s ' ' '_' \
-    | sed 's/[^a-z0-9_-]//g' \
-    | sed 's/_\+/_/g; s/^_//; s/_$//')
+artist_normalized=$(normalize_folder_name "$artist_input")
 
 if [ -z "$artist_normalized" ]; then
     error_exit 1 "Artist name normalized to empty string" "original" "$artist_input"
@@ -577,107 +694,82 @@ else
 fi
 
 #############################################
-# Album Folder Setup
+# Stage Downloads
 #############################################
 
-# Get album name from tags (use first file as representative)
-first_file="${mp3_files[0]}"
-
-# Try to read album tag (ID3v2 preferred)
-album_raw=$("$KID3_CMD" -c 'get album' "$first_file" 2>/dev/null | head -n 1)
-
-if [ -z "$album_raw" ] || [ "$album_raw" = "-" ]; then
-    # Fallback: try albumartist or just use a generic name
-    album_raw=$("$KID3_CMD" -c 'get albumartist' "$first_file" 2>/dev/null | head -n 1)
-    if [ -z "$album_raw" ] || [ "$album_raw" = "-" ]; then
-        album_normalized="unknown_album_$(date +%Y%m%d)"
-        echo "  Warning: No album tag found – using fallback: $album_normalized"
-    else
-        album_normalized="various"
-        echo "  Warning: No album tag, but albumartist found – using 'various'"
-    fi
-else
-    # Normalize album name
-    album_normalized=$(printf '%s' "$album_raw" \
-        | tr '[:upper:]' '[:lower:]' \
-        | tr -s ' ' '_' \
-        | sed 's/[^a-z0-9_-]//g' \
-        | sed 's/_\+/_/g; s/^_//; s/_$//')
-
-    if [ -z "$album_normalized" ]; then
-        album_normalized="untitled_album"
-        echo "  Warning: Album name normalized to empty – using 'untitled_album'"
-    fi
-
-    echo "  Detected album: $album_raw → normalized to: $album_normalized"
-fi
-
-# Full path to target album folder
-ALBUM_DIR="$ARTIST_DIR/$album_normalized"
-
-# Create if missing
-if [ -d "$ALBUM_DIR" ]; then
-    echo "  Album folder already exists: $ALBUM_DIR"
-else
-    echo "  Creating album folder: $ALBUM_DIR"
-    if ! mkdir -p "$ALBUM_DIR" 2>/dev/null; then
-        error_exit 2 "Failed to create album directory" "directory" "$ALBUM_DIR"
+# Loose MP3s become one batch of their own
+if (( num_mp3 > 0 )); then
+    dir=$(mktemp -d "$IMPORT_ROOT/loose_XXXXXX") && mv -i -t "$dir" "${mp3_files[@]}" < /dev/null || {
+        error_exit 2 "Failed to stage MP3 files" "directory" "$IMPORT_ROOT"
         exit 2
-    fi
+    }
+    add_batch "$dir"
 fi
 
-#############################################
-# Move Files to Album Directory
-#############################################
+# One folder per ZIP, named after the archive
+for zipfile in "${zip_files[@]}"; do
+    zipname=$(normalize_folder_name "$(basename "$zipfile" .zip)")
+    dir=$(mktemp -d "$IMPORT_ROOT/${zipname:-zip}_XXXXXX") || {
+        error_exit 2 "Failed to create import folder" "directory" "$IMPORT_ROOT"
+        exit 2
+    }
+    add_batch "$dir" "$zipfile"
+done
 
-echo "  Moving files to $ALBUM_DIR ..."
-if ! mv -i -t "$ALBUM_DIR" "${mp3_files[@]}" 2>&1; then
-    error_exit 2 "Failed to move files to album directory" "destination" "$ALBUM_DIR"
+# Completion pipe: workers write "<index> <exit code>" lines (well under
+# PIPE_BUF, so they never interleave) and the main shell reads them
+BATCH_FIFO=$(mktemp -u "${TMPDIR:-/tmp}/musiclib_import.XXXXXX")
+if ! mkfifo "$BATCH_FIFO" || ! exec {BATCH_DONE_FD}<>"$BATCH_FIFO"; then
+    error_exit 2 "Cannot create import completion pipe" "path" "$BATCH_FIFO"
     exit 2
 fi
-echo "Organization complete."
-
-#############################################
-# Add Tracks to Database
-#############################################
-
-echo ""
-echo "Adding processed tracks to music library database..."
+rm -f "$BATCH_FIFO"
 
 added=0
 failed=0
 deferred=0
+batches_failed=0
+declare -a album_dirs=()
 
-# Build the list of newly moved files using their destination paths.
-# mp3_files[] still holds the pre-move paths from $DOWNLOAD_DIR; basename
-# gives the (post-normalization) filename now sitting in $ALBUM_DIR.
-# We must NOT glob "$ALBUM_DIR"/*.mp3 here because that would also pick up
-# any tracks that already existed in the folder, causing duplicate DB entries.
-declare -a new_track_files=()
-for f in "${mp3_files[@]}"; do
-    new_track_files+=("$ALBUM_DIR/$(basename "$f")")
-done
+echo "Importing ${#BATCH_DIRS[@]} batch(es), up to $IMPORT_JOBS at a time..."
+echo ""
 
-for file in "${new_track_files[@]}"; do
-    [ -f "$file" ] || continue
+#############################################
+# Process Batches
+#############################################
 
-    add_track_to_database "$file"
-    result=$?
-    
-    case $result in
-        0)
-            ((added++))
-            ;;
-        3)
-            ((deferred++))
-            ;;
-        *)
-            ((failed++))
-            echo "  Failed to add: $(basename "$file")"
-            ;;
-    esac
-done
+if [ -t 0 ]; then
+    # Interactive: extract everything (in parallel), then pause so the tags
+    # can be checked in kid3-qt before anything is renamed or moved
+    if (( num_zip > 0 )); then
+        run_batches extract note_batch_result
+        echo "ZIP processing complete."
+    fi
 
+    echo ""
+    echo "Files to import:"
+    for idx in "${!BATCH_DIRS[@]}"; do
+        [ "${BATCH_RC[$idx]}" -eq 0 ] || continue
+        leftover=("${BATCH_DIRS[$idx]}"/*.mp3)
+        echo "  ${BATCH_DIRS[$idx]} (${#leftover[@]} MP3 file(s))"
+    done
+    echo ""
+    echo "=== Need to tailor the tags in kid3-qt before continuing? Press Enter when ready to continue or Ctrl-C to abort ==="
+    read -r || {
+        error_exit 1 "User cancelled operation"
+        exit 1
+    }
+
+    run_batches process finish_batch
+else
+    # Non-interactive (GUI, scripts): nothing to wait for, so every album
+    # goes straight from extraction to tagging, rsgain and the database
+    run_batches all finish_batch
+fi
+exec {BATCH_DONE_FD}>&-
+rmdir "$IMPORT_ROOT" 2>/dev/null || true
+
+echo ""
 echo "Database update summary: $added track(s) added, $deferred queued, $failed failed."
 
 # Trigger pending operations processor if any operations were deferred
@@ -686,15 +778,27 @@ if [ $deferred -gt 0 ] && [ -f "$SCRIPT_DIR/musiclib_process_pending.sh" ]; then
     "$SCRIPT_DIR/musiclib_process_pending.sh" &
 fi
 
+# Index the lyrics and comments of the new tracks (only changed files are read)
+if [ "${TEXT_INDEX_ENABLED:-false}" = true ] && [ $added -gt 0 ] && [ -f "$SCRIPT_DIR/musiclib_textindex.sh" ]; then
+    "$SCRIPT_DIR/musiclib_textindex.sh" -q || true
+fi
+
 echo ""
 echo "All processing finished."
-echo "Files are now in: $ALBUM_DIR"
+if [ ${#album_dirs[@]} -gt 0 ]; then
+    echo "Files are now in:"
+    printf '  %s\n' "${album_dirs[@]}"
+fi
+if [ $batches_failed -gt 0 ]; then
+    echo "Batches that failed were left in: $IMPORT_ROOT"
+fi
 echo ""
 
 # Determine final exit code
-if [ $failed -gt 0 ]; then
+if [ $failed -gt 0 ] || [ $batches_failed -gt 0 ]; then
     # Some operations failed completely
-    error_exit 2 "Some tracks failed to import" "failed_count" "$failed" "added_count" "$added"
+    error_exit 2 "Some tracks failed to import" "failed_count" "$failed" "added_count" "$added" \
+        "failed_batches" "$batches_failed"
     exit 2
 elif [ $deferred -gt 0 ]; then
     # Some operations were deferred (but not failed)
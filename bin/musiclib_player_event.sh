@@ -12,8 +12,8 @@
 # Audacious, Clementine, Amarok, Elisa, and mpd (via mpd-mpris bridge).
 #
 # Dependencies:
-#   - playerctl / playerctld (package: playerctl)
-#   - qdbus6 (package: qt6-tools)
+#   - musiclib-cli (player queries; playerctld is used when running)
+#   - qdbus6 (package: qt6-tools; Audacious position fallback only)
 #   - exiftool, kid3-cli (existing musiclib deps)
 #
 # Exit codes:
@@ -75,27 +75,23 @@ export SCROBBLE_THRESHOLD_PCT
 
 #############################################
 # Detect active player and resolve current track filepath
-# (helpers are in musiclib_utils.sh: detect_active_mpris_bus,
-#  mpris_metadata_field, mpris_playback_status, file_uri_to_path)
+# (helpers are in musiclib_player_utils.sh: get_current_player_filepath,
+#  mpris_metadata_field, read_player_state)
 #############################################
-detect_active_mpris_bus
-
-if [ -z "$MPRIS_BUS" ]; then
-    # No MPRIS2 player active - not an error, just nothing to do
-    exit 0
-fi
-
-URL=$(mpris_metadata_field "xesam:url" || echo "")
-FILEPATH=$(file_uri_to_path "$URL")
+FILEPATH=$(get_current_player_filepath)
 
 if [ -z "$FILEPATH" ] || [ ! -f "$FILEPATH" ]; then
-    # No track playing, or non-local URL (stream, etc.) - not an error
+    # No allowed MPRIS2 player active, no track playing, or non-local URL
+    # (stream, etc.) - not an error, just nothing to do
     exit 0
 fi
 
 # Publish the current track path for GUI consumers (replaces audtool calls)
 echo "$FILEPATH" > "$MUSIC_DISPLAY_DIR/songpath.txt"
 
+# Scrobbles go to the shard that owns the playing file
+MUSICDB=$(shard_db_for_path "$FILEPATH")
+
 #############################################
 # Album Art Extraction
 #############################################
@@ -349,6 +345,8 @@ update_play_time() {
         error_exit 2 "Failed to finalize database update" "filepath" "$FILEPATH"
         return 2
     fi
+    publish_change "$MUSICDB" update "$(echo "$grepped_string" | cut -f2- -d: | cut -f1 -d"^")" \
+        "$FILEPATH" LastTimePlayed "$old_value" "$play_time"
 
     # Update tag with rebuild on failure
     if ! kid3-cli -c "set Songs-DB_Custom1 $play_time" "$FILEPATH" 2>/dev/null; then
@@ -445,18 +443,15 @@ monitor_playback() {
     while [ $checks_passed -lt $checks_needed ]; do
         sleep $check_interval
 
-        # Check if still playing (re-detect player in case it changed)
-        detect_active_mpris_bus
-        if [ -z "$MPRIS_BUS" ]; then
+        # Check if still playing and on the same track (player re-detected
+        # by the same query in case it changed)
+        read_player_state
+        if [ -z "$PLAYER_STATUS" ]; then
             #log_message "SCROBBLE_DEBUG: bail at check $checks_passed — no MPRIS bus"
             return 1
         fi
 
-        # Defensive trim: qdbus6 appends a newline. mpris_playback_status now
-        # strips it, but we re-strip here so a regression upstream cannot
-        # silently break the scrobble loop again.
-        local status
-        status=$(mpris_playback_status | tr -d '[:space:]')
+        local status="$PLAYER_STATUS"
         if [ "$status" != "Playing" ]; then
             #log_message "SCROBBLE_DEBUG: bail at check $checks_passed — status=|$status|"
             # Persist progress so a resume can skip already-elapsed checks.
@@ -468,12 +463,7 @@ monitor_playback() {
             return 1
         fi
 
-        # Check if still on same track. mpris_metadata_field can occasionally
-        # emit more than one line if the awk match fires twice; take the first
-        # file:// line only so the comparison is well-defined.
-        local current_url current
-        current_url=$(mpris_metadata_field "xesam:url" 2>/dev/null | grep -m1 '^file://' || echo "")
-        current=$(file_uri_to_path "$current_url")
+        local current="$PLAYER_FILEPATH"
         if [ "$current" != "$FILEPATH" ]; then
             #log_message "SCROBBLE_DEBUG: bail at check $checks_passed — track changed to $(basename "$current")"
             return 1
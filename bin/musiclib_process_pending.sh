@@ -63,8 +63,9 @@ fi
 #############################################
 
 # DB write step for update_rating_in_db — runs inside with_db_lock subshell.
-# Reads myrow, groupdesc_colnum, groupdesc_value, rating_colnum, popm_value, MUSICDB
-# from the subshell environment (inherited from update_rating_in_db locals at fork).
+# Reads myrow, grepped_string, groupdesc_colnum, groupdesc_value, rating_colnum,
+# popm_value, filepath, MUSICDB from the subshell environment (inherited from
+# update_rating_in_db locals at fork).
 _do_rating_db_update() {
     if ! awk -F'^' -v OFS='^' -v target_row="$myrow" \
         -v groupdesc_col="$groupdesc_colnum" -v new_groupdesc="$groupdesc_value" \
@@ -79,6 +80,10 @@ _do_rating_db_update() {
         rm -f "$MUSICDB.tmp"
         return 1
     fi
+    local row_data="${grepped_string#*:}"
+    publish_change "$MUSICDB" update "${row_data%%^*}" "$filepath" \
+        Rating "$(cut -f"$rating_colnum" -d'^' <<< "$row_data")" "$popm_value" \
+        GroupDesc "$(cut -f"$groupdesc_colnum" -d'^' <<< "$row_data")" "$groupdesc_value"
 }
 
 # Function to update rating in database
@@ -100,6 +105,11 @@ update_rating_in_db() {
     local popm_value="${STAR_TO_POPM[$star_rating]}"
     local groupdesc_value="${STAR_TO_GROUPDESC[$star_rating]}"
 
+    # Shard-local MUSICDB: _do_rating_db_update and acquire_db_lock see it
+    # through dynamic scoping, so the right DSV and lock are used
+    local MUSICDB
+    MUSICDB=$(shard_db_for_path "$filepath")
+
     # Verify database exists
     if [ ! -f "$MUSICDB" ]; then
         log_message "ERROR: Database file not found: $MUSICDB"
@@ -156,6 +166,7 @@ _do_add_track_db() {
         log_message "ERROR: Failed to write pending add_track to database: $filepath"
         return 3
     fi
+    publish_row_insert "$MUSICDB" "$new_entry"
     log_message "COMPLETED PENDING: Added track $filepath (ID: $next_id)"
 }
 
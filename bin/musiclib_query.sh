@@ -0,0 +1,353 @@
+#!/bin/bash
+#
+# musiclib_query.sh - Recency, lyrics/comment and aggregate queries over the database
+# Usage: musiclib_query.sh recent|least-recent|played-between|text [options]
+#        musiclib_query.sh --table albums|artists [--sort COLUMN] [options]
+#
+#   recent                 Most recently played tracks, newest first
+#   least-recent           Least recently played tracks, oldest first
+#   played-between F T     Tracks last played from date F up to (not
+#                          including) date T, oldest first
+#   text WORDS...          Tracks whose lyrics or comments contain the phrase
+#
+# Recency queries use the played index (see PLAYED INDEX in musiclib_db.sh):
+# a binary search over "<dsv>.lpidx" instead of a sort of the whole DSV.
+# Text queries use the text index built by musiclib_textindex.sh (see TEXT
+# INDEX in musiclib_db.sh).  --table prints the per-album or per-artist
+# aggregate table (see AGGREGATE TABLES in musiclib_db.sh).
+# Output is DSV: the header line followed by the matching rows.
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard)
+#   2 - System error (config failure, database not found, index failure)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_query.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_query.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli query recent [options]
+       musiclib-cli query least-recent [options]
+       musiclib-cli query played-between FROM TO [options]
+       musiclib-cli query text WORDS... [options]
+       musiclib-cli query --table albums|artists [options]
+
+Recency queries answered from the played index, lyrics/comment phrase
+search answered from the text index (musiclib-cli db textindex), and the
+per-album / per-artist aggregate tables (track count, total length, rating
+histogram, mean stars, first and last play, path prefix).  Prints the DSV
+header followed by the matching rows.
+
+Options:
+  -n COUNT            Maximum number of tracks (default: 50; played-between
+                      and text: unlimited)
+  --stars N           Only tracks rated N stars (0-5)
+  --include-unplayed  least-recent: list never-played tracks first
+  --table KIND        Print the aggregate table KIND (albums or artists)
+  --sort COLUMN       --table: order by COLUMN (numbers descending, text
+                      ascending; default: table order)
+  -d FILE             Database to query (default: every library shard)
+  --shard NAME        Query the named library shard only
+  -h, --help          Display this help
+
+FROM and TO are dates as accepted by date -d (e.g. 2026-01-01).
+
+Examples:
+  musiclib-cli query recent -n 20
+  musiclib-cli query least-recent --stars 5 -n 50
+  musiclib-cli query played-between 2026-09-01 2026-10-01 --stars 4
+  musiclib-cli query text "hello darkness my old friend"
+  musiclib-cli query --table albums --sort MeanStars -n 20
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+SUBCOMMAND=""
+COUNT=""
+STARS=-1
+INCLUDE_UNPLAYED=false
+TARGET_DB=""
+TARGET_SHARD=""
+TABLE=""
+SORT_COLUMN=""
+RANGE=()
+WORDS=()
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        -n|--stars|-d|--shard|--table|--sort)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                -n)      COUNT="$2" ;;
+                --stars) STARS="$2" ;;
+                -d)      TARGET_DB="$2" ;;
+                --table) TABLE="$2" ;;
+                --sort)  SORT_COLUMN="$2" ;;
+                --shard) TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --include-unplayed)
+            INCLUDE_UNPLAYED=true
+            shift
+            ;;
+        -*)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+        *)
+            if [ -z "$SUBCOMMAND" ]; then
+                SUBCOMMAND="$1"
+            elif [ "$SUBCOMMAND" = "played-between" ] && [ "${#RANGE[@]}" -lt 2 ]; then
+                RANGE+=("$1")
+            elif [ "$SUBCOMMAND" = "text" ]; then
+                WORDS+=("$1")
+            else
+                error_exit 1 "Unexpected argument" "argument" "$1"
+                exit 1
+            fi
+            shift
+            ;;
+    esac
+done
+
+if [ -n "$TABLE" ]; then
+    if [ -n "$SUBCOMMAND" ]; then
+        error_exit 1 "--table cannot be combined with a subcommand" "subcommand" "$SUBCOMMAND"
+        exit 1
+    fi
+    case "$TABLE" in
+        albums)  header="$AGG_ALBUMS_HEADER" ;;
+        artists) header="$AGG_ARTISTS_HEADER" ;;
+        *)
+            error_exit 1 "Unknown table (must be albums or artists)" "table" "$TABLE"
+            exit 1
+            ;;
+    esac
+    if [ "$STARS" != -1 ] || [ "$INCLUDE_UNPLAYED" = true ]; then
+        error_exit 1 "--stars and --include-unplayed do not apply to --table"
+        exit 1
+    fi
+    SORT_KEY=""
+    if [ -n "$SORT_COLUMN" ]; then
+        SORT_KEY=$(awk -F'^' -v c="$SORT_COLUMN" '{ for (i = 1; i <= NF; i++) if ($i == c) print i }' <<< "$header")
+        if [ -z "$SORT_KEY" ]; then
+            error_exit 1 "Unknown column for --sort" "column" "$SORT_COLUMN" "columns" "$header"
+            exit 1
+        fi
+    fi
+    SUBCOMMAND=table
+    COUNT="${COUNT:-0}"
+elif [ -n "$SORT_COLUMN" ]; then
+    error_exit 1 "--sort requires --table"
+    exit 1
+fi
+
+case "$SUBCOMMAND" in
+    table)
+        ;;
+    recent|least-recent)
+        COUNT="${COUNT:-50}"
+        ;;
+    played-between)
+        COUNT="${COUNT:-0}"
+        if [ "${#RANGE[@]}" -ne 2 ]; then
+            error_exit 1 "played-between requires FROM and TO dates"
+            exit 1
+        fi
+        ;;
+    text)
+        COUNT="${COUNT:-0}"
+        if [ "${#WORDS[@]}" -eq 0 ]; then
+            error_exit 1 "text requires the words to search for"
+            exit 1
+        fi
+        ;;
+    "")
+        show_usage >&2
+        error_exit 1 "No subcommand given (recent, least-recent, played-between or text) or --table"
+        exit 1
+        ;;
+    *)
+        error_exit 1 "Unknown subcommand (must be recent, least-recent, played-between or text)" "subcommand" "$SUBCOMMAND"
+        exit 1
+        ;;
+esac
+
+if ! [[ "$COUNT" =~ ^[0-9]+$ ]]; then
+    error_exit 1 "-n must be a non-negative integer" "count" "$COUNT"
+    exit 1
+fi
+if ! [[ "$STARS" =~ ^(-1|[0-5])$ ]]; then
+    error_exit 1 "--stars must be between 0 and 5" "stars" "$STARS"
+    exit 1
+fi
+
+# Date -> SQL serial (days since 1899-12-30, like LastTimePlayed)
+to_serial() {
+    local epoch
+    epoch=$(date -d "$1" +%s 2>/dev/null) || return 1
+    awk -v e="$epoch" 'BEGIN { printf "%.6f", e / 86400 + 25569 }'
+}
+
+FROM=0
+TO=max
+MODE=oldest
+case "$SUBCOMMAND" in
+    recent)
+        FROM=0.000001
+        MODE=newest
+        ;;
+    least-recent)
+        [ "$INCLUDE_UNPLAYED" = true ] || FROM=0.000001
+        ;;
+    played-between)
+        if ! FROM=$(to_serial "${RANGE[0]}") || ! TO=$(to_serial "${RANGE[1]}"); then
+            error_exit 1 "Invalid date" "from" "${RANGE[0]}" "to" "${RANGE[1]}"
+            exit 1
+        fi
+        ;;
+esac
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+#############################################
+# Main
+#############################################
+# Aggregate tables: each shard's table is (re)built on demand; album rows
+# are concatenated, artist rows merged across shards
+if [ "$SUBCOMMAND" = "table" ]; then
+    tables=()
+    for db in "${TARGETS[@]}"; do
+        if [ ! -f "$db" ]; then
+            error_exit 2 "Database not found" "database" "$db"
+            exit 2
+        fi
+        if ! table=$(agg_table_ensure "$db" "$TABLE"); then
+            error_exit 2 "Failed to build aggregate table" "database" "$db" "table" "$TABLE"
+            exit 2
+        fi
+        tables+=("$table")
+    done
+
+    if [ "$TABLE" = artists ] && [ "${#tables[@]}" -gt 1 ]; then
+        agg_artists_merge "${tables[@]}"
+    else
+        printf '%s\n' "$header"
+        for table in "${tables[@]}"; do tail -n +2 "$table"; done
+    fi | {
+        IFS= read -r line && printf '%s\n' "$line"
+        case "$SORT_COLUMN" in
+            "") cat ;;
+            IDAlbum) LC_ALL=C sort -s -t'^' -k"$SORT_KEY,$SORT_KEY"n ;;
+            Album|Artist|PathPrefix) LC_ALL=C sort -s -t'^' -k"$SORT_KEY,$SORT_KEY" ;;
+            *) LC_ALL=C sort -s -t'^' -k"$SORT_KEY,$SORT_KEY"gr ;;
+        esac | if [ "$COUNT" -gt 0 ]; then head -n "$COUNT"; else cat; fi
+    }
+    exit 0
+fi
+
+# Text search: phrase -> paths from each shard's text index, then the rows
+# for those paths
+if [ "$SUBCOMMAND" = "text" ]; then
+    declare -A text_paths=()
+    for db in "${TARGETS[@]}"; do
+        if [ ! -f "$db" ]; then
+            error_exit 2 "Database not found" "database" "$db"
+            exit 2
+        fi
+        text_paths["$db"]=$(text_index_search "$db" "${WORDS[*]}")
+        case $? in
+            1)
+                error_exit 1 "Search words must be longer than one character" "text" "${WORDS[*]}"
+                exit 1
+                ;;
+            2)
+                error_exit 2 "No text index (run: musiclib-cli db textindex)" "database" "$db"
+                exit 2
+                ;;
+        esac
+    done
+
+    head -n 1 "${TARGETS[0]}"
+    for db in "${TARGETS[@]}"; do
+        [ -z "${text_paths[$db]}" ] && continue
+        printf '%s\n' "${text_paths[$db]}" | awk -F'^' -v stars="$STARS" '
+            FNR == NR { want[$0] = 1; next }
+            FNR == 1 {
+                for (i = 1; i <= NF; i++) {
+                    if ($i == "SongPath") pcol = i
+                    if ($i == "GroupDesc") gcol = i
+                }
+                next
+            }
+            ($pcol in want) && (stars < 0 || $gcol + 0 == stars)
+        ' - "$db"
+    done | if [ "$COUNT" -gt 0 ]; then head -n "$COUNT"; else cat; fi
+    exit 0
+fi
+
+# Each shard contributes its own best COUNT records; they are merged on the
+# serial and cut to COUNT again.
+collect() {
+    local db idx
+    for db in "${TARGETS[@]}"; do
+        if [ ! -f "$db" ]; then
+            error_exit 2 "Database not found" "database" "$db"
+            return 2
+        fi
+        if ! idx=$(lp_index_ensure "$db"); then
+            error_exit 2 "Failed to build played index" "database" "$db"
+            return 2
+        fi
+        lp_index_range "$idx" "$STARS" "$FROM" "$TO" "$MODE" "$COUNT" | sed "s|\$|^$db|"
+    done
+}
+
+if ! records=$(collect); then
+    exit 2
+fi
+
+head -n 1 "${TARGETS[0]}"
+[ -z "$records" ] && exit 0
+
+if [ "$MODE" = newest ]; then
+    sort_opts=(-t'^' -k2,2r)
+else
+    sort_opts=(-t'^' -k2,2)
+fi
+printf '%s\n' "$records" | LC_ALL=C sort -s "${sort_opts[@]}" |
+    if [ "$COUNT" -gt 0 ]; then head -n "$COUNT"; else cat; fi | lp_rows_at
+exit 0
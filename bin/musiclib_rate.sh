@@ -1,9 +1,10 @@
 #!/bin/bash
 #
 # musiclib_rate.sh - Rate a track's star rating
-# Usage: musiclib_rate.sh <star_rating> [filepath]
+# Usage: musiclib_rate.sh <star_rating> [filepath...]
 #
 # When filepath is provided, rates that specific file (GUI mode).
+# Several filepaths are rated together in one batch (see Batch Rating).
 # When filepath is omitted, rates the currently playing track in the active
 # MPRIS2 player via playerctld (keyboard shortcut mode).
 #
@@ -94,7 +95,7 @@ declare -A STAR_TO_IMAGE=(
 # Validate Input
 #############################################
 if [ $# -eq 0 ]; then
-    echo "Usage: musiclib-cli rate <star_rating> [filepath]"
+    echo "Usage: musiclib-cli rate <star_rating> [filepath...]"
     echo ""
     echo "Rate a track in the MusicLib database"
     echo ""
@@ -109,7 +110,8 @@ if [ $# -eq 0 ]; then
     echo ""
     echo "  filepath       (Optional) Absolute path to the audio file."
     echo "                 If omitted, rates the currently playing track"
-    echo "                 in the active MPRIS2 player."
+    echo "                 in the active MPRIS2 player. Several files are"
+    echo "                 rated together: one database update, one notification."
     echo ""
     echo "Keyboard shortcuts (bind these for current-track rating):"
     echo "  META+0  = Needs rating (0 stars)"
@@ -129,6 +131,241 @@ if [[ ! "$STAR_RATING" =~ ^[0-5]$ ]]; then
     exit 1
 fi
 
+#############################################
+# Batch Rating (several files)
+#############################################
+# "musiclib_rate.sh N FILE FILE..." (Dolphin service menu with %F, or a
+# multi-selection) rates every file in one run: one kid3-cli call for the
+# tags, one locked rewrite of each shard DSV, one setfattr call for Baloo
+# and one summary notification.  Running one rate per file instead would
+# rewrite the whole DSV per file, with every run fighting for the lock.
+
+# Apply the rating to every path listed in <list> with one rewrite of
+# $MUSICDB (call under the DB lock).  Prints one line per listed path:
+#   updated|not-found ^ ID ^ PATH ^ OLD_RATING ^ OLD_GROUPDESC
+# Returns 2 on error (never 1, which with_db_lock reserves for a timeout).
+rate_rows_in_db() {
+    local list="$1"
+    local pathcol ratingcol groupcol results
+
+    if [ ! -f "$MUSICDB" ]; then
+        error_exit 2 "Database file not found" "database" "$MUSICDB"
+        return 2
+    fi
+    if ! pathcol=$(get_column_index "$MUSICDB" "SongPath") \
+            || ! ratingcol=$(get_column_index "$MUSICDB" "Rating") \
+            || ! groupcol=$(get_column_index "$MUSICDB" "GroupDesc"); then
+        error_exit 2 "Could not find SongPath, Rating or GroupDesc columns in database" "database" "$MUSICDB"
+        return 2
+    fi
+
+    if ! results=$(awk -F'^' -v OFS='^' -v list="$list" -v out="$MUSICDB.tmp" \
+            -v pcol="$pathcol" -v rcol="$ratingcol" -v gcol="$groupcol" \
+            -v new_rating="$POPM_VALUE" -v new_group="$GROUPDESC_VALUE" '
+        BEGIN {
+            while ((getline line < list) > 0) { order[++n] = line; want[line] = 1 }
+        }
+        NR > 1 && ($pcol in want) && !($pcol in old) {
+            old[$pcol] = $1 "^" $pcol "^" $rcol "^" $gcol
+            $rcol = new_rating
+            $gcol = new_group
+        }
+        { print > out }
+        END {
+            for (i = 1; i <= n; i++)
+                print ((order[i] in old) ? "updated^" old[order[i]] : "not-found^^" order[i] "^^")
+        }
+    ' "$MUSICDB"); then
+        rm -f "$MUSICDB.tmp"
+        error_exit 2 "Failed to update database columns" "database" "$MUSICDB"
+        return 2
+    fi
+
+    if ! mv "$MUSICDB.tmp" "$MUSICDB" 2>/dev/null; then
+        rm -f "$MUSICDB.tmp"
+        error_exit 2 "Failed to finalize database update" "database" "$MUSICDB"
+        return 2
+    fi
+
+    local status id path old_rating old_group count
+    count=$(grep -c '^updated' <<< "$results" || true)
+    if [ "$count" -gt "$BATCH_DELETE_MAX_EVENTS" ]; then
+        publish_change "$MUSICDB" reload "" ""
+    else
+        while IFS='^' read -r status id path old_rating old_group; do
+            [ "$status" = updated ] || continue
+            publish_change "$MUSICDB" update "$id" "$path" \
+                Rating "$old_rating" "$POPM_VALUE" GroupDesc "$old_group" "$GROUPDESC_VALUE"
+        done <<< "$results"
+    fi
+    printf '%s\n' "$results"
+}
+
+# Rate every file given; exit code as for a single file (0, 1, 2, or 3 if
+# any rating had to be queued).
+# Usage: rate_files FILE...
+rate_files() {
+    local -a files=() tagged=() failed=()
+    local f
+
+    # kid3-cli is always required for tag writes, as for a single file
+    check_required_tools kid3-cli || {
+        error_exit 2 "Required tools not available" "missing" "kid3-cli"
+        return 2
+    }
+
+    for f in "$@"; do
+        if [ -f "$f" ]; then
+            files+=("$f")
+        else
+            echo "Warning: Track file not found: $f" >&2
+            failed+=("$f")
+        fi
+    done
+    if [ "${#files[@]}" -eq 0 ]; then
+        error_exit 2 "Track files not found" "files" "$#"
+        return 2
+    fi
+
+    echo "Rating ${#files[@]} tracks"
+    echo "  Stars: $STAR_RATING"
+    echo "  POPM: $POPM_VALUE"
+    echo "  GroupDesc: $GROUPDESC_VALUE"
+
+    # Tags: one kid3-cli run for all files; only when it fails are the files
+    # redone one at a time, with the same tag repair as a single rating
+    echo "Updating file tags..."
+    if kid3-cli -c "set POPM $POPM_VALUE" -c "set TIT1 $GROUPDESC_VALUE" "${files[@]}" 2>/dev/null; then
+        tagged=("${files[@]}")
+    else
+        for f in "${files[@]}"; do
+            if kid3-cli -c "set POPM $POPM_VALUE" -c "set TIT1 $GROUPDESC_VALUE" "$f" 2>/dev/null \
+                    || { rebuild_tag "$f" && kid3-cli -c "set POPM $POPM_VALUE" -c "set TIT1 $GROUPDESC_VALUE" "$f" 2>/dev/null; }; then
+                tagged+=("$f")
+            else
+                echo "Warning: Tag write failed: $f" >&2
+                failed+=("$f")
+            fi
+        done
+    fi
+    [ "${#tagged[@]}" -gt 0 ] || { error_exit 2 "Tag write failed for every track" "files" "${#files[@]}"; return 2; }
+
+    # Database: group the files by owning shard, then one locked rewrite each
+    echo "Updating database..."
+    local -A shard_list=()
+    local db list i=0
+    local -a owners=()
+    mapfile -t owners < <(printf '%s\n' "${tagged[@]}" | shard_db_for_paths)
+    for f in "${tagged[@]}"; do
+        db="${owners[$i]}"
+        i=$((i + 1))
+        if [ -z "${shard_list[$db]:-}" ]; then
+            shard_list[$db]=$(mktemp)
+        fi
+        printf '%s\n' "$f" >> "${shard_list[$db]}"
+    done
+
+    local updated=0 not_found=0 queued=0 rc attempt results line
+    local pending_file="" ts shard_queued
+    for db in "${!shard_list[@]}"; do
+        list="${shard_list[$db]}"
+        MUSICDB="$db"
+        rc=1
+        for (( attempt = 1; attempt <= 3 && rc == 1; attempt++ )); do
+            [ "$attempt" -gt 1 ] && sleep 2
+            rc=0
+            results=$(with_db_lock 2 rate_rows_in_db "$list") || rc=$?
+        done
+
+        if [ "$rc" -eq 1 ]; then
+            # Still locked: queue every rating of this shard for
+            # musiclib_process_pending.sh, as a single rating would
+            pending_file="$(get_data_dir)/data/.pending_operations"
+            mkdir -p "$(dirname "$pending_file")" 2>/dev/null || true
+            ts=$(date +%s)
+            shard_queued=0
+            while IFS= read -r f; do
+                echo "$ts|musiclib_rate.sh|rate|$f|$STAR_RATING" >> "$pending_file"
+                shard_queued=$((shard_queued + 1))
+            done < "$list"
+            queued=$((queued + shard_queued))
+            log_message "PENDING: Rating $shard_queued tracks -> $STAR_RATING stars (database $db locked)"
+        elif [ "$rc" -ne 0 ]; then
+            while IFS= read -r f; do failed+=("$f"); done < "$list"
+        else
+            local missing=0
+            while IFS='^' read -r line _; do
+                case "$line" in
+                    updated)   updated=$((updated + 1)) ;;
+                    not-found) missing=$((missing + 1)) ;;
+                esac
+            done <<< "$results"
+            if [ "$missing" -gt 0 ]; then
+                log_message "Note: $missing rated tracks not found in database $db"
+                not_found=$((not_found + missing))
+            fi
+        fi
+        rm -f "$list"
+    done
+
+    # Baloo (Dolphin's Rating column): one setfattr call for all files
+    if command -v setfattr >/dev/null 2>&1; then
+        if ! setfattr -n "user.baloo.rating" -v "$((GROUPDESC_VALUE * 2))" "${tagged[@]}" 2>/dev/null; then
+            echo "Warning: Failed to set Baloo rating attribute on some files" >&2
+        fi
+    fi
+
+    # Conky shows the now-playing rating: refresh it if that track was rated
+    local current_playing
+    current_playing=$(get_current_player_filepath 2>/dev/null || true)
+    if [ -n "$current_playing" ]; then
+        for f in "${tagged[@]}"; do
+            [ "$f" = "$current_playing" ] || continue
+            mkdir -p "$MUSIC_DIR" 2>/dev/null &&
+                echo "$GROUPDESC_VALUE" > "$MUSIC_DIR/currgpnum.txt" 2>/dev/null &&
+                rm -f "$MUSIC_DIR/starrating.png" &&
+                { [ ! -f "$STAR_DIR/$IMAGE_FILE" ] || cp "$STAR_DIR/$IMAGE_FILE" "$MUSIC_DIR/starrating.png"; } ||
+                echo "Warning: Failed to update Conky rating display" >&2
+            break
+        done
+    fi
+
+    # One summary line and notification for the whole batch
+    local stars="Needs rating" summary
+    [ "$STAR_RATING" -gt 0 ] && stars=$(printf '★%.0s' $(seq 1 "$STAR_RATING"))
+    summary="$updated tracks rated: $stars"
+    [ "$not_found" -gt 0 ] && summary+=", $not_found not in database"
+    [ "$queued" -gt 0 ] && summary+=", $queued queued (database busy)"
+    [ "${#failed[@]}" -gt 0 ] && summary+=", ${#failed[@]} failed"
+    echo "✓ $summary"
+    log_message "Rated $updated tracks -> $STAR_RATING stars (batch of $#)"
+    if command -v kdialog >/dev/null 2>&1; then
+        kdialog --title 'Rating Updated' --passivepopup "$summary" 4 &
+    fi
+
+    if [ -f "$SCRIPT_DIR/musiclib_process_pending.sh" ] && [ "$queued" -eq 0 ]; then
+        "$SCRIPT_DIR/musiclib_process_pending.sh" &
+    fi
+
+    if [ "${#failed[@]}" -gt 0 ]; then
+        return 2
+    elif [ "$queued" -gt 0 ]; then
+        error_exit 3 "Operation queued due to database lock contention" "queued" "$queued" "stars" "$STAR_RATING"
+        return 3
+    fi
+    return 0
+}
+
+if [ $# -ge 3 ]; then
+    POPM_VALUE=${STAR_TO_POPM[$STAR_RATING]}
+    GROUPDESC_VALUE=${STAR_TO_GROUPDESC[$STAR_RATING]}
+    IMAGE_FILE=${STAR_TO_IMAGE[$STAR_RATING]}
+    shift
+    batch_rc=0
+    rate_files "$@" || batch_rc=$?
+    exit "$batch_rc"
+fi
+
 #############################################
 # Determine Track Filepath
 #############################################
@@ -146,8 +383,8 @@ if [ $# -ge 2 ]; then
     }
 else
     # Keyboard shortcut mode: get filepath from active MPRIS2 player
-    check_required_tools qdbus6 playerctl kid3-cli || {
-        error_exit 2 "Required tools not available" "missing" "qdbus6 or playerctl or kid3-cli"
+    check_required_tools "${MUSICLIB_CLI:-musiclib-cli}" kid3-cli || {
+        error_exit 2 "Required tools not available" "missing" "musiclib-cli or kid3-cli"
         exit 2
     }
 
@@ -164,6 +401,10 @@ if [ ! -f "$FILEPATH" ]; then
     exit 2
 fi
 
+# Write to the shard that owns this file (its DSV and lock); unchanged
+# when LIBRARY_SHARDS is not configured
+MUSICDB=$(shard_db_for_path "$FILEPATH")
+
 #############################################
 # Track Display Info (for notifications)
 #############################################
@@ -185,20 +426,18 @@ get_track_display_info() {
         fi
     fi
 
-    # Fallback: try MPRIS2 metadata, then basename
-    if [ -z "$display_title" ]; then
-        detect_active_mpris_bus
-        display_title=$(mpris_metadata_field "xesam:title" 2>/dev/null) || true
+    # Fallback: try MPRIS2 metadata (both fields in one query), then basename
+    if [ -z "$display_title" ] || [ -z "$display_artist" ]; then
+        local mpris_title="" mpris_artist=""
+        { read -r mpris_title; read -r mpris_artist; } \
+            < <(_musiclib_player metadata xesam:title xesam:artist) || true
+        [ -z "$display_title" ] && display_title="$mpris_title"
+        [ -z "$display_artist" ] && display_artist="$mpris_artist"
     fi
     if [ -z "$display_title" ]; then
         display_title=$(basename "$FILEPATH")
     fi
 
-    if [ -z "$display_artist" ]; then
-        detect_active_mpris_bus
-        display_artist=$(mpris_metadata_field "xesam:artist" 2>/dev/null) || true
-    fi
-
     TRACK_DISPLAY_TITLE="$display_title"
     TRACK_DISPLAY_ARTIST="$display_artist"
 }
@@ -301,6 +540,9 @@ update_database() {
         rm -f "$MUSICDB.tmp"
         return 2
     fi
+    record_id=$(echo "$grepped_string" | cut -f2- -d: | cut -f1 -d"^")
+    publish_change "$MUSICDB" update "$record_id" "$FILEPATH" \
+        Rating "$old_rating" "$POPM_VALUE" GroupDesc "$old_groupdesc" "$GROUPDESC_VALUE"
     return 0
 }
 
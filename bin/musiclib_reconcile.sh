@@ -0,0 +1,341 @@
+#!/bin/bash
+#
+# musiclib_reconcile.sh - Re-attach database rows to files that were moved
+# Usage: musiclib_reconcile.sh [--apply] [--root DIR] [-j JOBS] [-d FILE | --shard NAME]
+#
+# Rows whose SongPath no longer exists are joined against audio files under
+# the music root that no row points at ("orphans"), in three passes; each
+# pass only considers what the previous ones left unmatched, and a match
+# must be unique on both sides:
+#
+#   1. inode   same device, inode and size as recorded in <dsv>.fileids (mv)
+#   2. payload same size and payload hash as recorded (copy + delete, e.g.
+#              conform_musiclib.sh)
+#   3. tags    same Artist / Album / Title (case-insensitive) as the row
+#
+# Passes 1 and 2 need the identity records written by file_ids_update (see
+# FILE IDENTITIES in musiclib_db.sh), which this script and musiclib_build.sh
+# refresh on every run.  With --apply every matched row gets its new
+# SongPath in one rewrite under the lock; ID, rating, play history and all
+# other fields are kept.
+#
+# Output: one "ID<TAB>PASS<TAB>OLD PATH<TAB>NEW PATH" line per match, then a
+# summary.
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard)
+#   2 - System error (config failure, database not found, lock timeout)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_reconcile.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_reconcile.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli reconcile [options]
+
+Find files that were moved or renamed on disk and point their database
+rows at the new paths, keeping ID, rating and play history.  Without
+--apply only the matches are listed.
+
+Options:
+  --apply         Write the new paths to the database
+  --root DIR      Music directory to search (default: the shard's root)
+  -j JOBS         Parallel workers for hashing and tag reads (default: CPUs)
+  -d FILE         Database to reconcile (default: every library shard)
+  --shard NAME    Reconcile the named library shard only
+  -h, --help      Display this help
+
+Matching passes: inode, then size + audio payload hash, then
+Artist/Album/Title.  A match must be unique on both sides.
+
+Examples:
+  musiclib-cli reconcile
+  musiclib-cli reconcile --apply
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+APPLY=false
+ROOT_OVERRIDE=""
+JOBS=""
+TARGET_DB=""
+LOCK_TIMEOUT=10
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        --root|-j|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --root) ROOT_OVERRIDE="${2%/}" ;;
+                -j)     JOBS="$2" ;;
+                -d)     TARGET_DB="$2" ;;
+                --shard)
+                    if ! shard=$(get_library_shard "$2"); then
+                        error_exit 1 "Unknown library shard" "shard" "$2"
+                        exit 1
+                    fi
+                    TARGET_DB="${shard#*$'\t'}"
+                    ;;
+            esac
+            shift 2
+            ;;
+        --apply)
+            APPLY=true
+            shift
+            ;;
+        *)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+    esac
+done
+
+JOBS="${JOBS:-$(nproc 2>/dev/null || echo 2)}"
+if ! [[ "$JOBS" =~ ^[1-9][0-9]*$ ]]; then
+    error_exit 1 "-j must be a positive integer" "jobs" "$JOBS"
+    exit 1
+fi
+
+# "root<TAB>dsv" per target
+TARGETS=()
+while IFS=$'\t' read -r _name root dsv; do
+    if [ -z "$TARGET_DB" ] || [ "$dsv" = "$TARGET_DB" ]; then
+        TARGETS+=("${ROOT_OVERRIDE:-$root}"$'\t'"$dsv")
+    fi
+done < <(list_library_shards)
+if [ -n "$TARGET_DB" ] && [ "${#TARGETS[@]}" -eq 0 ]; then
+    TARGETS=("${ROOT_OVERRIDE:-${MUSIC_ROOT_DIR:-/mnt/music}}"$'\t'"$TARGET_DB")
+fi
+
+#############################################
+# Matching
+#############################################
+WORK_DIR=""
+cleanup() { [ -n "$WORK_DIR" ] && rm -rf "$WORK_DIR"; }
+trap cleanup EXIT
+
+# Lower-case, whitespace-collapsed "artist<US>album<US>title" key
+TAG_KEY_AWK='
+function tagkey(a, b, t,    k) {
+    k = tolower(a) "\037" tolower(b) "\037" tolower(t)
+    gsub(/[ \t]+/, " ", k)
+    return k
+}'
+
+# Writes $WORK_DIR/matches: ID<TAB>PASS<TAB>OLD<TAB>NEW
+find_matches() {
+    local root="$1" db="$2"
+    local ids="${db}.fileids"
+
+    # Rows whose file is gone: ID<TAB>PATH<TAB>ARTIST<TAB>ALBUM<TAB>TITLE
+    awk -F'^' -v OFS='\t' '
+        NR == 1 {
+            for (i = 1; i <= NF; i++) {
+                if ($i == "SongPath") p = i
+                else if ($i == "Artist") a = i
+                else if ($i == "Album") b = i
+                else if ($i == "SongTitle") t = i
+            }
+            next
+        }
+        { print $1, $p, $a, $b, $t }
+    ' "$db" > "$WORK_DIR/rows" || return 2
+    while IFS=$'\t' read -r id path rest; do
+        [ -e "$path" ] || printf '%s\t%s\t%s\n' "$id" "$path" "$rest"
+    done < "$WORK_DIR/rows" > "$WORK_DIR/missing"
+
+    : > "$WORK_DIR/matches"
+    if [ ! -s "$WORK_DIR/missing" ]; then
+        return 0
+    fi
+
+    # Audio files no row points at: PATH<TAB>DEV:INODE<TAB>SIZE
+    cut -f2 "$WORK_DIR/rows" | LC_ALL=C sort -u > "$WORK_DIR/known"
+    find "$root" -type f \( \
+        -iname "*.mp3" -o -iname "*.flac" -o -iname "*.m4a" -o \
+        -iname "*.ogg" -o -iname "*.opus" -o -iname "*.wma" \) 2>/dev/null |
+        LC_ALL=C sort | LC_ALL=C comm -23 - "$WORK_DIR/known" | tr '\n' '\0' |
+        xargs -0 -r stat -c $'%n\t%d:%i\t%s' 2>/dev/null > "$WORK_DIR/orphans"
+    if [ ! -s "$WORK_DIR/orphans" ]; then
+        return 0
+    fi
+
+    # Recorded identities of the missing paths: ID<TAB>OLD<TAB>DEV:INODE<TAB>SIZE<TAB>HASH
+    if [ -f "$ids" ]; then
+        LC_ALL=C awk -F'\t' -v OFS='\t' '
+            FNR == NR { rec[$1] = $2 "\t" $3 "\t" $5; next }
+            ($2 in rec) { print $1, $2, rec[$2] }
+        ' "$ids" "$WORK_DIR/missing" > "$WORK_DIR/recorded"
+    else
+        : > "$WORK_DIR/recorded"
+    fi
+
+    # Pass 1: inode (with size, in case the inode was reused)
+    LC_ALL=C awk -F'\t' -v OFS='\t' '
+        FNR == NR { k = $3 "\t" $4; n[k]++; id[k] = $1; old[k] = $2; next }
+        { k = $2 "\t" $3; m[k]++; path[k] = $1 }
+        END { for (k in m) if (m[k] == 1 && n[k] == 1) print id[k], "inode", old[k], path[k] }
+    ' "$WORK_DIR/recorded" "$WORK_DIR/orphans" >> "$WORK_DIR/matches"
+
+    # Pass 2: size + payload hash.  Only orphans whose size some missing
+    # record has are hashed.
+    LC_ALL=C awk -F'\t' '
+        FILENAME == ARGV[1] { done_id[$1] = 1; done_path[$4] = 1; next }
+        FILENAME == ARGV[2] { if (!($1 in done_id)) size[$4] = 1; next }
+        !($1 in done_path) && ($3 in size) { print $1 }
+    ' "$WORK_DIR/matches" "$WORK_DIR/recorded" "$WORK_DIR/orphans" | tr '\n' '\0' |
+        xargs -0 -r -n 64 -P "$JOBS" bash -c '
+            block="$1"; shift
+            for f; do
+                size=$(stat -c %s "$f" 2>/dev/null) || continue
+                h=$(dd if="$f" bs="$block" skip=$(( size / 2 / block )) count=1 2>/dev/null | sha256sum)
+                printf "%s\t%s:%s\n" "$f" "$size" "${h:0:16}"
+            done > "$0/hash.$$"
+        ' "$WORK_DIR" "$FILE_ID_BLOCK"
+    cat "$WORK_DIR"/hash.* 2>/dev/null > "$WORK_DIR/hashes"
+    LC_ALL=C awk -F'\t' -v OFS='\t' '
+        FILENAME == ARGV[1] { done_id[$1] = 1; next }
+        FILENAME == ARGV[2] { if (!($1 in done_id)) { k = $4 ":" $5; n[k]++; id[k] = $1; old[k] = $2 } next }
+        { m[$2]++; path[$2] = $1 }
+        END { for (k in m) if (m[k] == 1 && n[k] == 1) print id[k], "payload", old[k], path[k] }
+    ' "$WORK_DIR/matches" "$WORK_DIR/recorded" "$WORK_DIR/hashes" > "$WORK_DIR/pass2"
+    cat "$WORK_DIR/pass2" >> "$WORK_DIR/matches"
+
+    # Pass 3: tags of the orphans still unmatched
+    if command -v exiftool >/dev/null 2>&1 && command -v jq >/dev/null 2>&1; then
+        LC_ALL=C awk -F'\t' '
+            FNR == NR { done_path[$4] = 1; next }
+            !($1 in done_path) { print $1 }
+        ' "$WORK_DIR/matches" "$WORK_DIR/orphans" | tr '\n' '\0' |
+            xargs -0 -r -n 50 -P "$JOBS" bash -c '
+                exiftool -j -q -q -m -charset filename=utf8 -Artist -Album -Title "$@" 2>/dev/null |
+                    jq -r ".[] | [.SourceFile, (.Artist // \"\" | tostring),
+                                  (.Album // \"\" | tostring), (.Title // \"\" | tostring)] | @tsv" \
+                    > "$0/tags.$$" 2>/dev/null
+                exit 0
+            ' "$WORK_DIR"
+        cat "$WORK_DIR"/tags.* 2>/dev/null |
+            awk -F'\t' -v OFS='\t' "$TAG_KEY_AWK"'
+                FILENAME == ARGV[1] { done_id[$1] = 1; next }
+                FILENAME == ARGV[2] { if (!($1 in done_id) && $5 != "") { k = tagkey($3, $4, $5); n[k]++; id[k] = $1; old[k] = $2 } next }
+                $4 != "" { k = tagkey($2, $3, $4); m[k]++; path[k] = $1 }
+                END { for (k in m) if (m[k] == 1 && n[k] == 1) print id[k], "tags", old[k], path[k] }
+            ' "$WORK_DIR/matches" "$WORK_DIR/missing" - > "$WORK_DIR/pass3"
+        cat "$WORK_DIR/pass3" >> "$WORK_DIR/matches"
+    fi
+}
+
+# Point every matched row at its new path (called inside the lock)
+apply_matches() {
+    local db="$1"
+    local tmp="${db}.tmp"
+
+    awk -F'^' -v OFS='^' -v matches="$WORK_DIR/matches" '
+        BEGIN {
+            while ((getline line < matches) > 0) {
+                split(line, f, "\t")
+                old[f[1]] = f[3]; new[f[1]] = f[4]
+            }
+        }
+        NR == 1 { for (i = 1; i <= NF; i++) if ($i == "SongPath") p = i; print; next }
+        ($1 in new) && $p == old[$1] { $p = new[$1]; updated++ }
+        { print }
+        END { print updated + 0 > "/dev/stderr" }
+    ' "$db" > "$tmp" 2> "$WORK_DIR/updated" || { rm -f "$tmp"; return 2; }
+
+    if [ "$(cat "$WORK_DIR/updated")" -eq 0 ]; then
+        rm -f "$tmp"
+        return 0
+    fi
+    backup_database "$db" > /dev/null || { rm -f "$tmp"; return 2; }
+    mv "$tmp" "$db" || { rm -f "$tmp"; return 2; }
+    publish_change "$db" reload "" ""
+}
+
+#############################################
+# Main
+#############################################
+total_missing=0
+total_matched=0
+for target in "${TARGETS[@]}"; do
+    root="${target%%$'\t'*}"
+    db="${target#*$'\t'}"
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+    if [ ! -d "$root" ]; then
+        error_exit 1 "Music directory not found" "root" "$root"
+        exit 1
+    fi
+
+    WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_reconcile.XXXXXX") || exit 2
+    if ! find_matches "$root" "$db"; then
+        error_exit 2 "Reconciliation failed" "database" "$db"
+        exit 2
+    fi
+
+    missing=$(wc -l < "$WORK_DIR/missing")
+    matched=$(wc -l < "$WORK_DIR/matches")
+    cat "$WORK_DIR/matches"
+    total_missing=$((total_missing + missing))
+    total_matched=$((total_matched + matched))
+
+    if [ "$APPLY" = true ] && [ "$matched" -gt 0 ]; then
+        MUSICDB="$db"
+        with_db_lock "$LOCK_TIMEOUT" apply_matches "$db"
+        rc=$?
+        if [ "$rc" -eq 1 ]; then
+            error_exit 2 "Database lock timeout" "database" "$db" "timeout" "${LOCK_TIMEOUT}s"
+            exit 2
+        elif [ "$rc" -ne 0 ]; then
+            error_exit 2 "Failed to write new paths" "database" "$db"
+            exit 2
+        fi
+        log_message "Reconciled $db: $matched moved files re-attached" > /dev/null
+    fi
+
+    # Remember the files as they are now for the next run
+    file_ids_update "$db" "$JOBS" || true
+
+    rm -rf "$WORK_DIR"
+    WORK_DIR=""
+done
+
+echo "Missing files: $total_missing, matched: $total_matched, unmatched: $((total_missing - total_matched))"
+if [ "$APPLY" = false ] && [ "$total_matched" -gt 0 ]; then
+    echo "Run with --apply to update the database."
+fi
+exit 0
@@ -2,6 +2,7 @@
 #
 # musiclib_remove_record.sh - Remove a single track record from the database
 # Usage: musiclib_remove_record.sh <filepath> [record_id] [--delete-file]
+#        musiclib_remove_record.sh --batch <listfile|-> [--delete-file]
 #
 # Removes the database row matching the given file path.
 # By default the audio file on disk is NOT deleted — only the DSV record is
@@ -20,6 +21,19 @@
 # It handles config loading, argument validation, and database locking so
 # the GUI (QProcess) has a single script to invoke.
 #
+# --batch removes many rows at once: the list (a file, or stdin for "-")
+# holds one "ID<TAB>filepath" line per row.  Each shard is rewritten once
+# under one lock via delete_records_batch(), and one result line per
+# request is printed (per database, malformed lines last):
+# "STATUS<TAB>ID<TAB>filepath" with STATUS one of
+#   removed    row removed (file kept, or already absent with --delete-file)
+#   deleted    row removed and file deleted (--delete-file)
+#   file-error row removed, file could not be deleted
+#   not-found  no row with that ID and path
+#   invalid    malformed list line
+# followed by "Removed N of M records".  Exit code 1 when any request was
+# not-found or invalid; the other rows are still removed.
+#
 # Exit codes:
 #   0 - Success (record removed; file also deleted when --delete-file was given)
 #   1 - User error (no match, multiple matches, missing argument)
@@ -52,11 +66,140 @@ fi
 
 MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
 
+#############################################
+# Batch Mode
+#############################################
+# delete_records_batch returns 1 on I/O errors, which with_db_lock would
+# report like a lock timeout
+delete_batch_locked() {
+    delete_records_batch "$@" || return 2
+}
+
+# Usage: run_batch <listfile|-> <delete_file>
+run_batch() {
+    local list="$1" delete_file="$2"
+    local rc=0
+    BATCH_WORK=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_remove.XXXXXX") || {
+        error_exit 2 "Cannot create temporary directory"
+        return 2
+    }
+    trap 'rm -rf "$BATCH_WORK"' EXIT
+    local work="$BATCH_WORK"
+
+    if [ "$list" = "-" ]; then
+        cat > "$work/list"
+    elif [ -r "$list" ]; then
+        cat -- "$list" > "$work/list"
+    else
+        error_exit 1 "Batch list not readable" "list" "$list"
+        return 1
+    fi
+
+    # Assign every request to the shard that owns its path; each request
+    # keeps its position so the report can follow the input
+    local line id path
+    local total=0
+    : > "$work/requests"
+    : > "$work/paths"
+    while IFS= read -r line || [ -n "$line" ]; do
+        [ -z "$line" ] && continue
+        total=$((total + 1))
+        id="${line%%$'\t'*}"
+        path="${line#*$'\t'}"
+        if [ "$id" = "$line" ] || [ -z "$id" ] || [ -z "$path" ]; then
+            printf '%s\tinvalid\t%s\t\n' "$total" "$line" >> "$work/invalid"
+            continue
+        fi
+        printf '%s\t%s\t%s\n' "$total" "$id" "$path" >> "$work/requests"
+        printf '%s\n' "$path" >> "$work/paths"
+    done < "$work/list"
+    shard_db_for_paths < "$work/paths" | paste - "$work/requests" > "$work/byshard"
+
+    # One locked rewrite per shard
+    local db attempt lock_result
+    if [ -s "$work/byshard" ]; then
+        while IFS= read -r db; do
+            if [ ! -f "$db" ]; then
+                error_exit 2 "Database file not found" "database" "$db"
+                return 2
+            fi
+            awk -F'\t' -v db="$db" -v seq="$work/shard.seq" '
+                $1 == db { print $3 "\t" $4; print $2 > seq }
+            ' "$work/byshard" > "$work/shard"
+
+            attempt=1
+            while true; do
+                lock_result=0
+                MUSICDB="$db" with_db_lock 2 delete_batch_locked "$db" "$work/shard" \
+                    > "$work/shard.results" || lock_result=$?
+                [ "$lock_result" -ne 1 ] || [ "$attempt" -ge 3 ] && break
+                sleep 2
+                attempt=$((attempt + 1))
+            done
+            case "$lock_result" in
+                # Results come in list order, so line N is request seq[N]
+                0) paste "$work/shard.seq" "$work/shard.results" >> "$work/results" ;;
+                1) error_exit 2 "Database lock timeout after 3 attempts" "database" "$db"
+                   return 2 ;;
+                *) error_exit 2 "Failed to remove records" "database" "$db"
+                   return 2 ;;
+            esac
+        done < <(cut -f1 "$work/byshard" | awk '!seen[$0]++')
+    fi
+
+    # Optional file deletion, then report in request order
+    local status removed=0
+    touch "$work/results" "$work/invalid"
+    while IFS=$'\t' read -r _seq status id path; do
+        if [ "$status" = removed ]; then
+            removed=$((removed + 1))
+            if [ "$delete_file" = true ] && [ -f "$path" ]; then
+                if rm -- "$path" 2>/dev/null; then
+                    status=deleted
+                else
+                    status=file-error
+                    echo "Warning: could not delete file: $path" >&2
+                fi
+            fi
+        else
+            rc=1
+        fi
+        printf '%s\t%s\t%s\n' "$status" "$id" "$path"
+    done < <(LC_ALL=C sort -s -t $'\t' -k1,1n "$work/results" "$work/invalid")
+
+    echo "Removed $removed of $total records"
+    log_message "Removed $removed of $total DB records via batch" > /dev/null
+    if command -v kdialog >/dev/null 2>&1; then
+        kdialog --title 'Records Removed' --passivepopup \
+            "Removed $removed of $total records" 3 &
+    fi
+    return "$rc"
+}
+
+if [ "${1:-}" = "--batch" ]; then
+    BATCH_LIST="${2:-}"
+    if [ -z "$BATCH_LIST" ]; then
+        error_exit 1 "--batch requires a list file or '-'" "option" "--batch"
+        exit 1
+    fi
+    BATCH_DELETE=false
+    for arg in "${@:3}"; do
+        case "$arg" in
+            --delete-file) BATCH_DELETE=true ;;
+            *) error_exit 1 "Unknown option" "option" "$arg"; exit 1 ;;
+        esac
+    done
+    batch_rc=0
+    run_batch "$BATCH_LIST" "$BATCH_DELETE" || batch_rc=$?
+    exit "$batch_rc"
+fi
+
 #############################################
 # Validate Input
 #############################################
 if [ $# -eq 0 ]; then
     echo "Usage: $0 <filepath> [record_id] [--delete-file]"
+    echo "       $0 --batch <listfile|-> [--delete-file]"
     echo ""
     echo "Remove a track record from the MusicLib database."
     echo "By default the audio file on disk is NOT deleted."
@@ -69,6 +212,9 @@ if [ $# -eq 0 ]; then
     echo "                 is removed — safe to use when duplicates exist."
     echo "  --delete-file  (Optional) Also delete the audio file from disk after"
     echo "                 the database record has been removed."
+    echo "  --batch LIST   Remove every row listed in LIST (\"-\" for stdin), one"
+    echo "                 \"ID<TAB>filepath\" line per row, in a single rewrite per"
+    echo "                 database.  Prints one STATUS<TAB>ID<TAB>filepath line per row."
     exit 1
 fi
 
@@ -93,6 +239,9 @@ fi
 # Note: we do NOT check whether the file exists on disk.
 # The user may be removing an orphaned record whose file was already deleted.
 
+# Remove from the shard that owns this path
+MUSICDB=$(shard_db_for_path "$FILEPATH")
+
 if [ ! -f "$MUSICDB" ]; then
     error_exit 2 "Database file not found" "database" "$MUSICDB"
     exit 2
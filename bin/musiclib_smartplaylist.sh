@@ -252,18 +252,24 @@ fi
 # Validation
 ###############################################################################
 
+# Sharded libraries: the pool is built from every shard by the analyze
+# script; here only the header matters, and all shards share the schema.
+if [[ "$(library_shard_count)" -gt 1 ]]; then
+    MUSICDB="$(list_library_shards | head -n 1 | cut -f3)"
+fi
+
 if ! validate_database "$MUSICDB"; then
     error_exit 2 "Database not found or invalid" "path" "$MUSICDB"; exit 2
 fi
 
-# If player load is requested, verify qdbus6 and playerctl are available
+# If player load is requested, verify qdbus6 and musiclib-cli are available
 if [[ "$load_player" == "true" ]]; then
     if ! command -v qdbus6 >/dev/null 2>&1; then
         error_exit 2 "qdbus6 not found — required for player integration" "tool" "qdbus6"
         exit 2
     fi
-    if ! command -v playerctl >/dev/null 2>&1; then
-        error_exit 2 "playerctl not found — required for player detection" "tool" "playerctl"
+    if ! command -v "${MUSICLIB_CLI:-musiclib-cli}" >/dev/null 2>&1; then
+        error_exit 2 "musiclib-cli not found — required for player detection" "tool" "musiclib-cli"
         exit 2
     fi
 fi
@@ -363,16 +369,22 @@ fi
 ###############################################################################
 # Build initial excluded-artists list
 # Seed with the most recently played unique effective artists from the pool.
-###############################################################################
-
-sort -t"$DELIM" -k"$timecolnum" -rn "$SP_POOL" \
-    | awk -F"$DELIM" \
-        -v acol="$artistcolnum" \
-        -v ccol="$custom2colnum" \
-        -v n="$SP_EXCLUDED_ARTISTS" \
-        '{ ea = (ccol > 0 && $ccol != "") ? $ccol : $acol
-           if (seen[ea]++ == 0 && got < n) { print ea; got++ }
-           if (got >= n) exit }' \
+# Only each artist's latest play matters, so reduce the pool to one
+# (time, artist) pair per artist and sort those instead of the whole pool.
+###############################################################################
+
+awk -F"$DELIM" \
+    -v acol="$artistcolnum" \
+    -v ccol="$custom2colnum" \
+    -v tcol="$timecolnum" \
+    '{ ea = (ccol > 0 && $ccol != "") ? $ccol : $acol
+       t = $tcol + 0
+       if (!(ea in latest) || t > latest[ea]) latest[ea] = t }
+     END { for (ea in latest) printf "%.6f\t%s\n", latest[ea], ea }' \
+    "$SP_POOL" \
+    | sort -t$'\t' -k1,1 -rn \
+    | head -n "$SP_EXCLUDED_ARTISTS" \
+    | cut -f2- \
     > "$SP_EXCL" 2>/dev/null || touch "$SP_EXCL"
 
 ###############################################################################
@@ -566,13 +578,9 @@ log_message "smartplaylist: generated $final_size tracks -> $playlist_output"
 ###############################################################################
 
 if [[ "$load_player" == "true" ]]; then
-    # Detect the active MPRIS2 player (sets MPRIS_BUS; uses playerctld allowlist).
-    detect_active_mpris_bus
-
-    # Determine player identity for dispatch.
-    # playerctl --player=playerctld returns the proxied player's name.
-    _active_player_name=$(playerctl --player=playerctld metadata \
-        --format '{{ playerName }}' 2>/dev/null || echo "")
+    # Determine the active allowed MPRIS2 player's identity for dispatch
+    # (playerctld ordering, supported_mpris_players allowlist).
+    _active_player_name=$(_musiclib_player name || echo "")
 
     if [[ "$_active_player_name" == "audacious"* ]]; then
         # ── Audacious path: direct D-Bus via org.atheme.audacious ──────────────
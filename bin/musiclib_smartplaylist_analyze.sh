@@ -216,6 +216,35 @@ SP_GROUP4_HIGH="${SP_GROUP4_HIGH:-$_rg4_high}"
 SP_GROUP5_LOW="${SP_GROUP5_LOW:-$_rg5_low}"
 SP_GROUP5_HIGH="${SP_GROUP5_HIGH:-$_rg5_high}"
 
+###############################################################################
+# Temp directory setup
+###############################################################################
+
+TMPDIR_SP="$(get_data_dir)/tmp"
+mkdir -p "$TMPDIR_SP" 2>/dev/null || {
+    error_exit 2 "Cannot create temp directory" "path" "$TMPDIR_SP"; exit 2
+}
+SP_POOL="${TMPDIR_SP}/sp_analyze_${$}_pool.dsv"
+
+cleanup() { rm -f "${TMPDIR_SP}/sp_analyze_${$}_"* 2>/dev/null || true; }
+trap cleanup EXIT
+
+###############################################################################
+# Library shards: analyse the union of every shard
+# With LIBRARY_SHARDS configured, the shard DSVs are merged into one
+# snapshot (shards read in parallel) and the rest of the script runs on it
+# unchanged.  A single-library setup skips this and reads MUSICDB directly.
+###############################################################################
+
+if [[ "$(library_shard_count)" -gt 1 ]]; then
+    SP_SHARDS_DB="${TMPDIR_SP}/sp_analyze_${$}_shards.dsv"
+    if ! merge_library_shards "$SP_SHARDS_DB"; then
+        error_exit 2 "Failed to read library shards" "shards" "$LIBRARY_SHARDS"
+        exit 2
+    fi
+    MUSICDB="$SP_SHARDS_DB"
+fi
+
 ###############################################################################
 # Validation
 ###############################################################################
@@ -238,19 +267,6 @@ custom2colnum=$(get_column_index "$MUSICDB" "Custom2" 2>/dev/null) || custom2col
 # Variance is appended after the last original DSV field
 varcol=$(( $(head -1 "$MUSICDB" | tr -cd "$DELIM" | wc -c) + 2 ))
 
-###############################################################################
-# Temp directory setup
-###############################################################################
-
-TMPDIR_SP="$(get_data_dir)/tmp"
-mkdir -p "$TMPDIR_SP" 2>/dev/null || {
-    error_exit 2 "Cannot create temp directory" "path" "$TMPDIR_SP"; exit 2
-}
-SP_POOL="${TMPDIR_SP}/sp_analyze_${$}_pool.dsv"
-
-cleanup() { rm -f "${TMPDIR_SP}/sp_analyze_${$}_"* 2>/dev/null || true; }
-trap cleanup EXIT
-
 ###############################################################################
 # Current SQL date (OLE Automation / Delphi epoch: days since 1899-12-30)
 ###############################################################################
@@ -0,0 +1,404 @@
+#!/bin/bash
+#
+# musiclib_sqlmirror.sh - Maintain a read-only SQLite mirror of the database
+# Usage: musiclib_sqlmirror.sh [--follow] [--rebuild] [-d FILE | --shard NAME] [-q]
+#
+# Keeps "<dsv>.sqlite" in step with the DSV so external tools can run SQL
+# over the library without touching the DSV.  The DSV stays the authority
+# (ADR-003): the mirror is only ever written here, from the change feed
+# (see CHANGE FEED in musiclib_db.sh).  Each run applies the events recorded
+# since the last one in a single transaction; --follow keeps running and
+# applies new events in batches as they arrive.
+#
+# The mirror is rebuilt from the DSV only when it cannot be brought forward
+# event by event: no mirror yet, a different schema generation (DSV header or
+# mirror layout changed), a "reload" event, or a journal that was trimmed or
+# restarted past the last applied event.
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard)
+#   2 - System error (config failure, database not found, sqlite3/jq missing,
+#       lock timeout)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_sqlmirror.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_sqlmirror.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli db mirror [options]
+
+Bring the read-only SQLite mirror of each library shard ("<database>.sqlite")
+up to date with the change feed.  The mirror holds one table, "tracks", with
+the DSV's columns; empty fields are NULL.
+
+Options:
+  --follow        Keep running and apply changes as they are written
+  --rebuild       Rebuild the mirror from the DSV first
+  -d FILE         Database to mirror (default: every library shard)
+  --shard NAME    Mirror the named library shard only
+  -q              Quiet: print nothing on success
+  -h, --help      Display this help
+
+Examples:
+  musiclib-cli db mirror
+  sqlite3 -readonly ~/.local/share/musiclib/data/musiclib.dsv.sqlite \\
+      "SELECT Artist, COUNT(*) FROM tracks GROUP BY Artist ORDER BY 2 DESC LIMIT 10"
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+FOLLOW=false
+REBUILD=false
+QUIET=false
+TARGET_DB=""
+TARGET_SHARD=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        -d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                -d) TARGET_DB="$2" ;;
+                --shard) TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --follow)
+            FOLLOW=true
+            shift
+            ;;
+        --rebuild)
+            REBUILD=true
+            shift
+            ;;
+        -q)
+            QUIET=true
+            shift
+            ;;
+        *)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+    esac
+done
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+if ! command -v sqlite3 >/dev/null 2>&1 || ! command -v jq >/dev/null 2>&1; then
+    error_exit 2 "sqlite3 and jq are required for the SQL mirror" "tools" "sqlite3 jq"
+    exit 2
+fi
+
+#############################################
+# Mirror
+#############################################
+# Bump when the table layout below changes; together with the DSV header it
+# forms the generation stored in the mirror.
+MIRROR_LAYOUT=1
+
+# Column types; everything else is TEXT.  Empty DSV fields are stored as NULL.
+MIRROR_INTEGER_COLUMNS=" IDAlbum SongLength Rating GroupDesc "
+MIRROR_REAL_COLUMNS=" LastTimePlayed "
+MIRROR_INDEXED_COLUMNS="SongPath Album Artist AlbumArtist Rating LastTimePlayed"
+
+# jq: one change event -> SQL statement(s)
+MIRROR_JQ_EVENT='
+    def lit: if . == "" or . == null then "NULL" else "'"'"'" + (tostring | gsub("'"'"'"; "'"'"''"'"'")) + "'"'"'" end;
+    def ident: "\"" + gsub("\""; "\"\"") + "\"";
+    def ids: [split("\n")[] | select(. != "") | lit] | join(",");
+    if .op == "update" and (.changes | length) > 0 then
+        "UPDATE tracks SET " + ([.changes | to_entries[] | (.key | ident) + "=" + (.value[1] | lit)] | join(","))
+        + " WHERE \"ID\" IN (" + (.id | ids) + ");"
+    elif .op == "insert" then
+        "INSERT OR REPLACE INTO tracks (" + ([.changes | keys_unsorted[] | select(. != "") | ident] | join(","))
+        + ") VALUES (" + ([.changes | to_entries[] | select(.key != "") | .value[1] | lit] | join(",")) + ");"
+    elif .op == "delete" then
+        "DELETE FROM tracks WHERE \"ID\" IN (" + (.id | ids) + ");"
+    else empty end'
+
+WORK_DIR=""
+FOLLOW_PIDS=()
+cleanup() {
+    [ ${#FOLLOW_PIDS[@]} -gt 0 ] && kill "${FOLLOW_PIDS[@]}" 2>/dev/null
+    [ -n "$WORK_DIR" ] && rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+trap 'exit 0' INT TERM
+
+say() { [ "$QUIET" = true ] || echo "$*"; }
+
+# Last sequence number in a DSV's change journal (0 when empty)
+journal_seq() {
+    local last
+    last=$(tail -n 1 "${1}.changes" 2>/dev/null | sed -n 's/^{"seq":\([0-9]*\),.*/\1/p')
+    echo "${last:-0}"
+}
+
+# "time" of event SEQ in the journal, or nothing if it is not there
+journal_time() {
+    grep -m 1 "^{\"seq\":$2," "${1}.changes" 2>/dev/null |
+        sed -n 's/^{"seq":[0-9]*,"time":"\([^"]*\)".*/\1/p'
+}
+
+generation_of() {
+    printf '%s:%s' "$MIRROR_LAYOUT" "$(head -n 1 "$1" | md5sum | cut -c1-16)"
+}
+
+meta_get() {
+    sqlite3 -readonly "$1" "SELECT value FROM mirror_meta WHERE key = '$2';" 2>/dev/null
+}
+
+# Copy the DSV and note the journal position it corresponds to.  Runs under
+# the database lock: writers publish their event before releasing it, so the
+# copy contains exactly the events up to that position.
+snapshot_db() {
+    cp "$MUSICDB" "$WORK_DIR/snapshot" &&
+        journal_seq "$MUSICDB" > "$WORK_DIR/snapshot.seq" &&
+        journal_time "$MUSICDB" "$(cat "$WORK_DIR/snapshot.seq")" > "$WORK_DIR/snapshot.time"
+}
+
+# Rebuild <dsv>.sqlite from the DSV, replacing the old mirror atomically
+rebuild_mirror() {
+    local db="$1" mirror="${db}.sqlite"
+    local tmp="${mirror}.tmp.$$" seq stamp
+
+    MUSICDB="$db" with_db_lock 10 snapshot_db || return 2
+    seq=$(cat "$WORK_DIR/snapshot.seq")
+    stamp=$(cat "$WORK_DIR/snapshot.time")
+
+    rm -f "$tmp"
+    LC_ALL=C awk -F'^' \
+        -v ints="$MIRROR_INTEGER_COLUMNS" -v reals="$MIRROR_REAL_COLUMNS" \
+        -v indexed="$MIRROR_INDEXED_COLUMNS" -v gen="$(generation_of "$db")" \
+        -v seq="$seq" -v stamp="$stamp" -v dsv="$db" '
+        function lit(v) { if (v == "") return "NULL"; gsub(/\047/, "\047\047", v); return "\047" v "\047" }
+        NR == 1 {
+            print "PRAGMA journal_mode = WAL;"
+            print "BEGIN;"
+            print "CREATE TABLE mirror_meta (key TEXT PRIMARY KEY, value TEXT);"
+            printf "CREATE TABLE tracks ("
+            sep = ""
+            for (i = 1; i <= NF; i++) {
+                if ($i == "") continue
+                col[++ncol] = i
+                type = "TEXT"
+                if ($i == "ID") type = "INTEGER PRIMARY KEY"
+                else if (index(ints, " " $i " ")) type = "INTEGER"
+                else if (index(reals, " " $i " ")) type = "REAL"
+                printf "%s\"%s\" %s", sep, $i, type
+                sep = ", "
+                have[$i] = 1
+            }
+            print ");"
+            n = split(indexed, idx, " ")
+            for (i = 1; i <= n; i++)
+                if (idx[i] in have)
+                    printf "CREATE INDEX tracks_%s ON tracks (\"%s\");\n", idx[i], idx[i]
+            next
+        }
+        {
+            printf "INSERT OR REPLACE INTO tracks VALUES ("
+            for (c = 1; c <= ncol; c++)
+                printf "%s%s", (c > 1 ? "," : ""), lit($(col[c]))
+            print ");"
+        }
+        END {
+            printf "INSERT INTO mirror_meta VALUES (\047generation\047, %s);\n", lit(gen)
+            printf "INSERT INTO mirror_meta VALUES (\047seq\047, %s);\n", lit(seq)
+            printf "INSERT INTO mirror_meta VALUES (\047seq_time\047, %s);\n", lit(stamp)
+            printf "INSERT INTO mirror_meta VALUES (\047dsv\047, %s);\n", lit(dsv)
+            print "COMMIT;"
+        }
+    ' "$WORK_DIR/snapshot" | sqlite3 -bail "$tmp" > /dev/null ||
+        { rm -f "$tmp" "${tmp}-wal" "${tmp}-shm"; return 2; }
+
+    mv "$tmp" "$mirror" || { rm -f "$tmp"; return 2; }
+    rm -f "${tmp}-wal" "${tmp}-shm"
+    say "$db: mirror rebuilt ($(($(wc -l < "$WORK_DIR/snapshot") - 1)) tracks, change feed position $seq)"
+    log_message "SQL mirror rebuilt for $db at change seq $seq" > /dev/null
+}
+
+# Apply the events in FILE (NDJSON, ascending seq) to the mirror in one
+# transaction.  Events at or below the mirror's position are skipped, so a
+# batch may overlap a rebuild.  Returns 3 when the batch needs a rebuild.
+apply_events() {
+    local db="$1" events="$2" mirror="${1}.sqlite"
+    local from last stamp count
+
+    from=$(meta_get "$mirror" seq) || return 3
+    awk -v from="${from:-0}" '
+        match($0, /^\{"seq":[0-9]+/) && substr($0, 8, RLENGTH - 7) + 0 > from
+    ' "$events" > "$WORK_DIR/batch"
+    [ -s "$WORK_DIR/batch" ] || return 0
+
+    grep -q '"op":"reload"' "$WORK_DIR/batch" && return 3
+
+    last=$(tail -n 1 "$WORK_DIR/batch" | sed -n 's/^{"seq":\([0-9]*\),.*/\1/p')
+    stamp=$(tail -n 1 "$WORK_DIR/batch" | sed -n 's/^{"seq":[0-9]*,"time":"\([^"]*\)".*/\1/p')
+    count=$(wc -l < "$WORK_DIR/batch")
+
+    {
+        echo "BEGIN;"
+        jq -r "$MIRROR_JQ_EVENT" "$WORK_DIR/batch" || exit 1
+        echo "UPDATE mirror_meta SET value = '$last' WHERE key = 'seq';"
+        echo "UPDATE mirror_meta SET value = '$stamp' WHERE key = 'seq_time';"
+        echo "COMMIT;"
+    } | sqlite3 -bail "$mirror" > /dev/null 2>&1 || return 3
+
+    say "$db: applied $count change(s), change feed position $last"
+}
+
+# Decide whether the mirror can be brought forward from the journal
+mirror_current() {
+    local db="$1" mirror="${1}.sqlite" seq stamp
+
+    [ -f "$mirror" ] || return 1
+    [ "$(meta_get "$mirror" generation)" = "$(generation_of "$db")" ] || return 1
+
+    # The event the mirror last applied must still be the same event: a
+    # journal that was deleted and grew back reuses sequence numbers.
+    seq=$(meta_get "$mirror" seq)
+    [ -n "$seq" ] || return 1
+    stamp=$(journal_time "$db" "$seq")
+    [ -z "$stamp" ] || [ "$stamp" = "$(meta_get "$mirror" seq_time)" ]
+}
+
+# Catch up once; rebuild if the events cannot be applied
+sync_mirror() {
+    local db="$1" rc
+
+    if [ "$REBUILD" = true ] || ! mirror_current "$db"; then
+        rebuild_mirror "$db" || return 2
+    fi
+
+    "$SCRIPT_DIR/musiclib_db_changes.sh" -d "$db" --since "$(meta_get "${db}.sqlite" seq)" \
+        > "$WORK_DIR/events" || return 2
+    apply_events "$db" "$WORK_DIR/events"
+    rc=$?
+    if [ "$rc" -eq 3 ]; then
+        rebuild_mirror "$db" || return 2
+        "$SCRIPT_DIR/musiclib_db_changes.sh" -d "$db" --since "$(meta_get "${db}.sqlite" seq)" \
+            > "$WORK_DIR/events" || return 2
+        apply_events "$db" "$WORK_DIR/events" || return 2
+    elif [ "$rc" -ne 0 ]; then
+        return 2
+    fi
+    return 0
+}
+
+# Apply events as they arrive.  Lines are collected until the feed has been
+# quiet for half a second, so a burst of writes costs one transaction.
+FEED_PID=""
+follow_mirror() {
+    local db="$1" line rc
+
+    mkfifo "$WORK_DIR/feed" || return 2
+    while true; do
+        # The reader must not inherit the mirror lock
+        "$SCRIPT_DIR/musiclib_db_changes.sh" -d "$db" --follow \
+            --since "$(meta_get "${db}.sqlite" seq)" > "$WORK_DIR/feed" {mirror_lock}>&- &
+        FEED_PID=$!
+
+        : > "$WORK_DIR/pending"
+        while IFS= read -r -t 0.5 line; rc=$?; [ "$rc" -eq 0 ] || [ "$rc" -gt 128 ]; do
+            if [ "$rc" -eq 0 ]; then
+                printf '%s\n' "$line" >> "$WORK_DIR/pending"
+                continue
+            fi
+            [ -s "$WORK_DIR/pending" ] || continue
+            if ! apply_events "$db" "$WORK_DIR/pending"; then
+                # Whatever the rebuild did not already contain still applies
+                rebuild_mirror "$db" || return 2
+                apply_events "$db" "$WORK_DIR/pending" || return 2
+            fi
+            : > "$WORK_DIR/pending"
+        done < "$WORK_DIR/feed"
+
+        # The feed reader exited (journal gone?); resume from the mirror
+        wait "$FEED_PID" 2>/dev/null
+        FEED_PID=""
+        sleep 2
+    done
+}
+
+#############################################
+# Main
+#############################################
+for db in "${TARGETS[@]}"; do
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+done
+
+rc=0
+for db in "${TARGETS[@]}"; do
+    WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_sqlmirror.XXXXXX") || exit 2
+
+    # One maintainer per mirror
+    exec {mirror_lock}> "${db}.sqlite.lock" || { rc=2; continue; }
+    if ! flock -n "$mirror_lock"; then
+        say "$db: mirror is being updated by another process"
+        exec {mirror_lock}>&-
+        rm -rf "$WORK_DIR"; WORK_DIR=""
+        continue
+    fi
+
+    if ! sync_mirror "$db"; then
+        error_exit 2 "Failed to update SQL mirror" "database" "$db"
+        rc=2
+    elif [ "$FOLLOW" = true ]; then
+        # Each shard is followed by its own child; the lock and work
+        # directory go with it
+        (
+            trap '[ -n "$FEED_PID" ] && kill "$FEED_PID" 2>/dev/null; rm -rf "$WORK_DIR"' EXIT
+            trap 'exit 0' INT TERM
+            follow_mirror "$db"
+        ) &
+        FOLLOW_PIDS+=("$!")
+        exec {mirror_lock}>&-
+        WORK_DIR=""
+        continue
+    fi
+    exec {mirror_lock}>&-
+    rm -rf "$WORK_DIR"
+    WORK_DIR=""
+done
+
+if [ "$FOLLOW" = true ] && [ ${#FOLLOW_PIDS[@]} -gt 0 ]; then
+    wait
+fi
+
+exit "$rc"
@@ -0,0 +1,277 @@
+#!/bin/bash
+#
+# musiclib_stats.sh - Listening statistics for the library
+# Usage: musiclib_stats.sh [--days N] [--months N] [--top N] [--text] [-d FILE]
+#
+# One pass over the DSV (every shard when LIBRARY_SHARDS is set) computes:
+#   - track count, total length, rated and never-played counts
+#   - rating distribution (GroupDesc 0-5)
+#   - tracks by month of last play, for the last N months
+#   - top artists by tracks played in the last N days
+#
+# The result is cached in $(get_data_dir)/data/stats_cache.json, keyed on
+# each DSV's size, mtime and change-feed position plus the options and the
+# current date, so repeated calls between writes cost nothing.  The GUI
+# keeps the same aggregates in memory and updates them from the change
+# feed instead (see LibraryStats).
+#
+# Exit codes:
+#   0 - Success
+#   1 - User error (bad arguments, unknown shard)
+#   2 - System error (config failure, database not found)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_stats.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_stats.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+STATS_CACHE="$(get_data_dir)/data/stats_cache.json"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli stats [options]
+
+Listening statistics: rating distribution, tracks by month of last play,
+never-played count and top artists by recent plays.
+
+Options:
+  --days N        Window for "top artists" (default: 30)
+  --months N      Number of months in the last-played histogram (default: 12)
+  --top N         Number of top artists (default: 10)
+  --text          Human-readable output instead of JSON
+  -d FILE         Database to analyse (default: every library shard)
+  --shard NAME    Analyse the named library shard only
+  -h, --help      Display this help
+
+Examples:
+  musiclib-cli stats --text
+  musiclib-cli stats --days 7 --top 20
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+DAYS=30
+MONTHS=12
+TOP=10
+TEXT=false
+TARGET_DB=""
+TARGET_SHARD=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        --days|--months|--top|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --days)   DAYS="$2" ;;
+                --months) MONTHS="$2" ;;
+                --top)    TOP="$2" ;;
+                -d)       TARGET_DB="$2" ;;
+                --shard)  TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --text)
+            TEXT=true
+            shift
+            ;;
+        *)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+    esac
+done
+
+for n in "$DAYS" "$MONTHS" "$TOP"; do
+    if ! [[ "$n" =~ ^[1-9][0-9]*$ ]]; then
+        error_exit 1 "--days, --months and --top take a positive integer" "value" "$n"
+        exit 1
+    fi
+done
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+for db in "${TARGETS[@]}"; do
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+done
+
+#############################################
+# Aggregation
+#############################################
+# Emits the JSON document.  Dates are UTC days derived from the SQL serial
+# LastTimePlayed (days since 1899-12-30).
+compute_stats() {
+    local today
+    today=$(( $(date +%s) / 86400 ))
+
+    awk -F'^' -v today="$today" -v days="$DAYS" -v months="$MONTHS" -v top="$TOP" '
+        # Civil date from days since 1970-01-01 (proleptic Gregorian)
+        function ym(d,    z, era, doe, yoe, y, doy, mp, m) {
+            z = d + 719468
+            era = int((z >= 0 ? z : z - 146096) / 146097)
+            doe = z - era * 146097
+            yoe = int((doe - int(doe / 1460) + int(doe / 36524) - int(doe / 146096)) / 365)
+            y = yoe + era * 400
+            doy = doe - (365 * yoe + int(yoe / 4) - int(yoe / 100))
+            mp = int((5 * doy + 2) / 153)
+            m = (mp < 10) ? mp + 3 : mp - 9
+            if (m <= 2) y++
+            return y * 12 + (m - 1)
+        }
+        function jstr(s) {
+            gsub(/\\/, "\\\\", s)
+            gsub(/"/, "\\\"", s)
+            gsub(/\t/, "\\t", s)
+            return "\"" s "\""
+        }
+        FNR == 1 {
+            for (i = 1; i <= NF; i++) col[$i] = i
+            next
+        }
+        {
+            tracks++
+            len = $col["SongLength"] + 0
+            if (len > 0) duration += len
+
+            g = $col["GroupDesc"] + 0
+            if (g < 0 || g > 5) g = 0
+            rating[g]++
+            if (g > 0) rated++
+
+            serial = $col["LastTimePlayed"] + 0
+            if (serial <= 0) { never++; next }
+            day = int(serial - 25569)
+            by_month[ym(day)]++
+            if (day > today - days) recent[$col["Artist"]]++
+        }
+        END {
+            printf "{\"status\": \"ok\", \"tracks\": %d, \"duration_ms\": %.0f, \"rated\": %d, \"never_played\": %d, ", \
+                tracks, duration, rated, never
+            printf "\"ratings\": {"
+            for (g = 0; g <= 5; g++) printf "%s\"%d\": %d", (g ? ", " : ""), g, rating[g]
+            printf "}, \"last_played_by_month\": ["
+            now = ym(today)
+            for (k = now - months + 1; k <= now; k++)
+                printf "%s{\"month\": \"%04d-%02d\", \"tracks\": %d}", \
+                    (k > now - months + 1 ? ", " : ""), int(k / 12), k % 12 + 1, by_month[k]
+            printf "], \"recent_days\": %d, \"top_artists\": [", days
+            # Repeated max selection: top is small, artists are not
+            for (n = 0; n < top; n++) {
+                best = ""; bestc = 0
+                for (a in recent)
+                    if (recent[a] > bestc || (recent[a] == bestc && a < best)) { best = a; bestc = recent[a] }
+                if (bestc == 0) break
+                printf "%s{\"artist\": %s, \"tracks\": %d}", (n ? ", " : ""), jstr(best), bestc
+                delete recent[best]
+            }
+            printf "]}\n"
+        }
+    ' "${TARGETS[@]}"
+}
+
+# Render the JSON document for a terminal
+print_text() {
+    awk '
+        function num(key,    m) {
+            if (match($0, "\"" key "\": [0-9]+")) {
+                m = substr($0, RSTART, RLENGTH); sub(/.*: /, "", m); return m + 0
+            }
+            return 0
+        }
+        {
+            printf "Tracks:        %d\n", num("tracks")
+            m = int(num("duration_ms") / 60000)
+            printf "Total length:  %d h %02d min\n", int(m / 60), m % 60
+            printf "Rated:         %d\n", num("rated")
+            printf "Never played:  %d\n\n", num("never_played")
+
+            print "Rating distribution:"
+            r = $0; sub(/.*"ratings": \{/, "", r); sub(/\}.*/, "", r)
+            n = split(r, parts, /, /)
+            for (i = 1; i <= n; i++) {
+                split(parts[i], kv, /": /); gsub(/"/, "", kv[1])
+                printf "  %s stars  %d\n", kv[1], kv[2]
+            }
+
+            print "\nTracks by month of last play:"
+            s = $0
+            while (match(s, /"month": "[0-9-]+", "tracks": [0-9]+/)) {
+                e = substr(s, RSTART, RLENGTH); s = substr(s, RSTART + RLENGTH)
+                split(e, f, /"/); t = e; sub(/.*: /, "", t)
+                printf "  %s  %d\n", f[4], t
+            }
+
+            printf "\nTop artists, last %d days:\n", num("recent_days")
+            s = $0; sub(/.*"top_artists": \[/, "", s)
+            while (match(s, /"artist": "([^"\\]|\\.)*", "tracks": [0-9]+/)) {
+                e = substr(s, RSTART + 11, RLENGTH - 11); s = substr(s, RSTART + RLENGTH)
+                t = e; sub(/.*"tracks": /, "", t)
+                sub(/", "tracks": [0-9]+$/, "", e); gsub(/\\"/, "\"", e); gsub(/\\\\/, "\\", e)
+                printf "  %5d  %s\n", t, e
+            }
+        }
+    '
+}
+
+#############################################
+# Main
+#############################################
+# Cache key: options, date, and the state of every database and its journal
+cache_key="$DAYS $MONTHS $TOP $(date +%Y-%m-%d)"
+for db in "${TARGETS[@]}"; do
+    seq=$(tail -n 1 "${db}.changes" 2>/dev/null | sed -n 's/^{"seq":\([0-9]*\),.*/\1/p')
+    cache_key+=" $db:$(stat -c '%s:%Y' "$db"):${seq:-0}"
+done
+
+result=""
+if [ -f "$STATS_CACHE" ] && [ "$(head -n 1 "$STATS_CACHE")" = "$cache_key" ]; then
+    result=$(tail -n +2 "$STATS_CACHE")
+fi
+if [ -z "$result" ]; then
+    if ! result=$(compute_stats); then
+        error_exit 2 "Failed to read database" "database" "${TARGETS[*]}"
+        exit 2
+    fi
+    mkdir -p "$(dirname "$STATS_CACHE")" 2>/dev/null
+    # Per-process tmp name: concurrent runs must not write the same file
+    printf '%s\n%s\n' "$cache_key" "$result" > "${STATS_CACHE}.tmp.$$" 2>/dev/null &&
+        mv "${STATS_CACHE}.tmp.$$" "$STATS_CACHE" 2>/dev/null
+    rm -f "${STATS_CACHE}.tmp.$$"
+fi
+
+if [ "$TEXT" = true ]; then
+    printf '%s\n' "$result" | print_text
+else
+    printf '%s\n' "$result"
+fi
+exit 0
@@ -578,6 +578,10 @@ command -v id3v2 >/dev/null 2>&1 && HAS_ID3V2=true
 #############################################
 mkdir -p "$BACKUP_DIR"
 
+# Every backup of this run is indexed under one run ID, so the whole run
+# can be undone with "musiclib-cli tagrestore --batch <run ID>"
+TAG_BACKUP_RUN="tagclean_$(date +%Y%m%d_%H%M%S)"
+
 #############################################
 # Merge ID3v1 to ID3v2
 #############################################
@@ -1010,7 +1014,7 @@ process_directory() {
     local find_opts="-maxdepth 1 -type f"
     while IFS= read -r mp3_file; do
         process_file "$mp3_file"
-    done < <(find "$dirpath" $find_opts -iname "*.mp3" 2>/dev/null | sort)
+    done < <(find "$dirpath" $find_opts -iname "*.mp3" 2>/dev/null | disk_order_list)
 }
 
 #############################################
@@ -1074,6 +1078,9 @@ esac
 echo "Errors: $ERRORS"
 echo ""
 echo "Backup location: $BACKUP_DIR"
+if [ "$KEEP_BACKUP" = "true" ] && [ "$DRY_RUN" = false ]; then
+    echo "Backup run: $TAG_BACKUP_RUN (undo with: musiclib-cli tagrestore --batch $TAG_BACKUP_RUN)"
+fi
 [ "$DRY_RUN" = true ] && echo ""
 [ "$DRY_RUN" = true ] && echo "DRY RUN - No changes were made"
 
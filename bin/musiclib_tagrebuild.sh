@@ -270,7 +270,7 @@ process_directory() {
 
     while IFS= read -r mp3_file; do
         process_file "$mp3_file"
-    done < <(find "$dirpath" $find_opts -iname "*.mp3" 2>/dev/null | sort)
+    done < <(find "$dirpath" $find_opts -iname "*.mp3" 2>/dev/null | disk_order_list)
 }
 
 #############################################
@@ -361,6 +361,10 @@ fi
 #############################################
 mkdir -p "$BACKUP_DIR"
 
+# Every backup of this run is indexed under one run ID, so the whole run
+# can be undone with "musiclib-cli tagrestore --batch <run ID>"
+TAG_BACKUP_RUN="tagrebuild_$(date +%Y%m%d_%H%M%S)"
+
 #############################################
 # Main Execution
 #############################################
@@ -407,6 +411,8 @@ echo "Backup location: $BACKUP_DIR"
 
 if [ "$KEEP_BACKUP" = "true" ]; then
     echo "(--keep-backup: backups retained for successful rebuilds)"
+    [ "$DRY_RUN" = false ] &&
+        echo "Backup run: $TAG_BACKUP_RUN (undo with: musiclib-cli tagrestore --batch $TAG_BACKUP_RUN)"
 fi
 
 if [ "$DRY_RUN" = true ]; then
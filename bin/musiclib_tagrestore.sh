@@ -9,21 +9,34 @@
 # musiclib_tagclean.sh.  After a successful restore the backup file is retained so
 # the user can restore again or clean up manually.
 #
+# Batch mode restores many files concurrently.  It finds backups through the
+# backup index (TAG BACKUP INDEX in musiclib_db.sh) instead of searching the
+# backup directory per file, and checks each backup's audio payload against
+# the file before overwriting it.
+#
 # Usage:
 #   musiclib_tagrestore.sh <filepath.mp3>         # Restore most recent backup
 #   musiclib_tagrestore.sh <filepath.mp3> -n      # Dry-run: show what would be restored
 #   musiclib_tagrestore.sh <filepath.mp3> -v      # Verbose: list all available backups
 #   musiclib_tagrestore.sh <filepath.mp3> -l      # List all backups without restoring
+#   musiclib_tagrestore.sh --batch <DIR|LISTFILE|-|RUN_ID> [-j N] [-n] [--force]
+#   musiclib_tagrestore.sh --runs                 # List backup runs
 #
 # Options:
 #   -n, --dry-run    Preview the restore without overwriting the original
 #   -v, --verbose    Show all available backups and extra detail
 #   -l, --list       List all backups for the given file and exit (no restore)
+#   --batch SOURCE   Restore every file of a directory, a list file ("-" for
+#                    stdin) or a backup run
+#   -j, --jobs N     Parallel restores in batch mode (default: CPU count)
+#   --force          Batch mode: restore even if the audio payload differs
+#   --runs           List backup runs (ID, backups, time) and exit
 #   -h, --help       Show this help message
 #
 # Exit Codes:
 #   0  Restore successful (or dry-run completed)
 #   1  No backup found, file path does not exist, or invalid arguments
+#      (batch: some files had no backup, were missing or failed the payload check)
 #   2  Backup found but restore failed (copy error)
 #
 
@@ -41,6 +54,13 @@ if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
     exit 2
 fi
 
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    {
+        echo "{\"error\":\"Failed to load musiclib_db.sh\",\"script\":\"$(basename "$0")\",\"code\":2,\"context\":{\"file\":\"$SCRIPT_DIR/musiclib_db.sh\"},\"timestamp\":\"$(date -u +"%Y-%m-%dT%H:%M:%SZ")\"}"
+    } >&2
+    exit 2
+fi
+
 if ! load_config; then
     error_exit 2 "Configuration load failed"
     exit 2
@@ -54,6 +74,10 @@ DRY_RUN=false
 VERBOSE=false
 LIST_ONLY=false
 FILEPATH=""
+BATCH_SOURCE=""
+LIST_RUNS=false
+FORCE=false
+JOBS=""
 
 #############################################
 # Show Usage
@@ -61,6 +85,8 @@ FILEPATH=""
 show_usage() {
     cat << EOF
 Usage: musiclib-cli tagrestore <FILE.mp3> [options]
+       musiclib-cli tagrestore --batch <DIR|LISTFILE|-|RUN_ID> [-j N] [-n] [--force]
+       musiclib-cli tagrestore --runs
 
 Restore an MP3 file's tags from the most recent backup created by
 musiclib_tagrebuild.sh or musiclib_tagclean.sh when run with --keep-backup.
@@ -73,6 +99,16 @@ Options:
   -l, --list        List all available backups and exit without restoring
   -h, --help        Show this help message
 
+Batch mode:
+  --batch SOURCE    Restore many files at once.  SOURCE is a directory (every
+                    MP3 below it), a file with one path per line ("-" reads
+                    stdin), or a backup run ID as printed by tagclean and
+                    tagrebuild (every file that run backed up).
+  -j, --jobs N      Parallel restores (default: number of CPUs)
+  --force           Restore even when the backup's audio payload differs
+                    from the file's (normally such files are skipped)
+  --runs            List backup runs and exit
+
 Notes:
   - The backup file is NOT removed after restore.  You can restore again from
     the same backup, or delete it manually.
@@ -105,6 +141,25 @@ while [ $# -gt 0 ]; do
             LIST_ONLY=true
             shift
             ;;
+        --batch|-j|--jobs)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                --batch) BATCH_SOURCE="$2" ;;
+                *)       JOBS="$2" ;;
+            esac
+            shift 2
+            ;;
+        --force)
+            FORCE=true
+            shift
+            ;;
+        --runs)
+            LIST_RUNS=true
+            shift
+            ;;
         -h|--help|help)
             show_usage
             exit 0
@@ -124,6 +179,171 @@ while [ $# -gt 0 ]; do
     esac
 done
 
+#############################################
+# Backup Runs
+#############################################
+if [ "$LIST_RUNS" = true ]; then
+    tag_backup_index_compact "$BACKUP_DIR"
+    echo "=== Tag Backup Runs ==="
+    # Run IDs end in their start time, so a plain sort is chronological
+    awk -F'\t' '$3 != "" { n[$3]++ } END { for (r in n) printf "  %-32s %6d backups\n", r, n[r] }' \
+        "$BACKUP_DIR/$TAG_BACKUP_INDEX_NAME" 2>/dev/null | LC_ALL=C sort -t_ -k2
+    echo ""
+    echo "Restore a run with: musiclib-cli tagrestore --batch <RUN_ID>"
+    exit 0
+fi
+
+#############################################
+# Batch Restore
+#############################################
+# Restore "PATH BACKUP PAYLOAD" triples given as arguments; prints one
+# "STATUS<TAB>PATH<TAB>BACKUP" line each.  Runs in xargs workers.
+restore_worker() {
+    local path backup payload current tmp
+    while [ $# -ge 3 ]; do
+        path="$1" backup="$2" payload="$3"
+        shift 3
+        if [ ! -f "$path" ]; then
+            printf 'missing\t%s\t%s\n' "$path" "$backup"
+            continue
+        fi
+        if [ "$FORCE" != true ]; then
+            [ -n "$payload" ] || payload=$(mp3_payload_hash "$backup")
+            current=$(mp3_payload_hash "$path")
+            if [ -z "$payload" ] || [ "$payload" != "$current" ]; then
+                printf 'payload-mismatch\t%s\t%s\n' "$path" "$backup"
+                continue
+            fi
+        fi
+        # Copy next to the original, verify, then rename over it
+        tmp="${path}.restore.$$"
+        if cp -- "$backup" "$tmp" 2>/dev/null && cmp -s "$backup" "$tmp" &&
+           mv -f -- "$tmp" "$path"; then
+            printf 'restored\t%s\t%s\n' "$path" "$backup"
+        else
+            rm -f -- "$tmp"
+            printf 'failed\t%s\t%s\n' "$path" "$backup"
+        fi
+    done
+}
+
+run_batch() {
+    local source="$1"
+    local index="$BACKUP_DIR/$TAG_BACKUP_INDEX_NAME"
+    local work status path backup rc=0
+    local -A counts=()
+
+    BATCH_WORK=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_tagrestore.XXXXXX") || {
+        error_exit 2 "Cannot create temporary directory"
+        return 2
+    }
+    trap 'rm -rf "$BATCH_WORK"' EXIT
+    work="$BATCH_WORK"
+
+    tag_backup_index_compact "$BACKUP_DIR"
+    if [ ! -s "$index" ]; then
+        echo "No tag backups found in $BACKUP_DIR" >&2
+        return 1
+    fi
+
+    # Pick the backup for every target: PATH<TAB>BACKUP<TAB>PAYLOAD, with an
+    # empty BACKUP when there is none.  Path lookups take the newest backup of
+    # that exact path, falling back to index lines without a path (backups
+    # older than the index) with the same file name.
+    if [ -d "$source" ]; then
+        find "$source" -type f -iname '*.mp3' 2>/dev/null | LC_ALL=C sort > "$work/targets"
+    elif [ "$source" = "-" ]; then
+        cat > "$work/targets"
+    elif [ -f "$source" ]; then
+        cat -- "$source" > "$work/targets"
+    elif awk -F'\t' -v run="$source" '$3 == run { found = 1; exit } END { exit !found }' "$index"; then
+        awk -F'\t' -v run="$source" '$3 == run && $2 != "" { print $2 }' "$index" |
+            LC_ALL=C sort -u > "$work/targets"
+    else
+        error_exit 1 "Not a directory, list file or backup run" "source" "$source"
+        return 1
+    fi
+
+    LC_ALL=C awk -F'\t' -v OFS='\t' -v dir="$BACKUP_DIR" -v run="$source" -v byrun="$([ -d "$source" ] || [ -f "$source" ] || [ "$source" = - ] || echo 1)" '
+        function base(p) { sub(/.*\//, "", p); return p }
+        FNR == NR {
+            if (byrun && $3 != run) next
+            if ($2 != "") {
+                if (!($2 in best) || $1 > best[$2]) { best[$2] = $1; pay[$2] = $5 }
+            } else {
+                b = $1; sub(/\.backup\..*$/, "", b)
+                if (!(b in legacy) || $1 > legacy[b]) { legacy[b] = $1; lpay[b] = $5 }
+            }
+            next
+        }
+        $0 == "" { next }
+        ($0 in best) { print $0, dir "/" best[$0], pay[$0]; next }
+        (base($0) in legacy) { b = base($0); print $0, dir "/" legacy[b], lpay[b]; next }
+        { print $0, "", "" }
+    ' "$index" "$work/targets" > "$work/plan"
+
+    awk -F'\t' '$2 == "" { print "no-backup\t" $1 "\t" }' "$work/plan" > "$work/results"
+    awk -F'\t' '$2 != ""' "$work/plan" > "$work/todo"
+
+    echo "=== MusicLib Batch Tag Restore ==="
+    echo "Source:  $source"
+    echo "Files:   $(wc -l < "$work/plan") ($(wc -l < "$work/todo") with a backup)"
+    echo ""
+
+    if [ "$DRY_RUN" = true ]; then
+        while IFS=$'\t' read -r path backup _; do
+            echo "[DRY-RUN] $path  <-  $(basename "$backup")"
+        done < "$work/todo"
+        echo "[DRY-RUN] No changes made."
+        return 0
+    fi
+
+    export -f restore_worker mp3_payload_hash
+    export FORCE
+    tr '\t\n' '\0\0' < "$work/todo" |
+        xargs -0 -r -n 60 -P "$JOBS" bash -c 'restore_worker "$@" > "$0/part.$$"; exit 0' "$work"
+    cat "$work"/part.* >> "$work/results" 2>/dev/null
+
+    while IFS=$'\t' read -r status path backup; do
+        counts[$status]=$(( ${counts[$status]:-0} + 1 ))
+        [ "$status" = restored ] && [ "$VERBOSE" != true ] && continue
+        echo "  $status: $path"
+    done < "$work/results"
+
+    echo ""
+    echo "=== Summary ==="
+    echo "Restored:           ${counts[restored]:-0}"
+    echo "No backup:          ${counts[no-backup]:-0}"
+    echo "File missing:       ${counts[missing]:-0}"
+    echo "Payload mismatch:   ${counts[payload-mismatch]:-0}"
+    echo "Failed:             ${counts[failed]:-0}"
+    [ "${counts[payload-mismatch]:-0}" -gt 0 ] &&
+        echo "(A mismatching backup holds different audio; --force restores it anyway.)"
+    log_message "Batch tag restore from $source: ${counts[restored]:-0} restored" > /dev/null
+
+    if [ "${counts[failed]:-0}" -gt 0 ]; then
+        rc=2
+    elif [ "$(wc -l < "$work/results")" -ne "${counts[restored]:-0}" ]; then
+        rc=1
+    fi
+    return "$rc"
+}
+
+if [ -n "$BATCH_SOURCE" ]; then
+    if [ -n "$FILEPATH" ]; then
+        error_exit 1 "--batch cannot be combined with a file path" "filepath" "$FILEPATH"
+        exit 1
+    fi
+    JOBS="${JOBS:-$(nproc 2>/dev/null || echo 2)}"
+    if ! [[ "$JOBS" =~ ^[1-9][0-9]*$ ]]; then
+        error_exit 1 "-j must be a positive integer" "jobs" "$JOBS"
+        exit 1
+    fi
+    batch_rc=0
+    run_batch "$BATCH_SOURCE" || batch_rc=$?
+    exit "$batch_rc"
+fi
+
 #############################################
 # Validate Input
 #############################################
@@ -149,11 +369,19 @@ fi
 #############################################
 BASENAME="$(basename "$FILEPATH")"
 
-# Backups are named: <basename>.backup.<YYYYMMDD_HHMMSS>
-# Lexicographic sort on the timestamp suffix gives chronological order.
+# Backups are named: <basename>.backup.<YYYYMMDD_HHMMSS>, with a ".N" suffix
+# when several were taken within the same second.  Sort on the timestamp,
+# then numerically on N (none = the first), so ".10" comes after ".9".
 mapfile -t BACKUPS < <(
     find "$BACKUP_DIR" -maxdepth 1 -name "${BASENAME}.backup.*" -type f 2>/dev/null \
-    | sort
+    | awk -v prefix="${BASENAME}.backup." '{
+          rest = substr($0, index($0, "/" prefix) + length(prefix) + 1)
+          dot = index(rest, ".")
+          ts = dot ? substr(rest, 1, dot - 1) : rest
+          n = dot ? substr(rest, dot + 1) + 0 : 0
+          print ts "\t" n "\t" $0
+      }' \
+    | LC_ALL=C sort -t $'\t' -k1,1 -k2,2n | cut -f3-
 )
 
 if [ ${#BACKUPS[@]} -eq 0 ]; then
@@ -0,0 +1,251 @@
+#!/bin/bash
+#
+# musiclib_textindex.sh - Build or update the lyrics/comment text index
+# Usage: musiclib_textindex.sh [--rebuild] [-j JOBS] [-d FILE | --shard NAME] [-q]
+#
+# Writes a new <dsv>.txtindex generation (see TEXT INDEX in musiclib_db.sh)
+# for each library shard.  Only files that are new or whose mtime changed
+# since the last run are read, with exiftool batches running in parallel;
+# rows that left the database are dropped.  The term list is then regenerated
+# from the documents, which is cheap next to reading tags.
+#
+# Searched by "musiclib-cli query text" and the GUI library filter.
+#
+# Exit codes:
+#   0 - Success (including "another update is running")
+#   1 - User error (bad arguments, unknown shard)
+#   2 - System error (config failure, database not found, exiftool missing)
+
+set -u
+set -o pipefail
+
+# Setup paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+if ! source "$SCRIPT_DIR/musiclib_utils.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_utils.sh not found","script":"musiclib_textindex.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_utils.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+if ! source "$SCRIPT_DIR/musiclib_db.sh" 2>/dev/null; then
+    echo '{"error":"musiclib_db.sh not found","script":"musiclib_textindex.sh","code":2,"context":{"expected_path":"'"$SCRIPT_DIR/musiclib_db.sh"'"},"timestamp":"'$(date -u +"%Y-%m-%dT%H:%M:%SZ")'"}' >&2
+    exit 2
+fi
+
+if ! load_config 2>/dev/null; then
+    error_exit 2 "Failed to load configuration"
+    exit 2
+fi
+
+MUSICDB="${MUSICDB:-$(get_data_dir)/data/musiclib.dsv}"
+
+#############################################
+# Show Usage
+#############################################
+show_usage() {
+    cat << EOF
+Usage: musiclib-cli db textindex [options]
+
+Build or update the full-text index over lyrics and comment tags.  Only
+files added or modified since the last update are read.
+
+Options:
+  --rebuild       Re-read every file instead of only changed ones
+  -j JOBS         Parallel exiftool processes (default: TEXT_INDEX_JOBS, or
+                  the number of CPUs)
+  -d FILE         Database to index (default: every library shard)
+  --shard NAME    Index the named library shard only
+  -q              Quiet: print nothing on success
+  -h, --help      Display this help
+
+Examples:
+  musiclib-cli db textindex
+  musiclib-cli db textindex --rebuild -j 8
+  musiclib-cli query text "hello darkness my old friend"
+EOF
+}
+
+#############################################
+# Parse Arguments
+#############################################
+REBUILD=false
+QUIET=false
+JOBS="${TEXT_INDEX_JOBS:-}"
+TARGET_DB=""
+TARGET_SHARD=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        -j|-d|--shard)
+            if [ -z "${2:-}" ]; then
+                error_exit 1 "Option $1 requires an argument" "option" "$1"
+                exit 1
+            fi
+            case "$1" in
+                -j) JOBS="$2" ;;
+                -d) TARGET_DB="$2" ;;
+                --shard) TARGET_SHARD="$2" ;;
+            esac
+            shift 2
+            ;;
+        --rebuild)
+            REBUILD=true
+            shift
+            ;;
+        -q)
+            QUIET=true
+            shift
+            ;;
+        *)
+            show_usage >&2
+            error_exit 1 "Unknown option" "option" "$1"
+            exit 1
+            ;;
+    esac
+done
+
+JOBS="${JOBS:-$(nproc 2>/dev/null || echo 2)}"
+if ! [[ "$JOBS" =~ ^[1-9][0-9]*$ ]]; then
+    error_exit 1 "-j must be a positive integer" "jobs" "$JOBS"
+    exit 1
+fi
+
+resolve_target_dbs "$TARGET_DB" "$TARGET_SHARD" || exit 1
+
+if ! command -v exiftool >/dev/null 2>&1 || ! command -v jq >/dev/null 2>&1; then
+    error_exit 2 "exiftool and jq are required to read lyrics and comments" "tools" "exiftool jq"
+    exit 2
+fi
+
+#############################################
+# Indexing
+#############################################
+# Files per exiftool invocation: large enough to amortise its start-up,
+# small enough to keep every job busy
+BATCH_SIZE=50
+
+WORK_DIR=""
+cleanup() { [ -n "$WORK_DIR" ] && rm -rf "$WORK_DIR"; }
+trap cleanup EXIT
+
+# Print "PATH<TAB>raw text" for each file named on stdin (NUL-separated),
+# reading lyrics (USLT, Lyrics, UnsyncedLyrics) and comment tags.
+extract_text() {
+    parallel_parts "$WORK_DIR" "$JOBS" "$BATCH_SIZE" '
+        exiftool -j -q -q -m -charset filename=utf8 \
+            "-Lyrics*" "-UnsyncedLyrics*" "-UnsynchronizedLyrics*" "-Comment*" "$@" 2>/dev/null |
+            jq -r ".[] | [.SourceFile,
+                          ([to_entries[] | select(.key | test(\"^(Lyrics|Unsync|Comment)\")) | .value | tostring]
+                           | join(\" \") | gsub(\"[\\t\\r\\n]+\"; \" \"))] | @tsv" \
+            2>/dev/null
+    '
+}
+
+update_index() {
+    local db="$1"
+    local old_dir="" gen=0 new_dir docs terms d
+    local old_count kept_count todo_count
+
+    if old_dir=$(text_index_dir "$db"); then
+        gen="${old_dir##*.g}"
+        [[ "$gen" =~ ^[0-9]+$ ]] || gen=0
+    fi
+    docs="$old_dir/docs" terms="$old_dir/terms"
+
+    # path<TAB>mtime for every row whose file exists
+    sidecar_stat_current "$db" $'%n\t%Y' > "$WORK_DIR/current" || return 2
+
+    # Keep documents whose file is unchanged; queue the rest
+    if [ "$REBUILD" = true ] || [ -z "$old_dir" ]; then
+        sidecar_split "" "$WORK_DIR/current" "$WORK_DIR/kept" "$WORK_DIR/todo"
+        old_count=-1
+    else
+        sidecar_split "$docs" "$WORK_DIR/current" "$WORK_DIR/kept" "$WORK_DIR/todo"
+        old_count=$(wc -l < "$docs")
+    fi
+    kept_count=$(wc -l < "$WORK_DIR/kept")
+    todo_count=$(wc -l < "$WORK_DIR/todo")
+
+    if [ "$todo_count" -eq 0 ] && [ "$kept_count" -eq "$old_count" ]; then
+        [ "$QUIET" = true ] || echo "$db: text index up to date ($kept_count tracks)"
+        return 0
+    fi
+
+    tr '\n' '\0' < "$WORK_DIR/todo" | extract_text |
+        LC_ALL=C awk -F'\t' "$TEXT_INDEX_AWK_NORM"'
+            FNR == NR { mtime[$1] = $2; next }
+            ($1 in mtime) && !($1 in done) { done[$1] = 1; print $1 "\t" mtime[$1] "\t" tnorm($2) }
+        ' "$WORK_DIR/current" - > "$WORK_DIR/new" || return 2
+
+    # The new generation stays invisible until the link is switched
+    new_dir="${db}.txtindex.g$((gen + 1))"
+    rm -rf "$new_dir"
+    mkdir "$new_dir" || return 2
+    docs="$new_dir/docs" terms="$new_dir/terms"
+
+    LC_ALL=C sort -t $'\t' -k1,1 "$WORK_DIR/kept" "$WORK_DIR/new" > "$docs" ||
+        { rm -rf "$new_dir"; return 2; }
+
+    # TERM<TAB>doc numbers, one line per distinct word longer than one byte
+    LC_ALL=C awk -F'\t' '
+        {
+            n = split($3, w, " ")
+            delete seen
+            for (i = 1; i <= n; i++)
+                if (length(w[i]) > 1 && !(w[i] in seen)) { seen[w[i]] = 1; print w[i] "\t" NR }
+        }
+    ' "$docs" | LC_ALL=C sort -t $'\t' -k1,1 -k2,2n -S 25% -T "$WORK_DIR" |
+        LC_ALL=C awk -F'\t' '
+            $1 != term { if (term != "") print term "\t" ids; term = $1; ids = $2; next }
+            { ids = ids " " $2 }
+            END { if (term != "") print term "\t" ids }
+        ' > "$terms" || { rm -rf "$new_dir"; return 2; }
+
+    # One rename publishes docs and terms together
+    ln -s "$(basename "$new_dir")" "${db}.txtindex.tmp.$$" &&
+        mv -T "${db}.txtindex.tmp.$$" "${db}.txtindex" ||
+        { rm -f "${db}.txtindex.tmp.$$"; rm -rf "$new_dir"; return 2; }
+
+    # Keep the previous generation for readers that resolved the old link;
+    # drop anything older, and the flat files of the old layout
+    for d in "${db}".txtindex.g*; do
+        [ "$d" = "$new_dir" ] || [ "${d##*/}" = "${old_dir##*/}" ] || rm -rf "$d"
+    done
+    rm -f "${db}.txtdocs" "${db}.txtterms" "${db}.txtdocs.lock"
+
+    [ "$QUIET" = true ] ||
+        echo "$db: text index updated ($todo_count read, $(wc -l < "$docs") tracks, $(wc -l < "$terms") terms)"
+    log_message "Text index updated for $db: $todo_count files read" > /dev/null
+}
+
+#############################################
+# Main
+#############################################
+rc=0
+for db in "${TARGETS[@]}"; do
+    if [ ! -f "$db" ]; then
+        error_exit 2 "Database not found" "database" "$db"
+        exit 2
+    fi
+
+    # One updater per shard; a second one has nothing to add
+    exec {idx_lock}> "${db}.txtindex.lock" || { rc=2; continue; }
+    if ! flock -n "$idx_lock"; then
+        [ "$QUIET" = true ] || echo "$db: text index update already running"
+        exec {idx_lock}>&-
+        continue
+    fi
+
+    WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/musiclib_textindex.XXXXXX") || { rc=2; break; }
+    if ! update_index "$db"; then
+        error_exit 2 "Failed to update text index" "database" "$db"
+        rc=2
+    fi
+    rm -rf "$WORK_DIR"
+    WORK_DIR=""
+    exec {idx_lock}>&-
+done
+
+exit "$rc"
@@ -300,20 +300,218 @@ has_embedded_art() {
     return 1
 }
 
+#############################################
+# SCAN ORDERING AND PREFETCH
+#############################################
+
+# Sort a file list (stdin, one path per line) for a full-library scan.
+# SCAN_ORDER=disk (default) orders by physical location via
+# "musiclib-cli files order", so HDDs read in one sweep instead of seeking
+# between directories; without the CLI, inode order is used as the nearest
+# approximation.  SCAN_ORDER=path sorts by name, SCAN_ORDER=none keeps the
+# input order.
+# Usage: find ... | disk_order_list > list
+disk_order_list() {
+    local cli="${MUSICLIB_CLI:-musiclib-cli}"
+
+    case "${SCAN_ORDER:-disk}" in
+        path) sort; return ;;
+        none) cat; return ;;
+    esac
+
+    if command -v "$cli" >/dev/null 2>&1; then
+        "$cli" files order
+    else
+        tr '\n' '\0' | xargs -0 -r stat -c $'%i\t%n' 2>/dev/null | sort -s -n -k1,1 | cut -f2-
+    fi
+}
+
+# Warm the page cache with the tag-bearing parts of each file on stdin
+# (first SCAN_PREFETCH_KB KB and last 128 bytes), SCAN_PREFETCH_JOBS reads
+# in flight.  Best effort: a no-op when the CLI is missing or
+# SCAN_PREFETCH_KB=0.
+# Usage: sed -n '1,256p' list | prefetch_file_list &
+prefetch_file_list() {
+    local cli="${MUSICLIB_CLI:-musiclib-cli}"
+    local head_kb="${SCAN_PREFETCH_KB:-512}"
+
+    if [ "$head_kb" = "0" ] || ! command -v "$cli" >/dev/null 2>&1; then
+        cat > /dev/null
+        return 0
+    fi
+    "$cli" files prefetch --head "$head_kb" -j "${SCAN_PREFETCH_JOBS:-16}" >/dev/null 2>&1 || true
+}
+
 #############################################
 # LOGGING
 #############################################
 
-# Log message to log file and stdout.
-# LOGFILE is not set by every script that sources this file; default to
-# /dev/null so the `tee` does not error under `set -u` and the fallback echo
-# still reaches stdout.  Without this default, scripts that use `set -u`
-# (e.g. musiclib_player_event.sh) crash on the first log_message call.
-log_message() {
-    local message="$1"
-    local timestamp=$(date '+%Y-%m-%d %H:%M:%S')
+# Two logs are written:
+#   LOGFILE                 human-readable "[YYYY-MM-DD HH:MM:SS] message"
+#   LOGFILE -> .ndjson      structured event journal, one JSON object per
+#                           line (ts, level, component, pid, msg), shared
+#                           with musiclib-cli and the GUI and searched by
+#                           "musiclib-cli logs query"
+# Both are opened once per process and kept open, so a log line costs two
+# printf builtins (no date/tee forks).  Size-based rotation happens when a
+# process opens them: past LOG_MAX_SIZE_KB the file becomes .1, older
+# generations shift up, LOG_ROTATE_KEEP are kept.  Long-running writers
+# re-check every LOG_RECHECK_WRITES writes and reopen once their file has
+# grown past the limit or was rotated by another process.  Bash cannot open
+# them close-on-exec, so a subshell ( (...), $(...), pipeline stages) drops
+# the descriptors it inherited and opens its own on its first write.
+# LOGFILE is not set by every script that sources this file (under `set -u`
+# an unset LOGFILE must not crash log_message); without it lines only go to
+# stdout.
+
+_MUSICLIB_LOG_PATH=""
+_MUSICLIB_EVENT_PATH=""
+_MUSICLIB_LOG_FD=""
+_MUSICLIB_EVENT_FD=""
+_MUSICLIB_LOG_OWNER=""      # BASH_SUBSHELL that opened the descriptors
+_MUSICLIB_LOG_INODES=""     # "<log inode> <journal inode> " at open time
+_MUSICLIB_LOG_WRITES=0
+
+# Journal path for a text log path: musiclib.log -> musiclib.ndjson
+# Usage: log_journal_path [logfile]   (default: $LOGFILE)
+log_journal_path() {
+    local logfile="${1:-${LOGFILE:-}}"
+    [ -n "$logfile" ] || return 1
+    printf '%s\n' "${logfile%.log}.ndjson"
+}
+
+# Rotate FILE if it is larger than LOG_MAX_SIZE_KB.  Serialised with the
+# C++ writer through an flock on FILE.lock; whoever loses the race skips.
+# Usage: log_rotate_file <file>
+log_rotate_file() {
+    local file="$1"
+    local max_bytes=$(( ${LOG_MAX_SIZE_KB:-10240} * 1024 ))
+    local keep="${LOG_ROTATE_KEEP:-5}"
+    local size
+
+    [ -f "$file" ] || return 0
+    size=$(stat -c %s "$file" 2>/dev/null) || return 0
+    [ "$size" -gt "$max_bytes" ] || return 0
+
+    (
+        flock -n 9 || exit 0
+        # Re-check: another process may have rotated while we looked
+        size=$(stat -c %s "$file" 2>/dev/null) || exit 0
+        [ "$size" -gt "$max_bytes" ] || exit 0
+        if [ "$keep" -lt 1 ]; then
+            rm -f "$file"
+            exit 0
+        fi
+        local i
+        for (( i = keep - 1; i >= 1; i-- )); do
+            [ -e "$file.$i" ] && mv -f "$file.$i" "$file.$((i + 1))"
+        done
+        mv -f "$file" "$file.1"
+    ) 9>"$file.lock" 2>/dev/null
+    return 0
+}
 
-    echo "[$timestamp] $message" | tee -a "${LOGFILE:-/dev/null}" 2>/dev/null || echo "[$timestamp] $message"
+# Succeeds when an open log file has grown past LOG_MAX_SIZE_KB or its
+# path no longer names the file we hold open (rotated or removed)
+_log_needs_reopen() {
+    local max_bytes=$(( ${LOG_MAX_SIZE_KB:-10240} * 1024 ))
+    local ino size inodes=""
+
+    while read -r ino size; do
+        [ "$size" -gt "$max_bytes" ] && return 0
+        inodes+="$ino "
+    done < <(stat -c '%i %s' -- "$_MUSICLIB_LOG_PATH" "$_MUSICLIB_EVENT_PATH" 2>/dev/null)
+    [ "$inodes" != "$_MUSICLIB_LOG_INODES" ]
+}
+
+# (Re)open both log descriptors when LOGFILE changed since the last call,
+# in a new subshell, or when the periodic check finds them rotated
+_log_open() {
+    local logfile="${LOGFILE:-}" journal
+
+    if [ "$logfile" = "$_MUSICLIB_LOG_PATH" ] && [ "$BASH_SUBSHELL" = "$_MUSICLIB_LOG_OWNER" ]; then
+        [ -n "$_MUSICLIB_LOG_INODES" ] || return 0
+        (( ++_MUSICLIB_LOG_WRITES < ${LOG_RECHECK_WRITES:-200} )) && return 0
+        _MUSICLIB_LOG_WRITES=0
+        _log_needs_reopen || return 0
+    fi
+    _MUSICLIB_LOG_PATH="$logfile"
+    _MUSICLIB_LOG_OWNER="$BASH_SUBSHELL"
+    _MUSICLIB_LOG_INODES=""
+    _MUSICLIB_LOG_WRITES=0
+    [ -n "$_MUSICLIB_LOG_FD" ] && exec {_MUSICLIB_LOG_FD}>&-
+    [ -n "$_MUSICLIB_EVENT_FD" ] && exec {_MUSICLIB_EVENT_FD}>&-
+    _MUSICLIB_LOG_FD=""
+    _MUSICLIB_EVENT_FD=""
+    [ -n "$logfile" ] && [ "$logfile" != /dev/null ] || return 0
+
+    journal=$(log_journal_path "$logfile")
+    _MUSICLIB_EVENT_PATH="$journal"
+    log_rotate_file "$logfile"
+    log_rotate_file "$journal"
+    { exec {_MUSICLIB_LOG_FD}>>"$logfile"; } 2>/dev/null || _MUSICLIB_LOG_FD=""
+    { exec {_MUSICLIB_EVENT_FD}>>"$journal"; } 2>/dev/null || _MUSICLIB_EVENT_FD=""
+    _MUSICLIB_LOG_INODES=$(stat -c '%i' -- "$logfile" "$journal" 2>/dev/null | tr '\n' ' ')
+}
+
+# Escape a string for a JSON string literal (no forks)
+_log_json_escape() {
+    local s="$1"
+    s="${s//\\/\\\\}"
+    s="${s//\"/\\\"}"
+    s="${s//$'\t'/\\t}"
+    s="${s//$'\r'/\\r}"
+    s="${s//$'\n'/\\n}"
+    printf -v _LOG_JSON '%s' "$s"
+}
+
+# Append one event to the structured journal only.
+# Usage: log_event <debug|info|warn|error> <component> <message>
+log_event() {
+    local level="$1" component="$2" message="$3" ts comp_json
+
+    _log_open
+    [ -n "$_MUSICLIB_EVENT_FD" ] || return 0
+    TZ=UTC printf -v ts '%(%Y-%m-%dT%H:%M:%SZ)T' -1
+    _log_json_escape "$component"; comp_json="$_LOG_JSON"
+    _log_json_escape "$message"
+    printf '{"ts":"%s","level":"%s","component":"%s","pid":%d,"msg":"%s"}\n' \
+        "$ts" "$level" "$comp_json" "$$" "$_LOG_JSON" >&"$_MUSICLIB_EVENT_FD" 2>/dev/null || true
+}
+
+# Component name for events from this script: LOG_COMPONENT if set, else
+# the script name without the musiclib_ prefix and .sh suffix
+_log_component() {
+    local name="${LOG_COMPONENT:-${0##*/}}"
+    name="${name#musiclib_}"
+    printf -v _LOG_COMPONENT '%s' "${name%.sh}"
+}
+
+# Text log + stdout + journal with an explicit level and component
+# Usage: log_message_as <level> <component> <message>
+log_message_as() {
+    local level="$1" component="$2" message="$3" timestamp
+
+    printf -v timestamp '%(%Y-%m-%d %H:%M:%S)T' -1
+    printf '[%s] %s\n' "$timestamp" "$message"
+    _log_open
+    if [ -n "$_MUSICLIB_LOG_FD" ]; then
+        printf '[%s] %s\n' "$timestamp" "$message" >&"$_MUSICLIB_LOG_FD" 2>/dev/null || true
+    fi
+    log_event "$level" "$component" "$message"
+}
+
+# Log message to log file and stdout (and the journal; the level is taken
+# from an ERROR/WARNING prefix, otherwise info).
+log_message() {
+    local message="$1" level=info
+
+    case "$message" in
+        ERROR*|Error*|error:*)        level=error ;;
+        WARN*|Warning*|warning:*)     level=warn ;;
+    esac
+    _log_component
+    log_message_as "$level" "$_LOG_COMPONENT" "$message"
 }
 
 # Cleanup old files matching pattern in directory
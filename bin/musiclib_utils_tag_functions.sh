@@ -835,7 +835,9 @@ normalize_new_track_tags() {
     cleanup_normalize() {
         rm -rf "$temp_dir" 2>/dev/null || true
     }
-    trap cleanup_normalize RETURN
+    # The RETURN trap outlives this call; clear it so it does not fire (with
+    # temp_dir unset) when the caller returns
+    trap 'cleanup_normalize; trap - RETURN' RETURN
 
     #########################################
     # STAGE 1: Extract All Metadata
@@ -1061,3 +1063,123 @@ tags.save(v2_version=3)
     echo "  âœ“ Tag normalization complete"
     return 0
 }
+
+# ============================================================================
+# LOUDNESS SCAN CACHE
+# ============================================================================
+# rsgain decodes each track, measures integrated loudness and true peak
+# (EBU R128 / BS.1770) and writes the REPLAYGAIN_* frames in the same pass;
+# that decode is by far the most expensive part of boost and new-tracks.
+# After a successful scan the SHA-256 of every track is recorded in
+# loudness.cache together with the scan settings.  The hash covers the
+# tags too, so the gains just written are part of it: an album whose
+# tracks all still hash to a cached value with the same settings already
+# carries exactly those gains and is not scanned again.  Any edit to a
+# track (tags or audio) changes its hash and brings the album back.
+#
+# Each line also carries the size, mtime and path the track had when it
+# was recorded.  A track whose size and mtime are unchanged is taken as
+# unchanged without reading it; only the others are hashed, which still
+# catches tracks that were moved or merely touched.
+#
+# Cache lines: SHA256^SETTINGS^SIZE^MTIME^PATH (settings e.g. "easy" or
+# "custom:-12").  Lines of the older SHA256^SETTINGS form still count as
+# hash hits.  Every record rewrites the file keeping one line per path,
+# so rescans replace entries instead of appending to them.
+
+loudness_cache_file() {
+    echo "${LOUDNESS_CACHE:-$(get_data_dir)/data/loudness.cache}"
+}
+
+#############################################
+# Check whether an album's loudness scan can be skipped
+# Usage: loudness_cached <settings> <file>...
+# Returns: 0=every file matches a cached scan with these settings,
+#          1=scan needed (or cache disabled)
+#############################################
+loudness_cached() {
+    local settings="$1"
+    shift
+    local cache changed
+    local -a rehash=()
+    cache=$(loudness_cache_file)
+
+    [ "${LOUDNESS_CACHE_ENABLED:-true}" = true ] || return 1
+    [ $# -gt 0 ] && [ -s "$cache" ] || return 1
+
+    # Files whose size or mtime differ from their cached line; fails if
+    # one of them cannot be stat'ed
+    changed=$(stat -c '%s^%Y^%n' -- "$@" 2>/dev/null | awk -v settings="$settings" -v cache="$cache" -v want=$# '
+        BEGIN {
+            while ((getline line < cache) > 0) {
+                if (split(line, f, "^") < 5 || f[2] != settings) continue
+                seen[substr(line, length(f[1] f[2] f[3] f[4]) + 5)] = f[3] "^" f[4]
+            }
+        }
+        {
+            n = index($0, "^"); m = index(substr($0, n + 1), "^") + n
+            if (seen[substr($0, m + 1)] != substr($0, 1, m - 1)) print substr($0, m + 1)
+        }
+        END { exit NR != want }
+    ') || return 1
+    [ -n "$changed" ] || return 0
+
+    mapfile -t rehash <<< "$changed"
+    sha256sum -- "${rehash[@]}" 2>/dev/null | awk -v settings="$settings" -v cache="$cache" -v want=${#rehash[@]} '
+        BEGIN {
+            while ((getline line < cache) > 0) {
+                split(line, f, "^")
+                if (f[2] == settings) done[f[1]] = 1
+            }
+        }
+        ($1 in done) { hit++ }
+        END { exit !(NR == want && hit == want) }
+    '
+}
+
+#############################################
+# Record a successful loudness scan of an album
+# Usage: loudness_record <settings> <file>...
+# Returns: 0 always (the cache is an optimisation only)
+#############################################
+loudness_record() {
+    local settings="$1"
+    shift
+    local cache lines
+
+    [ "${LOUDNESS_CACHE_ENABLED:-true}" = true ] || return 0
+    [ $# -gt 0 ] || return 0
+    cache=$(loudness_cache_file)
+    mkdir -p "$(dirname "$cache")" 2>/dev/null || return 0
+
+    lines=$(paste -d'^' <(sha256sum -- "$@" 2>/dev/null | cut -d' ' -f1) \
+                        <(stat -c '%s^%Y^%n' -- "$@" 2>/dev/null) |
+            awk -v settings="$settings" -v want=$# '
+                { rec[NR] = $0; if (index($0, "^") == 1 || split($0, f, "^") < 4) bad = 1 }
+                END {
+                    if (bad || NR != want) exit
+                    for (i = 1; i <= NR; i++) {
+                        n = index(rec[i], "^")
+                        print substr(rec[i], 1, n - 1) "^" settings substr(rec[i], n)
+                    }
+                }
+            ')
+    [ -n "$lines" ] || return 0
+    # Parallel import batches record at the same time.  Rewrite the cache
+    # with the newest line per path (legacy lines once per hash/settings)
+    {
+        flock 9
+        { [ -f "$cache" ] && cat -- "$cache"; printf '%s\n' "$lines"; } |
+            awk '
+                {
+                    if (split($0, f, "^") >= 5) key = "p:" substr($0, length(f[1] f[2] f[3] f[4]) + 5)
+                    else key = "h:" $0
+                    if (!(key in line)) order[++n] = key
+                    line[key] = $0
+                }
+                END { for (i = 1; i <= n; i++) print line[order[i]] }
+            ' > "$cache.tmp.$$" && mv -f "$cache.tmp.$$" "$cache"
+        rm -f "$cache.tmp.$$"
+    } 9>> "$cache.lock" 2>/dev/null || true
+    return 0
+}
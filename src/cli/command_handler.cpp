@@ -3,7 +3,12 @@
 
 #include "command_handler.h"
 #include "cli_utils.h"
+#include "file_prefetch.h"
+#include "library_snapshot.h"
+#include "log_query.h"
 #include "output_streams.h"
+#include "player_query.h"
+#include <QDir>
 #include <QFileInfo>
 
 // Static member initialization
@@ -19,7 +24,7 @@ void CommandHandler::registerCommands() {
     commands_["rate"] = {
         "rate",
         "Set star rating for a track (0-5 stars)",
-        "<rating> [filepath]",
+        "<rating> [filepath...]",
         "musiclib_rate.sh",
         handleRate
     };
@@ -64,7 +69,7 @@ void CommandHandler::registerCommands() {
     commands_["tagrestore"] = {
         "tagrestore",
         "Restore MP3 tags from a backup created by tagrebuild or tagclean",
-        "<FILE.mp3> [options]",
+        "<FILE.mp3> [options] | --batch <DIR|LIST|RUN_ID> [options] | --runs",
         "musiclib_tagrestore.sh",
         handleTagrestore
     };
@@ -114,6 +119,96 @@ void CommandHandler::registerCommands() {
         handleSmartPlaylist
     };
 
+    // Register: db
+    commands_["db"] = {
+        "db",
+        "Database maintenance (snapshots, merge, change feed, indexes, SQL mirror)",
+        "backup|restore|list|merge|changes|textindex|mirror|snapshot|lookup [options]",
+        "",
+        handleDb
+    };
+
+    // Register: stats
+    commands_["stats"] = {
+        "stats",
+        "Listening statistics (ratings, last-played months, top artists)",
+        "[--days N] [--months N] [--top N] [--text]",
+        "musiclib_stats.sh",
+        handleStats
+    };
+
+    // Register: query
+    commands_["query"] = {
+        "query",
+        "Recently played tracks, lyrics/comment search, album/artist tables",
+        "recent|least-recent|played-between|text [options] | --table albums|artists",
+        "musiclib_query.sh",
+        handleQuery
+    };
+
+    // Register: clusters
+    commands_["clusters"] = {
+        "clusters",
+        "Propose near-duplicate artist/genre clusters; apply a mapping to Custom2",
+        "artists|genres [--threshold T] [-o FILE] | apply MAPPING [--dry-run]",
+        "musiclib_clusters.sh",
+        handleClusters
+    };
+
+    // Register: fingerprint
+    commands_["fingerprint"] = {
+        "fingerprint",
+        "Find the same recording in other encodings by acoustic fingerprint",
+        "build [--rebuild] [-j JOBS] | match [FILE...] [--threshold T] [-o FILE]",
+        "musiclib_fingerprint.sh",
+        handleFingerprint
+    };
+
+    // Register: reconcile
+    commands_["reconcile"] = {
+        "reconcile",
+        "Re-attach database rows to moved or renamed files (keeps history)",
+        "[--apply] [--root DIR] [-j JOBS]",
+        "musiclib_reconcile.sh",
+        handleReconcile
+    };
+
+    // Register: remove-record
+    commands_["remove-record"] = {
+        "remove-record",
+        "Remove track records from the database (optionally delete the files)",
+        "<filepath> [record_id] [--delete-file] | --batch <listfile|-> [--delete-file]",
+        "musiclib_remove_record.sh",
+        handleRemoveRecord
+    };
+
+    // Register: player
+    commands_["player"] = {
+        "player",
+        "Query the active MPRIS2 player (current track, status, metadata)",
+        "current [--status] | status | metadata <field>... | name | bus",
+        "",
+        handlePlayer
+    };
+
+    // Register: files
+    commands_["files"] = {
+        "files",
+        "Sort a file list by disk location or prefetch tag headers (stdin)",
+        "order | prefetch [--head KB] [--tail BYTES] [-j N] [-v]",
+        "",
+        handleFiles
+    };
+
+    // Register: logs
+    commands_["logs"] = {
+        "logs",
+        "Search the event journal (level, component, time range)",
+        "query [--level L] [--component C] [--since T] [--until T] [--grep TEXT] [-n N] [--json]",
+        "",
+        handleLogs
+    };
+
     registered_ = true;
 }
 
@@ -140,6 +235,16 @@ int CommandHandler::executeCommand(const QString& cmd, const QStringList& args)
     return cmdInfo.handler(args);
 }
 
+bool CommandHandler::isNative(const QString& cmd, const QStringList& args) {
+    if (!commands_.contains(cmd)) {
+        return false;
+    }
+    if (cmd == "db") {
+        return !args.isEmpty() && (args[0] == "snapshot" || args[0] == "lookup");
+    }
+    return commands_[cmd].scriptName.isEmpty();
+}
+
 void CommandHandler::showHelp(const QString& cmd) {
     if (cmd.isEmpty()) {
         // This shouldn't be called directly - global help is in main.cpp
@@ -164,11 +269,14 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "Arguments:" << Qt::endl;
         cout << "  <rating>     Star rating (0-5, where 0 removes rating)" << Qt::endl;
         cout << "  [filepath]   Path to audio file (optional - uses currently playing track if omitted)" << Qt::endl;
+        cout << "               Several files are rated in one batch: one database update and" << Qt::endl;
+        cout << "               one summary notification" << Qt::endl;
         cout << Qt::endl;
         cout << "Examples:" << Qt::endl;
         cout << "  musiclib-cli rate 4                           # Rate currently playing track" << Qt::endl;
         cout << "  musiclib-cli rate 4 \"/mnt/music/song.mp3\"     # Rate specific file" << Qt::endl;
         cout << "  musiclib-cli rate 5 \"~/Music/track.flac\"      # Rate with expanded path" << Qt::endl;
+        cout << "  musiclib-cli rate 3 ~/Music/Album/*.flac       # Rate a whole album" << Qt::endl;
     }
     else if (cmd == "mobile") {
         cout << "Subcommands:" << Qt::endl;
@@ -177,9 +285,11 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "  refresh-player-playlists       Refresh all playlists from active player to Musiclib" << Qt::endl;
         cout << "                                 No mobile upload is performed" << Qt::endl;
         cout << "  update-lastplayed <playlist>   Update last-played times for a playlist" << Qt::endl;
+        cout << "  retry <playlist> | --all       Retry failed last-played updates" << Qt::endl;
         cout << "  status                         Show current mobile playlist status" << Qt::endl;
         cout << "  logs [filter]                  View mobile operations log" << Qt::endl;
-        cout << "                                 Filters: errors, warnings, stats, today" << Qt::endl;
+        cout << "                                 Filters: errors, warnings, stats, today," << Qt::endl;
+        cout << "                                 or a date (YYYY-MM-DD)" << Qt::endl;
         cout << "  cleanup                        Remove orphaned metadata files" << Qt::endl;
         cout << Qt::endl;
         cout << "Configuration:" << Qt::endl;
@@ -192,11 +302,15 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "  musiclib-cli mobile refresh-player-playlists" << Qt::endl;
         cout << "  musiclib-cli mobile status" << Qt::endl;
         cout << "  musiclib-cli mobile logs errors" << Qt::endl;
+        cout << "  musiclib-cli mobile retry --all" << Qt::endl;
         cout << "  musiclib-cli mobile cleanup" << Qt::endl;
     }
     else if (cmd == "build") {
         cout << "Options:" << Qt::endl;
-        cout << "  --dry-run   Preview changes without modifying database" << Qt::endl;
+        cout << "  --dry-run            Read all files as a build would and report the" << Qt::endl;
+        cout << "                       differences to the current database (rows added," << Qt::endl;
+        cout << "                       removed, changed per column, lost LastTimePlayed)" << Qt::endl;
+        cout << "  --diff-detail FILE   With --dry-run: one JSON line per differing row" << Qt::endl;
         cout << Qt::endl;
         cout << "Description:" << Qt::endl;
         cout << "  Scans the music repository and builds/rebuilds the database." << Qt::endl;
@@ -242,17 +356,28 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "  -n, --dry-run   Show what would be restored without writing" << Qt::endl;
         cout << "  -v, --verbose   List all available backups and show extra detail" << Qt::endl;
         cout << "  -l, --list      List all available backups and exit without restoring" << Qt::endl;
+        cout << "  --batch SOURCE  Restore many files: a directory, a list file (- for stdin)," << Qt::endl;
+        cout << "                  or a backup run ID printed by tagclean/tagrebuild" << Qt::endl;
+        cout << "  -j, --jobs N    Parallel restores in batch mode (default: CPU count)" << Qt::endl;
+        cout << "  --force         Restore even when the backup holds different audio" << Qt::endl;
+        cout << "  --runs          List backup runs and exit" << Qt::endl;
         cout << Qt::endl;
         cout << "Description:" << Qt::endl;
         cout << "  Restores an MP3 file's tags from the most recent backup created by" << Qt::endl;
-        cout << "  tagrebuild or tagclean when run with --keep-backup." << Qt::endl;
+        cout << "  tagrebuild or tagclean when run with --keep-backup.  Batch mode looks" << Qt::endl;
+        cout << "  backups up in the backup index and skips any whose audio does not match" << Qt::endl;
+        cout << "  the current file." << Qt::endl;
         cout << Qt::endl;
-        cout << "Exit codes: 0=success, 1=no backup or bad args, 2=restore failed" << Qt::endl;
+        cout << "Exit codes: 0=success, 1=no backup or bad args (batch: some files skipped)," << Qt::endl;
+        cout << "            2=restore failed" << Qt::endl;
         cout << Qt::endl;
         cout << "Examples:" << Qt::endl;
         cout << "  musiclib-cli tagrestore \"/mnt/music/song.mp3\"" << Qt::endl;
         cout << "  musiclib-cli tagrestore \"/mnt/music/song.mp3\" --dry-run" << Qt::endl;
         cout << "  musiclib-cli tagrestore \"/mnt/music/song.mp3\" --list" << Qt::endl;
+        cout << "  musiclib-cli tagrestore --runs" << Qt::endl;
+        cout << "  musiclib-cli tagrestore --batch tagclean_20260301_101500 -n" << Qt::endl;
+        cout << "  musiclib-cli tagrestore --batch \"/mnt/music/Pink Floyd\" -j 8" << Qt::endl;
     }
     else if (cmd == "new-tracks") {
         cout << "Arguments:" << Qt::endl;
@@ -261,13 +386,16 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "Description:" << Qt::endl;
         cout << "  Imports new music downloads into the library and database." << Qt::endl;
         cout << "  Processes files from the download directory ($NEW_DOWNLOAD_DIR) by:" << Qt::endl;
-        cout << "    1. Extracting ZIP files (if present)" << Qt::endl;
-        cout << "    2. Pausing for tag editing in GUI (kid3, kid3-qt)" << Qt::endl;
+        cout << "    1. Extracting ZIP files (if present, one album per ZIP)" << Qt::endl;
+        cout << "    2. Pausing for tag editing in GUI (kid3, kid3-qt) when run from a terminal" << Qt::endl;
         cout << "    3. Normalizing MP3 filenames from ID3 tags" << Qt::endl;
-        cout << "    4. Standardizing volume levels with rsgain" << Qt::endl;
+        cout << "    4. Standardizing volume levels with rsgain, per album" << Qt::endl;
         cout << "    5. Organizing files into artist/album folder structure" << Qt::endl;
         cout << "    6. Adding tracks to the musiclib.dsv database" << Qt::endl;
         cout << Qt::endl;
+        cout << "  Albums are processed in parallel (NEW_TRACKS_JOBS) and each is added" << Qt::endl;
+        cout << "  to the database as soon as it is ready." << Qt::endl;
+        cout << Qt::endl;
         cout << "  IMPORTANT: Check the album tag during the pause - it determines" << Qt::endl;
         cout << "  the folder name in the repository." << Qt::endl;
         cout << Qt::endl;
@@ -293,7 +421,8 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "Description:" << Qt::endl;
         cout << "  Removes existing ReplayGain tags from all .mp3 files in ALBUM_DIR," << Qt::endl;
         cout << "  then rescans with rsgain at the requested target loudness." << Qt::endl;
-        cout << "  Only processes .mp3 files directly inside ALBUM_DIR (not recursive)." << Qt::endl;
+        cout << "  Disc subfolders of ALBUM_DIR are included. An album unchanged since it" << Qt::endl;
+        cout << "  was last boosted to the same loudness is skipped." << Qt::endl;
         cout << "  Requires both kid3-cli and rsgain to be installed." << Qt::endl;
         cout << Qt::endl;
         cout << "  NOTE: pass a positive integer even though LUFS is normally shown as" << Qt::endl;
@@ -349,6 +478,300 @@ void CommandHandler::showHelp(const QString& cmd) {
         cout << "  musiclib-cli smart-playlist generate -p 100 -n \"Evening Mix\" -g 180,90,45,30,14" << Qt::endl;
         cout << "  musiclib-cli smart-playlist generate -o ~/Music/playlist.m3u" << Qt::endl;
     }
+    else if (cmd == "db") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  backup                       Take a deduplicated snapshot of the database" << Qt::endl;
+        cout << "                               (every shard unless -d/--shard is given)." << Qt::endl;
+        cout << "  restore <ID|latest>          Restore a snapshot.  The current database is" << Qt::endl;
+        cout << "                               snapshotted first, so a restore can be undone." << Qt::endl;
+        cout << "  list                         List snapshots, oldest first." << Qt::endl;
+        cout << "  merge <other.dsv> [options]  Merge play history and ratings from another" << Qt::endl;
+        cout << "                               machine's database into the local one." << Qt::endl;
+        cout << "  changes [options]            Print change events written by the backend" << Qt::endl;
+        cout << "                               (one JSON object per line)." << Qt::endl;
+        cout << "  textindex [options]          Build or update the lyrics/comment text index" << Qt::endl;
+        cout << "                               used by 'query text' and the library filter." << Qt::endl;
+        cout << "  mirror [options]             Bring the read-only SQLite copy of the database" << Qt::endl;
+        cout << "                               (<database>.sqlite) up to date." << Qt::endl;
+        cout << "  snapshot [--publish]         Show (or rebuild) the shared in-memory library" << Qt::endl;
+        cout << "                               snapshot read by KRunner and 'db lookup'." << Qt::endl;
+        cout << "  lookup <PATH|--id N>         Print one track's row from the snapshot." << Qt::endl;
+        cout << Qt::endl;
+        cout << "backup/restore/list options:" << Qt::endl;
+        cout << "  -d FILE             Database to operate on (default: MUSICDB from config)" << Qt::endl;
+        cout << "  --shard NAME        Operate on the named library shard" << Qt::endl;
+        cout << "  -o FILE             restore: write to FILE instead of replacing the database" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  Snapshots are stored as compressed content-defined chunks in DB_BACKUP_DIR;" << Qt::endl;
+        cout << "  each chunk is stored once, so unchanged data costs nothing.  All snapshots" << Qt::endl;
+        cout << "  are kept for DB_BACKUP_KEEP_ALL_HOURS, then one per day for" << Qt::endl;
+        cout << "  DB_BACKUP_RETENTION_DAYS." << Qt::endl;
+        cout << Qt::endl;
+        cout << "merge options:" << Qt::endl;
+        cout << "  -d FILE             Local database (default: MUSICDB from config)" << Qt::endl;
+        cout << "  -o FILE             Merged output file (default: <database>.merged)" << Qt::endl;
+        cout << "  -r FILE             Conflict report file (default: <output>.report)" << Qt::endl;
+        cout << "  --apply             Replace the local database with the merged result" << Qt::endl;
+        cout << "                      (takes the database lock and writes a backup first)" << Qt::endl;
+        cout << "  --relative          Match tracks by path relative to the music roots" << Qt::endl;
+        cout << "  --local-root DIR    Music root of the local database (default: MUSIC_ROOT_DIR)" << Qt::endl;
+        cout << "  --other-root DIR    Music root of the other database (default: same as local)" << Qt::endl;
+        cout << "  --rating RULE       Rating conflict rule: played (default), local, other" << Qt::endl;
+        cout << Qt::endl;
+        cout << "changes options:" << Qt::endl;
+        cout << "  --since SEQ         Only events after sequence number SEQ" << Qt::endl;
+        cout << "  --follow            Keep running and print new events as they arrive" << Qt::endl;
+        cout << "  -d FILE             Database whose feed to read (default: MUSICDB from config)" << Qt::endl;
+        cout << "  --shard NAME        Read the feed of the named library shard" << Qt::endl;
+        cout << "  A {\"op\":\"reload\"} event means events were trimmed from the journal" << Qt::endl;
+        cout << "  (CHANGE_FEED_MAX_EVENTS); reread the database, then continue." << Qt::endl;
+        cout << Qt::endl;
+        cout << "textindex options:" << Qt::endl;
+        cout << "  --rebuild           Re-read every file instead of only changed ones" << Qt::endl;
+        cout << "  -j JOBS             Parallel exiftool processes (default: TEXT_INDEX_JOBS" << Qt::endl;
+        cout << "                      or the number of CPUs)" << Qt::endl;
+        cout << "  -d FILE             Database to index (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME        Index the named library shard only" << Qt::endl;
+        cout << "  -q                  Print nothing on success" << Qt::endl;
+        cout << Qt::endl;
+        cout << "mirror options:" << Qt::endl;
+        cout << "  --follow            Keep running and apply changes as they are written" << Qt::endl;
+        cout << "  --rebuild           Rebuild the mirror from the database first" << Qt::endl;
+        cout << "  -d FILE             Database to mirror (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME        Mirror the named library shard only" << Qt::endl;
+        cout << "  -q                  Print nothing on success" << Qt::endl;
+        cout << "  The mirror is fed from the change feed, one transaction per batch, and is" << Qt::endl;
+        cout << "  only rebuilt when the feed cannot bring it forward.  The DSV stays the" << Qt::endl;
+        cout << "  authority; never write to the mirror.  'systemctl --user enable --now" << Qt::endl;
+        cout << "  musiclib-sqlmirror.service' keeps it current in the background." << Qt::endl;
+        cout << Qt::endl;
+        cout << "snapshot/lookup options:" << Qt::endl;
+        cout << "  -d FILE             Database (default: $MUSICDB, then MUSICDB from config)" << Qt::endl;
+        cout << "  --publish           snapshot: build a new generation even if current" << Qt::endl;
+        cout << "  --field NAME        lookup: print only this column" << Qt::endl;
+        cout << "  The snapshot is a binary image of the database in $XDG_RUNTIME_DIR/musiclib" << Qt::endl;
+        cout << "  that readers map instead of parsing the DSV.  It is rebuilt by the first" << Qt::endl;
+        cout << "  reader that sees the DSV changed; the DSV stays the authority." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Merge rules:" << Qt::endl;
+        cout << "  LastTimePlayed takes the newer value.  A rating only on one side is kept." << Qt::endl;
+        cout << "  When both sides are rated differently, 'played' keeps the rating of the" << Qt::endl;
+        cout << "  side that played the track most recently.  Custom2 is filled only when" << Qt::endl;
+        cout << "  the local value is empty.  Tracks missing locally are reported, not added." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli db backup                                      # Snapshot now" << Qt::endl;
+        cout << "  musiclib-cli db list" << Qt::endl;
+        cout << "  musiclib-cli db restore 20261018_140000 -o /tmp/old.dsv     # Extract an old version" << Qt::endl;
+        cout << "  musiclib-cli db restore latest                              # Roll back to last snapshot" << Qt::endl;
+        cout << "  musiclib-cli db merge ~/laptop-musiclib.dsv                 # Preview into musiclib.dsv.merged" << Qt::endl;
+        cout << "  musiclib-cli db merge ~/laptop-musiclib.dsv --apply         # Merge in place" << Qt::endl;
+        cout << "  musiclib-cli db merge other.dsv --relative --other-root /media/music" << Qt::endl;
+        cout << "  musiclib-cli db changes --since 1200 --follow               # Tail live updates" << Qt::endl;
+        cout << "  musiclib-cli db mirror                                      # Catch up the SQL mirror" << Qt::endl;
+    }
+    else if (cmd == "stats") {
+        cout << "Options:" << Qt::endl;
+        cout << "  --days N        Window for top artists by recent plays (default: 30)" << Qt::endl;
+        cout << "  --months N      Months in the last-played histogram (default: 12)" << Qt::endl;
+        cout << "  --top N         Number of top artists (default: 10)" << Qt::endl;
+        cout << "  --text          Human-readable output instead of JSON" << Qt::endl;
+        cout << "  -d FILE         Database to analyse (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME    Analyse the named library shard only" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  Results are cached until the database or its change feed moves on," << Qt::endl;
+        cout << "  so repeated calls between writes return immediately." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli stats --text" << Qt::endl;
+        cout << "  musiclib-cli stats --days 7 --top 20" << Qt::endl;
+    }
+    else if (cmd == "query") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  recent                  Most recently played tracks, newest first" << Qt::endl;
+        cout << "  least-recent            Least recently played tracks, oldest first" << Qt::endl;
+        cout << "  played-between FROM TO  Tracks last played in [FROM, TO), oldest first" << Qt::endl;
+        cout << "  text WORDS...           Tracks whose lyrics or comments contain the phrase" << Qt::endl;
+        cout << "  --table albums|artists  Per-album or per-artist aggregate table" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Options:" << Qt::endl;
+        cout << "  -n COUNT            Maximum number of tracks (default: 50;" << Qt::endl;
+        cout << "                      played-between and text: unlimited)" << Qt::endl;
+        cout << "  --stars N           Only tracks rated N stars (0-5)" << Qt::endl;
+        cout << "  --include-unplayed  least-recent: list never-played tracks first" << Qt::endl;
+        cout << "  --sort COLUMN       --table: order by COLUMN (numbers descending)" << Qt::endl;
+        cout << "  -d FILE             Database to query (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME        Query the named library shard only" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  Output is the DSV header followed by the matching rows.  Queries" << Qt::endl;
+        cout << "  binary-search <database>.lpidx, which is rebuilt after the database" << Qt::endl;
+        cout << "  changes.  'text' needs the text index: musiclib-cli db textindex." << Qt::endl;
+        cout << "  --table prints track count, total length, rating histogram, mean" << Qt::endl;
+        cout << "  stars, first/last play and path prefix per album (IDAlbum) or per" << Qt::endl;
+        cout << "  artist (Custom2, else AlbumArtist), from <database>.albums/.artists." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli query recent -n 20" << Qt::endl;
+        cout << "  musiclib-cli query least-recent --stars 5 -n 50" << Qt::endl;
+        cout << "  musiclib-cli query played-between 2026-09-01 2026-10-01" << Qt::endl;
+        cout << "  musiclib-cli query text \"hello darkness my old friend\"" << Qt::endl;
+        cout << "  musiclib-cli query --table albums --sort MeanStars -n 20" << Qt::endl;
+    }
+    else if (cmd == "clusters") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  artists        Cluster distinct Artist and AlbumArtist spellings" << Qt::endl;
+        cout << "  genres         Cluster distinct Genre spellings" << Qt::endl;
+        cout << "  apply MAPPING  Set Custom2 from a reviewed artist mapping" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Options:" << Qt::endl;
+        cout << "  --threshold T   Trigram similarity needed to join two names, 0-1" << Qt::endl;
+        cout << "                  (default: 0.6)" << Qt::endl;
+        cout << "  -o FILE         Write the mapping to FILE instead of stdout" << Qt::endl;
+        cout << "  --dry-run       apply: report what would change without writing" << Qt::endl;
+        cout << "  -d FILE         Database to use (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME    Use the named library shard only" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  The mapping is TSV: cluster, canonical, variant, tracks.  Delete the" << Qt::endl;
+        cout << "  lines you disagree with before applying.  apply only fills empty" << Qt::endl;
+        cout << "  Custom2 fields, in one rewrite of each database." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli clusters artists -o ~/artists.tsv" << Qt::endl;
+        cout << "  musiclib-cli clusters apply ~/artists.tsv --dry-run" << Qt::endl;
+        cout << "  musiclib-cli clusters genres --threshold 0.5" << Qt::endl;
+    }
+    else if (cmd == "fingerprint") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  build          Fingerprint new and changed tracks (needs fpcalc)" << Qt::endl;
+        cout << "  match          List groups of tracks that are the same recording" << Qt::endl;
+        cout << "  match FILE...  List library tracks that are the same recording as FILE" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Options:" << Qt::endl;
+        cout << "  --threshold T   Similarity (1 - bit error rate) needed to group two" << Qt::endl;
+        cout << "                  tracks, 0-1 (default: 0.8)" << Qt::endl;
+        cout << "  --rebuild       build: fingerprint every track again" << Qt::endl;
+        cout << "  -j JOBS         Parallel fpcalc processes (default: CPUs)" << Qt::endl;
+        cout << "  -o FILE         match: write the groups to FILE instead of stdout" << Qt::endl;
+        cout << "  -d FILE         Database to use (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME    Use the named library shard only" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  Groups are TSV: group, similarity, ID, artist, title, size, path." << Qt::endl;
+        cout << "  The largest file of each group comes first.  match brings the" << Qt::endl;
+        cout << "  fingerprints up to date before matching." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli fingerprint build -j 8" << Qt::endl;
+        cout << "  musiclib-cli fingerprint match -o ~/duplicates.tsv" << Qt::endl;
+        cout << "  musiclib-cli fingerprint match ~/Downloads/track.mp3" << Qt::endl;
+    }
+    else if (cmd == "reconcile") {
+        cout << "Options:" << Qt::endl;
+        cout << "  --apply         Write the new paths to the database" << Qt::endl;
+        cout << "  --root DIR      Music directory to search (default: the shard's root)" << Qt::endl;
+        cout << "  -j JOBS         Parallel workers for hashing and tag reads (default: CPUs)" << Qt::endl;
+        cout << "  -d FILE         Database to reconcile (default: every library shard)" << Qt::endl;
+        cout << "  --shard NAME    Reconcile the named library shard only" << Qt::endl;
+        cout << Qt::endl;
+        cout << "  Rows whose file is missing are matched against audio files no row" << Qt::endl;
+        cout << "  points at: first by inode, then by size + audio payload hash, then by" << Qt::endl;
+        cout << "  Artist/Album/Title.  A match must be unique on both sides.  The first" << Qt::endl;
+        cout << "  two passes use identities recorded by 'build' and earlier reconcile runs." << Qt::endl;
+        cout << "  --apply updates SongPath in one rewrite; ID, rating and play history" << Qt::endl;
+        cout << "  are kept." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli reconcile" << Qt::endl;
+        cout << "  musiclib-cli reconcile --apply" << Qt::endl;
+    }
+    else if (cmd == "remove-record") {
+        cout << "Arguments:" << Qt::endl;
+        cout << "  <filepath>           Audio file whose record is removed (need not exist)" << Qt::endl;
+        cout << "  [record_id]          Only remove the row with this ID and path" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Options:" << Qt::endl;
+        cout << "  --batch LIST         Remove every row listed in LIST (\"-\" reads stdin)," << Qt::endl;
+        cout << "                       one \"ID<TAB>filepath\" line per row.  Each database" << Qt::endl;
+        cout << "                       is rewritten once, and one STATUS<TAB>ID<TAB>filepath" << Qt::endl;
+        cout << "                       line is printed per row (removed, deleted, file-error," << Qt::endl;
+        cout << "                       not-found, invalid)." << Qt::endl;
+        cout << "  --delete-file        Also delete the audio file(s) from disk" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli remove-record \"/mnt/music/deleted/old_track.mp3\"" << Qt::endl;
+        cout << "  musiclib-cli query text \"...\" | awk -F'^' '{print $1 \"\\t\" $7}' \\" << Qt::endl;
+        cout << "      | musiclib-cli remove-record --batch -" << Qt::endl;
+    }
+    else if (cmd == "player") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  current             Path of the track the active player is playing" << Qt::endl;
+        cout << "  current --status    Playback status and path, tab-separated, in one call" << Qt::endl;
+        cout << "  status              Playing, Paused or Stopped" << Qt::endl;
+        cout << "  metadata <field>... One line per MPRIS metadata field" << Qt::endl;
+        cout << "                      (e.g. xesam:title xesam:artist mpris:length)" << Qt::endl;
+        cout << "  name                Player name (e.g. strawberry, audacious)" << Qt::endl;
+        cout << "  bus                 D-Bus name of the active player" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Description:" << Qt::endl;
+        cout << "  The active player is the one playerctld ranks first, limited to the" << Qt::endl;
+        cout << "  supported_mpris_players allowlist in musiclib.conf.  All queries use" << Qt::endl;
+        cout << "  one D-Bus connection; file:// URLs are decoded to plain paths." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Exit codes: 0=success, 1=no allowed player or nothing to report," << Qt::endl;
+        cout << "            2=D-Bus error" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli player current" << Qt::endl;
+        cout << "  musiclib-cli player metadata xesam:title xesam:artist" << Qt::endl;
+    }
+    else if (cmd == "files") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  order               Print the paths read from stdin sorted by device and" << Qt::endl;
+        cout << "                      physical location (inode order where the filesystem" << Qt::endl;
+        cout << "                      does not report extents, e.g. NFS)" << Qt::endl;
+        cout << "  prefetch            Read the head and tail of each file on stdin into the" << Qt::endl;
+        cout << "                      page cache with several concurrent readers" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Prefetch options:" << Qt::endl;
+        cout << "  --head KB           Bytes read from the start of each file (default: 512)" << Qt::endl;
+        cout << "  --tail BYTES        Bytes read from the end of each file (default: 128)" << Qt::endl;
+        cout << "  -j, --jobs N        Concurrent readers (default: 16)" << Qt::endl;
+        cout << "  -v                  Print a summary to stderr" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Description:" << Qt::endl;
+        cout << "  Used by build, tagclean and tagrebuild so that tag reads on HDD or NAS" << Qt::endl;
+        cout << "  libraries follow the disk layout and hit the page cache.  Unreadable" << Qt::endl;
+        cout << "  files are listed last by 'order' and skipped by 'prefetch'." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  find /mnt/music -name '*.mp3' | musiclib-cli files order > scan.lst" << Qt::endl;
+        cout << "  musiclib-cli files prefetch --head 256 -j 32 < scan.lst" << Qt::endl;
+    }
+    else if (cmd == "logs") {
+        cout << "Subcommands:" << Qt::endl;
+        cout << "  query               Print matching events, oldest first, across the" << Qt::endl;
+        cout << "                      journal and its rotated files" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Query options:" << Qt::endl;
+        cout << "  --level L           debug, info, warn or error; shows L and above" << Qt::endl;
+        cout << "  --component C       Script or program, e.g. rate, mobile, build, cli, gui" << Qt::endl;
+        cout << "  --since T           Events at or after T: YYYY-MM-DD[ HH:MM[:SS]] (local" << Qt::endl;
+        cout << "                      time) or relative: 30m, 2h, 7d" << Qt::endl;
+        cout << "  --until T           Events at or before T (same formats)" << Qt::endl;
+        cout << "  --grep TEXT         Message contains TEXT (case-insensitive)" << Qt::endl;
+        cout << "  -n N                Only the last N matches" << Qt::endl;
+        cout << "  --json              Print the raw NDJSON lines" << Qt::endl;
+        cout << "  --file PATH         Journal to read (default: LOGFILE with .ndjson)" << Qt::endl;
+        cout << Qt::endl;
+        cout << "Description:" << Qt::endl;
+        cout << "  Every backend script, the CLI and the GUI append structured events to" << Qt::endl;
+        cout << "  the journal next to the text log (musiclib.log -> musiclib.ndjson)." << Qt::endl;
+        cout << "  It is rotated at LOG_MAX_SIZE_KB, keeping LOG_ROTATE_KEEP old files." << Qt::endl;
+        cout << Qt::endl;
+        cout << "Examples:" << Qt::endl;
+        cout << "  musiclib-cli logs query --level warn --since 1d" << Qt::endl;
+        cout << "  musiclib-cli logs query --component mobile -n 20" << Qt::endl;
+        cout << "  musiclib-cli logs query --since 2026-10-01 --until 2026-10-02 --json | jq ." << Qt::endl;
+    }
     else if (cmd == "setup") {
         cout << "Options:" << Qt::endl;
         cout << "  --build-db    Build initial database after setup completes" << Qt::endl;
@@ -382,29 +805,22 @@ void CommandHandler::showAvailableCommands() {
 // ============================================================================
 
 int CommandHandler::handleRate(const QStringList& args) {
-    // Rate accepts either 1 or 2 arguments:
-    // 1 arg:  <rating>           - rates currently playing track (uses audtool)
-    // 2 args: <rating> <filepath> - rates specific file
+    // Rate accepts a rating and zero or more files:
+    // 1 arg:   <rating>                  - rates currently playing track
+    // 2+ args: <rating> <filepath>...    - rates the given files (several
+    //                                      files are rated as one batch)
     
-    if (args.size() != 1 && args.size() != 2) {
-        cerr << "Error: 'rate' requires 1 or 2 arguments" << Qt::endl;
+    if (args.isEmpty()) {
+        cerr << "Error: 'rate' requires at least 1 argument" << Qt::endl;
         showHelp("rate");
         return 1;
     }
     
-    QString ratingStr;
-    QString filepath;
+    const QString ratingStr = args[0];
+    const QStringList filepaths = args.mid(1);
     
-    if (args.size() == 1) {
-        // Single argument: rating only (current track)
-        ratingStr = args[0];
-        // Script will use audtool to get current track
-    } else {
-        // Two arguments: rating + filepath
-        ratingStr = args[0];
-        filepath = args[1];
-
-        // Validate file exists
+    // Validate files exist
+    for (const QString& filepath : filepaths) {
         if (!QFileInfo::exists(filepath)) {
             cerr << "Error: File not found: " << filepath << Qt::endl;
             return 1;
@@ -422,9 +838,7 @@ int CommandHandler::handleRate(const QStringList& args) {
     // Build script arguments
     QStringList scriptArgs;
     scriptArgs << ratingStr;  // Rating is always first for the script
-    if (!filepath.isEmpty()) {
-        scriptArgs << filepath;  // Add filepath if provided
-    }
+    scriptArgs << filepaths;
     
     return CLIUtils::executeScript("musiclib_rate.sh", scriptArgs);
 }
@@ -455,12 +869,13 @@ int CommandHandler::handleBuild(const QStringList& args) {
     // Pass all arguments directly to musiclib_build.sh - the script handles its own
     // argument parsing and validation, so no whitelist is needed here.
     // Supported flags (see musiclib_build.sh show_usage):
-    //   [MUSIC_DIR]  -h/--help  -d/--dry-run  -o FILE  -m DEPTH  --no-header
+    //   [MUSIC_DIR]  -h/--help  -d/--dry-run  --diff-detail FILE  -o FILE  -m DEPTH  --no-header
     //   -q/--quiet   -s COLUMN  -b/--backup   -t/--test  --no-progress
     int exitCode = CLIUtils::executeScript("musiclib_build.sh", args,
                                            /*interactive=*/false, /*streamOutput=*/true);
 
-    // Exit code 1 from --dry-run / -d is informational (preview complete), not an error
+    // Exit code 1 from --dry-run / -d is informational (preview complete), not an error.
+    // --diff-detail is only valid with --dry-run, so it alone never makes exit 1 a success.
     if (exitCode == 1 && (args.contains("--dry-run") || args.contains("-d"))) {
         return 0;
     }
@@ -488,7 +903,11 @@ int CommandHandler::handleTagrestore(const QStringList& args) {
     // Pass all arguments directly to musiclib_tagrestore.sh - the script handles its own
     // argument parsing and validation.
     // Supported: <FILE.mp3> [-n/--dry-run] [-v/--verbose] [-l/--list] [-h/--help]
-    return CLIUtils::executeScript("musiclib_tagrestore.sh", args);
+    //           --batch <DIR|LIST|-|RUN_ID> [-j N] [--force], --runs
+    // A batch list on stdin needs the terminal's input channel.
+    const int batch = args.indexOf("--batch");
+    const bool fromStdin = batch >= 0 && args.value(batch + 1) == "-";
+    return CLIUtils::executeScript("musiclib_tagrestore.sh", args, fromStdin);
 }
 
 int CommandHandler::handleNewTracks(const QStringList& args) {
@@ -555,6 +974,249 @@ int CommandHandler::handleSmartPlaylist(const QStringList& args) {
     }
 }
 
+int CommandHandler::handleDb(const QStringList& args) {
+    if (args.isEmpty()) {
+        cerr << "Error: 'db' requires a subcommand" << Qt::endl;
+        showHelp("db");
+        return 1;
+    }
+
+    QString subcommand = args[0];
+
+    if (subcommand == "backup" || subcommand == "restore" || subcommand == "list") {
+        // musiclib_db_backup.sh takes the subcommand itself and handles its own
+        // option parsing (-d, --shard, -o, -h).
+        return CLIUtils::executeScript("musiclib_db_backup.sh", args);
+    }
+    else if (subcommand == "merge") {
+        // musiclib_db_merge.sh handles its own option parsing
+        // (-d, -o, -r, --apply, --relative, --local-root, --other-root, --rating, -h).
+        return CLIUtils::executeScript("musiclib_db_merge.sh", args.mid(1));
+    }
+    else if (subcommand == "changes") {
+        // musiclib_db_changes.sh handles --since, --follow, -d, --shard, -h.
+        // Stream so --follow output appears as events are written.
+        return CLIUtils::executeScript("musiclib_db_changes.sh", args.mid(1), false, true);
+    }
+    else if (subcommand == "textindex") {
+        // musiclib_textindex.sh handles --rebuild, -j, -d, --shard, -q, -h.
+        // Stream so progress on large libraries is visible.
+        return CLIUtils::executeScript("musiclib_textindex.sh", args.mid(1), false, true);
+    }
+    else if (subcommand == "mirror") {
+        // musiclib_sqlmirror.sh handles --follow, --rebuild, -d, --shard, -q, -h.
+        // Stream so --follow output appears as batches are applied.
+        return CLIUtils::executeScript("musiclib_sqlmirror.sh", args.mid(1), false, true);
+    }
+    else if (subcommand == "snapshot") {
+        // Native: maps the shared snapshot, no backend script involved
+        return handleDbSnapshot(args.mid(1));
+    }
+    else if (subcommand == "lookup") {
+        return handleDbLookup(args.mid(1));
+    }
+    else {
+        cerr << "Error: Unknown db subcommand '" << subcommand << "'" << Qt::endl;
+        cerr << "Valid subcommands: backup, restore, list, merge, changes, textindex, mirror," << Qt::endl;
+        cerr << "                   snapshot, lookup" << Qt::endl;
+        return 1;
+    }
+}
+
+// Remove "OPTION VALUE" from @p args and return VALUE (empty if absent)
+static QString takeOption(QStringList& args, const QString& option, bool* present = nullptr) {
+    const int i = args.indexOf(option);
+    if (present)
+        *present = i >= 0;
+    if (i < 0)
+        return QString();
+    args.removeAt(i);
+    return i < args.size() ? args.takeAt(i) : QString();
+}
+
+// Database for the native db subcommands: -d FILE, else $MUSICDB (set by
+// the backend scripts, so their lookups skip reading the config), else the
+// config file, else the default location.
+static QString takeDatabaseArg(QStringList& args) {
+    const QString given = takeOption(args, "-d");
+    if (!given.isEmpty())
+        return given;
+    QString db = qEnvironmentVariable("MUSICDB");
+    if (db.isEmpty())
+        db = CLIUtils::readConfigValue("MUSICDB");
+    if (db.isEmpty())
+        db = QDir::homePath() + "/.local/share/musiclib/data/musiclib.dsv";
+    return db;
+}
+
+int CommandHandler::handleDbSnapshot(const QStringList& args) {
+    QStringList rest = args;
+    const QString db = takeDatabaseArg(rest);
+    const bool publish = rest.removeAll("--publish") > 0;
+    if (!rest.isEmpty()) {
+        cerr << "Error: Unknown option '" << rest.first() << "'" << Qt::endl;
+        return 1;
+    }
+
+    QString error;
+    if (publish && !LibrarySnapshot::publish(db, &error)) {
+        cerr << "Error: " << error << Qt::endl;
+        return 2;
+    }
+
+    LibrarySnapshot snapshot;
+    snapshot.setDsvPath(db);
+    snapshot.refresh(&error);
+    if (!snapshot.isMapped()) {
+        cerr << "Error: " << (error.isEmpty() ? QStringLiteral("No snapshot for ") + db : error) << Qt::endl;
+        return 2;
+    }
+
+    cout << "Database:   " << db << Qt::endl;
+    cout << "Snapshot:   " << LibrarySnapshot::snapshotPath(db) << Qt::endl;
+    cout << "Generation: " << snapshot.generation() << Qt::endl;
+    cout << "Rows:       " << snapshot.rowCount() << Qt::endl;
+    cout << "Columns:    " << snapshot.columnCount() << Qt::endl;
+    return 0;
+}
+
+int CommandHandler::handleDbLookup(const QStringList& args) {
+    QStringList rest = args;
+    const QString db = takeDatabaseArg(rest);
+
+    bool hasField = false;
+    bool hasId = false;
+    const QString field = takeOption(rest, "--field", &hasField);
+    const QString idArg = takeOption(rest, "--id", &hasId);
+    bool idOk = false;
+    const qint64 id = idArg.toLongLong(&idOk);
+    if ((hasId ? !rest.isEmpty() : rest.size() != 1) || (hasId && !idOk) || (hasField && field.isEmpty())) {
+        cerr << "Error: 'db lookup' needs exactly one of <PATH> or --id <N>" << Qt::endl;
+        return 1;
+    }
+
+    LibrarySnapshot snapshot;
+    snapshot.setDsvPath(db);
+    QString error;
+    snapshot.refresh(&error);
+    if (!snapshot.isMapped()) {
+        cerr << "Error: " << (error.isEmpty() ? QStringLiteral("No snapshot for ") + db : error) << Qt::endl;
+        return 2;
+    }
+
+    const int row = hasId ? snapshot.findId(id) : snapshot.findPath(rest.first().toUtf8());
+    if (row < 0)
+        return 1;
+
+    if (!field.isEmpty()) {
+        const int col = snapshot.column(field.toUtf8().constData());
+        if (col < 0) {
+            cerr << "Error: Unknown column '" << field << "'" << Qt::endl;
+            return 1;
+        }
+        cout << snapshot.text(row, col) << Qt::endl;
+        return 0;
+    }
+
+    // The row as it appears in the DSV (the derived SearchText column is
+    // the last one and is left out)
+    QStringList fields;
+    for (int col = 0; col < snapshot.columnCount() - 1; ++col)
+        fields << snapshot.text(row, col);
+    cout << fields.join('^') << Qt::endl;
+    return 0;
+}
+
+int CommandHandler::handleStats(const QStringList& args) {
+    // musiclib_stats.sh handles its own option parsing
+    // (--days, --months, --top, --text, -d, --shard, -h).
+    return CLIUtils::executeScript("musiclib_stats.sh", args);
+}
+
+int CommandHandler::handleQuery(const QStringList& args) {
+    // musiclib_query.sh takes the subcommand itself (recent, least-recent,
+    // played-between, text, or --table) and handles its own option parsing
+    // (-n, --stars, --include-unplayed, --sort, -d, --shard, -h).
+    return CLIUtils::executeScript("musiclib_query.sh", args);
+}
+
+int CommandHandler::handleClusters(const QStringList& args) {
+    // musiclib_clusters.sh takes the subcommand itself and handles its own
+    // option parsing (--threshold, -o, --dry-run, -d, --shard, -h).
+    return CLIUtils::executeScript("musiclib_clusters.sh", args);
+}
+
+int CommandHandler::handleFingerprint(const QStringList& args) {
+    // musiclib_fingerprint.sh takes the subcommand itself and handles its
+    // own option parsing (--threshold, --rebuild, -j, -o, -d, --shard, -q, -h).
+    return CLIUtils::executeScript("musiclib_fingerprint.sh", args);
+}
+
+int CommandHandler::handleReconcile(const QStringList& args) {
+    // musiclib_reconcile.sh handles its own option parsing
+    // (--apply, --root, -j, -d, --shard, -h).
+    return CLIUtils::executeScript("musiclib_reconcile.sh", args, false, true);
+}
+
+int CommandHandler::handleRemoveRecord(const QStringList& args) {
+    // musiclib_remove_record.sh handles its own argument parsing.  A batch
+    // list on stdin needs the terminal's input channel.
+    const int batch = args.indexOf("--batch");
+    const bool fromStdin = batch >= 0 && args.value(batch + 1) == "-";
+    return CLIUtils::executeScript("musiclib_remove_record.sh", args, fromStdin);
+}
+
+int CommandHandler::handlePlayer(const QStringList& args) {
+    static const QStringList subcommands = {"current", "status", "metadata", "name", "bus"};
+    if (args.isEmpty() || !subcommands.contains(args[0])) {
+        if (args.isEmpty())
+            cerr << "Error: 'player' requires a subcommand" << Qt::endl;
+        else
+            cerr << "Error: Unknown player subcommand '" << args[0] << "'" << Qt::endl;
+        showHelp("player");
+        return 1;
+    }
+    if (args[0] == "metadata" && args.size() < 2) {
+        cerr << "Error: 'player metadata' requires at least one field name" << Qt::endl;
+        return 1;
+    }
+
+    // Answered in-process over QtDBus; no backend script involved
+    return PlayerQuery::run(args);
+}
+
+int CommandHandler::handleFiles(const QStringList& args) {
+    if (args.isEmpty() || (args[0] != "order" && args[0] != "prefetch")) {
+        if (args.isEmpty())
+            cerr << "Error: 'files' requires a subcommand" << Qt::endl;
+        else
+            cerr << "Error: Unknown files subcommand '" << args[0] << "'" << Qt::endl;
+        showHelp("files");
+        return 1;
+    }
+    if (args[0] == "order" && args.size() > 1) {
+        cerr << "Error: 'files order' takes no options" << Qt::endl;
+        return 1;
+    }
+
+    // Native: reads the file list from stdin, no backend script involved
+    return FilePrefetch::run(args);
+}
+
+int CommandHandler::handleLogs(const QStringList& args) {
+    if (args.isEmpty() || args[0] != "query") {
+        if (args.isEmpty())
+            cerr << "Error: 'logs' requires a subcommand" << Qt::endl;
+        else
+            cerr << "Error: Unknown logs subcommand '" << args[0] << "'" << Qt::endl;
+        showHelp("logs");
+        return 1;
+    }
+
+    // Native: reads the journal directly, no backend script involved
+    return LogQuery::run(args);
+}
+
 int CommandHandler::handleBoost(const QStringList& args) {
     // Check that rsgain is available (as recorded by the setup wizard)
     QString rsgainInstalled = CLIUtils::readConfigValue("RSGAIN_INSTALLED");
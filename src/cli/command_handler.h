@@ -54,6 +54,17 @@ public:
      * @brief Show list of available commands with descriptions
      */
     static void showAvailableCommands();
+
+    /**
+     * @brief Whether an invocation is answered in-process
+     *
+     * True for commands with no backend script (player, files, logs) and
+     * for the native db subcommands (snapshot, lookup). Script-backed
+     * commands log their own failures.
+     * @param cmd Subcommand name
+     * @param args Arguments passed to the subcommand
+     */
+    static bool isNative(const QString& cmd, const QStringList& args);
     
 private:
     // Command handlers (one per subcommand)
@@ -68,6 +79,18 @@ private:
     static int handleSetup(const QStringList& args);
     static int handleBoost(const QStringList& args);
     static int handleSmartPlaylist(const QStringList& args);
+    static int handleDb(const QStringList& args);
+    static int handleDbSnapshot(const QStringList& args);
+    static int handleDbLookup(const QStringList& args);
+    static int handleStats(const QStringList& args);
+    static int handleQuery(const QStringList& args);
+    static int handleClusters(const QStringList& args);
+    static int handleFingerprint(const QStringList& args);
+    static int handleReconcile(const QStringList& args);
+    static int handleRemoveRecord(const QStringList& args);
+    static int handlePlayer(const QStringList& args);
+    static int handleFiles(const QStringList& args);
+    static int handleLogs(const QStringList& args);
 
     // Command registry
     static QMap<QString, CommandInfo> commands_;
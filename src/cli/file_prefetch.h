@@ -0,0 +1,46 @@
+// file_prefetch.h - Disk-order sorting and tag-header prefetch for scans
+//
+// Full-library scans (build, tag maintenance) hand files to exiftool or
+// kid3-cli one at a time.  On spinning disks and NFS the cost is seek and
+// round-trip latency, not bandwidth.  This helper lets the scripts
+//   - order a file list by physical location (FIEMAP extent of the first
+//     block; inode number where FIEMAP is not supported, e.g. NFS), and
+//   - warm the page cache with just the parts a tag reader needs (the
+//     first N KB for ID3v2/MP4/FLAC headers, the last 128 bytes for
+//     ID3v1/APE), using a pool of threads issuing preads concurrently so
+//     the disk or server sees a deep queue.
+// Tag readers that run afterwards are then served from memory.
+
+#pragma once
+
+#include <QStringList>
+#include <QtGlobal>
+
+/**
+ * @brief Physical-order sorting and concurrent header reads for file lists
+ */
+class FilePrefetch {
+public:
+    /**
+     * @brief Sort @p paths by device, then physical offset (or inode)
+     *
+     * Files that cannot be opened keep their relative order and go last.
+     */
+    static QStringList diskOrder(const QStringList& paths);
+
+    /**
+     * @brief Read the head and tail of every file into the page cache
+     * @param headBytes Bytes read from the start of each file
+     * @param tailBytes Bytes read from the end of each file
+     * @param jobs Concurrent readers (queue depth)
+     * @return Number of files that could not be read
+     */
+    static int prefetch(const QStringList& paths, qint64 headBytes, qint64 tailBytes, int jobs);
+
+    /**
+     * @brief Run a "files" subcommand; the file list is read from stdin
+     * @param args order | prefetch [--head KB] [--tail BYTES] [-j N] [-v]
+     * @return 0 on success, 1 on bad arguments
+     */
+    static int run(const QStringList& args);
+};
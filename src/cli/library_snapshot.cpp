@@ -0,0 +1,454 @@
+// library_snapshot.cpp - Shared read-only library snapshot
+
+#include "library_snapshot.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'M', 'L', 'S', 'N', 'A', 'P', '\0', '\1'};
+constexpr quint32 kVersion = 1;
+const char kDelimiter = '^';
+
+struct DsvStat {
+    qint64  size = -1;
+    qint64  mtimeNs = -1;
+    quint64 inode = 0;
+};
+
+DsvStat fromStat(const struct stat& st) {
+    DsvStat s;
+    s.size = static_cast<qint64>(st.st_size);
+    s.mtimeNs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    s.inode = static_cast<quint64>(st.st_ino);
+    return s;
+}
+
+bool statDsv(const QByteArray& file, DsvStat* out) {
+    struct stat st {};
+    if (::stat(file.constData(), &st) != 0)
+        return false;
+    *out = fromStat(st);
+    return true;
+}
+
+bool matches(const SnapshotHeader& h, const DsvStat& s) {
+    return h.dsvSize == s.size && h.dsvMtimeNs == s.mtimeNs && h.dsvInode == s.inode;
+}
+
+// Header of the snapshot currently on disk, without mapping it
+bool readHeader(const QByteArray& snapFile, SnapshotHeader* header) {
+    const int fd = ::open(snapFile.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    const bool ok = ::pread(fd, header, sizeof(*header), 0) == ssize_t(sizeof(*header))
+                    && std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+                    && header->version == kVersion;
+    ::close(fd);
+    return ok;
+}
+
+// Exclusive lock held while a generation is built
+class PublishLock {
+public:
+    explicit PublishLock(const QByteArray& snapFile) {
+        fd_ = ::open((snapFile + ".lock").constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd_ >= 0)
+            ::flock(fd_, LOCK_EX);
+    }
+    ~PublishLock() {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+private:
+    int fd_ = -1;
+};
+
+void align8(QByteArray& out) {
+    while (out.size() % 8)
+        out.append('\0');
+}
+
+void appendArray(QByteArray& out, const QVector<quint32>& values) {
+    out.append(reinterpret_cast<const char*>(values.constData()),
+               values.size() * qsizetype(sizeof(quint32)));
+    align8(out);
+}
+
+// Deduplicating string table; offset 0 is the empty string
+class StringTable {
+public:
+    StringTable() { add(QByteArray()); }
+
+    quint32 add(const QByteArray& s) {
+        auto it = offsets_.constFind(s);
+        if (it != offsets_.constEnd())
+            return it.value();
+        const quint32 offset = quint32(data_.size());
+        const quint32 len = quint32(s.size());
+        data_.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        data_.append(s);
+        data_.append('\0');
+        offsets_.insert(s, offset);
+        return offset;
+    }
+
+    QByteArray at(quint32 offset) const {
+        quint32 len;
+        std::memcpy(&len, data_.constData() + offset, sizeof(len));
+        return QByteArray::fromRawData(data_.constData() + offset + sizeof(len), len);
+    }
+
+    const QByteArray& data() const { return data_; }
+
+private:
+    QByteArray data_;
+    QHash<QByteArray, quint32> offsets_;
+};
+
+bool fail(QString* error, const QString& message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+bool noSnapshotDir(QString* error) {
+    return fail(error, QStringLiteral("No private directory for library snapshots"));
+}
+
+// The per-user fallback directory in the shared temp dir: created 0700,
+// and used only if it is a real directory owned by this user that no one
+// else can write to (another user may have created the name first).
+bool ensurePrivateDir(const QByteArray& path) {
+    if (::mkdir(path.constData(), 0700) != 0 && errno != EEXIST)
+        return false;
+    struct stat st {};
+    return ::lstat(path.constData(), &st) == 0 && S_ISDIR(st.st_mode)
+           && st.st_uid == ::getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// Parse the DSV and write a new generation next to the old one, then
+// rename it into place.  Caller holds the publish lock.
+bool build(const QString& dsvPath, const QByteArray& snapFile, QString* error) {
+    QFile dsv(dsvPath);
+    if (!dsv.open(QIODevice::ReadOnly))
+        return fail(error, QStringLiteral("Cannot read %1").arg(dsvPath));
+
+    // Record the state of the file actually read (a concurrent tmp+mv
+    // rewrite replaces the inode, which the next refresh will notice)
+    struct stat st {};
+    if (::fstat(dsv.handle(), &st) != 0)
+        return fail(error, QStringLiteral("Cannot stat %1").arg(dsvPath));
+    const DsvStat source = fromStat(st);
+    const QByteArray data = dsv.readAll();
+    dsv.close();
+
+    qsizetype pos = 0;
+    auto nextLine = [&data, &pos]() {
+        qsizetype eol = data.indexOf('\n', pos);
+        if (eol < 0)
+            eol = data.size();
+        QByteArray line = data.mid(pos, eol - pos);
+        if (line.endsWith('\r'))
+            line.chop(1);
+        pos = eol + 1;
+        return line;
+    };
+
+    QList<QByteArray> names = nextLine().split(kDelimiter);
+    while (!names.isEmpty() && names.last().isEmpty())
+        names.removeLast();
+    if (names.isEmpty())
+        return fail(error, QStringLiteral("%1 has no header line").arg(dsvPath));
+
+    const int named = int(names.size());
+    auto columnOf = [&names](const char* name) { return int(names.indexOf(name)); };
+    const int idCol = columnOf("ID");
+    const int artistCol = columnOf("Artist");
+    const int albumCol = columnOf("Album");
+    const int albumArtistCol = columnOf("AlbumArtist");
+    const int titleCol = columnOf("SongTitle");
+    const int pathCol = columnOf("SongPath");
+    names.append("SearchText");
+    const int columns = int(names.size());
+
+    StringTable strings;
+    QVector<QVector<quint32>> cells(columns);
+    quint32 rows = 0;
+    while (pos < data.size()) {
+        const QByteArray line = nextLine();
+        if (line.trimmed().isEmpty())
+            continue;
+        const QList<QByteArray> f = line.split(kDelimiter);
+        auto field = [&f](int col) { return col >= 0 && col < f.size() ? f.at(col) : QByteArray(); };
+        for (int c = 0; c < named; ++c)
+            cells[c].append(strings.add(field(c)));
+        const QString search = QString::fromUtf8(field(artistCol) + '\t' + field(titleCol) + '\t'
+                                                 + field(albumCol) + '\t' + field(albumArtistCol));
+        cells[named].append(strings.add(search.toLower().toUtf8()));
+        ++rows;
+    }
+
+    auto cellAt = [&](int col, quint32 row) {
+        return col < 0 ? QByteArray() : strings.at(cells[col][row]);
+    };
+
+    QVector<quint32> idIndex(rows);
+    QVector<quint32> pathIndex(rows);
+    for (quint32 r = 0; r < rows; ++r)
+        idIndex[r] = pathIndex[r] = r;
+    std::stable_sort(idIndex.begin(), idIndex.end(), [&](quint32 a, quint32 b) {
+        return cellAt(idCol, a).toLongLong() < cellAt(idCol, b).toLongLong();
+    });
+    std::stable_sort(pathIndex.begin(), pathIndex.end(), [&](quint32 a, quint32 b) {
+        return cellAt(pathCol, a) < cellAt(pathCol, b);
+    });
+
+    QVector<quint32> nameOffsets;
+    for (const QByteArray& name : std::as_const(names))
+        nameOffsets.append(strings.add(name));
+
+    SnapshotHeader previous {};
+    const quint64 generation = readHeader(snapFile, &previous) ? previous.generation + 1 : 1;
+
+    SnapshotHeader h {};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.headerSize = sizeof(SnapshotHeader);
+    h.generation = generation;
+    h.dsvSize = source.size;
+    h.dsvMtimeNs = source.mtimeNs;
+    h.dsvInode = source.inode;
+    h.rowCount = rows;
+    h.columnCount = quint32(columns);
+
+    QByteArray out(sizeof(SnapshotHeader), '\0');
+    align8(out);
+    h.columnNamesOffset = quint64(out.size());
+    appendArray(out, nameOffsets);
+    h.cellsOffset = quint64(out.size());
+    for (const QVector<quint32>& column : std::as_const(cells))
+        out.append(reinterpret_cast<const char*>(column.constData()),
+                   column.size() * qsizetype(sizeof(quint32)));
+    align8(out);
+    h.idIndexOffset = quint64(out.size());
+    appendArray(out, idIndex);
+    h.pathIndexOffset = quint64(out.size());
+    appendArray(out, pathIndex);
+    h.stringsOffset = quint64(out.size());
+    h.stringsSize = quint64(strings.data().size());
+    out.append(strings.data());
+    h.fileSize = quint64(out.size());
+    std::memcpy(out.data(), &h, sizeof(h));
+
+    const QByteArray tmpFile = snapFile + ".tmp." + QByteArray::number(qint64(::getpid()));
+    QFile tmp(QFile::decodeName(tmpFile));
+    if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate) || tmp.write(out) != out.size()) {
+        tmp.remove();
+        return fail(error, QStringLiteral("Cannot write %1").arg(tmp.fileName()));
+    }
+    tmp.close();
+    if (::rename(tmpFile.constData(), snapFile.constData()) != 0) {
+        tmp.remove();
+        return fail(error, QStringLiteral("Cannot replace %1").arg(QFile::decodeName(snapFile)));
+    }
+    return true;
+}
+
+} // namespace
+
+LibrarySnapshot::~LibrarySnapshot() {
+    unmap();
+}
+
+QString LibrarySnapshot::snapshotPath(const QString& dsvPath) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        dir = QDir::tempPath() + QStringLiteral("/musiclib-") + QString::number(::getuid());
+        if (!ensurePrivateDir(QFile::encodeName(dir)))
+            return QString();
+    }
+    dir += QStringLiteral("/musiclib");
+    QDir().mkpath(dir);
+
+    const QByteArray key = QCryptographicHash::hash(
+        QFileInfo(dsvPath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return dir + QStringLiteral("/library-") + QString::fromLatin1(key) + QStringLiteral(".snap");
+}
+
+bool LibrarySnapshot::publish(const QString& dsvPath, QString* error) {
+    const QByteArray snapFile = QFile::encodeName(snapshotPath(dsvPath));
+    if (snapFile.isEmpty())
+        return noSnapshotDir(error);
+    PublishLock lock(snapFile);
+    return build(dsvPath, snapFile, error);
+}
+
+void LibrarySnapshot::setDsvPath(const QString& dsvPath) {
+    if (dsvPath == dsvPath_)
+        return;
+    unmap();
+    dsvPath_ = dsvPath;
+}
+
+bool LibrarySnapshot::isStale(const QByteArray& dsvFile) const {
+    DsvStat current;
+    // A missing DSV cannot be rebuilt from; keep serving what is mapped
+    if (!statDsv(dsvFile, &current))
+        return false;
+    return !header_ || !matches(*header_, current);
+}
+
+bool LibrarySnapshot::refresh(QString* error) {
+    if (dsvPath_.isEmpty())
+        return fail(error, QStringLiteral("No database path set"));
+
+    const QByteArray dsvFile = QFile::encodeName(dsvPath_);
+    const QByteArray snapFile = QFile::encodeName(snapshotPath(dsvPath_));
+    if (snapFile.isEmpty())
+        return noSnapshotDir(error);
+    const quint64 before = mappedInode_;
+
+    // Another process may have published a newer generation already
+    struct stat st {};
+    if (::stat(snapFile.constData(), &st) == 0 && quint64(st.st_ino) != mappedInode_)
+        map(nullptr);
+
+    if (isStale(dsvFile)) {
+        PublishLock lock(snapFile);
+        SnapshotHeader onDisk {};
+        DsvStat current;
+        const bool fresh = readHeader(snapFile, &onDisk) && statDsv(dsvFile, &current)
+                           && matches(onDisk, current);
+        if (!fresh && !build(dsvPath_, snapFile, error))
+            return false;
+        if (!map(error))
+            return false;
+    }
+
+    return mappedInode_ != before;
+}
+
+bool LibrarySnapshot::map(QString* error) {
+    const QByteArray snapFile = QFile::encodeName(snapshotPath(dsvPath_));
+    if (snapFile.isEmpty())
+        return noSnapshotDir(error);
+    const int fd = ::open(snapFile.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return fail(error, QStringLiteral("No snapshot at %1").arg(QFile::decodeName(snapFile)));
+
+    struct stat st {};
+    void* addr = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size >= qint64(sizeof(SnapshotHeader)))
+        addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return fail(error, QStringLiteral("Cannot map %1").arg(QFile::decodeName(snapFile)));
+
+    const auto* h = static_cast<const SnapshotHeader*>(addr);
+    const quint64 size = quint64(st.st_size);
+    const quint64 cellBytes = quint64(h->rowCount) * h->columnCount * sizeof(quint32);
+    const quint64 rowBytes = quint64(h->rowCount) * sizeof(quint32);
+    const bool valid = std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0
+                       && h->version == kVersion && h->fileSize == size
+                       && h->columnNamesOffset + h->columnCount * sizeof(quint32) <= size
+                       && h->cellsOffset + cellBytes <= size
+                       && h->idIndexOffset + rowBytes <= size
+                       && h->pathIndexOffset + rowBytes <= size
+                       && h->stringsOffset + h->stringsSize <= size;
+    if (!valid) {
+        ::munmap(addr, size_t(st.st_size));
+        return fail(error, QStringLiteral("Invalid snapshot %1").arg(QFile::decodeName(snapFile)));
+    }
+
+    unmap();
+    base_ = static_cast<const uchar*>(addr);
+    header_ = h;
+    mappedSize_ = qint64(st.st_size);
+    mappedInode_ = quint64(st.st_ino);
+    idColumn_ = column("ID");
+    pathColumn_ = column("SongPath");
+    return true;
+}
+
+void LibrarySnapshot::unmap() {
+    if (base_)
+        ::munmap(const_cast<uchar*>(base_), size_t(mappedSize_));
+    base_ = nullptr;
+    header_ = nullptr;
+    mappedSize_ = 0;
+    mappedInode_ = 0;
+    idColumn_ = pathColumn_ = -1;
+}
+
+const quint32* LibrarySnapshot::array(quint64 offset) const {
+    return reinterpret_cast<const quint32*>(base_ + offset);
+}
+
+QByteArray LibrarySnapshot::stringAt(quint32 offset) const {
+    if (offset + sizeof(quint32) > header_->stringsSize)
+        return QByteArray();
+    const uchar* p = base_ + header_->stringsOffset + offset;
+    quint32 len;
+    std::memcpy(&len, p, sizeof(len));
+    if (offset + sizeof(quint32) + len > header_->stringsSize)
+        return QByteArray();
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(p + sizeof(len)), int(len));
+}
+
+int LibrarySnapshot::column(const char* name) const {
+    for (int c = 0; c < columnCount(); ++c) {
+        if (columnName(c) == name)
+            return c;
+    }
+    return -1;
+}
+
+QByteArray LibrarySnapshot::columnName(int col) const {
+    if (col < 0 || col >= columnCount())
+        return QByteArray();
+    return stringAt(array(header_->columnNamesOffset)[col]);
+}
+
+QByteArray LibrarySnapshot::cell(int row, int col) const {
+    if (row < 0 || row >= rowCount() || col < 0 || col >= columnCount())
+        return QByteArray();
+    return stringAt(array(header_->cellsOffset)[quint64(col) * header_->rowCount + quint64(row)]);
+}
+
+int LibrarySnapshot::findId(qint64 id) const {
+    if (idColumn_ < 0)
+        return -1;
+    const quint32* begin = array(header_->idIndexOffset);
+    const quint32* end = begin + header_->rowCount;
+    const quint32* it = std::lower_bound(begin, end, id, [this](quint32 row, qint64 value) {
+        return cell(int(row), idColumn_).toLongLong() < value;
+    });
+    return it != end && cell(int(*it), idColumn_).toLongLong() == id ? int(*it) : -1;
+}
+
+int LibrarySnapshot::findPath(const QByteArray& path) const {
+    if (pathColumn_ < 0)
+        return -1;
+    const quint32* begin = array(header_->pathIndexOffset);
+    const quint32* end = begin + header_->rowCount;
+    const quint32* it = std::lower_bound(begin, end, path, [this](quint32 row, const QByteArray& value) {
+        return cell(int(row), pathColumn_) < value;
+    });
+    return it != end && cell(int(*it), pathColumn_) == path ? int(*it) : -1;
+}
@@ -0,0 +1,124 @@
+// library_snapshot.h - Shared read-only library snapshot
+//
+// A binary image of one DSV file that local readers map instead of parsing
+// the DSV themselves.  It lives in $XDG_RUNTIME_DIR/musiclib (tmpfs), so
+// every reader maps the same pages: N readers cost one copy in RAM and a
+// lookup from a short-lived process is two stats, an mmap and a binary
+// search.  The DSV stays the authority; a snapshot only records which DSV
+// state (size, mtime, inode) it was built from.
+//
+// Layout (native byte order, sections 8-byte aligned):
+//   header          SnapshotHeader
+//   column names    columnCount x u32 string offsets
+//   cells           columnCount x rowCount u32 string offsets, column-major
+//   id index        rowCount u32 row numbers sorted by numeric ID
+//   path index      rowCount u32 row numbers sorted by SongPath bytes
+//   strings         u32 length + bytes + NUL, deduplicated; offset 0 is ""
+//
+// The columns are the DSV header's, plus a derived "SearchText" column:
+// lower-cased "artist\ttitle\talbum\talbumartist" for substring search.
+//
+// Generations: a snapshot is never modified in place.  publish() writes a
+// new file and renames it over the old one, so a mapped generation stays
+// valid until its reader unmaps it, and refresh() switches to the new one
+// when it sees a different inode.  Whichever reader first notices that the
+// DSV changed publishes the next generation (under a lock file so
+// concurrent readers do not all rebuild it).
+//
+// This file is shared by musiclib-cli and the KRunner plugin and only
+// depends on QtCore and POSIX.
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+struct SnapshotHeader {
+    char    magic[8];            // "MLSNAP\0\1"
+    quint32 version;
+    quint32 headerSize;
+    quint64 generation;
+    qint64  dsvSize;
+    qint64  dsvMtimeNs;
+    quint64 dsvInode;
+    quint32 rowCount;
+    quint32 columnCount;
+    quint64 columnNamesOffset;
+    quint64 cellsOffset;
+    quint64 idIndexOffset;
+    quint64 pathIndexOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+    quint64 fileSize;
+};
+
+/**
+ * @brief Read-only mapping of the snapshot of one DSV file
+ *
+ * Not thread-safe by itself: callers that query from several threads must
+ * serialise refresh() against readers (see TrackIndex in the KRunner
+ * plugin).
+ */
+class LibrarySnapshot {
+public:
+    LibrarySnapshot() = default;
+    ~LibrarySnapshot();
+    LibrarySnapshot(const LibrarySnapshot&) = delete;
+    LibrarySnapshot& operator=(const LibrarySnapshot&) = delete;
+
+    /// Snapshot file for @p dsvPath (one per DSV, keyed by its absolute path).
+    /// Empty when there is no XDG runtime directory and the per-user
+    /// fallback in the temp dir is not private to this user.
+    static QString snapshotPath(const QString& dsvPath);
+
+    /**
+     * @brief Build a snapshot of @p dsvPath and atomically replace the old one
+     * @param error Receives a message on failure
+     * @return false if the DSV cannot be read or the snapshot not written
+     */
+    static bool publish(const QString& dsvPath, QString* error = nullptr);
+
+    /// Use the snapshot of @p dsvPath; unmaps any previous one.  Does not map.
+    void setDsvPath(const QString& dsvPath);
+    QString dsvPath() const { return dsvPath_; }
+
+    /**
+     * @brief Map the newest generation, publishing one first if the DSV changed
+     * @return true if a different generation is mapped now
+     */
+    bool refresh(QString* error = nullptr);
+
+    bool isMapped() const { return header_ != nullptr; }
+    quint64 generation() const { return header_ ? header_->generation : 0; }
+    int rowCount() const { return header_ ? int(header_->rowCount) : 0; }
+    int columnCount() const { return header_ ? int(header_->columnCount) : 0; }
+
+    /// Column number for @p name, or -1
+    int column(const char* name) const;
+    QByteArray columnName(int col) const;
+
+    /// Cell bytes without copying; valid until the next refresh()
+    QByteArray cell(int row, int col) const;
+    QString text(int row, int col) const { return QString::fromUtf8(cell(row, col)); }
+
+    /// Row with this ID, or -1
+    int findId(qint64 id) const;
+    /// Row with this SongPath, or -1
+    int findPath(const QByteArray& path) const;
+
+private:
+    bool map(QString* error);
+    void unmap();
+    bool isStale(const QByteArray& dsvFile) const;
+    QByteArray stringAt(quint32 offset) const;
+    const quint32* array(quint64 offset) const;
+
+    QString dsvPath_;
+    const uchar* base_ = nullptr;
+    const SnapshotHeader* header_ = nullptr;
+    qint64 mappedSize_ = 0;
+    quint64 mappedInode_ = 0;
+    int idColumn_ = -1;
+    int pathColumn_ = -1;
+};
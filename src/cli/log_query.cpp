@@ -0,0 +1,222 @@
+// log_query.cpp - Filtered reads of the NDJSON event journal
+
+#include "log_query.h"
+#include "cli_utils.h"
+#include "output_streams.h"
+#include "structured_log.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include <deque>
+
+namespace {
+
+struct Filter {
+    int minLevel = -1;
+    QString component;
+    QByteArray since;       // UTC "YYYY-MM-DDTHH:MM:SS", compared as text
+    QByteArray until;
+    QString grep;
+};
+
+// "2h", "30m", "7d", "45s" relative to now, or a local date/time
+QByteArray parseTime(const QString& text, bool* ok) {
+    *ok = true;
+    static const QRegularExpression relative(QStringLiteral("^(\\d+)([smhd])$"));
+    const QRegularExpressionMatch m = relative.match(text);
+    QDateTime when;
+    if (m.hasMatch()) {
+        const qint64 n = m.captured(1).toLongLong();
+        const QString unit = m.captured(2);
+        const qint64 secs = unit == "s" ? n : unit == "m" ? n * 60 : unit == "h" ? n * 3600 : n * 86400;
+        when = QDateTime::currentDateTimeUtc().addSecs(-secs);
+    } else {
+        static const char* formats[] = {
+            "yyyy-MM-dd'T'HH:mm:ss", "yyyy-MM-dd HH:mm:ss", "yyyy-MM-dd'T'HH:mm",
+            "yyyy-MM-dd HH:mm", "yyyy-MM-dd"
+        };
+        for (const char* format : formats) {
+            when = QDateTime::fromString(text, QString::fromLatin1(format));
+            if (when.isValid())
+                break;
+        }
+        if (!when.isValid()) {
+            *ok = false;
+            return QByteArray();
+        }
+        when = when.toUTC();
+    }
+    return when.toString(QStringLiteral("yyyy-MM-dd'T'HH:mm:ss")).toLatin1();
+}
+
+// Value of "ts" without parsing the line; every writer puts it first
+QByteArray timestampOf(const QByteArray& line) {
+    static const QByteArray prefix("{\"ts\":\"");
+    if (!line.startsWith(prefix))
+        return QByteArray();
+    const int end = line.indexOf('"', prefix.size());
+    return end < 0 ? QByteArray() : line.mid(prefix.size(), end - prefix.size());
+}
+
+bool matches(const QByteArray& line, const Filter& f, QJsonObject* event) {
+    if (!f.since.isEmpty() || !f.until.isEmpty()) {
+        const QByteArray ts = timestampOf(line).left(19);
+        if (!f.since.isEmpty() && ts < f.since)
+            return false;
+        if (!f.until.isEmpty() && ts > f.until)
+            return false;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(line);
+    if (!doc.isObject())
+        return false;
+    *event = doc.object();
+
+    if (f.minLevel >= 0
+            && StructuredLog::levelFromName(event->value(QStringLiteral("level")).toString()) < f.minLevel)
+        return false;
+    if (!f.component.isEmpty()) {
+        const QString c = event->value(QStringLiteral("component")).toString();
+        if (c != f.component && !c.startsWith(f.component + QLatin1Char('/')))
+            return false;
+    }
+    if (!f.grep.isEmpty()
+            && !event->value(QStringLiteral("msg")).toString().contains(f.grep, Qt::CaseInsensitive))
+        return false;
+    return true;
+}
+
+QString formatEvent(const QJsonObject& event) {
+    QString ts = event.value(QStringLiteral("ts")).toString();
+    const QDateTime when = QDateTime::fromString(ts, Qt::ISODateWithMs);
+    if (when.isValid())
+        ts = when.toLocalTime().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+
+    QString out = QStringLiteral("%1 %2 %3: %4")
+                      .arg(ts, event.value(QStringLiteral("level")).toString().toUpper().leftJustified(5),
+                           event.value(QStringLiteral("component")).toString(),
+                           event.value(QStringLiteral("msg")).toString());
+
+    static const QStringList fixed = {"ts", "level", "component", "pid", "msg"};
+    for (auto it = event.constBegin(); it != event.constEnd(); ++it) {
+        if (fixed.contains(it.key()))
+            continue;
+        const QJsonValue v = it.value();
+        const QString text = v.isString() ? v.toString()
+                           : v.isBool()   ? QString(v.toBool() ? "true" : "false")
+                                          : QString::number(v.toDouble(), 'g', 15);
+        out += QStringLiteral(" %1=%2").arg(it.key(), text);
+    }
+    return out;
+}
+
+} // namespace
+
+QString LogQuery::defaultJournal() {
+    QString logFile = qEnvironmentVariable("LOGFILE");
+    if (logFile.isEmpty())
+        logFile = CLIUtils::readConfigValue(QStringLiteral("LOGFILE"));
+    if (logFile.isEmpty()) {
+        QString dataHome = qEnvironmentVariable("XDG_DATA_HOME");
+        if (dataHome.isEmpty())
+            dataHome = QDir::homePath() + QStringLiteral("/.local/share");
+        logFile = dataHome + QStringLiteral("/musiclib/logs/musiclib.log");
+    }
+    return StructuredLog::journalPath(logFile);
+}
+
+QStringList LogQuery::journalFiles(const QString& journal) {
+    QStringList files;
+    for (int i = 1; QFileInfo::exists(journal + QLatin1Char('.') + QString::number(i)); ++i)
+        files.prepend(journal + QLatin1Char('.') + QString::number(i));
+    if (QFileInfo::exists(journal))
+        files.append(journal);
+    return files;
+}
+
+int LogQuery::run(const QStringList& args) {
+    Filter filter;
+    QString journal;
+    bool json = false;
+    int limit = 0;
+
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& arg = args.at(i);
+        const bool hasValue = i + 1 < args.size();
+        bool ok = true;
+        if (arg == "--level" && hasValue) {
+            filter.minLevel = StructuredLog::levelFromName(args.at(++i));
+            ok = filter.minLevel >= 0;
+        } else if (arg == "--component" && hasValue) {
+            filter.component = args.at(++i);
+        } else if (arg == "--since" && hasValue) {
+            filter.since = parseTime(args.at(++i), &ok);
+        } else if (arg == "--until" && hasValue) {
+            filter.until = parseTime(args.at(++i), &ok);
+        } else if (arg == "--grep" && hasValue) {
+            filter.grep = args.at(++i);
+        } else if (arg == "-n" && hasValue) {
+            limit = args.at(++i).toInt(&ok);
+            ok = ok && limit > 0;
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--file" && hasValue) {
+            journal = args.at(++i);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Error: Invalid option or value '" << arg << "' for 'logs query'" << Qt::endl;
+            return 1;
+        }
+    }
+
+    if (journal.isEmpty())
+        journal = defaultJournal();
+    const QStringList files = journalFiles(journal);
+    if (files.isEmpty()) {
+        cerr << "Error: No event journal at " << journal << Qt::endl;
+        return 2;
+    }
+
+    // With -n only the last N matches are kept, so the whole history is
+    // still scanned once but never held in memory
+    std::deque<QString> tail;
+    QJsonObject event;
+    for (const QString& path : files) {
+        if (!filter.since.isEmpty() && path != journal) {
+            const QByteArray modified = QFileInfo(path).lastModified().toUTC()
+                                            .toString(QStringLiteral("yyyy-MM-dd'T'HH:mm:ss")).toLatin1();
+            if (modified < filter.since)
+                continue;   // every event in it is older
+        }
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            cerr << "Warning: Cannot read " << path << Qt::endl;
+            continue;
+        }
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine().trimmed();
+            if (line.isEmpty() || !matches(line, filter, &event))
+                continue;
+            QString out = json ? QString::fromUtf8(line) : formatEvent(event);
+            if (limit > 0) {
+                tail.push_back(std::move(out));
+                if (int(tail.size()) > limit)
+                    tail.pop_front();
+            } else {
+                cout << out << '\n';
+            }
+        }
+    }
+    for (const QString& out : tail)
+        cout << out << '\n';
+    cout.flush();
+    return 0;
+}
@@ -0,0 +1,31 @@
+// log_query.h - Filtered reads of the NDJSON event journal
+//
+// Reads the journal and its rotated generations (oldest first: .N ... .1,
+// then the live file) and prints the events that match.  Time filters are
+// applied to the "ts" prefix of each line before it is parsed, and rotated
+// files last modified before --since are skipped without being opened, so
+// narrow queries over a large history stay cheap.
+
+#pragma once
+
+#include <QStringList>
+
+/**
+ * @brief Implementation of "musiclib-cli logs query"
+ */
+class LogQuery {
+public:
+    /**
+     * @brief Run a "logs" subcommand
+     * @param args query [--level L] [--component C] [--since T] [--until T]
+     *             [--grep TEXT] [-n N] [--json] [--file PATH]
+     * @return 0 on success, 1 on bad arguments, 2 if the journal cannot be read
+     */
+    static int run(const QStringList& args);
+
+    /// Journal for LOGFILE (environment, then musiclib.conf, then the default)
+    static QString defaultJournal();
+
+    /// Journal files for @p journal, oldest first (rotated .N ... .1, live)
+    static QStringList journalFiles(const QString& journal);
+};
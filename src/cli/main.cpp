@@ -2,12 +2,15 @@
 // Phase 1, Task 2: Argument Parser Implementation
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QTextStream>
 #include <cstdlib>
 
 #include "command_handler.h"
 #include "cli_utils.h"
+#include "log_query.h"
+#include "structured_log.h"
 
 #include "output_streams.h"
 
@@ -110,8 +113,27 @@ int main(int argc, char *argv[]) {
     // Extract subcommand
     QString subcommand = args.takeFirst();
     
+    // System errors (exit >= 2) of the natively implemented commands are
+    // recorded in the event journal; script-backed commands log their own.
+    // The journal path (which needs the config) is only looked up once
+    // there is something to write, so other runs pay nothing for it.
+    StructuredLog::instance().openLazily(&LogQuery::defaultJournal);
+    QElapsedTimer timer;
+    timer.start();
+
     // Execute subcommand
     int exitCode = CommandHandler::executeCommand(subcommand, args);
+
+    if (exitCode >= 2 && CommandHandler::isNative(subcommand, args)) {
+        StructuredLog::instance().log(
+            StructuredLog::Level::Error,
+            QStringLiteral("cli"),
+            QStringLiteral("%1 exited with code %2").arg(subcommand).arg(exitCode),
+            {{QStringLiteral("command"), subcommand},
+             {QStringLiteral("exit"), exitCode},
+             {QStringLiteral("ms"), timer.elapsed()}});
+    }
+    StructuredLog::instance().close();
     
     return exitCode;
 }
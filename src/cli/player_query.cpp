@@ -0,0 +1,193 @@
+// player_query.cpp - MPRIS2 player queries for musiclib-cli
+
+#include "player_query.h"
+#include "cli_utils.h"
+#include "output_streams.h"
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+#include <QUrl>
+
+namespace {
+
+const QString kMprisPrefix = QStringLiteral("org.mpris.MediaPlayer2.");
+const QString kMprisPath = QStringLiteral("/org/mpris/MediaPlayer2");
+const QString kPlayerIface = QStringLiteral("org.mpris.MediaPlayer2.Player");
+const QString kPlayerctldBus = QStringLiteral("org.mpris.MediaPlayer2.playerctld");
+const QString kPlayerctldIface = QStringLiteral("com.github.altdesktop.playerctld");
+
+// Same default as detect_active_mpris_bus in musiclib_player_utils.sh
+const QString kDefaultPlayers = QStringLiteral("strawberry audacious clementine amarok elisa mpd");
+
+// Per-call timeout; a hung player must not stall a keyboard shortcut
+constexpr int kCallTimeoutMs = 2000;
+
+QVariant getProperty(const QString& bus, const QString& iface, const QString& name) {
+    QDBusMessage msg = QDBusMessage::createMethodCall(
+        bus, kMprisPath, QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+    msg << iface << name;
+    const QDBusMessage reply = QDBusConnection::sessionBus().call(msg, QDBus::Block, kCallTimeoutMs);
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty())
+        return QVariant();
+    return reply.arguments().first().value<QDBusVariant>().variant();
+}
+
+QStringList toStringList(const QVariant& value) {
+    if (value.userType() == qMetaTypeId<QDBusArgument>())
+        return qdbus_cast<QStringList>(value.value<QDBusArgument>());
+    return value.toStringList();
+}
+
+bool isAllowed(const QString& bus, const QStringList& allowed) {
+    const QString name = bus.mid(kMprisPrefix.size());
+    for (const QString& entry : allowed) {
+        if (name.startsWith(entry))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+QStringList PlayerQuery::allowlist() {
+    // Scripts pass their already-loaded setting through the environment;
+    // only a direct invocation pays for reading the config file.
+    QString players = qEnvironmentVariable("supported_mpris_players");
+    if (players.isEmpty())
+        players = CLIUtils::readConfigValue(QStringLiteral("supported_mpris_players"));
+    if (players.isEmpty())
+        players = kDefaultPlayers;
+    return players.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+}
+
+bool PlayerQuery::detect() {
+    bus_.clear();
+
+    QDBusConnectionInterface* busIface = QDBusConnection::sessionBus().interface();
+    if (!busIface)
+        return false;
+
+    const QStringList allowed = allowlist();
+
+    // playerctld keeps its players ordered by last activity; the first one
+    // is what playerctl (and the listener) treat as the active player.
+    if (busIface->isServiceRegistered(kPlayerctldBus)) {
+        const QStringList ranked = toStringList(
+            getProperty(kPlayerctldBus, kPlayerctldIface, QStringLiteral("PlayerNames")));
+        if (!ranked.isEmpty() && isAllowed(ranked.first(), allowed))
+            bus_ = ranked.first();
+        return !bus_.isEmpty();
+    }
+
+    // Without playerctld: prefer an allowed player that is playing, else
+    // the first allowed one.
+    const QStringList names = busIface->registeredServiceNames().value();
+    QString fallback;
+    for (const QString& name : names) {
+        if (!name.startsWith(kMprisPrefix) || !isAllowed(name, allowed))
+            continue;
+        if (getProperty(name, kPlayerIface, QStringLiteral("PlaybackStatus")).toString()
+                == QLatin1String("Playing")) {
+            bus_ = name;
+            return true;
+        }
+        if (fallback.isEmpty())
+            fallback = name;
+    }
+    bus_ = fallback;
+    return !bus_.isEmpty();
+}
+
+QString PlayerQuery::playerName() const {
+    return bus_.mid(kMprisPrefix.size());
+}
+
+QVariant PlayerQuery::playerProperty(const QString& name) const {
+    if (bus_.isEmpty())
+        return QVariant();
+    return getProperty(bus_, kPlayerIface, name);
+}
+
+QString PlayerQuery::playbackStatus() const {
+    return playerProperty(QStringLiteral("PlaybackStatus")).toString();
+}
+
+QVariantMap PlayerQuery::metadata() const {
+    const QVariant value = playerProperty(QStringLiteral("Metadata"));
+    if (value.userType() == qMetaTypeId<QDBusArgument>())
+        return qdbus_cast<QVariantMap>(value.value<QDBusArgument>());
+    return value.toMap();
+}
+
+QString PlayerQuery::formatField(const QVariantMap& metadata, const QString& key) {
+    const QVariant value = metadata.value(key);
+    if (!value.isValid())
+        return QString();
+    if (value.userType() == qMetaTypeId<QDBusObjectPath>())
+        return value.value<QDBusObjectPath>().path();
+    if (value.userType() == qMetaTypeId<QDBusArgument>() || value.userType() == QMetaType::QStringList)
+        return toStringList(value).join(QStringLiteral(", "));
+    return value.toString();
+}
+
+QString PlayerQuery::uriToPath(const QString& uri) {
+    if (!uri.startsWith(QLatin1String("file://")))
+        return QString();
+    const QUrl url = QUrl::fromEncoded(uri.toUtf8());
+    return url.isLocalFile() ? url.toLocalFile() : QString();
+}
+
+int PlayerQuery::run(const QStringList& args) {
+    const QString subcommand = args.value(0);
+
+    if (!QDBusConnection::sessionBus().isConnected()) {
+        cerr << "Error: D-Bus session bus is not available" << Qt::endl;
+        return 2;
+    }
+
+    // No allowed player is not an error for callers; they get no output.
+    PlayerQuery player;
+    if (!player.detect())
+        return 1;
+
+    if (subcommand == "bus") {
+        cout << player.busName() << Qt::endl;
+        return 0;
+    }
+    if (subcommand == "name") {
+        cout << player.playerName() << Qt::endl;
+        return 0;
+    }
+    if (subcommand == "status") {
+        const QString status = player.playbackStatus();
+        if (status.isEmpty())
+            return 2;
+        cout << status << Qt::endl;
+        return 0;
+    }
+    if (subcommand == "current") {
+        const QString path = uriToPath(formatField(player.metadata(), QStringLiteral("xesam:url")));
+        if (args.contains("--status")) {
+            // One line for polling loops: status and path in a single call
+            cout << player.playbackStatus() << '\t' << path << Qt::endl;
+            return 0;
+        }
+        if (path.isEmpty())
+            return 1;
+        cout << path << Qt::endl;
+        return 0;
+    }
+
+    // metadata <field>...: one line per field, in order; an absent field
+    // prints an empty line so positions stay stable.
+    const QVariantMap metadata = player.metadata();
+    bool allFound = true;
+    for (const QString& key : args.mid(1)) {
+        allFound = allFound && metadata.contains(key);
+        cout << formatField(metadata, key) << Qt::endl;
+    }
+    return allFound ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+// player_query.h - MPRIS2 player queries for musiclib-cli
+//
+// Answers "which player is active, what is it playing" over a single QtDBus
+// session-bus connection, so the backend scripts need one process per query
+// instead of a playerctl + qdbus6 chain (see musiclib_player_utils.sh).
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+/**
+ * @brief Read-only view of the active MPRIS2 player
+ *
+ * The active player is the one playerctld ranks first (last active), or,
+ * when playerctld is not running, the first MPRIS2 player on the bus that
+ * is playing.  Only players whose bus name starts with an entry of the
+ * supported_mpris_players allowlist are considered, matching the listener.
+ */
+class PlayerQuery {
+public:
+    /**
+     * @brief Detect the active allowed player
+     * @return false if no session bus or no allowed player is active
+     */
+    bool detect();
+
+    /// Full bus name of the active player (e.g. org.mpris.MediaPlayer2.strawberry)
+    QString busName() const { return bus_; }
+
+    /// Player name as playerctl reports it (bus name without the MPRIS prefix)
+    QString playerName() const;
+
+    /// Playing, Paused or Stopped; empty on error
+    QString playbackStatus() const;
+
+    /// Metadata map of the current track; empty on error
+    QVariantMap metadata() const;
+
+    /**
+     * @brief Format one metadata value for shell consumption
+     *
+     * Lists are joined with ", ", object paths print as paths, numbers in
+     * decimal.  Unknown keys give an empty string.
+     */
+    static QString formatField(const QVariantMap& metadata, const QString& key);
+
+    /**
+     * @brief Decode a file:// URI to a local path
+     * @return Empty for non-file URIs (streams, Spotify, ...)
+     */
+    static QString uriToPath(const QString& uri);
+
+    /**
+     * @brief Run a "player" subcommand
+     * @param args current [--status] | status | metadata <field>... | name | bus
+     * @return 0 on success, 1 if there is nothing to report, 2 on D-Bus errors
+     */
+    static int run(const QStringList& args);
+
+private:
+    QVariant playerProperty(const QString& name) const;
+    static QStringList allowlist();
+
+    QString bus_;
+};
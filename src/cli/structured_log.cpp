@@ -0,0 +1,350 @@
+// structured_log.cpp - Asynchronous NDJSON event journal
+
+#include "structured_log.h"
+#include <QDateTime>
+#include <QFile>
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Upper bound on one write(); a full ring drains in a few batches
+constexpr qsizetype kBatchBytes = 256 * 1024;
+
+void appendEscaped(QByteArray& out, const QByteArray& utf8) {
+    out.reserve(out.size() + utf8.size() + 2);
+    out.append('"');
+    for (const char c : utf8) {
+        switch (c) {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                out.append(buf);
+            } else {
+                out.append(c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+void appendValue(QByteArray& out, const QVariant& value) {
+    switch (value.userType()) {
+    case QMetaType::Bool:
+        out.append(value.toBool() ? "true" : "false");
+        break;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        out.append(value.toString().toLatin1());
+        break;
+    case QMetaType::Double:
+        out.append(QByteArray::number(value.toDouble(), 'g', 15));
+        break;
+    default:
+        appendEscaped(out, value.toString().toUtf8());
+    }
+}
+
+qint64 envNumber(const char* name, qint64 fallback) {
+    bool ok = false;
+    const qint64 v = qEnvironmentVariable(name).toLongLong(&ok);
+    return ok && v >= 0 ? v : fallback;
+}
+
+} // namespace
+
+StructuredLog& StructuredLog::instance() {
+    static StructuredLog log;
+    return log;
+}
+
+StructuredLog::StructuredLog()
+    : slots_(new Slot[kCapacity]) {
+    for (quint64 i = 0; i < kCapacity; ++i)
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+
+    // Same knobs as the shell writer (exported by scripts that call us)
+    maxBytes_ = envNumber("LOG_MAX_SIZE_KB", 10240) * 1024;
+    keep_ = int(envNumber("LOG_ROTATE_KEEP", 5));
+}
+
+StructuredLog::~StructuredLog() {
+    close();
+}
+
+QString StructuredLog::journalPath(const QString& logFile) {
+    if (logFile.isEmpty())
+        return QString();
+    if (logFile.endsWith(QLatin1String(".log")))
+        return logFile.left(logFile.size() - 4) + QLatin1String(".ndjson");
+    return logFile + QLatin1String(".ndjson");
+}
+
+const char* StructuredLog::levelName(Level level) {
+    switch (level) {
+    case Level::Debug: return "debug";
+    case Level::Info:  return "info";
+    case Level::Warn:  return "warn";
+    case Level::Error: return "error";
+    }
+    return "info";
+}
+
+int StructuredLog::levelFromName(const QString& name) {
+    const QString n = name.toLower();
+    if (n == QLatin1String("debug"))
+        return int(Level::Debug);
+    if (n == QLatin1String("info"))
+        return int(Level::Info);
+    if (n == QLatin1String("warn") || n == QLatin1String("warning"))
+        return int(Level::Warn);
+    if (n == QLatin1String("error"))
+        return int(Level::Error);
+    return -1;
+}
+
+void StructuredLog::open(const QString& path) {
+    openLazily([path]() { return path; });
+}
+
+void StructuredLog::openLazily(std::function<QString()> resolvePath) {
+    // Only the writer thread calls the resolver, and only before its first
+    // write, so setting it here (before any log()) needs no lock
+    resolvePath_ = std::move(resolvePath);
+}
+
+void StructuredLog::log(Level level, const QString& component, const QString& message,
+                        const QVariantMap& fields) {
+    if (stop_.load(std::memory_order_relaxed) || !resolvePath_)
+        return;
+
+    QByteArray line;
+    line.reserve(160 + message.size());
+    line.append("{\"ts\":\"");
+    line.append(QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toLatin1());
+    line.append("\",\"level\":\"");
+    line.append(levelName(level));
+    line.append("\",\"component\":");
+    appendEscaped(line, component.toUtf8());
+    line.append(",\"pid\":");
+    line.append(QByteArray::number(qint64(::getpid())));
+    line.append(",\"msg\":");
+    appendEscaped(line, message.toUtf8());
+    for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+        line.append(',');
+        appendEscaped(line, it.key().toUtf8());
+        line.append(':');
+        appendValue(line, it.value());
+    }
+    line.append("}\n");
+
+    if (!push(std::move(line))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ensureStarted();
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_one();
+}
+
+void StructuredLog::flush() {
+    if (!started_.load(std::memory_order_acquire))
+        return;
+    const quint64 target = tail_.load(std::memory_order_acquire);
+    for (quint64 w = written_.load(std::memory_order_acquire); w < target;
+         w = written_.load(std::memory_order_acquire)) {
+        written_.wait(w, std::memory_order_acquire);
+    }
+}
+
+void StructuredLog::close() {
+    if (stop_.exchange(true))
+        return;
+    if (writer_.joinable()) {
+        wake_.fetch_add(1, std::memory_order_release);
+        wake_.notify_one();
+        writer_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+// Bounded MPMC ring after Vyukov: each slot's sequence says whose turn it
+// is, so producers claim slots with one CAS on tail_ and never wait on the
+// writer.  Only the writer pops, so head_ needs no atomics.
+bool StructuredLog::push(QByteArray&& line) {
+    quint64 pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & (kCapacity - 1)];
+        const quint64 seq = slot.sequence.load(std::memory_order_acquire);
+        const qint64 diff = qint64(seq) - qint64(pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.line = std::move(line);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;   // full: the writer is a whole ring behind
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool StructuredLog::pop(QByteArray& line) {
+    Slot& slot = slots_[head_ & (kCapacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1)
+        return false;
+    line = std::move(slot.line);
+    slot.line = QByteArray();
+    slot.sequence.store(head_ + kCapacity, std::memory_order_release);
+    ++head_;
+    return true;
+}
+
+void StructuredLog::ensureStarted() {
+    if (!started_.exchange(true, std::memory_order_acq_rel))
+        writer_ = std::thread([this]() { writerLoop(); });
+}
+
+void StructuredLog::writerLoop() {
+    openFile();
+
+    QByteArray batch;
+    QByteArray line;
+    for (;;) {
+        const quint32 seen = wake_.load(std::memory_order_acquire);
+
+        batch.clear();
+        while (batch.size() < kBatchBytes && pop(line))
+            batch.append(line);
+
+        const quint64 dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != droppedReported_) {
+            batch.append("{\"ts\":\"");
+            batch.append(QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toLatin1());
+            batch.append("\",\"level\":\"warn\",\"component\":\"log\",\"pid\":");
+            batch.append(QByteArray::number(qint64(::getpid())));
+            batch.append(",\"msg\":\"journal ring full, events dropped\",\"dropped\":");
+            batch.append(QByteArray::number(dropped - droppedReported_));
+            batch.append("}\n");
+            droppedReported_ = dropped;
+        }
+
+        if (!batch.isEmpty()) {
+            writeBatch(batch);
+            written_.store(head_, std::memory_order_release);
+            written_.notify_all();
+            continue;
+        }
+        if (stop_.load(std::memory_order_acquire))
+            break;
+        wake_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void StructuredLog::openFile() {
+    if (path_.isEmpty() && resolvePath_)
+        path_ = QFile::encodeName(resolvePath_());
+    if (path_.isEmpty())
+        return;
+
+    fd_ = ::open(path_.constData(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st {};
+    const bool ok = fd_ >= 0 && ::fstat(fd_, &st) == 0;
+    size_ = ok ? qint64(st.st_size) : 0;
+    dev_ = ok ? st.st_dev : 0;
+    ino_ = ok ? st.st_ino : 0;
+}
+
+void StructuredLog::reopen() {
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+    openFile();
+}
+
+// Another process (the shell writer or a second CLI) may have rotated the
+// journal since the last batch.  One stat per batch notices the rename, so
+// we never keep appending to a generation that is already ".1".
+void StructuredLog::reopenIfReplaced() {
+    struct stat st {};
+    if (::stat(path_.constData(), &st) != 0 || st.st_ino != ino_ || st.st_dev != dev_) {
+        reopen();
+        return;
+    }
+    size_ = qint64(st.st_size);     // count the other writers' lines too
+}
+
+void StructuredLog::writeBatch(const QByteArray& batch) {
+    if (path_.isEmpty())
+        return;
+    reopenIfReplaced();
+    if (fd_ < 0)
+        return;
+
+    const char* data = batch.constData();
+    qint64 left = batch.size();
+    while (left > 0) {
+        const ssize_t n = ::write(fd_, data, size_t(left));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;     // disk full or similar: logging must not take us down
+        }
+        data += n;
+        left -= n;
+    }
+    size_ += batch.size();
+    rotateIfNeeded();
+}
+
+void StructuredLog::rotateIfNeeded() {
+    if (maxBytes_ <= 0 || size_ <= maxBytes_)
+        return;
+
+    const int lockFd = ::open((path_ + ".lock").constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lockFd < 0 || ::flock(lockFd, LOCK_EX | LOCK_NB) != 0) {
+        // Someone else is rotating: follow them to the new file now
+        // rather than pretending ours is empty
+        if (lockFd >= 0)
+            ::close(lockFd);
+        reopen();
+        return;
+    }
+
+    // Another writer may have rotated already: only rotate the file we
+    // still point at, and only if it is still over the limit
+    struct stat ours {}, onDisk {};
+    const bool same = ::fstat(fd_, &ours) == 0 && ::stat(path_.constData(), &onDisk) == 0
+                      && ours.st_ino == onDisk.st_ino && ours.st_dev == onDisk.st_dev;
+    if (same && qint64(onDisk.st_size) > maxBytes_) {
+        if (keep_ < 1) {
+            ::unlink(path_.constData());
+        } else {
+            for (int i = keep_ - 1; i >= 1; --i) {
+                const QByteArray from = path_ + '.' + QByteArray::number(i);
+                ::rename(from.constData(), (path_ + '.' + QByteArray::number(i + 1)).constData());
+            }
+            ::rename(path_.constData(), (path_ + ".1").constData());
+        }
+    }
+    ::close(lockFd);
+    reopen();
+}
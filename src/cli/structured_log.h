@@ -0,0 +1,122 @@
+// structured_log.h - Asynchronous NDJSON event journal
+//
+// The structured journal sits next to the text log (LOGFILE with its
+// extension replaced by .ndjson, e.g. musiclib.log -> musiclib.ndjson).
+// The backend scripts append to it through log_event in musiclib_utils.sh;
+// musiclib-cli and the GUI append through this class.  One JSON object per
+// line, "ts" always first so readers can filter on time before parsing:
+//   {"ts":"2026-10-19T08:15:02.114Z","level":"warn","component":"gui",
+//    "pid":4242,"msg":"...", ...extra fields}
+//
+// log() never blocks and never touches the disk: it formats the line and
+// pushes it into a fixed-size lock-free ring (multi-producer, one consumer).
+// A writer thread drains the ring and appends each batch with a single
+// write().  When the ring is full the line is dropped and counted; the
+// writer then records how many were lost in a "log" component warning.
+//
+// Rotation is size based and shared with the shell writer: once the journal
+// exceeds LOG_MAX_SIZE_KB (default 10240) it is renamed to .1, older
+// generations shift up and at most LOG_ROTATE_KEEP (default 5) are kept.
+// Whoever rotates holds an flock on "<journal>.lock".
+//
+// Shared by musiclib-cli and the GUI; only depends on QtCore and POSIX.
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <sys/types.h>
+
+/**
+ * @brief Process-wide asynchronous writer for the NDJSON journal
+ */
+class StructuredLog {
+public:
+    enum class Level { Debug, Info, Warn, Error };
+
+    /// The process-wide journal; flushed and closed at exit
+    static StructuredLog& instance();
+
+    /// Journal path for a text log path (musiclib.log -> musiclib.ndjson)
+    static QString journalPath(const QString& logFile);
+
+    static const char* levelName(Level level);
+    /// Level for "debug", "info", "warn"/"warning", "error"; -1 if unknown
+    static int levelFromName(const QString& name);
+
+    /// Append to @p path from now on; starts the writer thread
+    void open(const QString& path);
+
+    /**
+     * @brief Resolve the journal path on the first log() instead of now
+     *
+     * For processes that usually log nothing (the CLI only records
+     * failures), so the config is not read on every run.
+     */
+    void openLazily(std::function<QString()> resolvePath);
+
+    /// Queue one event; returns immediately
+    void log(Level level, const QString& component, const QString& message,
+             const QVariantMap& fields = QVariantMap());
+
+    /// Block until every event queued so far is on disk
+    void flush();
+
+    /// Flush and stop the writer thread
+    void close();
+
+    /// Events dropped because the ring was full
+    quint64 dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    ~StructuredLog();
+    StructuredLog(const StructuredLog&) = delete;
+    StructuredLog& operator=(const StructuredLog&) = delete;
+
+private:
+    StructuredLog();
+
+    struct Slot {
+        std::atomic<quint64> sequence {0};
+        QByteArray line;
+    };
+
+    static constexpr quint64 kCapacity = 1024;   // power of two
+
+    bool push(QByteArray&& line);
+    bool pop(QByteArray& line);
+    void ensureStarted();
+    void writerLoop();
+    void writeBatch(const QByteArray& batch);
+    void openFile();
+    void reopen();
+    void reopenIfReplaced();
+    void rotateIfNeeded();
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<quint64> tail_ {0};    // next slot to fill
+    alignas(64) quint64 head_ = 0;                 // next slot to drain (writer only)
+
+    std::atomic<quint32> wake_ {0};        // bumped on every push
+    std::atomic<quint64> written_ {0};     // ring position written up to
+    std::atomic<quint64> dropped_ {0};
+    quint64 droppedReported_ = 0;
+    std::atomic<bool> stop_ {false};
+    std::atomic<bool> started_ {false};
+
+    std::function<QString()> resolvePath_;
+    QByteArray path_;
+    int fd_ = -1;
+    dev_t dev_ = 0;                        // identity of the file fd_ has open
+    ino_t ino_ = 0;
+    qint64 size_ = 0;
+    qint64 maxBytes_ = 10240LL * 1024;
+    int keep_ = 5;
+    std::thread writer_;
+};
@@ -0,0 +1,429 @@
+// albumgridpanel.cpp
+// MusicLib Qt GUI — Album Cover Grid Panel implementation
+// Copyright (c) 2026 MusicLib Project
+
+#include "albumgridpanel.h"
+#include "albumthumbnails.h"
+#include "libraryaggregates.h"
+
+#include <QApplication>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QListView>
+#include <QLineEdit>
+#include <QLabel>
+#include <QScrollBar>
+#include <QPainter>
+#include <QTimer>
+#include <QIcon>
+#include <QCollator>
+#include <QMultiHash>
+#include <QSet>
+#include <QVector>
+#include <KLocalizedString>
+
+#include <algorithm>
+
+static constexpr int kCoverEdge     = 160;   // logical pixels
+static constexpr int kTilePadding   = 6;
+static constexpr int kTileSpacing   = 4;
+static constexpr int kLoadInterval  = 16;    // ms, about one frame
+
+// ─────────────────────────────────────────────────────────────
+// Model: one row per album, filtered in place.  No Q_OBJECT —
+// it only uses QAbstractItemModel's own signals.
+// ─────────────────────────────────────────────────────────────
+namespace AlbumGridPanelDetail {
+
+struct Entry {
+    LibraryAggregates::AlbumKey key;
+    QString title;
+    QString artist;
+    QString dir;      ///< album directory, the thumbnail key
+    int     tracks = 0;
+};
+
+class Model : public QAbstractListModel
+{
+public:
+    enum Roles { ArtistRole = Qt::UserRole + 1, DirRole };
+
+    Model(AlbumThumbnails *thumbnails, QObject *parent)
+        : QAbstractListModel(parent), m_thumbnails(thumbnails) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(m_rows.size());
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || index.row() >= m_rows.size())
+            return QVariant();
+        const Entry &e = entry(index.row());
+        switch (role) {
+        case Qt::DisplayRole:
+            return e.title.isEmpty() ? i18n("Unknown Album") : e.title;
+        case ArtistRole:
+            return e.artist;
+        case DirRole:
+            return e.dir;
+        case Qt::ToolTipRole:
+            return i18np("%2\n%3\n1 track", "%2\n%3\n%1 tracks", e.tracks, e.title, e.artist);
+        case Qt::DecorationRole:
+            // Only what is already decoded; loading is driven by the viewport
+            if (const QPixmap *pixmap = m_thumbnails->thumbnail(e.dir))
+                return *pixmap;
+            return QVariant();
+        default:
+            return QVariant();
+        }
+    }
+
+    const Entry &entry(int row) const { return m_all.at(m_rows.at(row)); }
+    QList<int> rowsOf(const QString &dir) const { return m_rowsByDir.values(dir); }
+
+    /// Replace the albums (already sorted).  Returns true if the rows
+    /// changed and the model was reset, false if only their text did.
+    bool setAlbums(QVector<Entry> all)
+    {
+        m_all = std::move(all);
+        return apply();
+    }
+
+    bool setFilter(const QString &filter)
+    {
+        m_filter = filter.trimmed();
+        return apply();
+    }
+
+private:
+    bool apply()
+    {
+        QVector<int> rows;
+        rows.reserve(m_all.size());
+        for (int i = 0; i < m_all.size(); ++i) {
+            const Entry &e = m_all.at(i);
+            if (m_filter.isEmpty()
+                    || e.title.contains(m_filter, Qt::CaseInsensitive)
+                    || e.artist.contains(m_filter, Qt::CaseInsensitive))
+                rows.append(i);
+        }
+
+        // A rating or a play changes no album's place: keep the view (and
+        // its scroll position) and just repaint
+        bool same = rows.size() == m_keys.size();
+        for (int row = 0; same && row < rows.size(); ++row)
+            same = m_all.at(rows.at(row)).key == m_keys.at(row);
+
+        if (!same)
+            beginResetModel();
+        m_rows = std::move(rows);
+        m_keys.clear();
+        m_rowsByDir.clear();
+        m_keys.reserve(m_rows.size());
+        for (int row = 0; row < m_rows.size(); ++row) {
+            const Entry &e = entry(row);
+            m_keys.append(e.key);
+            m_rowsByDir.insert(e.dir, row);
+        }
+
+        if (same) {
+            if (!m_rows.isEmpty())
+                Q_EMIT dataChanged(index(0), index(int(m_rows.size()) - 1));
+        } else {
+            endResetModel();
+        }
+        return !same;
+    }
+
+    AlbumThumbnails *m_thumbnails;
+    QVector<Entry>   m_all;
+    QVector<int>     m_rows;                  ///< indices into m_all after filtering
+    QVector<LibraryAggregates::AlbumKey> m_keys;
+    QMultiHash<QString, int> m_rowsByDir;     ///< an album directory can hold several albums
+    QString          m_filter;
+};
+
+// ─────────────────────────────────────────────────────────────
+// Tile: cover (or a placeholder until it is decoded), then the
+// title and the artist, each on one elided line.
+// ─────────────────────────────────────────────────────────────
+class Delegate : public QStyledItemDelegate
+{
+public:
+    explicit Delegate(QObject *parent) : QStyledItemDelegate(parent)
+    {
+        m_placeholder = QIcon::fromTheme(QStringLiteral("media-album-cover"),
+                                         QIcon::fromTheme(QStringLiteral("audio-x-generic")));
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const override
+    {
+        const int line = option.fontMetrics.height();
+        return QSize(kCoverEdge + 2 * kTilePadding, kCoverEdge + 3 * kTilePadding + 2 * line);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override
+    {
+        QStyleOptionViewItem opt(option);
+        initStyleOption(&opt, index);
+        QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+        style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+
+        const QRect cover(opt.rect.x() + (opt.rect.width() - kCoverEdge) / 2,
+                          opt.rect.y() + kTilePadding, kCoverEdge, kCoverEdge);
+        const QVariant decoration = index.data(Qt::DecorationRole);
+        if (decoration.canConvert<QPixmap>()) {
+            const QPixmap pixmap = decoration.value<QPixmap>();
+            QRect target(QPoint(), pixmap.deviceIndependentSize().toSize());
+            target.moveCenter(cover.center());
+            painter->drawPixmap(target, pixmap);
+        } else {
+            painter->save();
+            painter->setPen(opt.palette.color(QPalette::Mid));
+            painter->drawRect(cover.adjusted(0, 0, -1, -1));
+            painter->restore();
+            const int edge = kCoverEdge / 2;
+            m_placeholder.paint(painter, cover.adjusted(edge / 2, edge / 2, -edge / 2, -edge / 2),
+                                Qt::AlignCenter, QIcon::Disabled);
+        }
+
+        const bool selected = opt.state.testFlag(QStyle::State_Selected);
+        const int line = opt.fontMetrics.height();
+        QRect text(opt.rect.x() + kTilePadding, cover.bottom() + kTilePadding,
+                   opt.rect.width() - 2 * kTilePadding, line);
+
+        painter->save();
+        QFont bold = opt.font;
+        bold.setBold(true);
+        painter->setFont(bold);
+        painter->setPen(opt.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+        painter->drawText(text, Qt::AlignHCenter | Qt::AlignVCenter,
+                          QFontMetrics(bold).elidedText(opt.text, Qt::ElideRight, text.width()));
+
+        text.translate(0, line);
+        painter->setFont(opt.font);
+        if (!selected)
+            painter->setPen(opt.palette.color(QPalette::PlaceholderText));
+        painter->drawText(text, Qt::AlignHCenter | Qt::AlignVCenter,
+                          opt.fontMetrics.elidedText(index.data(Model::ArtistRole).toString(),
+                                                     Qt::ElideRight, text.width()));
+        painter->restore();
+    }
+
+private:
+    QIcon m_placeholder;
+};
+
+} // namespace AlbumGridPanelDetail
+
+using AlbumGridPanelDetail::Entry;
+using AlbumGridPanelDetail::Model;
+
+// ─────────────────────────────────────────────────────────────
+// Panel
+// ─────────────────────────────────────────────────────────────
+
+AlbumGridPanel::AlbumGridPanel(LibraryAggregates *aggregates, QWidget *parent)
+    : QWidget(parent)
+    , m_aggregates(aggregates)
+{
+    m_thumbnails = new AlbumThumbnails(kCoverEdge, devicePixelRatioF(), this);
+    m_model = new Model(m_thumbnails, this);
+
+    auto *layout = new QVBoxLayout(this);
+
+    auto *filterRow = new QHBoxLayout;
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(i18n("Filter by album or artist…"));
+    m_filterEdit->setClearButtonEnabled(true);
+    m_countLabel = new QLabel(this);
+    filterRow->addWidget(m_filterEdit, 1);
+    filterRow->addWidget(m_countLabel);
+    layout->addLayout(filterRow);
+
+    // List mode with left-to-right wrapping rather than IconMode: with
+    // uniform item sizes it positions rows arithmetically instead of
+    // keeping a rectangle per item, which is what keeps 5,000+ tiles cheap
+    m_view = new QListView(this);
+    m_view->setViewMode(QListView::ListMode);
+    m_view->setFlow(QListView::LeftToRight);
+    m_view->setWrapping(true);
+    m_view->setResizeMode(QListView::Adjust);
+    m_view->setMovement(QListView::Static);
+    m_view->setUniformItemSizes(true);
+    m_view->setSpacing(kTileSpacing);
+    m_view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_view->verticalScrollBar()->setSingleStep(24);
+    m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setItemDelegate(new AlbumGridPanelDetail::Delegate(m_view));
+    m_view->setModel(m_model);
+    layout->addWidget(m_view, 1);
+
+    m_loadTimer = new QTimer(this);
+    m_loadTimer->setSingleShot(true);
+    m_loadTimer->setInterval(kLoadInterval);
+    connect(m_loadTimer, &QTimer::timeout, this, &AlbumGridPanel::loadVisible);
+
+    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &AlbumGridPanel::onScrolled);
+    // Range changes cover resizes and relayouts
+    connect(m_view->verticalScrollBar(), &QScrollBar::rangeChanged,
+            this, &AlbumGridPanel::scheduleLoad);
+    connect(m_model, &QAbstractItemModel::modelReset,
+            this, &AlbumGridPanel::scheduleLoad);
+
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
+        m_model->setFilter(text);
+        m_countLabel->setText(i18np("1 album", "%1 albums", m_model->rowCount()));
+        scheduleLoad();
+    });
+
+    connect(m_view, &QListView::activated, this, [this](const QModelIndex &index) {
+        const Entry &e = m_model->entry(index.row());
+        Q_EMIT albumActivated(e.key.first, e.key.second, m_thumbnails->coverPath(e.dir));
+    });
+
+    connect(m_thumbnails, &AlbumThumbnails::thumbnailReady,
+            this, &AlbumGridPanel::onThumbnailReady);
+    connect(m_aggregates, &LibraryAggregates::changed,
+            this, &AlbumGridPanel::onAggregatesChanged);
+}
+
+void AlbumGridPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_dirty)
+        refresh();
+    else
+        scheduleLoad();
+}
+
+void AlbumGridPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_loadTimer->stop();
+    m_thumbnails->request({});   // cancel what has not started
+}
+
+void AlbumGridPanel::onAggregatesChanged()
+{
+    if (isVisible())
+        refresh();
+    else
+        m_dirty = true;
+}
+
+void AlbumGridPanel::refresh()
+{
+    m_dirty = false;
+
+    QVector<Entry> all;
+    all.reserve(m_aggregates->albums().size());
+    for (const AlbumAggregate &album : m_aggregates->albums())
+        all.append(Entry{{album.dsv, album.id}, album.title, album.artist(),
+                         album.pathPrefix(), album.tracks});
+
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+    std::sort(all.begin(), all.end(), [&collator](const Entry &a, const Entry &b) {
+        if (const int c = collator.compare(a.artist, b.artist))
+            return c < 0;
+        if (const int c = collator.compare(a.title, b.title))
+            return c < 0;
+        return a.key < b.key;
+    });
+
+    // Imports may have brought covers for albums that had none
+    m_thumbnails->forgetMissing();
+
+    const int scroll = m_view->verticalScrollBar()->value();
+    if (m_model->setAlbums(std::move(all))) {
+        m_view->doItemsLayout();
+        m_view->verticalScrollBar()->setValue(scroll);
+    }
+    m_countLabel->setText(i18np("1 album", "%1 albums", m_model->rowCount()));
+    scheduleLoad();
+}
+
+void AlbumGridPanel::onScrolled(int value)
+{
+    if (value != m_lastScroll)
+        m_scrollingDown = value > m_lastScroll;
+    m_lastScroll = value;
+    scheduleLoad();
+}
+
+void AlbumGridPanel::scheduleLoad()
+{
+    // Throttle rather than debounce, so covers keep arriving during a
+    // long scroll instead of only once it stops
+    if (!m_loadTimer->isActive())
+        m_loadTimer->start();
+}
+
+void AlbumGridPanel::loadVisible()
+{
+    const int count = m_model->rowCount();
+    if (!isVisible() || count == 0) {
+        m_thumbnails->request({});
+        return;
+    }
+
+    // Uniform tiles in wrapped rows: two rectangles give the whole layout
+    const QRect first = m_view->visualRect(m_model->index(0));
+    int columns = 1;
+    while (columns < count
+           && m_view->visualRect(m_model->index(columns)).top() == first.top())
+        ++columns;
+    const int stride = columns < count
+        ? m_view->visualRect(m_model->index(columns)).top() - first.top()
+        : first.height();
+    if (stride <= 0)
+        return;
+
+    const int rows       = (count + columns - 1) / columns;
+    const int firstRow   = qBound(0, -first.top() / stride, rows - 1);
+    const int screenRows = m_view->viewport()->height() / stride + 2;
+    const int lastRow    = qMin(rows - 1, firstRow + screenRows - 1);
+
+    // Prefetch a screen ahead in the scroll direction and half a screen behind
+    const int ahead  = screenRows;
+    const int behind = qMax(1, screenRows / 2);
+
+    QStringList dirs;
+    QSet<QString> seen;
+    auto addRow = [&](int row) {
+        for (int i = row * columns; i < qMin(count, (row + 1) * columns); ++i) {
+            const QString &dir = m_model->entry(i).dir;
+            if (!seen.contains(dir)) {
+                seen.insert(dir);
+                dirs.append(dir);
+            }
+        }
+    };
+    for (int row = firstRow; row <= lastRow; ++row)
+        addRow(row);
+    for (int n = 1; n <= qMax(ahead, behind); ++n) {
+        const int down = lastRow + n, up = firstRow - n;
+        const bool wantDown = n <= (m_scrollingDown ? ahead : behind);
+        const bool wantUp   = n <= (m_scrollingDown ? behind : ahead);
+        if (wantDown && down < rows)
+            addRow(down);
+        if (wantUp && up >= 0)
+            addRow(up);
+    }
+    m_thumbnails->request(dirs);
+}
+
+void AlbumGridPanel::onThumbnailReady(const QString &dir)
+{
+    for (int row : m_model->rowsOf(dir))
+        m_view->update(m_model->index(row));
+}
@@ -0,0 +1,66 @@
+// albumgridpanel.h
+// MusicLib Qt GUI — Album Cover Grid Panel
+//
+// Every album of LibraryAggregates as a cover tile, sorted by artist and
+// title, with a filter on either.  The grid is a wrapping list view with
+// uniform item sizes, so Qt lays out and paints only the rows on screen;
+// covers are requested from AlbumThumbnails for the visible rows plus a
+// prefetch margin in the scroll direction, and each new request cancels
+// the loads that scrolled out of reach.  Like the Statistics panel, a
+// hidden grid skips library updates and catches up when shown.
+// Activating a tile opens the Album View window for that album.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QWidget>
+
+class AlbumThumbnails;
+class LibraryAggregates;
+class QLabel;
+class QLineEdit;
+class QListView;
+class QHideEvent;
+class QShowEvent;
+class QTimer;
+
+namespace AlbumGridPanelDetail { class Model; }
+
+class AlbumGridPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AlbumGridPanel(LibraryAggregates *aggregates, QWidget *parent = nullptr);
+
+Q_SIGNALS:
+    /// Album @p id of shard @p dsv was activated; @p coverPath may be empty
+    void albumActivated(const QString &dsv, int id, const QString &coverPath);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private Q_SLOTS:
+    void onAggregatesChanged();
+    void refresh();
+    void onScrolled(int value);
+    void scheduleLoad();
+    void loadVisible();
+    void onThumbnailReady(const QString &dir);
+
+private:
+    LibraryAggregates           *m_aggregates;
+    AlbumThumbnails             *m_thumbnails = nullptr;
+    AlbumGridPanelDetail::Model *m_model      = nullptr;
+    bool                         m_dirty      = true;
+
+    QListView *m_view        = nullptr;
+    QLineEdit *m_filterEdit  = nullptr;
+    QLabel    *m_countLabel  = nullptr;
+    QTimer    *m_loadTimer   = nullptr;   ///< throttles loadVisible() while scrolling
+
+    int  m_lastScroll    = 0;
+    bool m_scrollingDown = true;
+};
@@ -0,0 +1,209 @@
+// albumthumbnails.cpp
+// MusicLib Qt GUI — Asynchronous album cover thumbnails implementation
+// Copyright (c) 2026 MusicLib Project
+
+#include "albumthumbnails.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <cmath>
+#include <utility>
+
+static constexpr int kPixmapBudgetKiB = 64 * 1024;   // decoded thumbnails kept in memory
+
+namespace {
+
+// Same preference as musiclib_player_event.sh: folder.jpg, then an image
+// whose name says it is the cover, then the largest image
+QString findCover(const QString &dir)
+{
+    const QString folder = dir + QStringLiteral("folder.jpg");
+    if (QFileInfo::exists(folder))
+        return folder;
+
+    const QFileInfoList images = QDir(dir).entryInfoList(
+        {QStringLiteral("*.jpg"), QStringLiteral("*.jpeg"), QStringLiteral("*.png")},
+        QDir::Files | QDir::Readable, QDir::Name);
+    if (images.isEmpty())
+        return QString();
+
+    static const QLatin1String preferred[] = {
+        QLatin1String("folder"), QLatin1String("cover"),
+        QLatin1String("front"),  QLatin1String("album")
+    };
+    for (const QLatin1String &name : preferred) {
+        for (const QFileInfo &image : images) {
+            if (image.fileName().contains(name, Qt::CaseInsensitive))
+                return image.filePath();
+        }
+    }
+
+    const QFileInfo *largest = &images.first();
+    for (const QFileInfo &image : images) {
+        if (image.size() > largest->size())
+            largest = &image;
+    }
+    return largest->filePath();
+}
+
+QString stampOf(const QFileInfo &info)
+{
+    return QStringLiteral("%1:%2").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+}
+
+// Runs on a pool thread.  The cached PNG records which cover it was made
+// from and that file's mtime and size, so a replaced cover is redecoded
+// while an unchanged one costs one stat and a small PNG read.
+void loadThumbnail(const QString &dir, int edge, const QString &cacheFile,
+                   const std::atomic_bool &cancelled, QString *source, QImage *image)
+{
+    QImageReader cached(cacheFile, "png");
+    if (cached.canRead()) {
+        const QString cachedSource = cached.text(QStringLiteral("MusicLib::Source"));
+        const QFileInfo info(cachedSource);
+        if (!cachedSource.isEmpty() && info.exists()
+                && cached.text(QStringLiteral("MusicLib::Stamp")) == stampOf(info)) {
+            *image = cached.read();
+            if (!image->isNull()) {
+                *source = cachedSource;
+                return;
+            }
+        }
+    }
+
+    if (cancelled)
+        return;
+    const QString cover = findCover(dir);
+    if (cover.isEmpty() || cancelled)
+        return;
+
+    // Let the decoder scale: JPEG decodes straight to 1/2, 1/4 or 1/8 size,
+    // which is most of the saving on large scans
+    QImageReader reader(cover);
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+    if (size.isValid() && (size.width() > edge || size.height() > edge))
+        reader.setScaledSize(size.scaled(edge, edge, Qt::KeepAspectRatio));
+    QImage decoded = reader.read();
+    if (decoded.isNull())
+        return;
+    if (decoded.width() > edge || decoded.height() > edge)
+        decoded = decoded.scaled(edge, edge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    decoded.setText(QStringLiteral("MusicLib::Source"), cover);
+    decoded.setText(QStringLiteral("MusicLib::Stamp"), stampOf(QFileInfo(cover)));
+    QSaveFile out(cacheFile);
+    if (out.open(QIODevice::WriteOnly)) {
+        QImageWriter writer(&out, "png");
+        if (writer.write(decoded))
+            out.commit();
+        else
+            out.cancelWriting();
+    }
+
+    *source = cover;
+    *image = decoded;
+}
+
+} // namespace
+
+AlbumThumbnails::AlbumThumbnails(int edge, qreal dpr, QObject *parent)
+    : QObject(parent)
+    , m_edge(int(std::ceil(edge * dpr)))
+    , m_dpr(dpr)
+{
+    // Leave cores for the UI thread and the backend scripts; decoding is
+    // mostly I/O bound on a cold cache anyway
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+    m_pixmaps.setMaxCost(kPixmapBudgetKiB);
+    QDir().mkpath(cacheDir());
+}
+
+AlbumThumbnails::~AlbumThumbnails()
+{
+    for (const Token &token : std::as_const(m_pending))
+        token->store(true);
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QString AlbumThumbnails::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + QStringLiteral("/musiclib/thumbnails");
+}
+
+const QPixmap *AlbumThumbnails::thumbnail(const QString &dir) const
+{
+    return m_pixmaps.object(dir);
+}
+
+void AlbumThumbnails::request(const QStringList &dirs)
+{
+    const QSet<QString> wanted(dirs.constBegin(), dirs.constEnd());
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (wanted.contains(it.key())) {
+            ++it;
+        } else {
+            it.value()->store(true);   // scrolled away: skip it if not started
+            it = m_pending.erase(it);
+        }
+    }
+
+    const int count = int(dirs.size());
+    for (int i = 0; i < count; ++i) {
+        const QString &dir = dirs.at(i);
+        if (dir.isEmpty() || m_pending.contains(dir) || m_missing.contains(dir)
+                || m_pixmaps.contains(dir))
+            continue;
+
+        const Token token = std::make_shared<std::atomic_bool>(false);
+        m_pending.insert(dir, token);
+
+        const QString cacheFile = cacheDir() + QLatin1Char('/')
+            + QString::fromLatin1(QCryptographicHash::hash(dir.toUtf8(), QCryptographicHash::Md5).toHex())
+            + QLatin1Char('-') + QString::number(m_edge) + QStringLiteral(".png");
+        const int edge = m_edge;
+
+        // Earlier entries are more urgent; the pool runs higher priorities first
+        m_pool.start(QRunnable::create([this, dir, edge, cacheFile, token] {
+            QString source;
+            QImage image;
+            if (!*token)
+                loadThumbnail(dir, edge, cacheFile, *token, &source, &image);
+            QMetaObject::invokeMethod(this, [this, dir, source, image, token] {
+                onLoaded(dir, source, image, token);
+            }, Qt::QueuedConnection);
+        }), count - i);
+    }
+}
+
+void AlbumThumbnails::onLoaded(const QString &dir, const QString &source, const QImage &image,
+                               const Token &token)
+{
+    const auto it = m_pending.constFind(dir);
+    if (it != m_pending.constEnd() && it.value() == token)
+        m_pending.erase(it);
+    if (*token)
+        return;
+
+    if (image.isNull()) {
+        m_missing.insert(dir);
+        return;
+    }
+
+    auto *pixmap = new QPixmap(QPixmap::fromImage(image));
+    pixmap->setDevicePixelRatio(m_dpr);
+    m_sources.insert(dir, source);
+    m_pixmaps.insert(dir, pixmap, qMax(1, int(image.sizeInBytes() / 1024)));
+    emit thumbnailReady(dir);
+}
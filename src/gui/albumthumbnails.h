@@ -0,0 +1,72 @@
+// albumthumbnails.h
+// MusicLib Qt GUI — Asynchronous album cover thumbnails
+//
+// Cover thumbnails for the album grid, keyed by album directory.  The
+// cover is chosen the way musiclib_player_event.sh picks folder.jpg
+// (folder.jpg, then an image named folder/cover/front/album, then the
+// largest image), decoded at thumbnail size on a small worker pool, and
+// written to an on-disk cache under ~/.cache/musiclib/thumbnails so later
+// sessions skip the decode.  Only what the view asks for is loaded:
+// request() replaces the wanted set, and jobs for albums that left it are
+// cancelled before they touch the disk.  Decoded pixmaps live in a
+// cost-bounded cache, so memory stays flat however large the library is.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+class AlbumThumbnails : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Thumbnails fit an @p edge square (logical pixels) on a screen with
+    /// device pixel ratio @p dpr
+    AlbumThumbnails(int edge, qreal dpr, QObject *parent = nullptr);
+    ~AlbumThumbnails() override;
+
+    /// Decoded thumbnail for album directory @p dir, or nullptr if not loaded
+    const QPixmap *thumbnail(const QString &dir) const;
+    /// Cover file the thumbnail of @p dir was made from; empty if unknown
+    QString coverPath(const QString &dir) const { return m_sources.value(dir); }
+
+    /// Load the thumbnails of @p dirs, most urgent first; pending jobs for
+    /// directories not listed are cancelled
+    void request(const QStringList &dirs);
+
+    /// Retry albums that had no cover (new files may have been imported)
+    void forgetMissing() { m_missing.clear(); }
+
+    /// Disk cache directory
+    static QString cacheDir();
+
+signals:
+    void thumbnailReady(const QString &dir);
+
+private:
+    using Token = std::shared_ptr<std::atomic_bool>;   ///< set to cancel a job
+
+    void onLoaded(const QString &dir, const QString &source, const QImage &image,
+                  const Token &token);
+
+    int                       m_edge;      ///< device pixels
+    qreal                     m_dpr;
+    QThreadPool               m_pool;
+    QCache<QString, QPixmap>  m_pixmaps;   ///< cost in KiB
+    QHash<QString, QString>   m_sources;   ///< dir -> cover file
+    QHash<QString, Token>     m_pending;   ///< dir -> queued or running job
+    QSet<QString>             m_missing;   ///< dirs without any cover
+};
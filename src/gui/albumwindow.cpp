@@ -3,6 +3,7 @@
 // Copyright (c) 2026 MusicLib Project
 
 #include "albumwindow.h"
+#include "libraryaggregates.h"
 #include "librarymodel.h"
 
 #include <QVBoxLayout>
@@ -56,6 +57,9 @@ AlbumWindow::AlbumWindow(QWidget *parent)
     artCommentLayout->addWidget(m_artworkLabel);
     artCommentLayout->addWidget(m_commentLabel, 1);
 
+    // ── Summary (from the album's aggregate row) ──
+    m_summaryLabel = new QLabel(this);
+
     // ── Track list ──
     m_trackList = new QTreeWidget(this);
     m_trackList->setRootIsDecorated(false);
@@ -72,6 +76,7 @@ AlbumWindow::AlbumWindow(QWidget *parent)
     auto *mainLayout = new QVBoxLayout(this);
     mainLayout->addWidget(m_headerLabel);
     mainLayout->addLayout(artCommentLayout);
+    mainLayout->addWidget(m_summaryLabel);
     mainLayout->addWidget(m_trackList, 1);  // track list gets the stretch
 }
 
@@ -81,8 +86,7 @@ AlbumWindow::~AlbumWindow() = default;
 // Populate with album data
 // ─────────────────────────────────────────────────────────────
 
-void AlbumWindow::populate(LibraryModel *model,
-                           int albumId,
+void AlbumWindow::populate(const AlbumAggregate *aggregate,
                            const QString &artist,
                            const QString &album,
                            const QString &year,
@@ -116,14 +120,35 @@ void AlbumWindow::populate(LibraryModel *model,
         m_commentLabel->setText(tr("No description available."));
     }
 
-    // ── Track list from DSV ──
+    // ── Track list and summary from the aggregate row ──
+    // LibraryAggregates keeps each album's tracks and totals current, so the
+    // window no longer walks the whole library to find them.
     m_trackList->clear();
+    m_summaryLabel->clear();
 
-    if (!model) {
+    if (!aggregate) {
         return;
     }
 
-    // Collect all tracks matching this IDAlbum using trackAt() for raw data access
+    const qint64 totalSecs = aggregate->durationMs / 1000;
+    QString length = QStringLiteral("%1:%2")
+                         .arg(totalSecs / 60)
+                         .arg(totalSecs % 60, 2, 10, QLatin1Char('0'));
+    if (totalSecs >= 3600) {
+        length = QStringLiteral("%1:%2:%3")
+                     .arg(totalSecs / 3600)
+                     .arg((totalSecs / 60) % 60, 2, 10, QLatin1Char('0'))
+                     .arg(totalSecs % 60, 2, 10, QLatin1Char('0'));
+    }
+    const double mean = aggregate->meanStars();
+    m_summaryLabel->setText(
+        tr("%n track(s) · %1 · %2 · last played %3", nullptr, aggregate->tracks)
+            .arg(length,
+                 mean > 0.0 ? QString(QChar(0x2605)) + QStringLiteral(" ")
+                                  + QString::number(mean, 'f', 1)
+                            : tr("unrated"),
+                 sqlTimeToDate(aggregate->maxLastPlayed())));
+
     struct TrackInfo {
         QString trackNumber;   // first 2 chars of filename
         QString title;
@@ -131,27 +156,11 @@ void AlbumWindow::populate(LibraryModel *model,
         double  lastPlayed;
     };
     QList<TrackInfo> tracks;
+    tracks.reserve(aggregate->members.size());
 
-    const int rowCount = model->rowCount();
-    for (int row = 0; row < rowCount; ++row) {
-        TrackRecord record = model->trackAt(row);
-
-        // Match by IDAlbum
-        bool ok = false;
-        int rowAlbumId = record.idAlbum.toInt(&ok);
-        if (!ok || rowAlbumId != albumId) {
-            continue;
-        }
-
-        TrackInfo info;
-        info.title      = record.songTitle;
-        info.groupDesc  = record.groupDesc.toInt();
-        info.lastPlayed = record.lastTimePlayed.toDouble();
-
-        // Extract track number from SongPath
-        info.trackNumber = extractTrackNumber(record.songPath);
-
-        tracks.append(info);
+    for (const AlbumTrack &member : aggregate->members) {
+        tracks.append({extractTrackNumber(member.songPath), member.title,
+                       member.stars, member.lastPlayed});
     }
 
     // Sort by track number
@@ -197,8 +206,7 @@ QString AlbumWindow::sqlTimeToDate(double sqlTime)
     }
 
     // SQL serial time: days since 1899-12-30
-    // Convert to Unix epoch: (sqlTime - 25569) * 86400
-    qint64 unixEpoch = static_cast<qint64>((sqlTime - 25569.0) * 86400.0);
+    qint64 unixEpoch = static_cast<qint64>((sqlTime - SERIAL_UNIX_EPOCH) * 86400.0);
     QDateTime dt = QDateTime::fromSecsSinceEpoch(unixEpoch, QTimeZone::systemTimeZone());
 
     if (!dt.isValid()) {
@@ -6,8 +6,10 @@
 //   - Header: Artist - Album (Year)
 //   - Album artwork from data/conky_output/folder.jpg
 //   - Comment/description from data/conky_output/detail.txt
-//   - Full tracklist from DSV (matched by IDAlbum), sorted by track number
-//     (first 2 characters of filename), showing Title, Rating stars, Last Played
+//   - Full tracklist from the album's aggregate row (LibraryAggregates),
+//     sorted by track number (first 2 characters of filename), showing
+//     Title, Rating stars, Last Played
+//   - Summary line: track count, total length, mean rating, last played
 //
 // Copyright (c) 2026 MusicLib Project
 
@@ -17,7 +19,7 @@
 #include <QLabel>
 #include <QTreeWidget>
 
-class LibraryModel;
+struct AlbumAggregate;
 
 /**
  * @brief Modal-less child window showing album detail for the currently playing track.
@@ -30,6 +32,7 @@ class LibraryModel;
  *   │ Artwork  │ from detail.txt               │
  *   │          │                               │
  *   ├──────────┴───────────────────────────────┤
+ *   │ 10 tracks · 40:12 · ★ 4.2 · 01/03/2026    │
  *   │ Track              Rating    Last Played  │
  *   │ 01 Toys in the..   ★★★★★    12/16/2025  │
  *   │ 02 Uncle Salty      ★★★★☆    01/03/2026  │
@@ -47,16 +50,14 @@ public:
     /**
      * @brief Populate the window with album data.
      *
-     * @param model       The library model (DSV data) to query for album tracks
-     * @param albumId     IDAlbum value to match in DSV
+     * @param aggregate   Album row from LibraryAggregates (nullptr: no tracks)
      * @param artist      Artist name for the header
      * @param album       Album name for the header
      * @param year        Year string (from conky year.txt)
      * @param artworkPath Full path to album artwork (folder.jpg)
      * @param comment     Album/artist comment (from conky detail.txt)
      */
-    void populate(LibraryModel *model,
-                  int albumId,
+    void populate(const AlbumAggregate *aggregate,
                   const QString &artist,
                   const QString &album,
                   const QString &year,
@@ -77,5 +78,6 @@ private:
     QLabel       *m_headerLabel;    ///< "Artist - Album (Year)"
     QLabel       *m_artworkLabel;   ///< Album artwork image
     QLabel       *m_commentLabel;   ///< detail.txt content
+    QLabel       *m_summaryLabel;   ///< Tracks, length, mean rating, last played
     QTreeWidget  *m_trackList;      ///< Track listing table
 };
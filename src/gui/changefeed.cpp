@@ -0,0 +1,134 @@
+// changefeed.cpp
+// MusicLib Qt GUI — Database change-feed subscriber
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "changefeed.h"
+
+#include <QDBusConnection>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+ChangeFeed::ChangeFeed(QObject *parent)
+    : QObject(parent)
+{
+    // Live wake-up.  The journal stays the source of truth: the signal only
+    // triggers a poll, so a missed or reordered signal costs nothing.
+    QDBusConnection::sessionBus().connect(
+        QString(),
+        QStringLiteral("/org/musiclib/ChangeFeed"),
+        QStringLiteral("org.musiclib.ChangeFeed"),
+        QStringLiteral("Changed"),
+        this, SLOT(onChanged(QString,qulonglong,QString)));
+}
+
+QString ChangeFeed::journalPath(const QString &dsvPath)
+{
+    return dsvPath + QStringLiteral(".changes");
+}
+
+void ChangeFeed::setDatabases(const QStringList &dsvPaths)
+{
+    m_cursors.clear();
+    for (const QString &path : dsvPaths)
+        seekToEnd(path);
+}
+
+void ChangeFeed::seekToEnd(const QString &dsvPath)
+{
+    Cursor cursor;
+
+    QFile file(journalPath(dsvPath));
+    if (file.open(QIODevice::ReadOnly)) {
+        cursor.offset = file.size();
+        // The last line carries the highest sequence number; 4 KB is
+        // comfortably more than one event.
+        file.seek(qMax<qint64>(0, cursor.offset - 4096));
+        const QList<QByteArray> lines = file.readAll().split('\n');
+        for (auto it = lines.crbegin(); it != lines.crend(); ++it) {
+            const QJsonObject event = QJsonDocument::fromJson(*it).object();
+            if (event.contains(QStringLiteral("seq"))) {
+                cursor.seq = static_cast<quint64>(event.value(QStringLiteral("seq")).toInteger());
+                break;
+            }
+        }
+    }
+
+    m_cursors.insert(dsvPath, cursor);
+}
+
+void ChangeFeed::poll(const QString &dsvPath)
+{
+    auto it = m_cursors.find(dsvPath);
+    if (it == m_cursors.end())
+        return;
+    Cursor &cursor = it.value();
+
+    QFile file(journalPath(dsvPath));
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    // A shorter file has been trimmed (tmp+mv) or recreated; rescan it and
+    // skip what was already delivered.
+    const bool rescanned = file.size() < cursor.offset;
+    if (rescanned)
+        cursor.offset = 0;
+    file.seek(cursor.offset);
+
+    bool gap = false;
+    quint64 newest = 0;
+    QList<QJsonObject> events;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (!line.endsWith('\n'))
+            break;                      // writer mid-append; finish next poll
+        cursor.offset += line.size();
+
+        const QJsonObject event = QJsonDocument::fromJson(line).object();
+        const quint64 seq = static_cast<quint64>(event.value(QStringLiteral("seq")).toInteger());
+        if (seq == 0)
+            continue;
+        newest = qMax(newest, seq);
+        if (seq <= cursor.seq)
+            continue;
+
+        if (seq != cursor.seq + 1
+            || event.value(QStringLiteral("op")).toString() == QLatin1String("reload"))
+            gap = true;
+        cursor.seq = seq;
+        if (!gap)
+            events.append(event);
+    }
+
+    // Journal restarted below our position (deleted, or database restored)
+    if (rescanned && newest < cursor.seq) {
+        cursor.seq = newest;
+        gap = true;
+    }
+
+    // Emit only once the cursor is settled: a receiver may seekToEnd() or
+    // poll() again from its slot.
+    if (gap) {
+        emit resyncRequired(dsvPath);
+        return;
+    }
+    for (const QJsonObject &event : std::as_const(events))
+        emit changeReceived(dsvPath, event);
+}
+
+bool ChangeFeed::covers(const QString &dsvPath) const
+{
+    const QFileInfo journal(journalPath(dsvPath));
+    if (!journal.exists())
+        return false;
+    return journal.lastModified() >= QFileInfo(dsvPath).lastModified();
+}
+
+void ChangeFeed::onChanged(const QString &dsvPath, qulonglong seq, const QString &event)
+{
+    Q_UNUSED(event);
+    const auto it = m_cursors.constFind(dsvPath);
+    if (it != m_cursors.constEnd() && seq > it->seq)
+        poll(dsvPath);
+}
@@ -0,0 +1,67 @@
+// changefeed.h
+// MusicLib Qt GUI — Database change-feed subscriber
+//
+// Backend writers append one JSON event per DSV write to "<dsv>.changes"
+// and broadcast it as org.musiclib.ChangeFeed.Changed on the session bus
+// (see the CHANGE FEED section of musiclib_db.sh).  This class follows
+// those journals so LibraryModel can patch single rows instead of
+// reparsing the whole DSV after every rating or scrobble.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Follows the change journals of one or more DSV files.
+ *
+ * Each journal is read incrementally from a remembered byte offset.  Events
+ * are delivered in sequence order through changeReceived().  When the
+ * sequence jumps (events trimmed from the journal, journal reset, or a bulk
+ * "reload" event), resyncRequired() is emitted instead and the subscriber
+ * is expected to reparse that DSV.
+ */
+class ChangeFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChangeFeed(QObject *parent = nullptr);
+
+    /// Follow these DSVs, starting after the events already journaled.
+    void setDatabases(const QStringList &dsvPaths);
+
+    /// Skip to the current end of one journal.  Call just before reparsing
+    /// the DSV; events published meanwhile are still delivered afterwards.
+    void seekToEnd(const QString &dsvPath);
+
+    /// Read and deliver events appended since the last call.
+    void poll(const QString &dsvPath);
+
+    /// True if the journal is at least as new as the DSV, i.e. every write
+    /// to the DSV so far has published an event.  A writer that does not
+    /// publish (hand edits, old scripts) leaves the DSV newer.
+    bool covers(const QString &dsvPath) const;
+
+signals:
+    void changeReceived(const QString &dsvPath, const QJsonObject &event);
+    void resyncRequired(const QString &dsvPath);
+
+private slots:
+    void onChanged(const QString &dsvPath, qulonglong seq, const QString &event);
+
+private:
+    struct Cursor {
+        quint64 seq    = 0;   ///< last delivered sequence number
+        qint64  offset = 0;   ///< journal bytes consumed
+    };
+
+    static QString journalPath(const QString &dsvPath);
+
+    QHash<QString, Cursor> m_cursors;
+};
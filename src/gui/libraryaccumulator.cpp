@@ -0,0 +1,66 @@
+// libraryaccumulator.cpp
+// MusicLib Qt GUI — Base for aggregates kept in step with the LibraryModel
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "libraryaccumulator.h"
+#include "librarymodel.h"
+
+#include <QTimer>
+
+LibraryAccumulator::LibraryAccumulator(LibraryModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_notifyTimer(new QTimer(this))
+{
+    m_notifyTimer->setSingleShot(true);
+    m_notifyTimer->setInterval(200);
+    connect(m_notifyTimer, &QTimer::timeout, this, &LibraryAccumulator::changed);
+
+    connect(m_model, &QAbstractItemModel::modelReset,
+            this, &LibraryAccumulator::rebuild);
+    connect(m_model, &QAbstractItemModel::rowsInserted,
+            this, &LibraryAccumulator::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &LibraryAccumulator::onRowsAboutToBeRemoved);
+    connect(m_model, &LibraryModel::trackChanged,
+            this, &LibraryAccumulator::onTrackChanged);
+}
+
+void LibraryAccumulator::rebuild()
+{
+    clear();
+    const int rows = m_model->rowCount();
+    for (int row = 0; row < rows; ++row)
+        account(m_model->trackAt(row), +1);
+    scheduleNotify();
+}
+
+void LibraryAccumulator::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    for (int row = first; row <= last; ++row)
+        account(m_model->trackAt(row), +1);
+    scheduleNotify();
+}
+
+void LibraryAccumulator::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    for (int row = first; row <= last; ++row)
+        account(m_model->trackAt(row), -1);
+    scheduleNotify();
+}
+
+void LibraryAccumulator::onTrackChanged(const TrackRecord &before, const TrackRecord &after)
+{
+    account(before, -1);
+    account(after, +1);
+    scheduleNotify();
+}
+
+void LibraryAccumulator::scheduleNotify()
+{
+    if (!m_notifyTimer->isActive())
+        m_notifyTimer->start();
+}
@@ -0,0 +1,54 @@
+// libraryaccumulator.h
+// MusicLib Qt GUI — Base for aggregates kept in step with the LibraryModel
+//
+// Holds the model wiring that LibraryStats and LibraryAggregates share:
+// a full rebuild on model reset, and per-row adjustments for inserted,
+// removed and changed tracks, with change notifications coalesced into
+// one changed() signal.  Subclasses supply only clear() and account().
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QModelIndex>
+#include <QObject>
+
+class LibraryModel;
+class QTimer;
+struct TrackRecord;
+
+class LibraryAccumulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LibraryAccumulator(LibraryModel *model, QObject *parent = nullptr);
+
+signals:
+    /// Aggregates changed.  Coalesced, so a burst of updates emits once.
+    void changed();
+
+protected:
+    /// Drop all aggregates before a rebuild
+    virtual void clear() = 0;
+    /// Add (@p sign +1) or retract (@p sign -1) one track
+    virtual void account(const TrackRecord &track, int sign) = 0;
+
+    LibraryModel *model() const { return m_model; }
+
+protected slots:
+    /// Recompute from every row of the model.  Subclass constructors call
+    /// this once they are fully built (account() is virtual).
+    void rebuild();
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onTrackChanged(const TrackRecord &before, const TrackRecord &after);
+
+private:
+    void scheduleNotify();
+
+    LibraryModel *m_model;
+    QTimer       *m_notifyTimer;
+};
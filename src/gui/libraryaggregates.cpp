@@ -0,0 +1,173 @@
+// libraryaggregates.cpp
+// MusicLib Qt GUI — Incrementally maintained album and artist tables
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "libraryaggregates.h"
+#include "librarymodel.h"
+
+#include <algorithm>
+
+namespace {
+
+QString dirOf(const QString &path)
+{
+    return path.left(path.lastIndexOf(QLatin1Char('/')) + 1);
+}
+
+// Adjust a counter and drop it when it reaches zero, so removals leave no
+// empty keys behind (min/max and "most frequent" read the keys directly)
+template <typename Map, typename Key>
+void bump(Map &map, const Key &key, int sign)
+{
+    if ((map[key] += sign) == 0)
+        map.remove(key);
+}
+
+void accountGroup(GroupAggregate &group, const TrackRecord &track, int sign)
+{
+    group.tracks += sign;
+    group.ratings[starsOf(track)] += sign;
+
+    const qint64 length = track.songLength.toLongLong();
+    if (length > 0)
+        group.durationMs += sign * length;
+
+    if (track.lastPlayedSerial > 0.0)
+        bump(group.played, track.lastPlayedSerial, sign);
+    bump(group.dirs, dirOf(track.songPath), sign);
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────
+// Derived values
+// ─────────────────────────────────────────────────────────────
+
+double GroupAggregate::meanStars() const
+{
+    int rated = 0, sum = 0;
+    for (int stars = 1; stars <= 5; ++stars) {
+        rated += ratings[stars];
+        sum   += stars * ratings[stars];
+    }
+    return rated > 0 ? double(sum) / rated : 0.0;
+}
+
+QString GroupAggregate::pathPrefix() const
+{
+    // Usually one directory per album and a handful per artist
+    auto it = dirs.constBegin();
+    if (it == dirs.constEnd())
+        return QString();
+    QString prefix = it.key();
+    for (++it; it != dirs.constEnd() && !prefix.isEmpty(); ++it) {
+        const QString &dir = it.key();
+        int n = 0;
+        const int max = int(qMin(prefix.size(), dir.size()));
+        while (n < max && prefix.at(n) == dir.at(n))
+            ++n;
+        prefix.truncate(n);
+    }
+    return prefix.left(prefix.lastIndexOf(QLatin1Char('/')) + 1);
+}
+
+QString AlbumAggregate::artist() const
+{
+    QString best;
+    int bestTracks = 0;
+    for (auto it = artists.constBegin(); it != artists.constEnd(); ++it) {
+        if (it.value() > bestTracks || (it.value() == bestTracks && it.key() < best)) {
+            best = it.key();
+            bestTracks = it.value();
+        }
+    }
+    return best;
+}
+
+// ─────────────────────────────────────────────────────────────
+// Maintenance
+// ─────────────────────────────────────────────────────────────
+
+LibraryAggregates::LibraryAggregates(LibraryModel *model, QObject *parent)
+    : LibraryAccumulator(model, parent)
+{
+    rebuild();
+}
+
+QString LibraryAggregates::effectiveArtist(const TrackRecord &track)
+{
+    return track.custom2.isEmpty() ? track.albumArtist : track.custom2;
+}
+
+void LibraryAggregates::account(const TrackRecord &track, int sign)
+{
+    const QString artistName = effectiveArtist(track);
+    const AlbumKey key(track.sourceDsv, track.idAlbum.toInt());
+
+    AlbumAggregate &album = m_albums[key];
+    accountGroup(album, track, sign);
+    bump(album.artists, artistName, sign);
+    if (sign > 0) {
+        album.dsv   = key.first;
+        album.id    = key.second;
+        album.title = track.album;
+        album.members.insert(track.id,
+                             {track.songTitle, track.songPath, starsOf(track),
+                              track.lastPlayedSerial});
+    } else {
+        album.members.remove(track.id);
+    }
+    if (album.tracks <= 0)
+        m_albums.remove(key);
+
+    ArtistAggregate &artist = m_artists[artistName];
+    accountGroup(artist, track, sign);
+    bump(artist.albums, key, sign);
+    artist.name = artistName;
+    if (artist.tracks <= 0)
+        m_artists.remove(artistName);
+}
+
+void LibraryAggregates::clear()
+{
+    m_albums.clear();
+    m_artists.clear();
+}
+
+// ─────────────────────────────────────────────────────────────
+// Queries
+// ─────────────────────────────────────────────────────────────
+
+const AlbumAggregate *LibraryAggregates::album(const QString &dsv, int id) const
+{
+    const auto it = m_albums.constFind(AlbumKey(dsv, id));
+    return it == m_albums.constEnd() ? nullptr : &it.value();
+}
+
+const ArtistAggregate *LibraryAggregates::artist(const QString &name) const
+{
+    const auto it = m_artists.constFind(name);
+    return it == m_artists.constEnd() ? nullptr : &it.value();
+}
+
+QList<const AlbumAggregate *> LibraryAggregates::bestRatedAlbums(int count, int minTracks) const
+{
+    QList<const AlbumAggregate *> result;
+    for (const AlbumAggregate &album : m_albums) {
+        if (album.tracks >= minTracks && album.meanStars() > 0.0)
+            result.append(&album);
+    }
+
+    const auto byRating = [](const AlbumAggregate *a, const AlbumAggregate *b) {
+        const double ma = a->meanStars(), mb = b->meanStars();
+        return ma != mb ? ma > mb : a->tracks > b->tracks;
+    };
+    if (result.size() > count) {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byRating);
+        result.resize(count);
+    } else {
+        std::sort(result.begin(), result.end(), byRating);
+    }
+    return result;
+}
@@ -0,0 +1,104 @@
+// libraryaggregates.h
+// MusicLib Qt GUI — Incrementally maintained album and artist tables
+//
+// One row per album (keyed by shard DSV and IDAlbum) and per effective
+// artist (Custom2, or AlbumArtist when Custom2 is empty — the same rule as
+// the smart playlist), holding track count, total SongLength, rating
+// histogram, mean stars, oldest and newest LastTimePlayed and the common
+// path prefix.  Like LibraryStats, the tables are built once when the
+// LibraryModel is (re)loaded and then adjusted per row from the model's
+// change notifications, so album views read them instead of scanning the
+// library.  "musiclib-cli query --table albums|artists" prints the same
+// tables from the backend.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include "libraryaccumulator.h"
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+
+#include <array>
+
+class LibraryModel;
+struct TrackRecord;
+
+/// Aggregates shared by the album and artist tables
+struct GroupAggregate {
+    int    tracks     = 0;
+    qint64 durationMs = 0;
+    std::array<int, 6> ratings {};   ///< tracks per star rating (GroupDesc 0-5)
+    QMap<double, int>   played;      ///< LastTimePlayed serial -> tracks (played only)
+    QHash<QString, int> dirs;        ///< directory of SongPath -> tracks
+
+    /// Mean star rating of the rated tracks; 0 if none is rated
+    double meanStars() const;
+    /// Oldest / newest LastTimePlayed serial; 0 if no track was played
+    double minLastPlayed() const { return played.isEmpty() ? 0.0 : played.firstKey(); }
+    double maxLastPlayed() const { return played.isEmpty() ? 0.0 : played.lastKey(); }
+    /// Longest directory prefix shared by every track ("/" terminated)
+    QString pathPrefix() const;
+};
+
+/// One track of an album, enough to list it without going back to the model
+struct AlbumTrack {
+    QString title;
+    QString songPath;
+    int     stars      = 0;
+    double  lastPlayed = 0.0;
+};
+
+struct AlbumAggregate : GroupAggregate {
+    QString dsv;                        ///< shard the album belongs to
+    int     id = 0;                     ///< IDAlbum
+    QString title;
+    QHash<QString, int>        artists; ///< effective artist -> tracks
+    QHash<QString, AlbumTrack> members; ///< row ID -> track (the album key holds the shard)
+
+    /// Most frequent effective artist of the album's tracks
+    QString artist() const;
+};
+
+struct ArtistAggregate : GroupAggregate {
+    QString name;
+    QHash<QPair<QString, int>, int> albums;   ///< (shard, IDAlbum) -> tracks
+
+    int albumCount() const { return int(albums.size()); }
+};
+
+class LibraryAggregates : public LibraryAccumulator
+{
+    Q_OBJECT
+
+public:
+    using AlbumKey = QPair<QString, int>;   ///< shard DSV, IDAlbum
+
+    explicit LibraryAggregates(LibraryModel *model, QObject *parent = nullptr);
+
+    /// Custom2 if set, otherwise AlbumArtist
+    static QString effectiveArtist(const TrackRecord &track);
+
+    const QHash<AlbumKey, AlbumAggregate> &albums() const  { return m_albums; }
+    const QHash<QString, ArtistAggregate> &artists() const { return m_artists; }
+
+    /// Album @p id of shard @p dsv, or nullptr
+    const AlbumAggregate *album(const QString &dsv, int id) const;
+    /// Artist @p name, or nullptr
+    const ArtistAggregate *artist(const QString &name) const;
+
+    /// Albums with at least @p minTracks tracks, best mean rating first
+    QList<const AlbumAggregate *> bestRatedAlbums(int count, int minTracks = 3) const;
+
+protected:
+    void clear() override;
+    void account(const TrackRecord &track, int sign) override;
+
+private:
+    QHash<AlbumKey, AlbumAggregate> m_albums;
+    QHash<QString, ArtistAggregate> m_artists;
+};
@@ -1,17 +1,30 @@
 #include "librarymodel.h"
+#include "changefeed.h"
 
 #include <QFile>
 #include <QTextStream>
 #include <QDateTime>
+#include <QJsonArray>
 #include <QColor>
 #include <QTimeZone>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
 
 static const char DSV_DELIMITER = '^';
 
+static double parseSerial(const QString &serialTime)
+{
+    bool ok = false;
+    const double serial = serialTime.toDouble(&ok);
+    return (ok && serial > 0.0) ? serial : 0.0;
+}
+
 LibraryModel::LibraryModel(QObject *parent)
     : QAbstractTableModel(parent)
     , m_watcher(new QFileSystemWatcher(this))
     , m_debounceTimer(new QTimer(this))
+    , m_feed(new ChangeFeed(this))
 {
     m_headers = {
         "ID", "Artist", "IDAlbum", "Album", "Album Artist",
@@ -27,6 +40,13 @@ LibraryModel::LibraryModel(QObject *parent)
             this, &LibraryModel::onFileChanged);
     connect(m_debounceTimer, &QTimer::timeout,
             this, &LibraryModel::reloadDebounced);
+
+    // Backend writers publish row-level changes; apply those directly and
+    // only reparse a shard when the feed cannot account for a change.
+    connect(m_feed, &ChangeFeed::changeReceived,
+            this, &LibraryModel::applyChange);
+    connect(m_feed, &ChangeFeed::resyncRequired,
+            this, &LibraryModel::onResyncRequired);
 }
 
 LibraryModel::~LibraryModel()
@@ -46,29 +66,40 @@ LibraryModel::~LibraryModel()
 
 bool LibraryModel::loadFromFile(const QString &path)
 {
-    m_dsvPath = path;
+    return loadFromFiles(QStringList{path});
+}
+
+bool LibraryModel::loadFromFiles(const QStringList &paths)
+{
+    m_dsvPaths = paths;
 
-    // Start watching the file for changes
+    // Start watching the files for changes
     if (!m_watcher->files().isEmpty())
         m_watcher->removePaths(m_watcher->files());
-    m_watcher->addPath(path);
-
-    parseFile(path);
+    for (const QString &path : paths)
+        m_watcher->addPath(path);
+
+    m_shardTracks = QVector<QVector<TrackRecord>>(paths.size());
+    m_shardRowById = QVector<QHash<QString, int>>(paths.size());
+    m_dirtyShards.clear();
+
+    QList<int> all;
+    for (int i = 0; i < paths.size(); ++i)
+        all.append(i);
+    m_feed->setDatabases(paths);
+    reloadShards(all);
     return !m_tracks.isEmpty();
 }
 
-void LibraryModel::parseFile(const QString &path)
+bool LibraryModel::parseFile(const QString &path, QVector<TrackRecord> &tracks)
 {
     QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit loadError(tr("Cannot open database file: %1").arg(path));
-        return;
-    }
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
 
     QTextStream in(&file);
     in.setEncoding(QStringConverter::Utf8);
 
-    QVector<TrackRecord> newTracks;
     bool firstLine = true;
 
     while (!in.atEnd()) {
@@ -101,27 +132,346 @@ void LibraryModel::parseFile(const QString &path)
         track.custom2       = fields[static_cast<int>(TrackColumn::Custom2)];
         track.groupDesc     = fields[static_cast<int>(TrackColumn::GroupDesc)];
         track.lastTimePlayed = fields[static_cast<int>(TrackColumn::LastTimePlayed)];
+        track.lastPlayedSerial = parseSerial(track.lastTimePlayed);
+        track.sourceDsv     = path;
+
+        tracks.append(track);
+    }
+
+    return true;
+}
+
+void LibraryModel::reloadShards(const QList<int> &shards)
+{
+    struct ParsedShard {
+        bool ok = false;
+        QVector<TrackRecord> tracks;
+    };
 
-        newTracks.append(track);
+    // Shards are independent files, so parse them on the global thread
+    // pool; with shards on separate disks the reads overlap.
+    const QStringList paths = m_dsvPaths;
+    const QList<ParsedShard> results = QtConcurrent::blockingMapped<QList<ParsedShard>>(
+        shards, [&paths](int shard) {
+            ParsedShard r;
+            r.ok = parseFile(paths.at(shard), r.tracks);
+            return r;
+        });
+
+    // A shard that cannot be read keeps its previous rows
+    for (int i = 0; i < shards.size(); ++i) {
+        if (results.at(i).ok) {
+            m_shardTracks[shards.at(i)] = results.at(i).tracks;
+            rebuildIdIndex(shards.at(i));
+        } else
+            emit loadError(tr("Cannot open database file: %1").arg(paths.at(shards.at(i))));
     }
 
+    qsizetype total = 0;
+    for (const QVector<TrackRecord> &shard : std::as_const(m_shardTracks))
+        total += shard.size();
+
+    QVector<TrackRecord> newTracks;
+    newTracks.reserve(total);
+    for (const QVector<TrackRecord> &shard : std::as_const(m_shardTracks))
+        newTracks += shard;
+
     beginResetModel();
     m_tracks = newTracks;
+    rebuildPlayedIndex();
     endResetModel();
 }
 
 void LibraryModel::onFileChanged(const QString &path)
 {
-    Q_UNUSED(path)
+    const int shard = m_dsvPaths.indexOf(path);
+    if (shard < 0)
+        return;
+
     // Re-add path in case the file was replaced (shell scripts use tmp+mv)
-    if (!m_watcher->files().contains(m_dsvPath))
-        m_watcher->addPath(m_dsvPath);
+    if (!m_watcher->files().contains(path))
+        m_watcher->addPath(path);
+    if (!m_dirtyShards.contains(shard))
+        m_dirtyShards.append(shard);
     m_debounceTimer->start();
 }
 
 void LibraryModel::reloadDebounced()
 {
-    parseFile(m_dsvPath);
+    const QList<int> dirty = m_dirtyShards;
+    m_dirtyShards.clear();
+
+    // Catch up on any events the D-Bus signal did not deliver; a shard is
+    // only reparsed if something wrote it without publishing.
+    QList<int> reload;
+    for (int shard : dirty) {
+        const QString &path = m_dsvPaths.at(shard);
+        m_feed->poll(path);
+        if (!m_feed->covers(path)) {
+            m_feed->seekToEnd(path);
+            reload.append(shard);
+        }
+    }
+    if (!reload.isEmpty())
+        reloadShards(reload);
+}
+
+void LibraryModel::onResyncRequired(const QString &path)
+{
+    const int shard = m_dsvPaths.indexOf(path);
+    if (shard < 0)
+        return;
+    m_dirtyShards.removeAll(shard);
+    // Seek first: anything published while we parse is replayed afterwards,
+    // and replaying an already-parsed change is harmless.
+    m_feed->seekToEnd(path);
+    reloadShards({shard});
+}
+
+int LibraryModel::shardOffset(int shard) const
+{
+    int offset = 0;
+    for (int i = 0; i < shard; ++i)
+        offset += m_shardTracks.at(i).size();
+    return offset;
+}
+
+int LibraryModel::findInShard(int shard, const QString &id, const QString &path) const
+{
+    const QVector<TrackRecord> &tracks = m_shardTracks.at(shard);
+    const auto it = m_shardRowById.at(shard).constFind(id);
+    if (it == m_shardRowById.at(shard).constEnd())
+        return -1;
+    if (path.isEmpty() || tracks.at(*it).songPath == path)
+        return *it;
+
+    // Several rows share this ID (a damaged DSV): look past the first
+    for (int i = *it + 1; i < tracks.size(); ++i) {
+        if (tracks.at(i).id == id && tracks.at(i).songPath == path)
+            return i;
+    }
+    return -1;
+}
+
+void LibraryModel::rebuildIdIndex(int shard)
+{
+    const QVector<TrackRecord> &tracks = m_shardTracks.at(shard);
+    QHash<QString, int> &rows = m_shardRowById[shard];
+    rows.clear();
+    rows.reserve(tracks.size());
+    // Backwards, so a duplicated ID ends up mapped to its first row
+    for (int i = int(tracks.size()) - 1; i >= 0; --i)
+        rows.insert(tracks.at(i).id, i);
+}
+
+void LibraryModel::removeFromIdIndex(int shard, const QString &id, int local)
+{
+    // Rows after the removed one moved up by one
+    const QVector<TrackRecord> &tracks = m_shardTracks.at(shard);
+    QHash<QString, int> &rows = m_shardRowById[shard];
+    for (int i = local; i < tracks.size(); ++i) {
+        auto it = rows.find(tracks.at(i).id);
+        if (it != rows.end() && *it == i + 1)
+            *it = i;
+    }
+
+    auto it = rows.find(id);
+    if (it == rows.end() || *it != local)
+        return;
+    rows.erase(it);
+    for (int i = local; i < tracks.size(); ++i) {
+        if (tracks.at(i).id == id) {
+            rows.insert(id, i);
+            break;
+        }
+    }
+}
+
+void LibraryModel::setField(TrackRecord &track, const QString &column, const QString &value)
+{
+    // DSV header names, as used in change events
+    if      (column == QLatin1String("ID"))             track.id = value;
+    else if (column == QLatin1String("Artist"))         track.artist = value;
+    else if (column == QLatin1String("IDAlbum"))        track.idAlbum = value;
+    else if (column == QLatin1String("Album"))          track.album = value;
+    else if (column == QLatin1String("AlbumArtist"))    track.albumArtist = value;
+    else if (column == QLatin1String("SongTitle"))      track.songTitle = value;
+    else if (column == QLatin1String("SongPath"))       track.songPath = value;
+    else if (column == QLatin1String("Genre"))          track.genre = value;
+    else if (column == QLatin1String("SongLength"))     track.songLength = value;
+    else if (column == QLatin1String("Rating"))         track.rating = value;
+    else if (column == QLatin1String("Custom2"))        track.custom2 = value;
+    else if (column == QLatin1String("GroupDesc"))      track.groupDesc = value;
+    else if (column == QLatin1String("LastTimePlayed")) {
+        track.lastTimePlayed = value;
+        track.lastPlayedSerial = parseSerial(value);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+// Played index
+//
+// Sorted arrays of (LastTimePlayed, row).  Ratings and scrobbles move one
+// entry by binary search + insertion; only inserting or removing a row in
+// the middle of the model renumbers entries (imports and deletions, which
+// are rare).
+// ─────────────────────────────────────────────────────────────
+
+const QVector<LibraryModel::PlayedKey> &LibraryModel::playedIndex(int stars) const
+{
+    return (stars >= 0 && stars <= 5) ? m_playedByStars[stars] : m_playedIndex;
+}
+
+void LibraryModel::rebuildPlayedIndex()
+{
+    m_playedIndex.clear();
+    for (auto &v : m_playedByStars)
+        v.clear();
+
+    for (int row = 0; row < m_tracks.size(); ++row) {
+        const TrackRecord &track = m_tracks.at(row);
+        if (track.lastPlayedSerial <= 0.0)
+            continue;
+        const PlayedKey key{track.lastPlayedSerial, row};
+        m_playedIndex.append(key);
+        m_playedByStars[starsOf(track)].append(key);
+    }
+    std::sort(m_playedIndex.begin(), m_playedIndex.end());
+    for (auto &v : m_playedByStars)
+        std::sort(v.begin(), v.end());
+}
+
+void LibraryModel::indexTrack(int row, const TrackRecord &track, bool add)
+{
+    if (track.lastPlayedSerial <= 0.0)
+        return;
+    const PlayedKey key{track.lastPlayedSerial, row};
+    for (QVector<PlayedKey> *v : {&m_playedIndex, &m_playedByStars[starsOf(track)]}) {
+        auto it = std::lower_bound(v->begin(), v->end(), key);
+        if (add)
+            v->insert(it, key);
+        else if (it != v->end() && it->row == row)
+            v->erase(it);
+    }
+}
+
+void LibraryModel::shiftPlayedRows(int fromRow, int delta)
+{
+    // Row is only the tie-break and shifting preserves the relative order
+    // of all rows, so the arrays stay sorted.
+    auto shift = [fromRow, delta](QVector<PlayedKey> &v) {
+        for (PlayedKey &key : v) {
+            if (key.row >= fromRow)
+                key.row += delta;
+        }
+    };
+    shift(m_playedIndex);
+    for (auto &v : m_playedByStars)
+        shift(v);
+}
+
+QList<int> LibraryModel::recentlyPlayedRows(int count, int stars) const
+{
+    const QVector<PlayedKey> &index = playedIndex(stars);
+    QList<int> rows;
+    for (auto it = index.crbegin(); it != index.crend() && rows.size() < count; ++it)
+        rows.append(it->row);
+    return rows;
+}
+
+QList<int> LibraryModel::leastRecentlyPlayedRows(int count, int stars) const
+{
+    const QVector<PlayedKey> &index = playedIndex(stars);
+    QList<int> rows;
+    for (auto it = index.cbegin(); it != index.cend() && rows.size() < count; ++it)
+        rows.append(it->row);
+    return rows;
+}
+
+QList<int> LibraryModel::rowsPlayedBetween(const QDateTime &from, const QDateTime &to,
+                                           int stars) const
+{
+    const auto serial = [](const QDateTime &dt) {
+        return dt.toSecsSinceEpoch() / 86400.0 + SERIAL_UNIX_EPOCH;
+    };
+    const QVector<PlayedKey> &index = playedIndex(stars);
+    auto first = std::lower_bound(index.cbegin(), index.cend(), PlayedKey{serial(from), -1});
+    auto last  = std::lower_bound(first, index.cend(), PlayedKey{serial(to), -1});
+
+    QList<int> rows;
+    rows.reserve(last - first);
+    for (auto it = first; it != last; ++it)
+        rows.append(it->row);
+    return rows;
+}
+
+void LibraryModel::applyChange(const QString &path, const QJsonObject &event)
+{
+    const int shard = m_dsvPaths.indexOf(path);
+    if (shard < 0)
+        return;
+
+    const QString op      = event.value(QStringLiteral("op")).toString();
+    const QString id      = event.value(QStringLiteral("id")).toString();
+    const QString song    = event.value(QStringLiteral("path")).toString();
+    const QJsonObject changes = event.value(QStringLiteral("changes")).toObject();
+
+    // Events are absolute (new values, not increments), so applying one the
+    // model already reflects is a no-op.
+    const int local = findInShard(shard, id, op == QLatin1String("insert") ? QString() : song);
+
+    if (op == QLatin1String("update") || (op == QLatin1String("insert") && local >= 0)) {
+        if (local < 0) {
+            // Our copy is missing a row the backend has: fall back to reparsing
+            onResyncRequired(path);
+            return;
+        }
+        TrackRecord &track = m_shardTracks[shard][local];
+        const TrackRecord before = track;
+        for (auto it = changes.constBegin(); it != changes.constEnd(); ++it)
+            setField(track, it.key(), it.value().toArray().at(1).toString());
+
+        if (track.id != before.id)
+            rebuildIdIndex(shard);
+
+        const int row = shardOffset(shard) + local;
+        m_tracks[row] = track;
+        indexTrack(row, before, false);
+        indexTrack(row, track, true);
+        emit trackChanged(before, track);
+        emit dataChanged(index(row, 0),
+                         index(row, static_cast<int>(TrackColumn::COUNT) - 1));
+    } else if (op == QLatin1String("insert")) {
+        TrackRecord track;
+        for (auto it = changes.constBegin(); it != changes.constEnd(); ++it)
+            setField(track, it.key(), it.value().toArray().at(1).toString());
+        track.sourceDsv = path;
+
+        const int row = shardOffset(shard) + m_shardTracks.at(shard).size();
+        beginInsertRows(QModelIndex(), row, row);
+        m_shardTracks[shard].append(track);
+        if (!m_shardRowById.at(shard).contains(track.id))
+            m_shardRowById[shard].insert(track.id, int(m_shardTracks.at(shard).size()) - 1);
+        m_tracks.insert(row, track);
+        if (row < m_tracks.size() - 1)
+            shiftPlayedRows(row, +1);
+        indexTrack(row, track, true);
+        endInsertRows();
+    } else if (op == QLatin1String("delete")) {
+        if (local < 0)
+            return;
+        const int row = shardOffset(shard) + local;
+        beginRemoveRows(QModelIndex(), row, row);
+        indexTrack(row, m_tracks.at(row), false);
+        m_shardTracks[shard].removeAt(local);
+        removeFromIdIndex(shard, id, local);
+        m_tracks.removeAt(row);
+        if (row < m_tracks.size())
+            shiftPlayedRows(row + 1, -1);
+        endRemoveRows();
+    } else {
+        onResyncRequired(path);
+    }
 }
 
 int LibraryModel::rowCount(const QModelIndex &parent) const
@@ -174,7 +524,7 @@ QVariant LibraryModel::data(const QModelIndex &index, int role) const
         if (static_cast<TrackColumn>(col) == TrackColumn::GroupDesc)
             return track.groupDesc.toInt();
         if (static_cast<TrackColumn>(col) == TrackColumn::LastTimePlayed)
-            return track.lastTimePlayed.toDouble();
+            return track.lastPlayedSerial;
         // Fall back to the display string so Album, Title, Artist, etc. sort correctly
         return data(index, Qt::DisplayRole);
     }
@@ -217,7 +567,7 @@ QString LibraryModel::formatLastPlayed(const QString &serialTime) const
     if (!ok || serial <= 0.0) return QString();
 
     // Excel serial: days since 1899-12-30
-    qint64 unixSecs = static_cast<qint64>((serial - 25569.0) * 86400.0);
+    qint64 unixSecs = static_cast<qint64>((serial - SERIAL_UNIX_EPOCH) * 86400.0);
     QDateTime dt = QDateTime::fromSecsSinceEpoch(unixSecs, QTimeZone::utc());
     if (!dt.isValid()) return QString();
     return dt.toLocalTime().toString("MM/dd/yy");
@@ -1,11 +1,18 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QDateTime>
 #include <QFileSystemWatcher>
+#include <QJsonObject>
 #include <QTimer>
+#include <QHash>
 #include <QVector>
 #include <QStringList>
 
+#include <array>
+
+class ChangeFeed;
+
 // Represents one row from musiclib.dsv
 struct TrackRecord {
     QString id;
@@ -21,8 +28,21 @@ struct TrackRecord {
     QString custom2;
     QString groupDesc;   // Star rating 0-5 (used for display)
     QString lastTimePlayed;
+    QString sourceDsv;   // Shard DSV this row was read from (not a DSV column)
+    double  lastPlayedSerial = 0.0;  // lastTimePlayed parsed once; 0 = never played
 };
 
+// LastTimePlayed is an SQL serial time: days since 1899-12-30, so
+// 1970-01-01 is serial day 25569
+inline constexpr double SERIAL_UNIX_EPOCH = 25569.0;
+
+// GroupDesc as a star rating; anything outside 0-5 counts as unrated
+inline int starsOf(const TrackRecord &track)
+{
+    const int stars = track.groupDesc.trimmed().toInt();
+    return (stars >= 0 && stars <= 5) ? stars : 0;
+}
+
 // Column indices - match DSV order
 enum class TrackColumn : int {
     ID           = 0,
@@ -53,6 +73,11 @@ public:
     // Load DSV from path; returns true on success
     bool loadFromFile(const QString &path);
 
+    // Load and merge several shard DSVs (LIBRARY_SHARDS).  Shards are parsed
+    // concurrently, and a change to one shard only reparses that shard.
+    // Returns true if any rows were loaded.
+    bool loadFromFiles(const QStringList &paths);
+
     // QAbstractTableModel interface
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -63,23 +88,62 @@ public:
     // Return the full TrackRecord for a given row
     TrackRecord trackAt(int row) const;
 
-    QString dsvPath() const { return m_dsvPath; }
+    QString dsvPath() const { return m_dsvPaths.value(0); }
+    QStringList dsvPaths() const { return m_dsvPaths; }
+
+    // Recency queries, answered from an index of played rows ordered by
+    // LastTimePlayed in O(log n + k).  stars = 0-5 restricts the query to
+    // one star rating; -1 means any.  Never-played rows are not indexed.
+    QList<int> recentlyPlayedRows(int count, int stars = -1) const;        // newest first
+    QList<int> leastRecentlyPlayedRows(int count, int stars = -1) const;   // oldest first
+    QList<int> rowsPlayedBetween(const QDateTime &from, const QDateTime &to,
+                                 int stars = -1) const;                   // oldest first
 
 signals:
     void loadError(const QString &message);
 
+    // A row was updated in place from the change feed (emitted before
+    // dataChanged).  Inserts and removals use the usual row signals.
+    void trackChanged(const TrackRecord &before, const TrackRecord &after);
+
 private slots:
     void onFileChanged(const QString &path);
     void reloadDebounced();
+    void applyChange(const QString &path, const QJsonObject &event);
+    void onResyncRequired(const QString &path);
 
 private:
-    void parseFile(const QString &path);
+    static bool parseFile(const QString &path, QVector<TrackRecord> &tracks);
+    static void setField(TrackRecord &track, const QString &column, const QString &value);
+    void reloadShards(const QList<int> &shards);
+    int  shardOffset(int shard) const;
+    int  findInShard(int shard, const QString &id, const QString &path) const;
+    void rebuildIdIndex(int shard);
+    void removeFromIdIndex(int shard, const QString &id, int local);
+
+    // Played index: (LastTimePlayed, row) kept sorted by binary insertion
+    struct PlayedKey {
+        double serial;
+        int    row;
+        bool operator<(const PlayedKey &o) const
+        { return serial != o.serial ? serial < o.serial : row < o.row; }
+    };
+    const QVector<PlayedKey> &playedIndex(int stars) const;
+    void rebuildPlayedIndex();
+    void indexTrack(int row, const TrackRecord &track, bool add);
+    void shiftPlayedRows(int fromRow, int delta);
     QString formatDuration(const QString &ms) const;
     QString formatLastPlayed(const QString &serialTime) const;
 
-    QVector<TrackRecord>  m_tracks;
+    QVector<TrackRecord>  m_tracks;         // all shards, concatenated in shard order
+    QVector<QVector<TrackRecord>> m_shardTracks;   // per-shard rows, index = m_dsvPaths
+    QVector<QHash<QString, int>>  m_shardRowById;  // per-shard ID -> first row with it
+    QList<int>            m_dirtyShards;    // shards changed since the last reload
     QStringList           m_headers;
-    QString               m_dsvPath;
+    QStringList           m_dsvPaths;
     QFileSystemWatcher   *m_watcher;
     QTimer               *m_debounceTimer;
+    ChangeFeed           *m_feed;           // row-level deltas from backend writers
+    QVector<PlayedKey>    m_playedIndex;    // played rows, oldest first
+    std::array<QVector<PlayedKey>, 6> m_playedByStars;   // same, per star rating
 };
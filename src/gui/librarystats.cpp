@@ -0,0 +1,108 @@
+// librarystats.cpp
+// MusicLib Qt GUI — Incrementally maintained listening statistics
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "librarystats.h"
+#include "librarymodel.h"
+
+#include <algorithm>
+
+namespace {
+
+// Epoch day of the track's last play, or -1 if never played
+qint64 playedDay(const TrackRecord &track)
+{
+    if (track.lastPlayedSerial <= 0.0)
+        return -1;
+    return static_cast<qint64>(track.lastPlayedSerial - SERIAL_UNIX_EPOCH);
+}
+
+int monthKey(const QDate &date)
+{
+    return date.year() * 12 + date.month() - 1;
+}
+
+const QDate kEpoch(1970, 1, 1);
+
+} // namespace
+
+LibraryStats::LibraryStats(LibraryModel *model, QObject *parent)
+    : LibraryAccumulator(model, parent)
+{
+    rebuild();
+}
+
+void LibraryStats::account(const TrackRecord &track, int sign)
+{
+    m_tracks += sign;
+    m_ratings[starsOf(track)] += sign;
+
+    const qint64 length = track.songLength.toLongLong();
+    if (length > 0)
+        m_durationMs += sign * length;
+
+    const qint64 day = playedDay(track);
+    if (day < 0) {
+        m_neverPlayed += sign;
+        return;
+    }
+
+    const int month = monthKey(kEpoch.addDays(day));
+    if ((m_byMonth[month] += sign) == 0)
+        m_byMonth.remove(month);
+
+    QHash<qint64, int> &days = m_artistDays[track.artist];
+    if ((days[day] += sign) == 0)
+        days.remove(day);
+    if (days.isEmpty())
+        m_artistDays.remove(track.artist);
+}
+
+void LibraryStats::clear()
+{
+    m_tracks = 0;
+    m_neverPlayed = 0;
+    m_durationMs = 0;
+    m_ratings.fill(0);
+    m_byMonth.clear();
+    m_artistDays.clear();
+}
+
+QList<QPair<QDate, int>> LibraryStats::lastPlayedByMonth(int months) const
+{
+    QList<QPair<QDate, int>> result;
+    const QDate today = QDate::currentDate();
+    QDate month(today.year(), today.month(), 1);
+    month = month.addMonths(-(months - 1));
+    for (int i = 0; i < months; ++i, month = month.addMonths(1))
+        result.append({month, m_byMonth.value(monthKey(month))});
+    return result;
+}
+
+QList<QPair<QString, int>> LibraryStats::topArtists(int days, int count) const
+{
+    const qint64 cutoff = kEpoch.daysTo(QDate::currentDate()) - days;
+
+    QList<QPair<QString, int>> result;
+    for (auto it = m_artistDays.constBegin(); it != m_artistDays.constEnd(); ++it) {
+        int tracks = 0;
+        for (auto d = it->constBegin(); d != it->constEnd(); ++d) {
+            if (d.key() > cutoff)
+                tracks += d.value();
+        }
+        if (tracks > 0)
+            result.append({it.key(), tracks});
+    }
+
+    const auto byTracks = [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if (result.size() > count) {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byTracks);
+        result.resize(count);
+    } else {
+        std::sort(result.begin(), result.end(), byTracks);
+    }
+    return result;
+}
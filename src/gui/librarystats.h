@@ -0,0 +1,61 @@
+// librarystats.h
+// MusicLib Qt GUI — Incrementally maintained listening statistics
+//
+// Aggregates (rating distribution, tracks by month of last play,
+// never-played count, per-artist recent plays) are computed once when the
+// LibraryModel is (re)loaded and then adjusted per row from the model's
+// change notifications, so a rating or scrobble costs O(1) here and the
+// dashboard only has to draw.  musiclib_stats.sh computes the same
+// figures for the CLI.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include "libraryaccumulator.h"
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include <array>
+
+class LibraryModel;
+struct TrackRecord;
+
+class LibraryStats : public LibraryAccumulator
+{
+    Q_OBJECT
+
+public:
+    explicit LibraryStats(LibraryModel *model, QObject *parent = nullptr);
+
+    int    trackCount() const       { return m_tracks; }
+    int    ratedCount() const       { return m_tracks - m_ratings[0]; }
+    int    neverPlayedCount() const { return m_neverPlayed; }
+    qint64 totalDurationMs() const  { return m_durationMs; }
+
+    /// Track count per star rating (GroupDesc 0-5).
+    const std::array<int, 6> &ratingCounts() const { return m_ratings; }
+
+    /// Tracks whose last play falls in each of the last @p months months,
+    /// oldest first.  The QDate is the first day of the month.
+    QList<QPair<QDate, int>> lastPlayedByMonth(int months) const;
+
+    /// Artists with the most tracks played in the last @p days, best first.
+    QList<QPair<QString, int>> topArtists(int days, int count) const;
+
+protected:
+    void clear() override;
+    void account(const TrackRecord &track, int sign) override;
+
+private:
+    int    m_tracks      = 0;
+    int    m_neverPlayed = 0;
+    qint64 m_durationMs  = 0;
+    std::array<int, 6> m_ratings {};
+    QHash<int, int> m_byMonth;                       // year*12 + month-1 -> tracks
+    QHash<QString, QHash<qint64, int>> m_artistDays; // artist -> epoch day -> tracks
+};
@@ -2,6 +2,7 @@
 #include "librarymodel.h"
 #include "ratingdelegate.h"
 #include "scriptrunner.h"
+#include "textindex.h"
 
 #include <QTableView>
 #include <QLineEdit>
@@ -32,7 +33,8 @@
 
 // ---------------------------------------------------------------------------
 // Custom proxy: adds "exclude unrated" filtering on top of the standard
-// text filter provided by QSortFilterProxyModel.
+// text filter provided by QSortFilterProxyModel, and also accepts rows the
+// lyrics/comment text index matched.
 // ---------------------------------------------------------------------------
 class LibraryFilterProxyModel : public QSortFilterProxyModel
 {
@@ -56,10 +58,26 @@ public:
         }
     }
 
+    // Restrict to the given source rows (the "Recently Played" view)
+    void setRowSubset(bool enabled, const QList<int> &rows = {}) {
+        beginFilterChange();
+        m_subsetEnabled = enabled;
+        m_subset = QSet<int>(rows.cbegin(), rows.cend());
+        endFilterChange();
+    }
+
+    // Paths matched by the lyrics/comment index for the current filter text.
+    // Takes effect with the next setFilterFixedString().
+    void setTextMatches(const QSet<QString> &paths) {
+        m_textMatches = paths;
+    }
+
 protected:
     bool filterAcceptsRow(int sourceRow,
                           const QModelIndex &sourceParent) const override
     {
+        if (m_subsetEnabled && !m_subset.contains(sourceRow))
+            return false;
         // Apply star-rating filters first
         if (m_excludeUnrated || m_excludeRated) {
             QModelIndex idx = sourceModel()->index(
@@ -73,15 +91,32 @@ protected:
             if (m_excludeRated && stars > 0)
                 return false;
         }
-        // Then apply the normal text filter
-        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+        // Then apply the normal text filter, or a lyrics/comment match
+        if (QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent))
+            return true;
+        if (m_textMatches.isEmpty())
+            return false;
+        QModelIndex pathIdx = sourceModel()->index(
+            sourceRow,
+            static_cast<int>(TrackColumn::SongPath),
+            sourceParent);
+        return m_textMatches.contains(sourceModel()->data(pathIdx).toString());
     }
 
 private:
     bool m_excludeUnrated = false;
     bool m_excludeRated   = false;
+    bool m_subsetEnabled  = false;
+    QSet<int> m_subset;
+    QSet<QString> m_textMatches;
 };
 
+// Shortest filter text also looked up in the lyrics/comment index
+static constexpr int TEXT_SEARCH_MIN_LENGTH = 3;
+
+// Size of the "Recently Played" view
+static constexpr int RECENTLY_PLAYED_COUNT = 200;
+
 // Columns visible by default.
 // A.2a: AlbumArtist moved into hidden set; Custom2 removed so "Custom Artist" is visible.
 static const QSet<int> HIDDEN_COLUMNS = {
@@ -102,6 +137,7 @@ LibraryView::LibraryView(QWidget *parent)
     , m_countLabel(new QLabel(this))
     , m_ratingDelegate(new RatingDelegate(this))
     , m_scriptRunner(new ScriptRunner(this))
+    , m_textIndex(new TextIndex)
 {
     // --- Filter bar ---
     m_filterEdit->setPlaceholderText("Filter by artist, album, or title...");
@@ -115,11 +151,16 @@ LibraryView::LibraryView(QWidget *parent)
     // Unrated starts checked, so Rated starts dimmed (mutually exclusive)
     m_excludeRatedCheckbox->setEnabled(false);
 
+    m_recentlyPlayedCheckbox = new QCheckBox(tr("Recently Played"), this);
+    m_recentlyPlayedCheckbox->setToolTip(
+        tr("Show only the %1 most recently played tracks").arg(RECENTLY_PLAYED_COUNT));
+
     QHBoxLayout *filterLayout = new QHBoxLayout();
     filterLayout->addWidget(new QLabel("Filter:", this));
     filterLayout->addWidget(m_filterEdit, 1);
     filterLayout->addWidget(m_excludeUnratedCheckbox);
     filterLayout->addWidget(m_excludeRatedCheckbox);
+    filterLayout->addWidget(m_recentlyPlayedCheckbox);
     filterLayout->addWidget(m_countLabel);
 
     // --- Proxy model for filtering and sorting ---
@@ -165,6 +206,44 @@ LibraryView::LibraryView(QWidget *parent)
             this, &LibraryView::onFilterChanged);
     connect(m_model, &LibraryModel::loadError,
             this, &LibraryView::onModelLoadError);
+    // Text index postings load in the background; redo a lyrics search
+    // that ran before they were ready
+    connect(m_textIndex.get(), &TextIndex::loaded, this, [this]() {
+        if (m_filterEdit->text().trimmed().size() >= TEXT_SEARCH_MIN_LENGTH)
+            onFilterChanged(m_filterEdit->text());
+    });
+
+    // Rows arrive and leave through the change feed without a reload;
+    // keep the count in step
+    auto refreshCount = [this]() {
+        bool anyFilter = !m_filterEdit->text().isEmpty()
+                         || m_excludeUnratedCheckbox->isChecked()
+                         || m_excludeRatedCheckbox->isChecked()
+                         || m_recentlyPlayedCheckbox->isChecked();
+        m_countLabel->setText(anyFilter
+            ? tr("%1 / %2 tracks").arg(m_proxyModel->rowCount()).arg(m_model->rowCount())
+            : tr("%1 tracks").arg(m_model->rowCount()));
+    };
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, refreshCount);
+    connect(m_model, &QAbstractItemModel::rowsRemoved,  this, refreshCount);
+
+    // The Recently Played view follows scrobbles; its rows come from the
+    // model's played index, so refreshing it is O(log n + k)
+    connect(m_recentlyPlayedCheckbox, &QCheckBox::toggled,
+            this, &LibraryView::onRecentlyPlayedToggled);
+    auto refreshRecent = [this]() {
+        if (m_recentlyPlayedCheckbox->isChecked())
+            refreshRecentlyPlayed();
+    };
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, refreshRecent);
+    connect(m_model, &QAbstractItemModel::rowsRemoved,  this, refreshRecent);
+    connect(m_model, &QAbstractItemModel::modelReset,   this, refreshRecent);
+    connect(m_model, &LibraryModel::trackChanged, this,
+            [this](const TrackRecord &before, const TrackRecord &after) {
+        if (m_recentlyPlayedCheckbox->isChecked()
+            && before.lastPlayedSerial != after.lastPlayedSerial)
+            refreshRecentlyPlayed();
+    });
 
     // Re-sort correctly when any column header is clicked
     connect(m_tableView->horizontalHeader(), &QHeaderView::sectionClicked,
@@ -191,6 +270,8 @@ LibraryView::LibraryView(QWidget *parent)
             this, &LibraryView::onRemoveSuccess);
     connect(m_scriptRunner, &ScriptRunner::removeError,
             this, &LibraryView::onRemoveError);
+    connect(m_scriptRunner, &ScriptRunner::removeBatchFinished,
+            this, &LibraryView::onRemoveBatchFinished);
 
     // Script runner results — tag rebuild (v2.2)
     connect(m_scriptRunner, &ScriptRunner::scriptOutput,
@@ -221,11 +302,24 @@ LibraryView::LibraryView(QWidget *parent)
 
 bool LibraryView::loadDatabase(const QString &path)
 {
-    bool ok = m_model->loadFromFile(path);
+    return loadDatabase(QStringList{path});
+}
+
+bool LibraryView::loadDatabase(const QStringList &paths)
+{
+    bool ok = m_model->loadFromFiles(paths);
+    m_textIndex->setDatabases(paths);
+    m_filterEdit->setPlaceholderText(m_textIndex->isAvailable()
+        ? tr("Filter by artist, album, title, or lyrics...")
+        : tr("Filter by artist, album, or title..."));
     setupColumns();
     m_countLabel->setText(tr("%1 tracks").arg(m_model->rowCount()));
-    if (ok)
-        emit statusMessage(tr("Loaded: %1  (%2 tracks)").arg(path).arg(m_model->rowCount()));
+    if (ok) {
+        const QString source = paths.size() == 1
+            ? paths.first()
+            : tr("%1 library shards").arg(paths.size());
+        emit statusMessage(tr("Loaded: %1  (%2 tracks)").arg(source).arg(m_model->rowCount()));
+    }
     return ok;
 }
 
@@ -253,8 +347,14 @@ void LibraryView::setupColumns()
     m_tableView->setColumnWidth(static_cast<int>(TrackColumn::LastTimePlayed), 90);
 }
 
+LibraryView::~LibraryView() = default;
+
 void LibraryView::onFilterChanged(const QString &text)
 {
+    // Lyrics and comments match too, when the text index has been built
+    static_cast<LibraryFilterProxyModel *>(m_proxyModel)->setTextMatches(
+        text.trimmed().size() >= TEXT_SEARCH_MIN_LENGTH ? m_textIndex->search(text)
+                                                        : QSet<QString>());
     m_proxyModel->setFilterFixedString(text);
 
     if (text.isEmpty()) {
@@ -267,7 +367,8 @@ void LibraryView::onFilterChanged(const QString &text)
 
     // Show filtered count when any filtering is active
     bool anyFilter = !text.isEmpty() || m_excludeUnratedCheckbox->isChecked()
-                     || m_excludeRatedCheckbox->isChecked();
+                     || m_excludeRatedCheckbox->isChecked()
+                     || m_recentlyPlayedCheckbox->isChecked();
     m_countLabel->setText(anyFilter
         ? tr("%1 / %2 tracks").arg(m_proxyModel->rowCount()).arg(m_model->rowCount())
         : tr("%1 tracks").arg(m_model->rowCount()));
@@ -282,7 +383,8 @@ void LibraryView::onExcludeUnratedToggled(bool checked)
 
     // Refresh the displayed count to reflect the new filter state
     bool anyFilter = !m_filterEdit->text().isEmpty() || checked
-                     || m_excludeRatedCheckbox->isChecked();
+                     || m_excludeRatedCheckbox->isChecked()
+                     || m_recentlyPlayedCheckbox->isChecked();
     m_countLabel->setText(anyFilter
         ? tr("%1 / %2 tracks").arg(m_proxyModel->rowCount()).arg(m_model->rowCount())
         : tr("%1 tracks").arg(m_model->rowCount()));
@@ -297,12 +399,36 @@ void LibraryView::onExcludeRatedToggled(bool checked)
 
     // Refresh the displayed count to reflect the new filter state
     bool anyFilter = !m_filterEdit->text().isEmpty() || checked
-                     || m_excludeUnratedCheckbox->isChecked();
+                     || m_excludeUnratedCheckbox->isChecked()
+                     || m_recentlyPlayedCheckbox->isChecked();
     m_countLabel->setText(anyFilter
         ? tr("%1 / %2 tracks").arg(m_proxyModel->rowCount()).arg(m_model->rowCount())
         : tr("%1 tracks").arg(m_model->rowCount()));
 }
 
+void LibraryView::onRecentlyPlayedToggled(bool checked)
+{
+    if (!checked) {
+        static_cast<LibraryFilterProxyModel *>(m_proxyModel)->setRowSubset(false);
+        onFilterChanged(m_filterEdit->text());
+        return;
+    }
+
+    refreshRecentlyPlayed();
+    // Newest first
+    m_proxyModel->sort(static_cast<int>(TrackColumn::LastTimePlayed), Qt::DescendingOrder);
+    m_tableView->horizontalHeader()->setSortIndicator(
+        static_cast<int>(TrackColumn::LastTimePlayed), Qt::DescendingOrder);
+}
+
+void LibraryView::refreshRecentlyPlayed()
+{
+    static_cast<LibraryFilterProxyModel *>(m_proxyModel)->setRowSubset(
+        true, m_model->recentlyPlayedRows(RECENTLY_PLAYED_COUNT));
+    m_countLabel->setText(
+        tr("%1 / %2 tracks").arg(m_proxyModel->rowCount()).arg(m_model->rowCount()));
+}
+
 void LibraryView::onModelLoadError(const QString &message)
 {
     emit statusMessage(tr("Error: %1").arg(message));
@@ -530,10 +656,13 @@ void LibraryView::showContextMenu(const QPoint &pos)
 
     menu.addSeparator();
 
-    QAction *removeAct = menu.addAction(tr("Remove Record"));
-    removeAct->setToolTip(tr("Remove this track from the database (file is not deleted)"));
+    QAction *removeAct = menu.addAction(tracks.size() > 1 ? tr("Remove Records") + countLabel
+                                                          : tr("Remove Record"));
+    removeAct->setToolTip(tracks.size() > 1
+        ? tr("Remove the selected tracks from the database (files are not deleted)")
+        : tr("Remove this track from the database (file is not deleted)"));
 
-    connect(removeAct, &QAction::triggered, this, [this, track]() {
+    connect(removeAct, &QAction::triggered, this, [this, track, tracks]() {
         // Confirmation dialog — show artist + title so user knows what they're removing
         QString display = track.songTitle;
         if (!track.artist.isEmpty())
@@ -541,19 +670,21 @@ void LibraryView::showContextMenu(const QPoint &pos)
 
         // Custom dialog so we can embed a "also delete file" checkbox
         QDialog dlg(this);
-        dlg.setWindowTitle(tr("Remove Record"));
+        dlg.setWindowTitle(tracks.size() > 1 ? tr("Remove Records") : tr("Remove Record"));
 
         QVBoxLayout *layout = new QVBoxLayout(&dlg);
 
-        QLabel *msgLabel = new QLabel(
-            tr("Remove \"%1\" from the database?").arg(display), &dlg);
+        QLabel *msgLabel = new QLabel(tracks.size() > 1
+            ? tr("Remove %1 tracks from the database?").arg(tracks.size())
+            : tr("Remove \"%1\" from the database?").arg(display), &dlg);
         msgLabel->setWordWrap(true);
         layout->addWidget(msgLabel);
 
         layout->addSpacing(6);
 
-        QCheckBox *deleteFileCheck = new QCheckBox(
-            tr("Also delete the audio file from disk"), &dlg);
+        QCheckBox *deleteFileCheck = new QCheckBox(tracks.size() > 1
+            ? tr("Also delete the audio files from disk")
+            : tr("Also delete the audio file from disk"), &dlg);
         deleteFileCheck->setChecked(false);   // safe default — file is kept
         layout->addWidget(deleteFileCheck);
 
@@ -570,6 +701,19 @@ void LibraryView::showContextMenu(const QPoint &pos)
 
         const bool deleteFile = deleteFileCheck->isChecked();
 
+        // Several rows go through --batch: one database rewrite for all
+        if (tracks.size() > 1) {
+            QVector<QPair<QString, QString>> records;
+            records.reserve(tracks.size());
+            for (const TrackRecord &t : tracks)
+                records.append({t.id, t.songPath});
+            emit statusMessage(deleteFile
+                ? tr("Removing %1 records and files...").arg(records.size())
+                : tr("Removing %1 records...").arg(records.size()));
+            m_scriptRunner->removeRecords(records, deleteFile);
+            return;
+        }
+
         if (deleteFile)
             emit statusMessage(tr("Removing record and file: %1...").arg(track.songTitle));
         else
@@ -602,6 +746,22 @@ void LibraryView::onRemoveError(const QString &filePath, const QString &message)
     QMessageBox::warning(this, tr("Remove Failed"), message);
 }
 
+void LibraryView::onRemoveBatchFinished(int removed, int requested, const QStringList &failed)
+{
+    emit statusMessage(tr("Removed %1 of %2 records").arg(removed).arg(requested));
+    if (failed.isEmpty())
+        return;
+
+    // Keep the dialog a sensible size when many rows failed
+    const int shown = qMin(failed.size(), 15);
+    QString details = failed.mid(0, shown).join(QLatin1Char('\n'));
+    if (failed.size() > shown)
+        details += QLatin1Char('\n') + tr("... and %1 more").arg(failed.size() - shown);
+    QMessageBox::warning(this, tr("Some Records Not Removed"),
+        tr("Removed %1 of %2 records.  Problems:\n\n%3")
+            .arg(QString::number(removed), QString::number(requested), details));
+}
+
 // ===========================================================================
 //  Tag rebuild result handlers (v2.2)
 // ===========================================================================
@@ -705,7 +865,7 @@ void LibraryView::onCellDoubleClicked(const QModelIndex &proxyIndex)
     }
 
     emit statusMessage(tr("Updating %1...").arg(displayName));
-    m_scriptRunner->editField(track.id, dsvFieldName, newValue);
+    m_scriptRunner->editField(track.id, dsvFieldName, newValue, track.songPath);
 }
 
 void LibraryView::onEditFieldSuccess(const QString &fieldName, const QString &newValue)
@@ -2,6 +2,8 @@
 
 #include <QWidget>
 
+#include <memory>
+
 class QTableView;
 class QCheckBox;
 class QLineEdit;
@@ -10,6 +12,7 @@ class QSortFilterProxyModel;
 class LibraryModel;
 class RatingDelegate;
 class ScriptRunner;
+class TextIndex;
 
 class LibraryView : public QWidget
 {
@@ -17,10 +20,14 @@ class LibraryView : public QWidget
 
 public:
     explicit LibraryView(QWidget *parent = nullptr);
+    ~LibraryView() override;
 
     // Load the DSV database file
     bool loadDatabase(const QString &path);
 
+    // Load every library shard DSV into one merged view
+    bool loadDatabase(const QStringList &paths);
+
     // Return the number of tracks loaded
     int trackCount() const;
 
@@ -36,11 +43,14 @@ private slots:
     void onRateError(const QString &filePath, int stars, const QString &message);
     void onExcludeUnratedToggled(bool checked);
     void onExcludeRatedToggled(bool checked);
+    void onRecentlyPlayedToggled(bool checked);
+    void refreshRecentlyPlayed();
 
     // Context menu (v2.1)
     void showContextMenu(const QPoint &pos);
     void onRemoveSuccess(const QString &filePath);
     void onRemoveError(const QString &filePath, const QString &message);
+    void onRemoveBatchFinished(int removed, int requested, const QStringList &failed);
 
     // Tag rebuild (v2.2)
     void onTagRebuildOutput(const QString &operationId, const QString &line);
@@ -64,5 +74,7 @@ private:
     ScriptRunner          *m_scriptRunner;
     QCheckBox             *m_excludeUnratedCheckbox;
     QCheckBox             *m_excludeRatedCheckbox;
+    QCheckBox             *m_recentlyPlayedCheckbox;
+    std::unique_ptr<TextIndex> m_textIndex;
     int                    m_pendingRebuildCount = 0;
 };
@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "musiclib.h"   // auto-generated by kconfig_compiler from musiclib.kcfg
+#include "structured_log.h"
 
 #include <QApplication>
 #include <KAboutData>
@@ -42,6 +43,11 @@ int main(int argc, char *argv[])
     auto *window = new MainWindow();
     window->setWindowIcon(QIcon(":/icons/musiclib.png"));
 
+    // Structured event journal next to the text log (musiclib.log ->
+    // musiclib.ndjson).  Opened after MainWindow has synced musiclib.conf so
+    // a LOGFILE set there is honoured.  Writes happen on a background thread.
+    StructuredLog::instance().open(StructuredLog::journalPath(settings->logFile()));
+
     // Honour "start minimized": if set, the window starts hidden and only
     // the system tray icon is visible.  The user can restore it via the
     // tray popup or right-click menu.
@@ -790,9 +790,10 @@ QGroupBox *MaintenancePanel::createNewTracksGroup()
 
     auto *desc = new QLabel(
         "Import new MP3 downloads from the configured download directory into the library.  "
-        "Extracts any ZIP file present, normalizes filenames and volume with rsgain, "
-        "organises files into an artist/album folder under MUSIC_REPO, and adds the "
-        "tracks to the database.  Place tracks for no more than one artist and album at a time.  "
+        "Extracts any ZIP files present (one album per ZIP), normalizes filenames and volume "
+        "with rsgain, organises files into artist/album folders under MUSIC_REPO, and adds the "
+        "tracks to the database.  Albums are processed in parallel.  Place tracks for no more "
+        "than one artist at a time.  "
         "<b>Do any needed tag editing to conform artist or album in kid3 before executing</b>.  ");
     desc->setWordWrap(true);
     desc->setTextFormat(Qt::RichText);
@@ -15,6 +15,10 @@
 #include "mobile_panel.h"
 #include "cdrippingpanel.h"
 #include "smartplaylistpanel.h"
+#include "statspanel.h"
+#include "albumgridpanel.h"
+#include "libraryaggregates.h"
+#include "librarystats.h"
 #include "systemtrayicon.h"
 #include "musiclib.h"   // KConfigXT-generated MusicLibSettings singleton
 
@@ -88,7 +92,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // ── Create data model for album window and status queries ──
     m_libraryModel = new LibraryModel(this);
-    m_libraryModel->loadFromFile(m_databasePath);
+    m_libraryModel->loadFromFiles(m_databasePaths);
 
     // ── Create script runner ──
     m_scriptRunner = new ScriptRunner(this);
@@ -354,6 +358,24 @@ void MainWindow::setupConfWriter()
             m_mobileDir = m_playlistsDir + QStringLiteral("/mobile");
         }
     }
+
+    // ── Library shards ──
+    // LIBRARY_SHARDS="name:root:dsv;..."; the GUI only needs the DSVs.
+    // Unsharded libraries are a single shard made of MUSICDB.
+    m_databasePaths.clear();
+    const QString shards = m_confWriter->value(QStringLiteral("LIBRARY_SHARDS"));
+    for (const QString &entry : shards.split(QLatin1Char(';'), Qt::SkipEmptyParts)) {
+        const QStringList parts = entry.trimmed().split(QLatin1Char(':'));
+        if (parts.size() < 3)
+            continue;
+        QString dsv = parts.mid(2).join(QLatin1Char(':')).trimmed();
+        dsv.replace(QStringLiteral("$HOME"), QDir::homePath());
+        if (dsv.isEmpty() || dsv.contains(QLatin1Char('$')))
+            continue;
+        m_databasePaths.append(dsv);
+    }
+    if (m_databasePaths.isEmpty())
+        m_databasePaths.append(m_databasePath);
 }
 
 // ═════════════════════════════════════════════════════════════
@@ -384,6 +406,8 @@ void MainWindow::setupSidebar()
     addItem(i18n("Mobile"),         QStringLiteral("smartphone"));
     addItem(i18n("CD Ripping"),     QStringLiteral("media-optical-audio"));
     addItem(i18n("Smart Playlist"), QStringLiteral("media-playlist-shuffle"));
+    addItem(i18n("Statistics"),     QStringLiteral("office-chart-bar"));
+    addItem(i18n("Albums"),         QStringLiteral("view-media-album-cover"));
     addItem(i18n("Settings"),       QStringLiteral("preferences-system"));
 
     connect(m_sidebar, &QListWidget::currentRowChanged,
@@ -400,7 +424,7 @@ void MainWindow::setupPanels()
 
     // ── Library panel (existing) ──
     m_libraryPanel = new LibraryView(this);
-    m_libraryPanel->loadDatabase(m_databasePath);
+    m_libraryPanel->loadDatabase(m_databasePaths);
     m_panelStack->addWidget(m_libraryPanel);   // index 0
 
     // ── Maintenance panel (existing) ──
@@ -438,6 +462,33 @@ void MainWindow::setupPanels()
             i18n("Playlist generated: %1", playlistPath), 6000);
     });
 
+    // ── Statistics panel ──
+    // LibraryStats follows m_libraryModel, which stays current through the
+    // backend change feed, so the dashboard never rescans the DSV itself.
+    m_libraryStats = new LibraryStats(m_libraryModel, this);
+    m_libraryAggregates = new LibraryAggregates(m_libraryModel, this);
+    m_statsPanel = new StatsPanel(m_libraryStats, this);
+    m_panelStack->addWidget(m_statsPanel);   // index 5
+
+    // ── Albums panel ──
+    // Cover grid over the same album table as the Album View window
+    m_albumGridPanel = new AlbumGridPanel(m_libraryAggregates, this);
+    m_panelStack->addWidget(m_albumGridPanel);   // index 6
+
+    connect(m_albumGridPanel, &AlbumGridPanel::albumActivated,
+            this, [this](const QString &dsv, int id, const QString &coverPath) {
+        const AlbumAggregate *album = m_libraryAggregates->album(dsv, id);
+        if (!album)
+            return;
+        if (!m_albumWindow)
+            m_albumWindow = new AlbumWindow(this);
+        m_albumWindow->populate(album, album->artist(), album->title,
+                                QString(), coverPath, QString());
+        m_albumWindow->show();
+        m_albumWindow->raise();
+        m_albumWindow->activateWindow();
+    });
+
     // ── K3b startup detection (Scenario D) ──
     // Check whether K3b is already running when musiclib starts.
     // If so, compare the running PID against the stored PID file:
@@ -741,8 +792,9 @@ void MainWindow::setupFileWatcher()
 {
     m_fileWatcher = new QFileSystemWatcher(this);
 
-    if (QFile::exists(m_databasePath)) {
-        m_fileWatcher->addPath(m_databasePath);
+    for (const QString &path : std::as_const(m_databasePaths)) {
+        if (QFile::exists(path))
+            m_fileWatcher->addPath(path);
     }
 
     connect(m_fileWatcher, &QFileSystemWatcher::fileChanged,
@@ -957,15 +1009,16 @@ void MainWindow::onDatabasePathChanged()
     setupConfWriter();
 
     // Reload models with the (possibly new) database path
-    m_libraryModel->loadFromFile(m_databasePath);
-    m_libraryPanel->loadDatabase(m_databasePath);
+    m_libraryModel->loadFromFiles(m_databasePaths);
+    m_libraryPanel->loadDatabase(m_databasePaths);
 
     // Update the file watcher
     if (!m_fileWatcher->files().isEmpty()) {
         m_fileWatcher->removePaths(m_fileWatcher->files());
     }
-    if (QFile::exists(m_databasePath)) {
-        m_fileWatcher->addPath(m_databasePath);
+    for (const QString &path : std::as_const(m_databasePaths)) {
+        if (QFile::exists(path))
+            m_fileWatcher->addPath(path);
     }
 
     // Refresh playlists dropdown (PLAYLISTS_DIR may have changed)
@@ -1072,12 +1125,14 @@ void MainWindow::onDatabaseChanged(const QString &path)
 {
     Q_UNUSED(path);
 
+    // The library models follow the backend change feed themselves (and
+    // reparse a shard only when a write was not published), so there is
+    // nothing to reload here.  Writers replace the DSV with mv, which drops
+    // the watch; re-arm it once the new file is in place.
     QTimer::singleShot(500, this, [this]() {
-        m_libraryModel->loadFromFile(m_databasePath);
-        m_libraryPanel->loadDatabase(m_databasePath);
-
-        if (!m_fileWatcher->files().contains(m_databasePath)) {
-            m_fileWatcher->addPath(m_databasePath);
+        for (const QString &path : std::as_const(m_databasePaths)) {
+            if (!m_fileWatcher->files().contains(path) && QFile::exists(path))
+                m_fileWatcher->addPath(path);
         }
     });
 }
@@ -1239,11 +1294,13 @@ void MainWindow::showAlbumWindow()
     }
 
     int albumId = -1;
+    QString albumDsv;
     const int rowCount = m_libraryModel->rowCount();
     for (int row = 0; row < rowCount; ++row) {
         TrackRecord record = m_libraryModel->trackAt(row);
         if (record.songPath == m_nowPlaying.songPath) {
             albumId = record.idAlbum.toInt();
+            albumDsv = record.sourceDsv;
             break;
         }
     }
@@ -1260,8 +1317,7 @@ void MainWindow::showAlbumWindow()
     QString artworkPath = m_musicDisplayDir + QStringLiteral("/folder.jpg");
 
     m_albumWindow->populate(
-        m_libraryModel,
-        albumId,
+        m_libraryAggregates->album(albumDsv, albumId),
         m_nowPlaying.artist,
         m_nowPlaying.album,
         m_nowPlaying.year,
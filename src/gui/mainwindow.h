@@ -35,6 +35,10 @@ class ScriptRunner;
 class MobilePanel;
 class CDRippingPanel;
 class SmartPlaylistPanel;
+class StatsPanel;
+class AlbumGridPanel;
+class LibraryAggregates;
+class LibraryStats;
 
 // Forward declaration - new album window
 class AlbumWindow;
@@ -94,6 +98,8 @@ public:
         PanelMobile,
         PanelCDRipping,
         PanelSmartPlaylist,  // ← smart playlist generation panel
+        PanelStatistics,     // listening statistics dashboard
+        PanelAlbums,         // album cover grid
         PanelSettings,       // opens dialog, not a panel
         PanelCount           // sentinel - must be last
     };
@@ -219,6 +225,10 @@ private:
     MobilePanel         *m_mobilePanel;                    ///< Mobile sync panel
     CDRippingPanel      *m_cdRippingPanel      = nullptr;  ///< K3b CD ripping settings panel
     SmartPlaylistPanel  *m_smartPlaylistPanel  = nullptr;  ///< Smart playlist generation panel
+    LibraryStats        *m_libraryStats        = nullptr;  ///< Aggregates over m_libraryModel
+    LibraryAggregates   *m_libraryAggregates   = nullptr;  ///< Per-album / per-artist tables
+    StatsPanel          *m_statsPanel          = nullptr;  ///< Listening statistics dashboard
+    AlbumGridPanel      *m_albumGridPanel      = nullptr;  ///< Album cover grid
 
     // ── Toolbar ──
     QToolBar      *m_toolbar         = nullptr;  ///< Main toolbar
@@ -282,6 +292,7 @@ private:
     // ── Config cache ──
     QString m_musicDisplayDir;   // conky output directory
     QString m_databasePath;      // musiclib.dsv path
+    QStringList m_databasePaths; // every shard DSV (just m_databasePath when unsharded)
     QString m_playlistsDir;      // playlists directory
     QString m_audaciousPlaylistsDir;  // AUDACIOUS_PLAYLISTS_DIR
     QString m_mobileDir;              // MOBILE_DIR (playlists/mobile)
@@ -1324,11 +1324,16 @@ void MobilePanel::appendError(const QString &line)
 
 void MobilePanel::updateRetryButtonVisibility()
 {
-    // Check if any .pending_tracks or .failed files exist in the mobile dir
+    // The backend lists playlists with outstanding .pending_tracks or
+    // .failed files in recovery.index; fall back to looking for the files
+    // themselves until the backend has created the index
     QDir mobileDir(m_mobileDir);
     bool hasRecovery = false;
 
-    if (mobileDir.exists()) {
+    const QFileInfo index(mobileDir.filePath(QStringLiteral("recovery.index")));
+    if (index.exists()) {
+        hasRecovery = index.size() > 0;
+    } else if (mobileDir.exists()) {
         QStringList pendingFiles = mobileDir.entryList(
             {QStringLiteral("*.pending_tracks"), QStringLiteral("*.failed")},
             QDir::Files);
@@ -1,4 +1,5 @@
 #include "scriptrunner.h"
+#include "structured_log.h"
 
 #include <QProcess>
 #include <QDir>
@@ -86,6 +87,9 @@ void ScriptRunner::onRateProcessFinished(int exitCode)
         }
         if (errMsg.isEmpty())
             errMsg = QString("Script exited with code %1").arg(exitCode);
+        StructuredLog::instance().log(StructuredLog::Level::Error, QStringLiteral("gui"),
+            QStringLiteral("Rating failed: %1").arg(errMsg),
+            {{QStringLiteral("path"), m_pendingFilePath}, {QStringLiteral("exit"), exitCode}});
         emit rateError(m_pendingFilePath, m_pendingStars, errMsg);
         break;
     }
@@ -149,13 +153,86 @@ void ScriptRunner::onRemoveProcessFinished(int exitCode)
     }
 }
 
+void ScriptRunner::removeRecords(const QVector<QPair<QString, QString>> &records,
+                                 bool deleteFile)
+{
+    QString script = resolveScript("musiclib_remove_record.sh");
+    if (script.isEmpty()) {
+        emit removeError(QString(),
+            "musiclib_remove_record.sh not found in ~/musiclib/bin or /usr/lib/musiclib/bin");
+        return;
+    }
+
+    m_pendingBatchSize = records.size();
+
+    QProcess *process = new QProcess(this);
+
+    connect(process,
+            QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ScriptRunner::onRemoveBatchProcessFinished);
+
+    // Run: bash musiclib_remove_record.sh --batch - [--delete-file]
+    // with one "ID<TAB>path" line per record on stdin.
+    QStringList args;
+    args << script << QStringLiteral("--batch") << QStringLiteral("-");
+    if (deleteFile)
+        args << QStringLiteral("--delete-file");
+    process->start("bash", args);
+
+    QByteArray list;
+    for (const auto &record : records)
+        list += record.first.toUtf8() + '\t' + record.second.toUtf8() + '\n';
+    process->write(list);
+    process->closeWriteChannel();
+}
+
+void ScriptRunner::onRemoveBatchProcessFinished(int exitCode)
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    if (process)
+        process->deleteLater();
+
+    // Exit 1 only means some rows were not found; the rest were removed
+    if (exitCode != 0 && exitCode != 1) {
+        QString errMsg;
+        if (process)
+            errMsg = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        if (errMsg.isEmpty())
+            errMsg = QString("Script exited with code %1").arg(exitCode);
+        emit removeError(QString(), errMsg);
+        return;
+    }
+
+    int removed = 0;
+    QStringList failed;
+    const QList<QByteArray> lines = process ? process->readAllStandardOutput().split('\n')
+                                            : QList<QByteArray>();
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split('\t');
+        if (fields.size() < 3)
+            continue;
+        const QString status = QString::fromUtf8(fields.at(0));
+        if (status == QLatin1String("removed") || status == QLatin1String("deleted")) {
+            ++removed;
+        } else {
+            if (status == QLatin1String("file-error"))
+                ++removed;
+            const QString path = fields.at(2).isEmpty() ? QString::fromUtf8(fields.at(1))
+                                                         : QString::fromUtf8(fields.at(2));
+            failed << QStringLiteral("%1: %2").arg(path, status);
+        }
+    }
+    emit removeBatchFinished(removed, m_pendingBatchSize, failed);
+}
+
 // ===========================================================================
 //  Field editing — v2.3 addition
 // ===========================================================================
 
 void ScriptRunner::editField(const QString &recordId,
                              const QString &fieldName,
-                             const QString &newValue)
+                             const QString &newValue,
+                             const QString &songPath)
 {
     QString script = resolveScript("musiclib_edit_field.sh");
     if (script.isEmpty()) {
@@ -172,7 +249,11 @@ void ScriptRunner::editField(const QString &recordId,
             QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &ScriptRunner::onEditProcessFinished);
 
-    process->start("bash", QStringList() << script << recordId << fieldName << newValue);
+    QStringList args;
+    args << script << recordId << fieldName << newValue;
+    if (!songPath.isEmpty())
+        args << songPath;
+    process->start("bash", args);
 }
 
 void ScriptRunner::onEditProcessFinished(int exitCode)
@@ -249,6 +330,12 @@ void ScriptRunner::runScript(const QString &operationId,
 
     m_scriptProcess->start("bash", fullArgs);
 
+    m_currentScript = scriptName;
+    m_scriptTimer.start();
+    StructuredLog::instance().log(StructuredLog::Level::Info, QStringLiteral("gui"),
+        QStringLiteral("Started %1").arg(operationId),
+        {{QStringLiteral("op"), operationId}, {QStringLiteral("script"), scriptName}});
+
     // If the caller supplied stdin data (e.g. "\n" to auto-confirm an
     // interactive read prompt), write it now and close the write channel so
     // the script sees EOF after consuming the data.
@@ -312,6 +399,16 @@ void ScriptRunner::onScriptProcessFinished(int exitCode, QProcess::ExitStatus st
     // Treat a crash as exit code -2 so callers can distinguish it
     int effectiveCode = (status == QProcess::CrashExit) ? -2 : exitCode;
 
+    // 1 is "preview complete" for dry runs, 3 is "deferred" (database busy)
+    const StructuredLog::Level level =
+        (effectiveCode == 0 || effectiveCode == 1) ? StructuredLog::Level::Info
+        : effectiveCode == 3                        ? StructuredLog::Level::Warn
+                                                    : StructuredLog::Level::Error;
+    StructuredLog::instance().log(level, QStringLiteral("gui"),
+        QStringLiteral("Finished %1 with exit code %2").arg(m_currentOpId).arg(effectiveCode),
+        {{QStringLiteral("op"), m_currentOpId}, {QStringLiteral("script"), m_currentScript},
+         {QStringLiteral("exit"), effectiveCode}, {QStringLiteral("ms"), m_scriptTimer.elapsed()}});
+
     emit scriptFinished(m_currentOpId, effectiveCode, stderrContent);
 
     // Clean up
@@ -3,8 +3,11 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QProcess>
+#include <QPair>
+#include <QVector>
 
 ///
 /// ScriptRunner — Async script executor for the MusicLib GUI.
@@ -16,6 +19,8 @@
 ///
 ///   2. removeRecord()   — Dedicated method for musiclib_remove_record.sh.
 ///                         Emits removeSuccess / removeError.
+///      removeRecords()  — Batch variant (--batch): one rewrite for many rows.
+///                         Emits removeBatchFinished / removeError.
 ///
 ///   3. editField()      — Dedicated method for musiclib_edit_field.sh (v2.3).
 ///                         Emits editSuccess / editError.
@@ -49,9 +54,12 @@ public:
     /// @param fieldName  DSV column name: Artist, Album, AlbumArtist,
     ///                   SongTitle, or Genre.
     /// @param newValue   Replacement text (must not contain '^').
+    /// @param songPath   The record's SongPath; selects the owning shard
+    ///                   when the library is sharded (IDs are per-DSV).
     void editField(const QString &recordId,
                    const QString &fieldName,
-                   const QString &newValue);
+                   const QString &newValue,
+                   const QString &songPath = QString());
 
     // --- Record removal (v2.1 addition) -------------------------------------
 
@@ -69,6 +77,14 @@ public:
                       const QString &filePath,
                       bool deleteFile = false);
 
+    /// Invoke musiclib_remove_record.sh --batch to delete many DB rows in a
+    /// single pass per database.
+    ///
+    /// @param records     (record ID, file path) pairs; both must match a row.
+    /// @param deleteFile  Also delete each removed row's audio file.
+    void removeRecords(const QVector<QPair<QString, QString>> &records,
+                       bool deleteFile = false);
+
     // --- Generic script execution (v2 addition) -----------------------------
 
     /// Run any backend script asynchronously.
@@ -112,6 +128,10 @@ signals:
     void removeSuccess(const QString &filePath);
     void removeError(const QString &filePath, const QString &message);
 
+    /// Batch removal finished.  @p failed lists "path: status" for every row
+    /// that was not removed or whose file could not be deleted.
+    void removeBatchFinished(int removed, int requested, const QStringList &failed);
+
     // --- Field editing signals (v2.3 addition) ------------------------------
     void editSuccess(const QString &fieldName, const QString &newValue);
     void editError(const QString &message);
@@ -133,6 +153,7 @@ private slots:
 
     // Record removal process handler (v2.1)
     void onRemoveProcessFinished(int exitCode);
+    void onRemoveBatchProcessFinished(int exitCode);
 
     // Field editing process handler (v2.3)
     void onEditProcessFinished(int exitCode);
@@ -150,6 +171,7 @@ private:
     QString m_pendingRemoveId;
     QString m_pendingRemovePath;
     bool    m_pendingDeleteFile = false;
+    int     m_pendingBatchSize  = 0;
 
     // --- Field editing state (v2.3) -----------------------------------------
     QString m_pendingEditField;
@@ -158,4 +180,6 @@ private:
     // --- Generic execution state (v2) ---------------------------------------
     QProcess *m_scriptProcess  = nullptr;
     QString   m_currentOpId;
+    QString   m_currentScript;
+    QElapsedTimer m_scriptTimer;    // duration for the event journal
 };
@@ -0,0 +1,216 @@
+// statspanel.cpp
+// MusicLib Qt GUI — Listening Statistics Panel implementation
+// Copyright (c) 2026 MusicLib Project
+
+#include "statspanel.h"
+#include "librarystats.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QSpinBox>
+#include <QScrollArea>
+#include <QPainter>
+#include <QLocale>
+#include <KLocalizedString>
+
+static constexpr int kMonths      = 12;
+static constexpr int kTopArtists  = 10;
+static constexpr int kRecentDays  = 30;
+
+// ─────────────────────────────────────────────────────────────
+// Horizontal bar list: one "label ▇▇▇▇ count" row per entry.
+// Painted directly; no item views or per-row widgets.
+// ─────────────────────────────────────────────────────────────
+namespace StatsPanelDetail {
+
+class BarChart : public QWidget
+{
+public:
+    explicit BarChart(QWidget *parent = nullptr) : QWidget(parent)
+    {
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    }
+
+    void setEntries(const QList<QPair<QString, int>> &entries)
+    {
+        m_entries = entries;
+        setFixedHeight(qMax(1, int(m_entries.size())) * rowHeight() + 4);
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter p(this);
+        const QFontMetrics fm = fontMetrics();
+        const int rowH = rowHeight();
+
+        if (m_entries.isEmpty()) {
+            p.setPen(palette().color(QPalette::PlaceholderText));
+            p.drawText(rect(), Qt::AlignLeft | Qt::AlignVCenter, i18n("No data"));
+            return;
+        }
+
+        int labelW = 0, countW = 0, maxValue = 1;
+        for (const auto &e : m_entries) {
+            labelW   = qMax(labelW, fm.horizontalAdvance(e.first));
+            countW   = qMax(countW, fm.horizontalAdvance(QLocale().toString(e.second)));
+            maxValue = qMax(maxValue, e.second);
+        }
+        labelW = qMin(labelW, width() / 3);
+
+        const int barX = labelW + 8;
+        const int barMaxW = qMax(0, width() - barX - countW - 8);
+        const QColor barColor = palette().color(QPalette::Highlight);
+
+        for (int i = 0; i < m_entries.size(); ++i) {
+            const auto &e = m_entries.at(i);
+            const QRect row(0, i * rowH, width(), rowH);
+
+            p.setPen(palette().color(QPalette::WindowText));
+            p.drawText(QRect(0, row.y(), labelW, rowH), Qt::AlignRight | Qt::AlignVCenter,
+                       fm.elidedText(e.first, Qt::ElideRight, labelW));
+
+            const int barW = static_cast<int>(qint64(barMaxW) * e.second / maxValue);
+            p.fillRect(QRect(barX, row.y() + 3, barW, rowH - 6), barColor);
+
+            p.drawText(QRect(barX + barW + 4, row.y(), countW + 4, rowH),
+                       Qt::AlignLeft | Qt::AlignVCenter, QLocale().toString(e.second));
+        }
+    }
+
+private:
+    int rowHeight() const { return fontMetrics().height() + 6; }
+
+    QList<QPair<QString, int>> m_entries;
+};
+
+} // namespace StatsPanelDetail
+
+using StatsPanelDetail::BarChart;
+
+// ═════════════════════════════════════════════════════════════
+// Construction
+// ═════════════════════════════════════════════════════════════
+
+StatsPanel::StatsPanel(LibraryStats *stats, QWidget *parent)
+    : QWidget(parent)
+    , m_stats(stats)
+{
+    auto *scroll = new QScrollArea(this);
+    scroll->setWidgetResizable(true);
+    scroll->setFrameShape(QFrame::NoFrame);
+    auto *content = new QWidget(scroll);
+    auto *layout = new QVBoxLayout(content);
+
+    // ── Overview ──
+    auto *overviewBox = new QGroupBox(i18n("Overview"), content);
+    auto *form = new QFormLayout(overviewBox);
+    m_tracksLabel      = new QLabel(overviewBox);
+    m_durationLabel    = new QLabel(overviewBox);
+    m_ratedLabel       = new QLabel(overviewBox);
+    m_neverPlayedLabel = new QLabel(overviewBox);
+    form->addRow(i18n("Tracks:"),       m_tracksLabel);
+    form->addRow(i18n("Total length:"), m_durationLabel);
+    form->addRow(i18n("Rated:"),        m_ratedLabel);
+    form->addRow(i18n("Never played:"), m_neverPlayedLabel);
+    layout->addWidget(overviewBox);
+
+    // ── Rating distribution ──
+    auto *ratingBox = new QGroupBox(i18n("Rating Distribution"), content);
+    auto *ratingLayout = new QVBoxLayout(ratingBox);
+    m_ratingChart = new BarChart(ratingBox);
+    ratingLayout->addWidget(m_ratingChart);
+    layout->addWidget(ratingBox);
+
+    // ── Tracks by month of last play ──
+    auto *monthBox = new QGroupBox(i18n("Tracks by Month of Last Play"), content);
+    auto *monthLayout = new QVBoxLayout(monthBox);
+    m_monthChart = new BarChart(monthBox);
+    monthLayout->addWidget(m_monthChart);
+    layout->addWidget(monthBox);
+
+    // ── Top artists ──
+    auto *artistBox = new QGroupBox(i18n("Top Artists by Recent Plays"), content);
+    auto *artistLayout = new QVBoxLayout(artistBox);
+    auto *daysRow = new QHBoxLayout();
+    daysRow->addWidget(new QLabel(i18n("Played in the last"), artistBox));
+    m_recentDaysSpin = new QSpinBox(artistBox);
+    m_recentDaysSpin->setRange(1, 3650);
+    m_recentDaysSpin->setValue(kRecentDays);
+    m_recentDaysSpin->setSuffix(i18n(" days"));
+    daysRow->addWidget(m_recentDaysSpin);
+    daysRow->addStretch();
+    artistLayout->addLayout(daysRow);
+    m_artistChart = new BarChart(artistBox);
+    artistLayout->addWidget(m_artistChart);
+    layout->addWidget(artistBox);
+
+    layout->addStretch();
+    scroll->setWidget(content);
+
+    auto *outer = new QVBoxLayout(this);
+    outer->setContentsMargins(0, 0, 0, 0);
+    outer->addWidget(scroll);
+
+    connect(m_stats, &LibraryStats::changed, this, &StatsPanel::onStatsChanged);
+    connect(m_recentDaysSpin, qOverload<int>(&QSpinBox::valueChanged),
+            this, &StatsPanel::refresh);
+}
+
+// ═════════════════════════════════════════════════════════════
+// Refresh
+// ═════════════════════════════════════════════════════════════
+
+void StatsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_dirty)
+        refresh();
+}
+
+void StatsPanel::onStatsChanged()
+{
+    // Only redraw what is on screen; a hidden panel catches up in showEvent
+    if (isVisible())
+        refresh();
+    else
+        m_dirty = true;
+}
+
+void StatsPanel::refresh()
+{
+    m_dirty = false;
+    const QLocale locale;
+
+    const int tracks = m_stats->trackCount();
+    const auto percent = [tracks](int n) {
+        return tracks > 0 ? QString::number(100.0 * n / tracks, 'f', 1) : QStringLiteral("0");
+    };
+
+    m_tracksLabel->setText(locale.toString(tracks));
+    const qint64 minutes = m_stats->totalDurationMs() / 60000;
+    m_durationLabel->setText(i18n("%1 h %2 min", locale.toString(minutes / 60),
+                                  QString::number(minutes % 60)));
+    m_ratedLabel->setText(i18n("%1 (%2%)", locale.toString(m_stats->ratedCount()),
+                               percent(m_stats->ratedCount())));
+    m_neverPlayedLabel->setText(i18n("%1 (%2%)", locale.toString(m_stats->neverPlayedCount()),
+                                     percent(m_stats->neverPlayedCount())));
+
+    QList<QPair<QString, int>> ratings;
+    for (int stars = 5; stars >= 0; --stars) {
+        ratings.append({stars == 0 ? i18n("Unrated") : i18np("1 star", "%1 stars", stars),
+                        m_stats->ratingCounts()[stars]});
+    }
+    m_ratingChart->setEntries(ratings);
+
+    QList<QPair<QString, int>> months;
+    for (const auto &m : m_stats->lastPlayedByMonth(kMonths))
+        months.append({locale.toString(m.first, QStringLiteral("MMM yyyy")), m.second});
+    m_monthChart->setEntries(months);
+
+    m_artistChart->setEntries(m_stats->topArtists(m_recentDaysSpin->value(), kTopArtists));
+}
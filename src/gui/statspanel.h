@@ -0,0 +1,50 @@
+// statspanel.h
+// MusicLib Qt GUI — Listening Statistics Panel
+//
+// Dashboard over LibraryStats: library overview, rating distribution,
+// tracks by month of last play, and top artists by recent plays.  The
+// aggregates are maintained incrementally by LibraryStats, so refreshing
+// the panel only reads a few dozen numbers; the panel also skips refreshes
+// while hidden and catches up when shown.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QWidget>
+
+class LibraryStats;
+class QLabel;
+class QSpinBox;
+class QShowEvent;
+
+namespace StatsPanelDetail { class BarChart; }
+
+class StatsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StatsPanel(LibraryStats *stats, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private Q_SLOTS:
+    void onStatsChanged();
+    void refresh();
+
+private:
+    LibraryStats *m_stats;
+    bool          m_dirty = true;
+
+    QLabel   *m_tracksLabel      = nullptr;
+    QLabel   *m_durationLabel    = nullptr;
+    QLabel   *m_ratedLabel       = nullptr;
+    QLabel   *m_neverPlayedLabel = nullptr;
+    QSpinBox *m_recentDaysSpin   = nullptr;
+
+    StatsPanelDetail::BarChart *m_ratingChart = nullptr;
+    StatsPanelDetail::BarChart *m_monthChart  = nullptr;
+    StatsPanelDetail::BarChart *m_artistChart = nullptr;
+};
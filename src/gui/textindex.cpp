@@ -0,0 +1,238 @@
+// textindex.cpp
+// MusicLib Qt GUI — Lyrics/comment full-text index reader
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "textindex.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+QString linkPath(const QString &dsv)         { return dsv + QStringLiteral(".txtindex"); }
+QString termsPath(const QString &generation) { return generation + QStringLiteral("/terms"); }
+QString docsPath(const QString &generation)  { return generation + QStringLiteral("/docs"); }
+
+bool isWordChar(QChar c)
+{
+    const ushort u = c.unicode();
+    if (u >= 0x80)
+        return u != 0x2018 && u != 0x2019;   // curly apostrophes fold to "'"
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9');
+}
+
+// Intersection of two sorted posting lists
+QVector<int> intersect(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<int> out;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(out));
+    return out;
+}
+
+} // namespace
+
+QString TextIndex::normalise(const QString &text)
+{
+    QString out(QLatin1Char(' '));
+    out.reserve(text.size() + 2);
+    for (const QChar c : text) {
+        if (isWordChar(c)) {
+            const ushort u = c.unicode();
+            out.append(u >= 'A' && u <= 'Z' ? QChar(u + ('a' - 'A')) : c);
+        } else if (!out.endsWith(QLatin1Char(' '))) {
+            out.append(QLatin1Char(' '));
+        }
+    }
+    if (!out.endsWith(QLatin1Char(' ')))
+        out.append(QLatin1Char(' '));
+    return out;
+}
+
+TextIndex::TextIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TextIndex::setDatabases(const QStringList &dsvPaths)
+{
+    m_shards.clear();
+    for (const QString &dsv : dsvPaths) {
+        Shard shard;
+        shard.dsv = dsv;
+        m_shards.append(shard);
+    }
+    // Start parsing now, so the first search finds the postings ready
+    for (Shard &shard : m_shards)
+        ensureLoaded(shard);
+}
+
+bool TextIndex::isAvailable() const
+{
+    for (const Shard &shard : m_shards) {
+        if (!currentGeneration(shard.dsv).isEmpty())
+            return true;
+    }
+    return false;
+}
+
+QString TextIndex::currentGeneration(const QString &dsv)
+{
+    // The writer replaces the link by rename, so one resolution names a
+    // directory whose docs and terms belong together
+    const QFileInfo link(linkPath(dsv));
+    return link.isSymLink() && link.exists() ? link.symLinkTarget() : QString();
+}
+
+void TextIndex::ensureLoaded(Shard &shard)
+{
+    const QString generation = currentGeneration(shard.dsv);
+    if (generation.isEmpty()) {
+        shard.data = Postings();
+        shard.generation.clear();
+        return;
+    }
+    if (generation == shard.generation || generation == shard.pending)
+        return;
+
+    // Parse on a worker thread; until it is done the previous generation,
+    // if any, keeps answering
+    shard.pending = generation;
+    const QString dsv = shard.dsv;
+    auto *watcher = new QFutureWatcher<Postings>(this);
+    connect(watcher, &QFutureWatcher<Postings>::finished, this, [this, watcher, dsv, generation]() {
+        watcher->deleteLater();
+        for (Shard &s : m_shards) {
+            if (s.dsv != dsv || s.pending != generation)
+                continue;           // databases changed meanwhile
+            s.pending.clear();
+            Postings data = watcher->result();
+            if (!data.ok)
+                return;             // generation already replaced; retry on next search
+            s.data = std::move(data);
+            s.generation = generation;
+            emit loaded();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&TextIndex::load, generation));
+}
+
+TextIndex::Postings TextIndex::load(const QString &generation)
+{
+    Postings data;
+    QFile terms(termsPath(generation));
+    QFile docs(docsPath(generation));
+    if (!terms.open(QIODevice::ReadOnly) || !docs.open(QIODevice::ReadOnly))
+        return data;
+
+    while (!terms.atEnd()) {
+        const QByteArray line = terms.readLine();
+        const int tab = line.indexOf('\t');
+        if (tab <= 0)
+            continue;
+        QVector<int> ids;
+        const QList<QByteArray> fields = line.mid(tab + 1).trimmed().split(' ');
+        ids.reserve(fields.size());
+        for (const QByteArray &id : fields)
+            ids.append(id.toInt());
+        data.terms.append(line.left(tab));
+        data.postings.append(ids);
+    }
+
+    qint64 offset = 0;
+    while (!docs.atEnd()) {
+        const QByteArray line = docs.readLine();
+        data.docOffsets.append(offset);
+        data.paths.append(QString::fromUtf8(line.left(line.indexOf('\t'))));
+        offset += line.size();
+    }
+
+    data.ok = true;
+    return data;
+}
+
+QVector<int> TextIndex::lookup(const Postings &data, const QByteArray &term, bool prefix)
+{
+    auto it = std::lower_bound(data.terms.cbegin(), data.terms.cend(), term);
+    if (!prefix) {
+        if (it == data.terms.cend() || *it != term)
+            return {};
+        return data.postings.at(it - data.terms.cbegin());
+    }
+
+    QVector<int> ids;
+    for (; it != data.terms.cend() && it->startsWith(term); ++it)
+        ids += data.postings.at(it - data.terms.cbegin());
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+QSet<QString> TextIndex::search(const QString &text)
+{
+    QSet<QString> result;
+
+    const QString normalised = normalise(text);
+    const QStringList words = normalised.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if (words.isEmpty())
+        return result;
+
+    // While the user is still typing the last word, match it as a prefix
+    const bool lastIsPrefix = !text.isEmpty() && isWordChar(text.back());
+
+    QList<QPair<QByteArray, bool>> keys;
+    for (int i = 0; i < words.size(); ++i) {
+        const QByteArray term = words.at(i).toUtf8();
+        if (term.size() > 1)
+            keys.append({term, lastIsPrefix && i == words.size() - 1});
+    }
+    if (keys.isEmpty())
+        return result;
+
+    // A single indexed word needs no phrase check; anything else is
+    // confirmed against the document text
+    const bool checkPhrase = words.size() > 1;
+    QByteArray phrase = normalised.toUtf8();
+    if (lastIsPrefix)
+        phrase.chop(1);
+
+    for (Shard &shard : m_shards) {
+        ensureLoaded(shard);
+        const Postings &data = shard.data;
+        if (data.terms.isEmpty())
+            continue;
+
+        QVector<int> docs = lookup(data, keys.first().first, keys.first().second);
+        for (int i = 1; i < keys.size() && !docs.isEmpty(); ++i)
+            docs = intersect(docs, lookup(data, keys.at(i).first, keys.at(i).second));
+        if (docs.isEmpty())
+            continue;
+
+        // The generation the postings came from, even if a newer one is
+        // already linked (it is kept until the update after next)
+        QFile file(docsPath(shard.generation));
+        if (checkPhrase && !file.open(QIODevice::ReadOnly))
+            continue;
+
+        for (int doc : std::as_const(docs)) {
+            if (doc < 1 || doc > data.paths.size())
+                continue;
+            if (checkPhrase) {
+                if (!file.seek(data.docOffsets.at(doc - 1)))
+                    continue;
+                const QByteArray line = file.readLine();
+                if (line.indexOf(phrase, line.indexOf('\t')) < 0)
+                    continue;
+            }
+            result.insert(data.paths.at(doc - 1));
+        }
+    }
+    return result;
+}
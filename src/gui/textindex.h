@@ -0,0 +1,76 @@
+// textindex.h
+// MusicLib Qt GUI — Lyrics/comment full-text index reader
+//
+// Reads the sidecar index written by musiclib_textindex.sh next to each
+// shard DSV (the generation directory "<dsv>.txtindex" links to; see TEXT
+// INDEX in musiclib_db.sh) and answers phrase queries with the paths of
+// matching tracks.  Term postings are parsed on a worker thread whenever
+// the link names a new generation, while the previous one keeps answering;
+// document text is only read back, by offset, to confirm a multi-word
+// phrase.  The last word may be a prefix, so results follow the filter box
+// as the user types.
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class TextIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TextIndex(QObject *parent = nullptr);
+
+    /// Use the indexes of these shard DSVs (missing indexes are skipped)
+    /// and start loading them.
+    void setDatabases(const QStringList &dsvPaths);
+
+    /// True when at least one shard has an index.
+    bool isAvailable() const;
+
+    /// Paths of tracks whose lyrics or comments contain @p text.  Empty when
+    /// nothing matches or the text has no word longer than one byte.  Only
+    /// shards whose index has finished loading take part.
+    QSet<QString> search(const QString &text);
+
+    /// Same normalisation as tnorm() in musiclib_db.sh: ASCII lower case,
+    /// curly apostrophes and other ASCII non-alphanumerics become spaces,
+    /// one space at each end.  Non-ASCII characters are kept as they are.
+    static QString normalise(const QString &text);
+
+signals:
+    /// A shard's index finished loading; results returned before may have
+    /// been incomplete.
+    void loaded();
+
+private:
+    struct Postings {
+        bool ok = false;
+        QList<QByteArray> terms;         // UTF-8, sorted byte-wise like the file
+        QVector<QVector<int>> postings;  // parallel to terms; 1-based doc numbers
+        QVector<qint64> docOffsets;      // doc N starts at docOffsets[N-1]
+        QStringList paths;               // doc N path at paths[N-1]
+    };
+
+    struct Shard {
+        QString  dsv;
+        QString  generation;             // directory the postings came from
+        QString  pending;                // directory being loaded, if any
+        Postings data;
+    };
+
+    void ensureLoaded(Shard &shard);
+    static QString currentGeneration(const QString &dsv);
+    static Postings load(const QString &generation);
+    static QVector<int> lookup(const Postings &data, const QByteArray &term, bool prefix);
+
+    QList<Shard> m_shards;
+};
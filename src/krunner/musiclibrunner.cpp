@@ -0,0 +1,217 @@
+// musiclibrunner.cpp
+// MusicLib KRunner plugin — Search, play and rate library tracks from KRunner
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "musiclibrunner.h"
+
+#include <KLocalizedString>
+#include <KRunner/QueryMatch>
+#include <KRunner/RunnerContext>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+K_PLUGIN_CLASS_WITH_JSON(MusicLibRunner, "plasma-runner-musiclib.json")
+
+static const QString TRIGGER = QStringLiteral("ml:");
+static const int     MAX_MATCHES = 20;
+
+MusicLibRunner::MusicLibRunner(QObject *parent, const KPluginMetaData &metaData)
+    : KRunner::AbstractRunner(parent, metaData)
+{
+    setMinLetterCount(3);
+
+    addSyntax(QStringLiteral(":q:"),
+              i18n("Finds tracks in the MusicLib library whose artist, title or album match :q:"));
+    addSyntax(QStringLiteral("ml: :q:"),
+              i18n("Searches only the MusicLib library for :q:"));
+    addSyntax(QStringLiteral("ml:rate 4 :q:"),
+              i18n("Rates the matching MusicLib track with the given number of stars (0-5)"));
+
+    m_actions = {
+        KRunner::Action(QStringLiteral("play"),   QStringLiteral("media-playback-start"),
+                        i18n("Play")),
+        KRunner::Action(QStringLiteral("rate"),   QStringLiteral("rating"),
+                        i18n("Rate…")),
+        KRunner::Action(QStringLiteral("folder"), QStringLiteral("document-open-folder"),
+                        i18n("Open Containing Folder")),
+    };
+}
+
+void MusicLibRunner::init()
+{
+    m_index.setDsvPaths(resolveDatabasePaths());
+    m_index.refreshIfChanged();
+
+    // Re-stat the DSV at the start of every query session.  A stat is
+    // microseconds; the reparse only happens if the file actually changed.
+    connect(this, &KRunner::AbstractRunner::prepare, this, [this]() {
+        m_index.refreshIfChanged();
+    });
+}
+
+QStringList MusicLibRunner::resolveDatabasePaths()
+{
+    QStringList configPaths;
+    const QByteArray envConf = qgetenv("MUSICLIB_CONFIG");
+    if (!envConf.isEmpty())
+        configPaths << QString::fromUtf8(envConf);
+    configPaths << QDir::homePath() + QStringLiteral("/.config/musiclib/musiclib.conf");
+    configPaths << QDir::homePath() + QStringLiteral("/musiclib/config/musiclib.conf");
+
+    for (const QString &path : configPaths) {
+        if (!QFileInfo::exists(path))
+            continue;
+        // The path goes in as $1, never into the script text, so quotes,
+        // '$' or backticks in it cannot break or extend the command
+        QProcess proc;
+        proc.start(QStringLiteral("bash"),
+                   {QStringLiteral("-c"),
+                    QStringLiteral("source \"$1\" 2>/dev/null"
+                                   " && printf '%s\\n%s\\n' \"$MUSICDB\" \"$LIBRARY_SHARDS\""),
+                    QStringLiteral("musiclib-krunner"), path});
+        if (!proc.waitForFinished(3000) || proc.exitCode() != 0)
+            continue;
+        const QStringList values = QString::fromUtf8(proc.readAllStandardOutput()).split(QLatin1Char('\n'));
+        const QString musicDb = values.value(0).trimmed();
+
+        // LIBRARY_SHARDS="name:root:dsv;..." — same parsing as the GUI;
+        // an unsharded library is the single shard MUSICDB
+        QStringList dsvs;
+        const QString shards = values.value(1).trimmed();
+        for (const QString &entry : shards.split(QLatin1Char(';'), Qt::SkipEmptyParts)) {
+            const QStringList parts = entry.trimmed().split(QLatin1Char(':'));
+            if (parts.size() < 3)
+                continue;
+            const QString dsv = parts.mid(2).join(QLatin1Char(':')).trimmed();
+            if (!dsv.isEmpty())
+                dsvs.append(dsv);
+        }
+        if (dsvs.isEmpty() && !musicDb.isEmpty())
+            dsvs.append(musicDb);
+        if (!dsvs.isEmpty())
+            return dsvs;
+    }
+
+    return {QDir::homePath() + QStringLiteral("/.local/share/musiclib/data/musiclib.dsv")};
+}
+
+void MusicLibRunner::match(KRunner::RunnerContext &context)
+{
+    QString query = context.query().trimmed();
+    bool explicitTrigger = false;
+    int  rateStars = -1;
+
+    if (query.startsWith(TRIGGER, Qt::CaseInsensitive)) {
+        explicitTrigger = true;
+        query = query.mid(TRIGGER.size()).trimmed();
+
+        static const QRegularExpression rateRe(QStringLiteral("^rate\\s+([0-5])\\s+(.+)$"),
+                                               QRegularExpression::CaseInsensitiveOption);
+        const QRegularExpressionMatch m = rateRe.match(query);
+        if (m.hasMatch()) {
+            rateStars = m.captured(1).toInt();
+            query = m.captured(2).trimmed();
+        }
+    }
+
+    if (query.size() < 3 || !context.isValid())
+        return;
+
+    // An absolute path names one track exactly; the Rate… action uses
+    // this so a common title cannot pick up other tracks
+    QVector<TrackHit> hits;
+    if (query.startsWith(QLatin1Char('/'))) {
+        IndexedTrack track;
+        if (m_index.find(query, &track))
+            hits.append({track, 1.0});
+    } else {
+        hits = m_index.match(query, MAX_MATCHES);
+    }
+    if (hits.isEmpty() || !context.isValid())
+        return;
+
+    QList<KRunner::QueryMatch> matches;
+    matches.reserve(hits.size());
+
+    for (const TrackHit &hit : hits) {
+        const IndexedTrack &t = hit.track;
+        KRunner::QueryMatch match(this);
+
+        const QString stars = t.stars > 0 ? QString(t.stars, QChar(0x2605)) : QString();
+        if (rateStars >= 0) {
+            match.setText(i18n("Rate %1 star(s): %2", rateStars, t.songTitle));
+            match.setData(QStringList{QStringLiteral("rate"), t.songPath,
+                                      QString::number(rateStars)});
+        } else {
+            match.setText(t.songTitle);
+            match.setData(QStringList{QStringLiteral("play"), t.songPath});
+            match.setActions(m_actions);
+        }
+        match.setSubtext(QStringLiteral("%1 — %2  %3").arg(t.artist, t.album, stars).trimmed());
+        match.setIconName(QStringLiteral("musiclib"));
+        match.setId(t.songPath);   // IDs repeat across shards
+        match.setRelevance(hit.relevance);
+        match.setCategoryRelevance(explicitTrigger
+                                       ? KRunner::QueryMatch::CategoryRelevance::Highest
+                                       : KRunner::QueryMatch::CategoryRelevance::Moderate);
+        matches.append(match);
+    }
+
+    context.addMatches(matches);
+}
+
+void MusicLibRunner::run(const KRunner::RunnerContext &context,
+                         const KRunner::QueryMatch &match)
+{
+    const QStringList data = match.data().toStringList();
+    if (data.size() < 2)
+        return;
+    const QString path = data.at(1);
+
+    if (const KRunner::Action action = match.selectedAction()) {
+        if (action.id() == QLatin1String("folder")) {
+            openFolder(path);
+        } else if (action.id() == QLatin1String("rate")) {
+            // Switch KRunner to the rate syntax for this exact file so the
+            // user only has to type the star count.
+            context.requestQueryStringUpdate(
+                QStringLiteral("ml:rate  %1").arg(path), 8);
+        } else {
+            playTrack(path);
+        }
+        return;
+    }
+
+    if (data.first() == QLatin1String("rate") && data.size() >= 3)
+        rateTrack(path, data.at(2).toInt());
+    else
+        playTrack(path);
+}
+
+void MusicLibRunner::playTrack(const QString &path) const
+{
+    // Same player preference as the library view's "Open with Audacious"
+    if (!QStandardPaths::findExecutable(QStringLiteral("audacious")).isEmpty())
+        QProcess::startDetached(QStringLiteral("audacious"), {path});
+    else
+        QProcess::startDetached(QStringLiteral("xdg-open"), {path});
+}
+
+void MusicLibRunner::rateTrack(const QString &path, int stars) const
+{
+    QProcess::startDetached(QStringLiteral("musiclib-cli"),
+                            {QStringLiteral("rate"), QString::number(stars), path});
+}
+
+void MusicLibRunner::openFolder(const QString &path) const
+{
+    QProcess::startDetached(QStringLiteral("dolphin"),
+                            {QStringLiteral("--select"), path});
+}
+
+#include "musiclibrunner.moc"
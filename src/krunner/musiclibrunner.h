@@ -0,0 +1,52 @@
+// musiclibrunner.h
+// MusicLib KRunner plugin — Search, play and rate library tracks from KRunner
+//
+// Query syntax:
+//   <text>               Tracks whose artist, title or album contain every
+//                        word of <text>.  Enter plays the track.
+//   ml: <text>           Same, but ranked above other runners' results.
+//   ml:rate N <text>     Enter rates the matched track N stars (0-5).
+//   /path/to/file        The track with exactly that SongPath, in any of
+//                        the forms above.
+//
+// Per-match actions: Play, Rate (opens the rate syntax for that track's
+// path, so only that file can be rated), Open Containing Folder.
+//
+// The runner never writes the database itself.  Playing launches the
+// player, rating dispatches to `musiclib-cli rate`, so all writes still
+// go through the shell backend (ADR-001).
+//
+// Copyright (c) 2026 MusicLib Project
+
+#pragma once
+
+#include "trackindex.h"
+
+#include <KRunner/AbstractRunner>
+
+class MusicLibRunner : public KRunner::AbstractRunner
+{
+    Q_OBJECT
+
+public:
+    MusicLibRunner(QObject *parent, const KPluginMetaData &metaData);
+
+    void match(KRunner::RunnerContext &context) override;
+    void run(const KRunner::RunnerContext &context,
+             const KRunner::QueryMatch &match) override;
+
+protected:
+    void init() override;
+
+private:
+    /// Resolve the shard DSVs (LIBRARY_SHARDS, else MUSICDB) from
+    /// musiclib.conf (same lookup order as musiclib-cli).
+    static QStringList resolveDatabasePaths();
+
+    void playTrack(const QString &path) const;
+    void rateTrack(const QString &path, int stars) const;
+    void openFolder(const QString &path) const;
+
+    TrackIndex       m_index;
+    KRunner::Actions m_actions;
+};
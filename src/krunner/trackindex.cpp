@@ -0,0 +1,190 @@
+// trackindex.cpp
+// MusicLib KRunner plugin — Search over the shared library snapshot
+//
+// Copyright (c) 2026 MusicLib Project
+
+#include "trackindex.h"
+
+#include <QByteArrayView>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+namespace {
+
+struct Candidate {
+    qreal relevance;
+    int   shard;
+    int   row;
+};
+
+// Orders the bounded heap so its top is the weakest candidate kept: lower
+// relevance first, and among equals the later row (earlier rows win ties)
+struct Weaker {
+    bool operator()(const Candidate &a, const Candidate &b) const
+    {
+        if (a.relevance != b.relevance)
+            return a.relevance > b.relevance;
+        return a.shard != b.shard ? a.shard < b.shard : a.row < b.row;
+    }
+};
+
+} // namespace
+
+void TrackIndex::setDsvPaths(const QStringList &paths)
+{
+    QWriteLocker locker(&m_lock);
+    if (paths == dsvPathsLocked())
+        return;
+    m_shards.clear();
+    for (const QString &path : paths) {
+        auto shard = std::make_unique<Shard>();
+        shard->snapshot.setDsvPath(path);
+        m_shards.push_back(std::move(shard));
+    }
+}
+
+QStringList TrackIndex::dsvPaths() const
+{
+    QReadLocker locker(&m_lock);
+    return dsvPathsLocked();
+}
+
+QStringList TrackIndex::dsvPathsLocked() const
+{
+    QStringList paths;
+    for (const auto &shard : m_shards)
+        paths.append(shard->snapshot.dsvPath());
+    return paths;
+}
+
+int TrackIndex::size() const
+{
+    QReadLocker locker(&m_lock);
+    int rows = 0;
+    for (const auto &shard : m_shards) {
+        if (shard->cols.search >= 0)
+            rows += shard->snapshot.rowCount();
+    }
+    return rows;
+}
+
+bool TrackIndex::refreshIfChanged()
+{
+    QWriteLocker locker(&m_lock);
+    bool changed = false;
+    for (const auto &shard : m_shards) {
+        LibrarySnapshot &snapshot = shard->snapshot;
+        if (snapshot.dsvPath().isEmpty() || !snapshot.refresh())
+            continue;
+
+        Columns &cols = shard->cols;
+        cols.id        = snapshot.column("ID");
+        cols.artist    = snapshot.column("Artist");
+        cols.album     = snapshot.column("Album");
+        cols.songTitle = snapshot.column("SongTitle");
+        cols.songPath  = snapshot.column("SongPath");
+        cols.groupDesc = snapshot.column("GroupDesc");
+        cols.search    = snapshot.column("SearchText");
+        changed = true;
+    }
+    return changed;
+}
+
+IndexedTrack TrackIndex::Shard::trackAt(int row) const
+{
+    IndexedTrack t;
+    t.id        = snapshot.text(row, cols.id);
+    t.artist    = snapshot.text(row, cols.artist);
+    t.album     = snapshot.text(row, cols.album);
+    t.songTitle = snapshot.text(row, cols.songTitle);
+    t.songPath  = snapshot.text(row, cols.songPath);
+    t.stars     = snapshot.cell(row, cols.groupDesc).toInt();
+    return t;
+}
+
+bool TrackIndex::find(const QString &path, IndexedTrack *track) const
+{
+    const QByteArray key = path.toUtf8();
+    QReadLocker locker(&m_lock);
+    for (const auto &shard : m_shards) {
+        if (shard->cols.search < 0)
+            continue;
+        const int row = shard->snapshot.findPath(key);
+        if (row >= 0) {
+            *track = shard->trackAt(row);
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector<TrackHit> TrackIndex::match(const QString &query, int limit) const
+{
+    QVector<TrackHit> hits;
+
+    QList<QByteArray> terms;
+    const QStringList words = query.toLower().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (const QString &w : words)
+        terms.append(w.toUtf8());
+    if (terms.isEmpty() || limit <= 0)
+        return hits;
+
+    const QByteArray &first = terms.first();
+
+    QReadLocker locker(&m_lock);
+
+    // Rank every matching row of every shard but keep only the best
+    // `limit` in a heap, so a short query that matches half the library
+    // neither drops later prefix hits nor decodes thousands of rows.
+    // Relevance is taken from the lower-cased SearchText
+    // ("artist\ttitle\t...") and GroupDesc; display fields are decoded
+    // for the winners only.
+    std::priority_queue<Candidate, std::vector<Candidate>, Weaker> best;
+    for (int s = 0; s < int(m_shards.size()); ++s) {
+        const LibrarySnapshot &snapshot = m_shards[s]->snapshot;
+        const Columns &cols = m_shards[s]->cols;
+        if (cols.search < 0)
+            continue;
+
+        const int rows = snapshot.rowCount();
+        for (int row = 0; row < rows; ++row) {
+            const QByteArray haystack = snapshot.cell(row, cols.search);
+            bool all = true;
+            for (const QByteArray &term : terms) {
+                if (!haystack.contains(term)) { all = false; break; }
+            }
+            if (!all || snapshot.cell(row, cols.songPath).isEmpty())
+                continue;
+
+            // Prefix hits on title or artist rank above mid-string hits
+            qreal relevance = 0.5;
+            const int tab = haystack.indexOf('\t');
+            if (tab >= 0 && QByteArrayView(haystack).sliced(tab + 1).startsWith(first))
+                relevance += 0.3;
+            if (haystack.startsWith(first))
+                relevance += 0.2;
+            // Tie-break toward higher-rated tracks
+            relevance += snapshot.cell(row, cols.groupDesc).toInt() * 0.01;
+
+            const Candidate candidate{relevance, s, row};
+            if (int(best.size()) < limit) {
+                best.push(candidate);
+            } else if (Weaker()(candidate, best.top())) {
+                best.pop();
+                best.push(candidate);
+            }
+        }
+    }
+
+    hits.resize(int(best.size()));
+    for (int i = int(best.size()) - 1; i >= 0; --i) {
+        const Candidate &c = best.top();
+        hits[i] = {m_shards[c.shard]->trackAt(c.row), c.relevance};
+        best.pop();
+    }
+    return hits;
+}
@@ -0,0 +1,429 @@
+#!/bin/bash
+# Test suite for the DSV write paths in bin/musiclib_db.sh and the batch
+# rating in bin/musiclib_rate.sh
+#
+# Covers:
+#   - Snapshot backups: create, unchanged, byte-exact restore, retention
+#     and chunk pruning, one set per DSV absolute path
+#   - delete_records_batch: found and not-found rows, DSV left untouched
+#     when nothing matched, one delete event per removed row
+#   - Batch rating across two library shards (kid3-cli stubbed)
+#   - Batch remove across two shards, reported in request order
+#   - clusters apply: Custom2 set in every shard and in the file tags
+#   - publish_change: sequence numbers stay continuous across a trim, and
+#     an event lost to a busy journal lock turns into a reload
+#
+# Fixtures: tests/data/library_local.dsv, library_other.dsv and
+# test_backend.conf.
+#
+# Usage: bash tests/test_db_backend.sh
+# Exit:  0 = all pass, 1 = any fail
+
+set -uo pipefail
+
+REPO="$(cd "$(dirname "$0")/.." && pwd)"
+DATA="$REPO/tests/data"
+PASS=0
+FAIL=0
+
+# ── Assertion helpers ─────────────────────────────────────────────────────────
+
+_pass() { echo "  PASS: $1"; PASS=$(( PASS + 1 )); }
+_fail() { echo "  FAIL: $1"; FAIL=$(( FAIL + 1 )); }
+
+assert_eq() {
+    local desc="$1" expected="$2" actual="$3"
+    if [ "$expected" = "$actual" ]; then _pass "$desc"
+    else _fail "$desc (expected='$expected', got='$actual')"; fi
+}
+
+assert_files_equal() {
+    local desc="$1" expected="$2" actual="$3"
+    if cmp -s "$expected" "$actual"; then _pass "$desc"
+    else _fail "$desc ($actual differs from $expected)"; fi
+}
+
+assert_file_contains() {
+    local desc="$1" pattern="$2" file="$3"
+    if grep -qF -- "$pattern" "$file" 2>/dev/null; then _pass "$desc"
+    else _fail "$desc (pattern not found: '$pattern' in $file)"; fi
+}
+
+# ── Sandbox ───────────────────────────────────────────────────────────────────
+# Every test gets a fresh TEST_ROOT holding the config, HOME, databases and
+# logs.  Stubs for kid3-cli, setfattr, kdialog and dbus-send come first on
+# PATH, so nothing outside the sandbox is touched.
+
+setup_sandbox() {
+    TEST_ROOT=$(mktemp -d)
+    export TEST_ROOT
+    mkdir -p "$TEST_ROOT/config" "$TEST_ROOT/home" "$TEST_ROOT/data" \
+             "$TEST_ROOT/logs" "$TEST_ROOT/stubs"
+    cp "$DATA/test_backend.conf" "$TEST_ROOT/config/musiclib.conf"
+
+    local tool
+    for tool in kid3-cli setfattr kdialog dbus-send; do
+        printf '#!/bin/bash\nprintf "%%s\\n" "$*" >> "%s/%s.calls"\n' \
+            "$TEST_ROOT" "$tool" > "$TEST_ROOT/stubs/$tool"
+        chmod +x "$TEST_ROOT/stubs/$tool"
+    done
+    printf '#!/bin/bash\nexit 1\n' > "$TEST_ROOT/stubs/musiclib-cli"
+    chmod +x "$TEST_ROOT/stubs/musiclib-cli"
+}
+
+# Copy a fixture DSV to <dest>, moving its /music paths under <root>
+install_dsv() {
+    local fixture="$1" dest="$2" root="$3"
+    sed "s|\^/music/|^$root/|" "$DATA/$fixture" > "$dest"
+}
+
+# Source musiclib_utils.sh and musiclib_db.sh into this shell, with the
+# sandbox config loaded
+load_backend() {
+    HOME="$TEST_ROOT/home"
+    MUSICLIB_CONFIG_DIR="$TEST_ROOT/config"
+    MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none"
+    PATH="$TEST_ROOT/stubs:$PATH"
+    # shellcheck source=/dev/null
+    source "$REPO/bin/musiclib_utils.sh"
+    # shellcheck source=/dev/null
+    source "$REPO/bin/musiclib_db.sh"
+    load_config
+}
+
+# Field <col> of the row whose SongPath ends in <suffix>
+row_field() {
+    awk -F'^' -v s="$2" -v c="$3" 'NR > 1 && substr($7, length($7) - length(s) + 1) == s { print $c }' "$1"
+}
+
+# Sequence numbers of a change journal, one per line
+journal_seqs() {
+    sed -n 's/^{"seq":\([0-9]*\),.*/\1/p' "$1"
+}
+
+# ── Test: snapshot backups ────────────────────────────────────────────────────
+
+test_snapshot() {
+    echo ""
+    echo "--- snapshot create / restore / prune ---"
+    (
+        setup_sandbox
+        load_backend
+        local db="$MUSICDB"
+        cp "$DATA/library_local.dsv" "$db"
+        cp "$db" "$TEST_ROOT/v1.dsv"
+
+        local first second
+        first=$(db_snapshot_create "$db")
+        assert_eq "first snapshot created" "created" "$(cut -f2 <<< "$first")"
+        second=$(db_snapshot_create "$db")
+        assert_eq "same content is not stored twice" "unchanged" "$(cut -f2 <<< "$second")"
+        assert_eq "unchanged reports the existing id" "$(cut -f1 <<< "$first")" "$(cut -f1 <<< "$second")"
+
+        local snap
+        snap=$(db_snapshot_file "$db" "$(cut -f1 <<< "$first")")
+        db_snapshot_restore "$snap" "$TEST_ROOT/restored_v1.dsv"
+        assert_files_equal "restore is byte for byte" "$TEST_ROOT/v1.dsv" "$TEST_ROOT/restored_v1.dsv"
+
+        # Age the first snapshot past retention, then store new content
+        local set_dir old_id
+        set_dir=$(db_snapshot_set_dir "$db")
+        old_id=$(date -d '-400 days' '+%Y%m%d_%H%M%S')
+        mv "$snap" "$set_dir/$old_id.snap"
+
+        sed -i 's|^3^Birch^\(.*\)^196^^4^|3^Birch^\1^255^^5^|' "$db"
+        cp "$db" "$TEST_ROOT/v2.dsv"
+        db_snapshot_create "$db" > /dev/null
+        local latest
+        latest=$(db_snapshot_file "$db" latest)
+
+        # Two snapshots on one day older than the keep-all window: only the
+        # newer of the two survives
+        local day
+        day=$(date -d '-10 days' '+%Y%m%d')
+        cp "$latest" "$set_dir/${day}_010000.snap"
+        cp "$latest" "$set_dir/${day}_020000.snap"
+
+        local pruned
+        pruned=$(db_snapshot_prune)
+        assert_eq "expired and same-day snapshots removed" "2" "$(cut -f1 <<< "$pruned")"
+        assert_eq "chunk only the expired snapshot used removed" "1" "$(cut -f2 <<< "$pruned")"
+        assert_eq "snapshots left" "2" "$(db_snapshot_list "$db" | wc -l)"
+        assert_eq "newer same-day snapshot kept" "${day}_020000" "$(db_snapshot_list "$db" | head -n 1 | cut -f1)"
+
+        db_snapshot_restore "$(db_snapshot_file "$db" latest)" "$TEST_ROOT/restored_v2.dsv"
+        assert_files_equal "latest restores byte for byte after prune" "$TEST_ROOT/v2.dsv" "$TEST_ROOT/restored_v2.dsv"
+
+        # A DSV with the same file name elsewhere gets its own set
+        mkdir -p "$TEST_ROOT/elsewhere"
+        cp "$DATA/library_other.dsv" "$TEST_ROOT/elsewhere/musiclib.dsv"
+        db_snapshot_create "$TEST_ROOT/elsewhere/musiclib.dsv" > /dev/null
+        assert_eq "same-named DSV kept apart" "1" "$(db_snapshot_list "$TEST_ROOT/elsewhere/musiclib.dsv" | wc -l)"
+        assert_eq "original set unaffected" "2" "$(db_snapshot_list "$db" | wc -l)"
+
+        rm -rf "$TEST_ROOT"
+    ) > "$RESULTS"
+    collect
+}
+
+# ── Test: delete_records_batch ────────────────────────────────────────────────
+
+test_delete_records_batch() {
+    echo ""
+    echo "--- delete_records_batch ---"
+    (
+        setup_sandbox
+        load_backend
+        local db="$MUSICDB" list="$TEST_ROOT/list" results
+        cp "$DATA/library_local.dsv" "$db"
+
+        printf '%s\t%s\n' \
+            2 /music/a/01.mp3 \
+            9 /music/x/01.mp3 \
+            3 /music/c/01.mp3 \
+            5 /music/d/01.mp3 > "$list"
+        results=$(delete_records_batch "$db" "$list" 2>/dev/null)
+
+        assert_eq "one result per request, in order" \
+            "$(printf 'removed\t2\t/music/a/01.mp3\nnot-found\t9\t/music/x/01.mp3\nnot-found\t3\t/music/c/01.mp3\nremoved\t5\t/music/d/01.mp3')" \
+            "$results"
+        grep -v -e '^2^' -e '^5^' "$DATA/library_local.dsv" > "$TEST_ROOT/expected.dsv"
+        assert_files_equal "only the matched rows removed" "$TEST_ROOT/expected.dsv" "$db"
+        assert_eq "one delete event per removed row" "2 5" \
+            "$(sed -n 's/.*"op":"delete","id":"\([0-9]*\)".*/\1/p' "$db.changes" | paste -sd' ')"
+
+        # Nothing matches: the DSV is not rewritten and nothing is published
+        cp "$db" "$TEST_ROOT/before.dsv"
+        local inode
+        inode=$(stat -c %i "$db")
+        printf '%s\t%s\n' 9 /music/x/01.mp3 > "$list"
+        results=$(delete_records_batch "$db" "$list" 2>/dev/null)
+        assert_eq "not-found only" "$(printf 'not-found\t9\t/music/x/01.mp3')" "$results"
+        assert_eq "DSV not rewritten" "$inode" "$(stat -c %i "$db")"
+        assert_files_equal "DSV unchanged" "$TEST_ROOT/before.dsv" "$db"
+        assert_eq "no further events" "2" "$(wc -l < "$db.changes")"
+
+        rm -rf "$TEST_ROOT"
+    ) > "$RESULTS"
+    collect
+}
+
+# ── Test: batch rating across shards ──────────────────────────────────────────
+
+test_batch_rate_shards() {
+    echo ""
+    echo "--- batch rate across shards ---"
+    setup_sandbox
+
+    local main="$TEST_ROOT/data/main.dsv" archive="$TEST_ROOT/data/archive.dsv"
+    install_dsv library_local.dsv "$main" "$TEST_ROOT/music"
+    install_dsv library_other.dsv "$archive" "$TEST_ROOT/archive"
+    cp "$main" "$TEST_ROOT/main.before"
+    cp "$archive" "$TEST_ROOT/archive.before"
+
+    local f
+    for f in music/a/01.mp3 music/a/02.mp3 music/c/01.mp3 music/z/01.mp3 \
+             archive/b/01.mp3 archive/e/01.mp3; do
+        mkdir -p "$TEST_ROOT/${f%/*}"
+        : > "$TEST_ROOT/$f"
+    done
+
+    local output rc
+    output=$(HOME="$TEST_ROOT/home" \
+             MUSICLIB_CONFIG_DIR="$TEST_ROOT/config" \
+             MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none" \
+             MUSICLIB_CLI="$TEST_ROOT/stubs/musiclib-cli" \
+             TEST_LIBRARY_SHARDS="main:$TEST_ROOT/music:$main;archive:$TEST_ROOT/archive:$archive" \
+             PATH="$TEST_ROOT/stubs:$PATH" \
+        bash "$REPO/bin/musiclib_rate.sh" 4 \
+            "$TEST_ROOT/music/a/02.mp3" "$TEST_ROOT/archive/b/01.mp3" \
+            "$TEST_ROOT/music/c/01.mp3" "$TEST_ROOT/archive/e/01.mp3" \
+            "$TEST_ROOT/music/z/01.mp3" 2>"$TEST_ROOT/stderr"); rc=$?
+
+    assert_eq "exit code 0" "0" "$rc"
+    assert_eq "tags written in one kid3-cli run" "1" \
+        "$(grep -c 'set POPM' "$TEST_ROOT/kid3-cli.calls")"
+    assert_eq "main: a/02 rated"  "196^4" "$(row_field "$main" /music/a/02.mp3 10)^$(row_field "$main" /music/a/02.mp3 12)"
+    assert_eq "main: c/01 rated"  "196^4" "$(row_field "$main" /music/c/01.mp3 10)^$(row_field "$main" /music/c/01.mp3 12)"
+    assert_eq "archive: b/01 rated" "196^4" "$(row_field "$archive" /archive/b/01.mp3 10)^$(row_field "$archive" /archive/b/01.mp3 12)"
+    assert_eq "archive: e/01 rated" "196^4" "$(row_field "$archive" /archive/e/01.mp3 10)^$(row_field "$archive" /archive/e/01.mp3 12)"
+    assert_eq "main: only the rated rows changed" "2" \
+        "$(diff "$TEST_ROOT/main.before" "$main" | grep -c '^<')"
+    # e/01 already has four stars in the fixture, so its row stays the same
+    assert_eq "archive: only the rated rows changed" "1" \
+        "$(diff "$TEST_ROOT/archive.before" "$archive" | grep -c '^<')"
+    assert_eq "main: one update event per row"    "2" "$(grep -c '"op":"update"' "$main.changes")"
+    assert_eq "archive: one update event per row" "2" "$(grep -c '"op":"update"' "$archive.changes")"
+    assert_eq "default database untouched" "" "$(ls "$TEST_ROOT/data/musiclib.dsv" 2>/dev/null)"
+    assert_file_contains "summary counts every shard" "4 tracks rated" <(printf '%s\n' "$output")
+    assert_file_contains "file in no shard reported" "1 not in database" <(printf '%s\n' "$output")
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: batch remove reports in request order ───────────────────────────────
+
+test_batch_remove_order() {
+    echo ""
+    echo "--- batch remove across shards ---"
+    setup_sandbox
+
+    local main="$TEST_ROOT/data/main.dsv" archive="$TEST_ROOT/data/archive.dsv"
+    install_dsv library_local.dsv "$main" "$TEST_ROOT/music"
+    install_dsv library_other.dsv "$archive" "$TEST_ROOT/archive"
+
+    # Shards interleaved, plus an unknown row and a malformed line
+    printf '%s\n' "11	$TEST_ROOT/archive/b/01.mp3" "3	$TEST_ROOT/music/b/01.mp3" \
+        "not-a-request" "14	$TEST_ROOT/archive/e/01.mp3" "99	$TEST_ROOT/music/x/01.mp3" \
+        "1	$TEST_ROOT/music/c/01.mp3" > "$TEST_ROOT/list"
+
+    local output rc
+    output=$(HOME="$TEST_ROOT/home" \
+             MUSICLIB_CONFIG_DIR="$TEST_ROOT/config" \
+             MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none" \
+             TEST_LIBRARY_SHARDS="main:$TEST_ROOT/music:$main;archive:$TEST_ROOT/archive:$archive" \
+             PATH="$TEST_ROOT/stubs:$PATH" \
+        bash "$REPO/bin/musiclib_remove_record.sh" --batch "$TEST_ROOT/list" 2>"$TEST_ROOT/stderr"); rc=$?
+
+    assert_eq "exit code 1 (some requests failed)" "1" "$rc"
+    assert_eq "report follows the request list" \
+        "removed:11 removed:3 invalid:not-a-request removed:14 not-found:99 removed:1" \
+        "$(printf '%s\n' "$output" | awk -F'\t' 'NF >= 3 { printf "%s%s:%s", sep, $1, $2; sep = " " }')"
+    assert_eq "main: three rows left"  "3" "$(tail -n +2 "$main" | wc -l)"
+    assert_eq "archive: four rows left" "4" "$(tail -n +2 "$archive" | wc -l)"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: cluster mapping writes Custom2 to the database and the tags ────────
+
+test_clusters_apply() {
+    echo ""
+    echo "--- clusters apply across shards ---"
+    setup_sandbox
+
+    local main="$TEST_ROOT/data/main.dsv" archive="$TEST_ROOT/data/archive.dsv"
+    install_dsv library_local.dsv "$main" "$TEST_ROOT/music"
+    install_dsv library_other.dsv "$archive" "$TEST_ROOT/archive"
+
+    local f
+    for f in music/a/01.mp3 music/b/01.mp3 archive/a/01.mp3 archive/b/01.mp3; do
+        mkdir -p "$TEST_ROOT/${f%/*}"
+        : > "$TEST_ROOT/$f"
+    done
+    printf '# musiclib clusters: artists\n1\tThe Aspen\tAspen\t5\n2\tBirch Trees\tBirch\t2\n' \
+        > "$TEST_ROOT/mapping.tsv"
+
+    local output rc
+    output=$(HOME="$TEST_ROOT/home" \
+             MUSICLIB_CONFIG_DIR="$TEST_ROOT/config" \
+             MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none" \
+             TEST_LIBRARY_SHARDS="main:$TEST_ROOT/music:$main;archive:$TEST_ROOT/archive:$archive" \
+             PATH="$TEST_ROOT/stubs:$PATH" \
+        bash "$REPO/bin/musiclib_clusters.sh" apply "$TEST_ROOT/mapping.tsv" 2>"$TEST_ROOT/stderr"); rc=$?
+
+    assert_eq "exit code 0" "0" "$rc"
+    assert_file_contains "summary counts every shard" "Set Custom2 on 5 tracks" <(printf '%s\n' "$output")
+    assert_eq "main: a/01 mapped"  "The Aspen"    "$(row_field "$main" /music/a/01.mp3 11)"
+    assert_eq "main: b/01 mapped"  "Birch Trees"  "$(row_field "$main" /music/b/01.mp3 11)"
+    assert_eq "main: set Custom2 kept" "Local Artist" "$(row_field "$main" /music/a/02.mp3 11)"
+    assert_eq "archive: b/01 mapped" "Birch Trees" "$(row_field "$archive" /archive/b/01.mp3 11)"
+    assert_eq "one kid3-cli run per canonical name" "2" "$(wc -l < "$TEST_ROOT/kid3-cli.calls")"
+    assert_eq "Birch Trees run tags both shards" \
+        "-c set Songs-DB_Custom2 \"Birch Trees\" $TEST_ROOT/music/b/01.mp3 $TEST_ROOT/archive/b/01.mp3" \
+        "$(grep 'Birch Trees' "$TEST_ROOT/kid3-cli.calls")"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: change feed sequence across a trim ──────────────────────────────────
+
+test_publish_change_trim() {
+    echo ""
+    echo "--- publish_change across a trim ---"
+    (
+        setup_sandbox
+        load_backend
+        local db="$MUSICDB" i
+        cp "$DATA/library_local.dsv" "$db"
+        CHANGE_FEED_MAX_EVENTS=20
+
+        for (( i = 1; i <= 130; i++ )); do
+            publish_change "$db" update "$i" "/music/a/01.mp3" Rating 0 "$i"
+        done
+
+        local seqs
+        seqs=$(journal_seqs "$db.changes")
+        assert_eq "journal trimmed at seq 100" "40" "$(wc -l <<< "$seqs")"
+        assert_eq "oldest kept event" "91" "$(head -n 1 <<< "$seqs")"
+        assert_eq "newest event" "130" "$(tail -n 1 <<< "$seqs")"
+        assert_eq "no gaps or repeats" "" \
+            "$(awk 'NR > 1 && $1 != prev + 1 { print prev " -> " $1 } { prev = $1 }' <<< "$seqs")"
+        wait    # signals are sent in the background
+        assert_eq "signal sent per event" "130" "$(wc -l < "$TEST_ROOT/dbus-send.calls")"
+
+        rm -rf "$TEST_ROOT"
+    ) > "$RESULTS"
+    collect
+}
+
+# ── Test: change feed lock timeout ────────────────────────────────────────────
+
+test_publish_change_busy() {
+    echo ""
+    echo "--- publish_change with the journal lock held ---"
+    (
+        setup_sandbox
+        load_backend
+        local db="$MUSICDB"
+        cp "$DATA/library_local.dsv" "$db"
+
+        publish_change "$db" update 1 "/music/a/01.mp3" Rating 0 64
+
+        # Another publisher holds the lock past the 5 s wait
+        flock -x "$db.changes.lock" sleep 7 &
+        local holder=$!
+        sleep 0.5
+        publish_change "$db" update 1 "/music/a/01.mp3" Rating 64 128 2>/dev/null
+        assert_eq "lost event leaves a gap marker" "yes" \
+            "$([ -e "$db.changes.gap" ] && echo yes || echo no)"
+        wait "$holder"
+
+        publish_change "$db" update 1 "/music/a/01.mp3" Rating 128 196
+        assert_eq "marker cleared" "no" "$([ -e "$db.changes.gap" ] && echo yes || echo no)"
+        assert_eq "reload precedes the next event" "update reload update" \
+            "$(sed -n 's/.*"op":"\([a-z]*\)".*/\1/p' "$db.changes" | paste -sd' ')"
+        assert_eq "sequence stays continuous" "1 2 3" "$(journal_seqs "$db.changes" | paste -sd' ')"
+
+        rm -rf "$TEST_ROOT"
+    ) > "$RESULTS"
+    collect
+}
+
+# Tests that source the backend run in a subshell; fold their PASS/FAIL
+# lines back into this shell's counters
+collect() {
+    cat "$RESULTS"
+    PASS=$(( PASS + $(grep -c '^  PASS:' "$RESULTS") ))
+    FAIL=$(( FAIL + $(grep -c '^  FAIL:' "$RESULTS") ))
+}
+
+# ── Runner ────────────────────────────────────────────────────────────────────
+
+RESULTS=$(mktemp)
+trap 'rm -f "$RESULTS"' EXIT
+
+test_snapshot
+test_delete_records_batch
+test_batch_rate_shards
+test_batch_remove_order
+test_clusters_apply
+test_publish_change_trim
+test_publish_change_busy
+
+echo ""
+echo "══════════════════════════════════════════════════"
+printf "  Results: %d passed, %d failed\n" "$PASS" "$FAIL"
+echo "══════════════════════════════════════════════════"
+
+[ "$FAIL" -eq 0 ]
@@ -0,0 +1,187 @@
+#!/bin/bash
+# Test suite for bin/musiclib_db_merge.sh
+#
+# Covers:
+#   - Merge rules: newer LastTimePlayed wins, unrated side loses, rating
+#     conflicts resolved by --rating, Custom2 filled only when empty
+#   - Report: UPDATE / CONFLICT / OTHER_ONLY / DUPLICATE lines
+#   - Output keeps the local database's ID order, byte for byte
+#   - Preview leaves the database alone; --apply replaces it
+#
+# Fixtures: tests/data/library_local.dsv, library_other.dsv and the expected
+# result library_merged.dsv.
+#
+# Usage: bash tests/test_db_merge.sh
+# Exit:  0 = all pass, 1 = any fail
+
+set -uo pipefail
+
+REPO="$(cd "$(dirname "$0")/.." && pwd)"
+SCRIPT="$REPO/bin/musiclib_db_merge.sh"
+DATA="$REPO/tests/data"
+PASS=0
+FAIL=0
+
+# ── Assertion helpers ─────────────────────────────────────────────────────────
+
+_pass() { echo "  PASS: $1"; PASS=$(( PASS + 1 )); }
+_fail() { echo "  FAIL: $1"; FAIL=$(( FAIL + 1 )); }
+
+assert_eq() {
+    local desc="$1" expected="$2" actual="$3"
+    if [ "$expected" = "$actual" ]; then _pass "$desc"
+    else _fail "$desc (expected='$expected', got='$actual')"; fi
+}
+
+assert_files_equal() {
+    local desc="$1" expected="$2" actual="$3"
+    if cmp -s "$expected" "$actual"; then _pass "$desc"
+    else _fail "$desc ($actual differs from $expected)"; fi
+}
+
+assert_file_contains() {
+    local desc="$1" pattern="$2" file="$3"
+    if grep -qF -- "$pattern" "$file" 2>/dev/null; then _pass "$desc"
+    else _fail "$desc (pattern not found: '$pattern' in $file)"; fi
+}
+
+# JSON summary field (numbers and booleans only)
+json_field() {
+    sed -n "s/.*\"$1\": \([a-z0-9]*\).*/\1/p" <<< "$2"
+}
+
+# ── Sandbox ───────────────────────────────────────────────────────────────────
+# A config that keeps every path under TEST_ROOT, and a HOME that is not
+# the user's.
+
+setup_sandbox() {
+    TEST_ROOT=$(mktemp -d)
+    export TEST_ROOT
+    mkdir -p "$TEST_ROOT/config" "$TEST_ROOT/home" "$TEST_ROOT/data" "$TEST_ROOT/logs"
+    cp "$DATA/test_backend.conf" "$TEST_ROOT/config/musiclib.conf"
+    cp "$DATA/library_local.dsv" "$TEST_ROOT/data/musiclib.dsv"
+    cp "$DATA/library_other.dsv" "$TEST_ROOT/other.dsv"
+}
+
+run_merge() {
+    HOME="$TEST_ROOT/home" \
+    MUSICLIB_CONFIG_DIR="$TEST_ROOT/config" \
+    MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none" \
+        bash "$SCRIPT" "$TEST_ROOT/other.dsv" "$@" 2>"$TEST_ROOT/stderr"
+}
+
+# ── Test: preview merge ───────────────────────────────────────────────────────
+
+test_merge_preview() {
+    echo ""
+    echo "--- merge (preview) ---"
+    setup_sandbox
+
+    local out="$TEST_ROOT/merged.dsv" report="$TEST_ROOT/merged.report" summary rc
+    summary=$(run_merge -o "$out" -r "$report"); rc=$?
+
+    assert_eq          "exit code 0"                       "0" "$rc"
+    assert_files_equal "merged rows, in local ID order"    "$DATA/library_merged.dsv" "$out"
+    assert_files_equal "database untouched by a preview"   "$DATA/library_local.dsv" "$TEST_ROOT/data/musiclib.dsv"
+
+    assert_eq "matched"            "4" "$(json_field matched "$summary")"
+    assert_eq "updated"            "2" "$(json_field updated "$summary")"
+    assert_eq "lastplayed_updates" "2" "$(json_field lastplayed_updates "$summary")"
+    assert_eq "rating_updates"     "2" "$(json_field rating_updates "$summary")"
+    assert_eq "custom2_updates"    "1" "$(json_field custom2_updates "$summary")"
+    assert_eq "conflicts"          "2" "$(json_field conflicts "$summary")"
+    assert_eq "local_only"         "1" "$(json_field local_only "$summary")"
+    assert_eq "other_only"         "1" "$(json_field other_only "$summary")"
+    assert_eq "duplicates"         "1" "$(json_field duplicates "$summary")"
+    assert_eq "applied"            "false" "$(json_field applied "$summary")"
+
+    # Unrated local row takes the other rating without a conflict
+    assert_file_contains "unrated side takes the rating" \
+        $'UPDATE\t/music/a/01.mp3\tRating\t0\t255' "$report"
+    # Both rated: the side played more recently wins
+    assert_file_contains "conflict: newer play keeps local" \
+        $'CONFLICT\t/music/b/01.mp3\tRating\t196/4\t64/2\tlocal' "$report"
+    assert_file_contains "conflict: newer play takes other" \
+        $'CONFLICT\t/music/c/01.mp3\tRating\t128/3\t255/5\tother' "$report"
+    assert_file_contains "Custom2 filled when empty" \
+        $'UPDATE\t/music/c/01.mp3\tCustom2\t\tOther Artist' "$report"
+    assert_file_contains "other-only row reported" \
+        $'OTHER_ONLY\t/music/e/01.mp3' "$report"
+    assert_file_contains "duplicate other row reported" \
+        $'DUPLICATE\t/music/a/01.mp3' "$report"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: --rating local ──────────────────────────────────────────────────────
+
+test_merge_rating_local() {
+    echo ""
+    echo "--- merge --rating local ---"
+    setup_sandbox
+
+    local out="$TEST_ROOT/merged.dsv" report="$TEST_ROOT/merged.report" summary
+    summary=$(run_merge -o "$out" -r "$report" --rating local)
+
+    assert_eq "conflicts still reported" "2" "$(json_field conflicts "$summary")"
+    assert_file_contains "conflict keeps local" \
+        $'CONFLICT\t/music/c/01.mp3\tRating\t128/3\t255/5\tlocal' "$report"
+    assert_eq "local rating kept" "128^3" \
+        "$(awk -F'^' '$7 == "/music/c/01.mp3" { print $10 "^" $12 }' "$out")"
+    assert_eq "LastTimePlayed still merged" "45500.000000" \
+        "$(awk -F'^' '$7 == "/music/c/01.mp3" { print $13 }' "$out")"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: --apply ─────────────────────────────────────────────────────────────
+
+test_merge_apply() {
+    echo ""
+    echo "--- merge --apply ---"
+    setup_sandbox
+
+    local db="$TEST_ROOT/data/musiclib.dsv" summary rc
+    summary=$(run_merge -o "$TEST_ROOT/merged.dsv" -r "$TEST_ROOT/merged.report" --apply); rc=$?
+
+    assert_eq          "exit code 0"                   "0" "$rc"
+    assert_eq          "applied"                       "true" "$(json_field applied "$summary")"
+    assert_files_equal "database replaced by merge"    "$DATA/library_merged.dsv" "$db"
+    assert_file_contains "reload published"            '"op":"reload"' "$db.changes"
+    assert_eq          "no temp file left"             "" "$(ls "$db".tmp 2>/dev/null)"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Test: argument errors ─────────────────────────────────────────────────────
+
+test_merge_errors() {
+    echo ""
+    echo "--- merge errors ---"
+    setup_sandbox
+
+    local rc
+    run_merge --rating newest >/dev/null; rc=$?
+    assert_eq "bad --rating is a user error" "1" "$rc"
+
+    HOME="$TEST_ROOT/home" MUSICLIB_CONFIG_DIR="$TEST_ROOT/config" \
+    MUSICLIB_SYSTEM_CONFIG_DIR="$TEST_ROOT/none" \
+        bash "$SCRIPT" "$TEST_ROOT/data/musiclib.dsv" >/dev/null 2>&1; rc=$?
+    assert_eq "merging a database with itself is refused" "1" "$rc"
+
+    rm -rf "$TEST_ROOT"
+}
+
+# ── Runner ────────────────────────────────────────────────────────────────────
+
+test_merge_preview
+test_merge_rating_local
+test_merge_apply
+test_merge_errors
+
+echo ""
+echo "══════════════════════════════════════════════════"
+printf "  Results: %d passed, %d failed\n" "$PASS" "$FAIL"
+echo "══════════════════════════════════════════════════"
+
+[ "$FAIL" -eq 0 ]